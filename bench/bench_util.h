@@ -0,0 +1,193 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#define _GNU_SOURCE
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<time.h>
+#include<inttypes.h>
+
+// the helpers shared by the benchmark drivers, wale_bench.c and wale_read_bench.c
+// the option lists, the pseudo random numbers, the log record size distributions, the backends and the latency percentiles
+
+#define MAX_LIST_SIZE 32
+
+typedef struct value_list value_list;
+struct value_list
+{
+	uint32_t count;
+	const char* values[MAX_LIST_SIZE];
+};
+
+// splits the comma separated list in place, returns 0 if it has too many values
+static int parse_value_list(value_list* list, char* str)
+{
+	list->count = 0;
+	char* save_ptr = NULL;
+	for(char* value = strtok_r(str, ",", &save_ptr); value != NULL; value = strtok_r(NULL, ",", &save_ptr))
+	{
+		if(list->count == MAX_LIST_SIZE)
+			return 0;
+		list->values[list->count++] = value;
+	}
+	return list->count > 0;
+}
+
+// -------------------------------------------------------------
+// the pseudo random numbers, every thread has its own generator, seeded from the seed and the thread_id, so that the runs are reproducible
+
+static uint64_t next_random(uint64_t* state)
+{
+	// splitmix64
+	uint64_t z = ((*state) += UINT64_C(0x9E3779B97F4A7C15));
+	z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+	return z ^ (z >> 31);
+}
+
+// -------------------------------------------------------------
+// distribution of the log record sizes
+
+typedef enum record_size_distribution_type record_size_distribution_type;
+enum record_size_distribution_type
+{
+	FIXED,
+	UNIFORM,
+	EXPONENTIAL,
+};
+
+typedef struct record_size_distribution record_size_distribution;
+struct record_size_distribution
+{
+	record_size_distribution_type type;
+	uint32_t min;
+	uint32_t max;
+	uint32_t mean;
+};
+
+static int parse_record_size_distribution(record_size_distribution* dist, const char* str)
+{
+	unsigned int a, b;
+	if(sscanf(str, "fixed:%u", &a) == 1 && a > 0)
+	{
+		(*dist) = (record_size_distribution){.type = FIXED, .min = a, .max = a, .mean = a};
+		return 1;
+	}
+	if(sscanf(str, "uniform:%u-%u", &a, &b) == 2 && a > 0 && a <= b)
+	{
+		(*dist) = (record_size_distribution){.type = UNIFORM, .min = a, .max = b, .mean = (a + b) / 2};
+		return 1;
+	}
+	if(sscanf(str, "exponential:%u", &a) == 1 && a > 0)
+	{
+		(*dist) = (record_size_distribution){.type = EXPONENTIAL, .min = 1, .max = 16 * a, .mean = a};
+		return 1;
+	}
+	return 0;
+}
+
+static uint32_t get_next_record_size(const record_size_distribution* dist, uint64_t* random_state)
+{
+	switch(dist->type)
+	{
+		case FIXED :
+			return dist->min;
+		case UNIFORM :
+			return dist->min + (next_random(random_state) % (((uint64_t)dist->max) - dist->min + 1));
+		case EXPONENTIAL :
+		default :
+		{
+			// inverse transform sampling, using a uniform random number in (0, 1]
+			double u = ((double)((next_random(random_state) >> 11) + 1)) / ((double)(UINT64_C(1) << 53));
+			double size = -(dist->mean * log(u));
+			return (size < 1.0) ? 1 : ((size > dist->max) ? dist->max : ((uint32_t)size));
+		}
+	}
+}
+
+// -------------------------------------------------------------
+// backends
+
+typedef struct backend backend;
+struct backend
+{
+	const char* name;
+
+	// the memory_block_io is used, if set, else the file_block_io
+	int is_memory;
+
+	// additional flags for the open_file_block_io()
+	int additional_flags;
+
+	// the write_blocks_durable (pwritev2(RWF_DSYNC)) is used, instead of the fdatasync on every flush
+	int has_durable_writes;
+};
+
+static const backend backends[] = {
+	{.name = "file", .is_memory = 0, .additional_flags = 0},
+	{.name = "file_direct", .is_memory = 0, .additional_flags = O_DIRECT},
+	{.name = "file_direct_dsync", .is_memory = 0, .additional_flags = O_DIRECT, .has_durable_writes = 1},
+	{.name = "ram", .is_memory = 1, .additional_flags = 0},
+};
+
+static const backend* find_backend(const char* name)
+{
+	for(uint32_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+		if(strcmp(backends[i].name, name) == 0)
+			return &(backends[i]);
+	return NULL;
+}
+
+// -------------------------------------------------------------
+
+static int parse_uint64(uint64_t* result, const char* str)
+{
+	char* end = NULL;
+	errno = 0;
+	unsigned long long value = strtoull(str, &end, 10);
+	if(errno != 0 || end == str || (*end) != '\0')
+		return 0;
+	(*result) = value;
+	return 1;
+}
+
+static uint64_t now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec) * UINT64_C(1000000000) + ((uint64_t)now.tv_nsec);
+}
+
+static int compare_uint64(const void* a, const void* b)
+{
+	uint64_t x = *((const uint64_t*)a);
+	uint64_t y = *((const uint64_t*)b);
+	return (x > y) - (x < y);
+}
+
+// latencies must be sorted
+static uint64_t get_percentile(const uint64_t* latencies, uint64_t count, double percentile)
+{
+	if(count == 0)
+		return 0;
+	uint64_t rank = (uint64_t)((percentile / 100.0) * count + 0.999999);
+	if(rank == 0)
+		rank = 1;
+	if(rank > count)
+		rank = count;
+	return latencies[rank - 1];
+}
+
+static void print_latencies(FILE* out, const char* name, uint64_t* latencies, uint64_t count)
+{
+	qsort(latencies, count, sizeof(uint64_t), compare_uint64);
+	fprintf(out, "\"%s\": {\"p50\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"p999\": %" PRIu64 ", \"max\": %" PRIu64 "}", name,
+		get_percentile(latencies, count, 50.0), get_percentile(latencies, count, 99.0), get_percentile(latencies, count, 99.9), (count == 0) ? 0 : latencies[count - 1]);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,505 @@
+#include"bench_util.h"
+
+#include<unistd.h>
+#include<pthread.h>
+#include<sys/utsname.h>
+#include<sys/resource.h>
+
+#include<file_block_io_ops.h>
+#include<memory_block_io_ops.h>
+#include<latency_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+/*
+	wale_bench, a benchmark driver for the append_log_record() and flush_all_log_records() of a WALe
+
+	it runs every combination of the values passed to the below options (comma separated lists), and prints a JSON report
+	every run starts with a fresh WALe file, and generates the same sequence of log record sizes for a given seed
+
+	--threads=1,4,16					number of threads appending concurrently
+	--record_sizes=fixed:128,...		distribution of the log record sizes
+										fixed:SIZE, uniform:MIN-MAX or exponential:MEAN (capped at 16 * MEAN)
+	--buffer_blocks=8,64				append_only_block_count of the WALe
+	--flush_every=0,64					every thread calls flush_all_log_records() after these many appends, 0 implies a single flush at the end of the run
+	--backend=file,file_direct,ram		block_io_ops to run over, ram is the memory_block_io
+										file_direct_dsync is file_direct with durable writes (pwritev2(RWF_DSYNC)) instead of an fdatasync on every flush
+	--records=200000					total log records appended in a run, divided equally among the threads
+	--block_size=4096
+	--seed=1
+	--file=wale_bench.log				path of the WALe file, it is deleted after every run
+	--output=report.json				path to write the report to, defaults to the stdout
+
+	the below options wrap every backend in a latency_block_io, to simulate a slower device
+	latencies are BASE[:JITTER[:TAIL[:TAIL_PER_MILLION]]] in microseconds, see latency_distribution in latency_block_io_ops.h
+
+	--read_latency_us=100:20
+	--write_latency_us=20:5
+	--flush_latency_us=2000:500:20000:1000
+	--read_mb_per_s=2000				bandwidth caps, 0 implies no cap
+	--write_mb_per_s=1000
+
+	the append latency is the time spent in the append_log_record() call
+	the commit latency of a log record is the time from the start of its append_log_record() call, until the return of the flush_all_log_records() call that its thread made after it
+	the context switches (voluntary and involuntary, of the whole process) are reported per log record appended
+	the progress is printed to the stderr
+*/
+
+// -------------------------------------------------------------
+// injected latencies
+
+static int parse_latency_distribution(latency_distribution* distribution, const char* str)
+{
+	unsigned long long base_us = 0, jitter_us = 0, tail_us = 0, tail_per_million = 0;
+	int parsed = sscanf(str, "%llu:%llu:%llu:%llu", &base_us, &jitter_us, &tail_us, &tail_per_million);
+	if(parsed < 1 || jitter_us > base_us || tail_per_million > 1000000)
+		return 0;
+	(*distribution) = (latency_distribution){.base_ns = base_us * 1000, .jitter_ns = jitter_us * 1000, .tail_ns = tail_us * 1000, .tail_per_million = tail_per_million};
+	return 1;
+}
+
+static int is_latency_injected(const latency_block_io_config* latency_config)
+{
+	return latency_config->read_latency.base_ns > 0 || latency_config->write_latency.base_ns > 0 || latency_config->flush_latency.base_ns > 0 ||
+		latency_config->read_latency.tail_per_million > 0 || latency_config->write_latency.tail_per_million > 0 || latency_config->flush_latency.tail_per_million > 0 ||
+		latency_config->read_bytes_per_second > 0 || latency_config->write_bytes_per_second > 0;
+}
+
+// -------------------------------------------------------------
+// a single run
+
+typedef struct run_config run_config;
+struct run_config
+{
+	uint32_t thread_count;
+	const char* record_sizes;
+	record_size_distribution record_size_distribution;
+	uint64_t buffer_block_count;
+	uint64_t flush_every;
+	const backend* backend;
+	uint64_t record_count;
+	uint64_t block_size;
+	uint64_t seed;
+	const char* file_path;
+	const latency_block_io_config* latency_config;
+};
+
+typedef struct run_thread run_thread;
+struct run_thread
+{
+	pthread_t thread;
+	uint32_t thread_id;
+
+	const run_config* config;
+	wale* wale_p;
+	const char* payload;
+	pthread_barrier_t* start_barrier;
+
+	uint64_t record_count;
+	uint64_t bytes_appended;
+
+	// latencies of all the log records appended by this thread, in nanoseconds
+	uint64_t* append_latencies;
+	uint64_t* commit_latencies;
+
+	// start time of the appends not yet flushed, by this thread
+	uint64_t* append_start_times;
+
+	int failed;
+};
+
+static void* run_appends(void* run_thread_p)
+{
+	run_thread* rt = run_thread_p;
+	uint64_t random_state = rt->config->seed * UINT64_C(1000003) + rt->thread_id;
+
+	pthread_barrier_wait(rt->start_barrier);
+
+	uint64_t unflushed = 0;
+	for(uint64_t i = 0; i < rt->record_count; i++)
+	{
+		uint32_t record_size = get_next_record_size(&(rt->config->record_size_distribution), &random_state);
+		uint64_t payload_offset = next_random(&random_state) % (rt->config->record_size_distribution.max - record_size + 1);
+
+		int error = NO_ERROR;
+		uint64_t start_time = now_ns();
+		uint256 log_sequence_number = append_log_record(rt->wale_p, rt->payload + payload_offset, record_size, 0, APPEND_BUFFERED, &error);
+		uint64_t end_time = now_ns();
+		if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			fprintf(stderr, "append_log_record failed, error = %d\n", error);
+			rt->failed = 1;
+			return NULL;
+		}
+
+		rt->append_latencies[i] = end_time - start_time;
+		rt->append_start_times[unflushed++] = start_time;
+		rt->bytes_appended += record_size;
+
+		if(unflushed == rt->config->flush_every || i == rt->record_count - 1)
+		{
+			if(are_equal_uint256(flush_all_log_records(rt->wale_p, &error), INVALID_LOG_SEQUENCE_NUMBER))
+			{
+				fprintf(stderr, "flush_all_log_records failed, error = %d\n", error);
+				rt->failed = 1;
+				return NULL;
+			}
+			uint64_t flush_end_time = now_ns();
+			for(uint64_t j = 0; j < unflushed; j++)
+				rt->commit_latencies[i + 1 - unflushed + j] = flush_end_time - rt->append_start_times[j];
+			unflushed = 0;
+		}
+	}
+
+	return NULL;
+}
+
+static uint64_t get_context_switches()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// runs the benchmark for the config, and prints its result as a JSON object to out
+static int run(const run_config* config, FILE* out)
+{
+	file_block_io fbio;
+	memory_block_io mbio;
+	block_io_ops block_io_functions;
+	if(config->backend->is_memory)
+	{
+		// enough blocks for all the log records (with their headers and crcs), the master record and the append only buffer
+		uint64_t max_block_count = ((config->record_count * (config->record_size_distribution.max + 16)) / config->block_size) + config->buffer_block_count + 2;
+		if(!open_memory_block_io(&mbio, config->block_size, max_block_count))
+		{
+			fprintf(stderr, "failed to open memory block io for backend %s : errno = %d\n", config->backend->name, errno);
+			return 0;
+		}
+		block_io_functions = get_block_io_ops_for_memory_block_io(&mbio);
+	}
+	else
+	{
+		unlink(config->file_path);
+		if(!open_file_block_io(&fbio, config->file_path, 1, config->block_size, config->backend->additional_flags))
+		{
+			fprintf(stderr, "failed to open %s for backend %s : errno = %d\n", config->file_path, config->backend->name, errno);
+			return 0;
+		}
+		block_io_functions = config->backend->has_durable_writes ? get_durable_write_block_io_ops_for_file_block_io(&fbio) : get_block_io_ops_for_file_block_io(&fbio);
+	}
+
+	latency_block_io lbio;
+	if(is_latency_injected(config->latency_config))
+	{
+		open_latency_block_io(&lbio, block_io_functions, config->latency_config);
+		block_io_functions = get_block_io_ops_for_latency_block_io(&lbio);
+	}
+
+	wale walE;
+	int error = NO_ERROR;
+	int failed = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(1), 0, NULL, block_io_functions, config->buffer_block_count, &error))
+	{
+		fprintf(stderr, "failed to initialize wale : error = %d\n", error);
+		failed = 1;
+		goto CLOSE_BACKEND;
+	}
+
+	// all the log records are slices of this payload
+	char* payload = malloc(config->record_size_distribution.max);
+	uint64_t payload_random_state = config->seed;
+	for(uint32_t i = 0; i < config->record_size_distribution.max; i++)
+		payload[i] = next_random(&payload_random_state);
+
+	pthread_barrier_t start_barrier;
+	pthread_barrier_init(&start_barrier, NULL, config->thread_count + 1);
+
+	run_thread* threads = calloc(config->thread_count, sizeof(run_thread));
+	for(uint32_t t = 0; t < config->thread_count; t++)
+	{
+		run_thread* rt = &(threads[t]);
+		rt->thread_id = t;
+		rt->config = config;
+		rt->wale_p = &walE;
+		rt->payload = payload;
+		rt->start_barrier = &start_barrier;
+		rt->record_count = (config->record_count / config->thread_count) + (t < (config->record_count % config->thread_count));
+		rt->append_latencies = malloc(sizeof(uint64_t) * rt->record_count);
+		rt->commit_latencies = malloc(sizeof(uint64_t) * rt->record_count);
+		rt->append_start_times = malloc(sizeof(uint64_t) * rt->record_count);
+		pthread_create(&(rt->thread), NULL, run_appends, rt);
+	}
+
+	pthread_barrier_wait(&start_barrier);
+	uint64_t start_time = now_ns();
+	uint64_t start_context_switches = get_context_switches();
+
+	for(uint32_t t = 0; t < config->thread_count; t++)
+		pthread_join(threads[t].thread, NULL);
+
+	uint64_t elapsed_ns = now_ns() - start_time;
+	uint64_t context_switches = get_context_switches() - start_context_switches;
+
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+
+	uint64_t record_count = 0;
+	uint64_t bytes_appended = 0;
+	for(uint32_t t = 0; t < config->thread_count; t++)
+	{
+		failed = failed || threads[t].failed;
+		record_count += threads[t].record_count;
+		bytes_appended += threads[t].bytes_appended;
+	}
+
+	// gather the latencies of all the threads
+	uint64_t* append_latencies = malloc(sizeof(uint64_t) * record_count);
+	uint64_t* commit_latencies = malloc(sizeof(uint64_t) * record_count);
+	uint64_t offset = 0;
+	for(uint32_t t = 0; t < config->thread_count; t++)
+	{
+		memcpy(append_latencies + offset, threads[t].append_latencies, sizeof(uint64_t) * threads[t].record_count);
+		memcpy(commit_latencies + offset, threads[t].commit_latencies, sizeof(uint64_t) * threads[t].record_count);
+		offset += threads[t].record_count;
+		free(threads[t].append_latencies);
+		free(threads[t].commit_latencies);
+		free(threads[t].append_start_times);
+	}
+
+	if(!failed)
+	{
+		double elapsed_s = ((double)elapsed_ns) / 1e9;
+		fprintf(out, "{\"threads\": %" PRIu32 ", \"record_sizes\": \"%s\", \"buffer_blocks\": %" PRIu64 ", \"flush_every\": %" PRIu64 ", \"backend\": \"%s\", ",
+			config->thread_count, config->record_sizes, config->buffer_block_count, config->flush_every, config->backend->name);
+		fprintf(out, "\"records\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"elapsed_s\": %.6f, \"records_per_s\": %.1f, \"mb_per_s\": %.3f, ",
+			record_count, bytes_appended, elapsed_s, record_count / elapsed_s, (bytes_appended / elapsed_s) / (1024.0 * 1024.0));
+		fprintf(out, "\"flushes\": %" PRIu64 ", \"scrolls\": %" PRIu64 ", \"written_bytes\": %" PRIu64 ", \"context_switches_per_record\": %.3f, ",
+			stats.counters[WALE_STATS_FLUSHES], stats.counters[WALE_STATS_SCROLLS], stats.counters[WALE_STATS_WRITTEN_BYTES], ((double)context_switches) / record_count);
+		fprintf(out, "\"lock_waits\": {\"global\": %" PRIu64 ", \"append_only_buffer\": %" PRIu64 ", \"flushed_log_records\": %" PRIu64 ", \"wait_for_scroll\": %" PRIu64 "}, ",
+			stats.lock_waits[WALE_STATS_GLOBAL_LOCK], stats.lock_waits[WALE_STATS_APPEND_ONLY_BUFFER_LOCK], stats.lock_waits[WALE_STATS_FLUSHED_LOG_RECORDS_LOCK], stats.lock_waits[WALE_STATS_WAIT_FOR_SCROLL]);
+		print_latencies(out, "append_latency_ns", append_latencies, record_count);
+		fprintf(out, ", ");
+		print_latencies(out, "commit_latency_ns", commit_latencies, record_count);
+		fprintf(out, "}");
+
+		fprintf(stderr, "threads=%" PRIu32 " record_sizes=%s buffer_blocks=%" PRIu64 " flush_every=%" PRIu64 " backend=%s : %.1f records/s\n",
+			config->thread_count, config->record_sizes, config->buffer_block_count, config->flush_every, config->backend->name, record_count / elapsed_s);
+	}
+
+	free(append_latencies);
+	free(commit_latencies);
+	free(threads);
+	free(payload);
+	pthread_barrier_destroy(&start_barrier);
+
+	deinitialize_wale(&walE);
+
+	CLOSE_BACKEND:;
+	if(is_latency_injected(config->latency_config))
+		close_latency_block_io(&lbio);
+	if(config->backend->is_memory)
+		close_memory_block_io(&mbio);
+	else
+	{
+		close_file_block_io(&fbio);
+		unlink(config->file_path);
+	}
+
+	return !failed;
+}
+
+// -------------------------------------------------------------
+
+static void print_usage(const char* program)
+{
+	fprintf(stderr, "usage : %s [--threads=1,4,16] [--record_sizes=fixed:128,uniform:64-4096,exponential:256] [--buffer_blocks=8,64] [--flush_every=0,64] [--backend=file,file_direct] [--records=200000] [--block_size=4096] [--seed=1] [--file=wale_bench.log] [--output=report.json] [--read_latency_us=BASE[:JITTER[:TAIL[:TAIL_PER_MILLION]]]] [--write_latency_us=...] [--flush_latency_us=...] [--read_mb_per_s=0] [--write_mb_per_s=0]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+	char threads_arg[256] = "1,4,16";
+	char record_sizes_arg[256] = "fixed:128,uniform:64-4096";
+	char buffer_blocks_arg[256] = "8,64";
+	char flush_every_arg[256] = "0,64";
+	char backend_arg[256] = "file";
+	uint64_t record_count = 200000;
+	uint64_t block_size = 4096;
+	uint64_t seed = 1;
+	const char* file_path = "wale_bench.log";
+	const char* output_path = NULL;
+	latency_block_io_config latency_config = {.seed = 0};
+
+	for(int i = 1; i < argc; i++)
+	{
+		char* value = strchr(argv[i], '=');
+		if(strncmp(argv[i], "--", 2) != 0 || value == NULL)
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+		(*value) = '\0';
+		value++;
+
+		const char* name = argv[i] + 2;
+		int valid = 1;
+		if(strcmp(name, "threads") == 0)
+			valid = (strlen(value) < sizeof(threads_arg)) && strcpy(threads_arg, value);
+		else if(strcmp(name, "record_sizes") == 0)
+			valid = (strlen(value) < sizeof(record_sizes_arg)) && strcpy(record_sizes_arg, value);
+		else if(strcmp(name, "buffer_blocks") == 0)
+			valid = (strlen(value) < sizeof(buffer_blocks_arg)) && strcpy(buffer_blocks_arg, value);
+		else if(strcmp(name, "flush_every") == 0)
+			valid = (strlen(value) < sizeof(flush_every_arg)) && strcpy(flush_every_arg, value);
+		else if(strcmp(name, "backend") == 0)
+			valid = (strlen(value) < sizeof(backend_arg)) && strcpy(backend_arg, value);
+		else if(strcmp(name, "records") == 0)
+			valid = parse_uint64(&record_count, value) && record_count > 0;
+		else if(strcmp(name, "block_size") == 0)
+			valid = parse_uint64(&block_size, value) && block_size > 0;
+		else if(strcmp(name, "seed") == 0)
+			valid = parse_uint64(&seed, value);
+		else if(strcmp(name, "file") == 0)
+			file_path = value;
+		else if(strcmp(name, "output") == 0)
+			output_path = value;
+		else if(strcmp(name, "read_latency_us") == 0)
+			valid = parse_latency_distribution(&(latency_config.read_latency), value);
+		else if(strcmp(name, "write_latency_us") == 0)
+			valid = parse_latency_distribution(&(latency_config.write_latency), value);
+		else if(strcmp(name, "flush_latency_us") == 0)
+			valid = parse_latency_distribution(&(latency_config.flush_latency), value);
+		else if(strcmp(name, "read_mb_per_s") == 0)
+		{
+			valid = parse_uint64(&(latency_config.read_bytes_per_second), value);
+			latency_config.read_bytes_per_second *= (1024 * 1024);
+		}
+		else if(strcmp(name, "write_mb_per_s") == 0)
+		{
+			valid = parse_uint64(&(latency_config.write_bytes_per_second), value);
+			latency_config.write_bytes_per_second *= (1024 * 1024);
+		}
+		else
+			valid = 0;
+
+		if(!valid)
+		{
+			fprintf(stderr, "invalid option --%s=%s\n", name, value);
+			print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	value_list threads_list, record_sizes_list, buffer_blocks_list, flush_every_list, backend_list;
+	if(!parse_value_list(&threads_list, threads_arg) || !parse_value_list(&record_sizes_list, record_sizes_arg) ||
+		!parse_value_list(&buffer_blocks_list, buffer_blocks_arg) || !parse_value_list(&flush_every_list, flush_every_arg) ||
+		!parse_value_list(&backend_list, backend_arg))
+	{
+		fprintf(stderr, "every list must have 1 to %d values\n", MAX_LIST_SIZE);
+		return -1;
+	}
+
+	// validate all the values, before starting any of the runs
+	uint64_t thread_counts[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < threads_list.count; i++)
+		if(!parse_uint64(&(thread_counts[i]), threads_list.values[i]) || thread_counts[i] == 0 || thread_counts[i] > record_count)
+		{
+			fprintf(stderr, "invalid thread count %s\n", threads_list.values[i]);
+			return -1;
+		}
+	record_size_distribution distributions[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < record_sizes_list.count; i++)
+		if(!parse_record_size_distribution(&(distributions[i]), record_sizes_list.values[i]))
+		{
+			fprintf(stderr, "invalid record size distribution %s\n", record_sizes_list.values[i]);
+			return -1;
+		}
+	uint64_t buffer_block_counts[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < buffer_blocks_list.count; i++)
+		if(!parse_uint64(&(buffer_block_counts[i]), buffer_blocks_list.values[i]) || buffer_block_counts[i] == 0)
+		{
+			fprintf(stderr, "invalid buffer block count %s\n", buffer_blocks_list.values[i]);
+			return -1;
+		}
+	uint64_t flush_everys[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < flush_every_list.count; i++)
+		if(!parse_uint64(&(flush_everys[i]), flush_every_list.values[i]))
+		{
+			fprintf(stderr, "invalid flush_every %s\n", flush_every_list.values[i]);
+			return -1;
+		}
+	const backend* selected_backends[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < backend_list.count; i++)
+		if((selected_backends[i] = find_backend(backend_list.values[i])) == NULL)
+		{
+			fprintf(stderr, "unknown backend %s\n", backend_list.values[i]);
+			return -1;
+		}
+
+	FILE* out = stdout;
+	if(output_path != NULL && (out = fopen(output_path, "w")) == NULL)
+	{
+		fprintf(stderr, "failed to open %s : errno = %d\n", output_path, errno);
+		return -1;
+	}
+
+	struct utsname host;
+	uname(&host);
+
+	fprintf(out, "{\n\"host\": {\"sysname\": \"%s\", \"release\": \"%s\", \"machine\": \"%s\", \"cpus\": %ld},\n", host.sysname, host.release, host.machine, sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(out, "\"records\": %" PRIu64 ", \"block_size\": %" PRIu64 ", \"seed\": %" PRIu64 ",\n", record_count, block_size, seed);
+	latency_config.seed = seed;
+	if(is_latency_injected(&latency_config))
+	{
+		const latency_distribution* latency_distributions[3] = {&(latency_config.read_latency), &(latency_config.write_latency), &(latency_config.flush_latency)};
+		const char* distribution_names[3] = {"read_latency_ns", "write_latency_ns", "flush_latency_ns"};
+		fprintf(out, "\"injected\": {");
+		for(int i = 0; i < 3; i++)
+			fprintf(out, "\"%s\": {\"base\": %" PRIu64 ", \"jitter\": %" PRIu64 ", \"tail\": %" PRIu64 ", \"tail_per_million\": %" PRIu32 "}, ", distribution_names[i],
+				latency_distributions[i]->base_ns, latency_distributions[i]->jitter_ns, latency_distributions[i]->tail_ns, latency_distributions[i]->tail_per_million);
+		fprintf(out, "\"read_bytes_per_second\": %" PRIu64 ", \"write_bytes_per_second\": %" PRIu64 "},\n", latency_config.read_bytes_per_second, latency_config.write_bytes_per_second);
+	}
+	fprintf(out, "\"runs\": [\n");
+
+	int failed_runs = 0;
+	int first_run = 1;
+	for(uint32_t b = 0; b < backend_list.count; b++)
+		for(uint32_t r = 0; r < record_sizes_list.count; r++)
+			for(uint32_t k = 0; k < buffer_blocks_list.count; k++)
+				for(uint32_t f = 0; f < flush_every_list.count; f++)
+					for(uint32_t t = 0; t < threads_list.count; t++)
+					{
+						run_config config = {
+							.thread_count = thread_counts[t],
+							.record_sizes = record_sizes_list.values[r],
+							.record_size_distribution = distributions[r],
+							.buffer_block_count = buffer_block_counts[k],
+							.flush_every = flush_everys[f],
+							.backend = selected_backends[b],
+							.record_count = record_count,
+							.block_size = block_size,
+							.seed = seed,
+							.file_path = file_path,
+							.latency_config = &latency_config,
+						};
+
+						if(!first_run)
+							fprintf(out, ",\n");
+						first_run = 0;
+
+						if(!run(&config, out))
+						{
+							fprintf(out, "{\"threads\": %" PRIu32 ", \"record_sizes\": \"%s\", \"buffer_blocks\": %" PRIu64 ", \"flush_every\": %" PRIu64 ", \"backend\": \"%s\", \"failed\": true}",
+								config.thread_count, config.record_sizes, config.buffer_block_count, config.flush_every, config.backend->name);
+							failed_runs++;
+						}
+					}
+
+	fprintf(out, "\n]\n}\n");
+
+	if(out != stdout)
+		fclose(out);
+
+	return (failed_runs == 0) ? 0 : -1;
+}
\ No newline at end of file
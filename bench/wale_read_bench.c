@@ -0,0 +1,643 @@
+#include"bench_util.h"
+
+#include<unistd.h>
+#include<sys/utsname.h>
+
+#include<file_block_io_ops.h>
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+/*
+	wale_read_bench, a benchmark driver for the read and recovery paths of a WALe
+
+	it builds a WALe file of the given size once for every combination of the backend, record_sizes and log_mb options (comma separated lists)
+	and then runs every workload against it, with every cache state, printing a JSON report
+
+	--log_mb=1024,51200				size of the log records appended to the WALe file, in MB
+	--record_sizes=fixed:128,...		distribution of the log record sizes, as in the wale_bench
+	--backend=file,file_direct			a backend of the wale_bench, ram is only ever warm
+	--cache=cold,warm					cold drops the pages of the WALe file from the page cache (posix_fadvise(POSIX_FADV_DONTNEED)) before the workload, warm reads the whole file before it
+										with file_direct the WALe never goes through the page cache, so both of them measure the device
+	--workloads=open,scan,random_get,backward,validate
+		open							initialize_wale() of the existing WALe file, i.e. the restart time
+		scan							forward walk with get_next_log_sequence_number_of(), reading every log record with get_log_record_at()
+		random_get						get_log_record_at() of --random_gets log sequence numbers, sampled uniformly from all of the log records
+		backward						backward walk with get_prev_log_sequence_number_of(), from the last flushed log record to the first one
+		validate						forward walk, calling validate_log_record_at() on every log record
+	--random_gets=100000				number of log records read by the random_get workload
+	--buffer_blocks=64					append only block count of the WALe
+	--block_size=4096					block size of the backend, it must be a multiple of the logical block size of the device for file_direct
+	--seed=1							seed of the log record sizes, the payloads and the sampled log sequence numbers
+	--file=wale_read_bench.log			path of the WALe file, for the file backends
+	--output=report.json				path of the JSON report, default is the stdout
+
+	every workload runs on a freshly initialized WALe, so the read_ios and the read_bytes (from the wale_stats) are of that workload alone
+	the bytes of every workload are the sizes of the log records it read or walked over (without their headers and crc32-s), so their mb_per_s are comparable
+	the open workload reports only its elapsed_s (the restart time), and no records_per_s or mb_per_s
+	the progress is printed to the stderr
+*/
+
+// -------------------------------------------------------------
+// the log
+
+typedef struct log_config log_config;
+struct log_config
+{
+	const backend* backend;
+	const char* record_sizes;
+	record_size_distribution record_size_distribution;
+	uint64_t log_bytes;
+	uint64_t buffer_block_count;
+	uint64_t block_size;
+	uint64_t seed;
+	uint64_t random_get_count;
+	const char* file_path;
+};
+
+// an open log, every workload reopens it
+typedef struct log_handle log_handle;
+struct log_handle
+{
+	const log_config* config;
+
+	// the memory_block_io outlives the WALe-s on it, the file_block_io is reopened for every workload
+	memory_block_io mbio;
+	file_block_io fbio;
+	int is_file_open;
+
+	wale walE;
+	int is_wale_initialized;
+
+	uint64_t record_count;
+
+	// sum of the sizes of all the log records appended
+	uint64_t record_bytes;
+
+	// a uniform sample of the log sequence numbers of the log records, for the random_get workload
+	uint256* sampled_log_sequence_numbers;
+	uint64_t sampled_count;
+};
+
+static block_io_ops open_log_backend(log_handle* log, int create)
+{
+	if(log->config->backend->is_memory)
+		return get_block_io_ops_for_memory_block_io(&(log->mbio));
+
+	if(!open_file_block_io(&(log->fbio), log->config->file_path, create, log->config->block_size, log->config->backend->additional_flags))
+	{
+		fprintf(stderr, "failed to open %s for backend %s : errno = %d\n", log->config->file_path, log->config->backend->name, errno);
+		return (block_io_ops){};
+	}
+	log->is_file_open = 1;
+	return log->config->backend->has_durable_writes ? get_durable_write_block_io_ops_for_file_block_io(&(log->fbio)) : get_block_io_ops_for_file_block_io(&(log->fbio));
+}
+
+static void close_log_wale(log_handle* log)
+{
+	if(log->is_wale_initialized)
+		deinitialize_wale(&(log->walE));
+	log->is_wale_initialized = 0;
+
+	if(log->is_file_open)
+		close_file_block_io(&(log->fbio));
+	log->is_file_open = 0;
+}
+
+// appends log records until their sizes sum up to the log_bytes, with a single flush at the end
+static int build_log(log_handle* log)
+{
+	const log_config* config = log->config;
+
+	if(config->backend->is_memory)
+	{
+		// reserve the address space for the log records along with their headers and crcs, the memory is allocated only as the blocks get written
+		uint64_t expected_record_count = (config->log_bytes / config->record_size_distribution.mean) + 1;
+		uint64_t max_block_count = ((2 * config->log_bytes + 64 * expected_record_count) / config->block_size) + config->buffer_block_count + 2;
+		if(!open_memory_block_io(&(log->mbio), config->block_size, max_block_count))
+		{
+			fprintf(stderr, "failed to open memory block io for backend %s : errno = %d\n", config->backend->name, errno);
+			return 0;
+		}
+	}
+	else
+		unlink(config->file_path);
+
+	block_io_ops block_io_functions = open_log_backend(log, 1);
+	if(!config->backend->is_memory && !log->is_file_open)
+		return 0;
+
+	int error = NO_ERROR;
+	if(!initialize_wale(&(log->walE), 8, get_uint256(1), 0, NULL, block_io_functions, config->buffer_block_count, &error))
+	{
+		fprintf(stderr, "failed to initialize wale : error = %d\n", error);
+		return 0;
+	}
+	log->is_wale_initialized = 1;
+
+	// all the log records are slices of this payload
+	char* payload = malloc(config->record_size_distribution.max);
+	uint64_t random_state = config->seed;
+	for(uint32_t i = 0; i < config->record_size_distribution.max; i++)
+		payload[i] = next_random(&random_state);
+
+	log->sampled_log_sequence_numbers = malloc(sizeof(uint256) * config->random_get_count);
+	log->sampled_count = 0;
+	log->record_count = 0;
+	log->record_bytes = 0;
+
+	int failed = 0;
+	uint64_t start_time = now_ns();
+	for(uint64_t bytes_appended = 0; bytes_appended < config->log_bytes;)
+	{
+		uint32_t record_size = get_next_record_size(&(config->record_size_distribution), &random_state);
+		uint64_t payload_offset = next_random(&random_state) % (config->record_size_distribution.max - record_size + 1);
+
+		uint256 log_sequence_number = append_log_record(&(log->walE), payload + payload_offset, record_size, 0, APPEND_BUFFERED, &error);
+		if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			fprintf(stderr, "append_log_record failed, error = %d\n", error);
+			failed = 1;
+			break;
+		}
+
+		// reservoir sampling, every log record ends up in the sample with the same probability
+		if(log->sampled_count < config->random_get_count)
+			log->sampled_log_sequence_numbers[log->sampled_count++] = log_sequence_number;
+		else
+		{
+			uint64_t i = next_random(&random_state) % (log->record_count + 1);
+			if(i < config->random_get_count)
+				log->sampled_log_sequence_numbers[i] = log_sequence_number;
+		}
+
+		log->record_count++;
+		log->record_bytes += record_size;
+		bytes_appended += record_size;
+	}
+
+	// shuffle the sample, its first slots are still in the order of the appends
+	for(uint64_t i = log->sampled_count; i > 1; i--)
+	{
+		uint64_t j = next_random(&random_state) % i;
+		uint256 temp = log->sampled_log_sequence_numbers[i - 1];
+		log->sampled_log_sequence_numbers[i - 1] = log->sampled_log_sequence_numbers[j];
+		log->sampled_log_sequence_numbers[j] = temp;
+	}
+
+	if(!failed && are_equal_uint256(flush_all_log_records(&(log->walE), &error), INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		fprintf(stderr, "flush_all_log_records failed, error = %d\n", error);
+		failed = 1;
+	}
+
+	if(!failed)
+		fprintf(stderr, "backend=%s record_sizes=%s log_mb=%" PRIu64 " : built %" PRIu64 " log records in %.3f s\n",
+			config->backend->name, config->record_sizes, config->log_bytes / (1024 * 1024), log->record_count, ((double)(now_ns() - start_time)) / 1e9);
+
+	free(payload);
+	close_log_wale(log);
+	return !failed;
+}
+
+// -------------------------------------------------------------
+// the page cache
+
+// opens the WALe file without the O_DIRECT of its backend, for managing its pages in the page cache
+static int open_for_page_cache(const log_config* config)
+{
+	int fd = open(config->file_path, O_RDONLY);
+	if(fd == -1)
+		fprintf(stderr, "failed to open %s : errno = %d\n", config->file_path, errno);
+	return fd;
+}
+
+static int drop_from_page_cache(const log_config* config)
+{
+	int fd = open_for_page_cache(config);
+	if(fd == -1)
+		return 0;
+
+	// the dirty pages can not be dropped, so write them first
+	int dropped = (fdatasync(fd) == 0) && (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+	if(!dropped)
+		fprintf(stderr, "failed to drop %s from the page cache : errno = %d\n", config->file_path, errno);
+	close(fd);
+	return dropped;
+}
+
+// the WALe file is read into the page cache, in chunks of this size
+#define LOAD_CHUNK_SIZE (1024 * 1024)
+
+static int load_into_page_cache(const log_config* config)
+{
+	int fd = open_for_page_cache(config);
+	if(fd == -1)
+		return 0;
+
+	char* chunk = malloc(LOAD_CHUNK_SIZE);
+	ssize_t res;
+	for(off_t offset = 0; (res = pread(fd, chunk, LOAD_CHUNK_SIZE, offset)) > 0; offset += res);
+	if(res == -1)
+		fprintf(stderr, "failed to read %s into the page cache : errno = %d\n", config->file_path, errno);
+	free(chunk);
+	close(fd);
+	return res == 0;
+}
+
+// -------------------------------------------------------------
+// the workloads
+
+typedef enum workload workload;
+enum workload
+{
+	OPEN,
+	SCAN,
+	RANDOM_GET,
+	BACKWARD,
+	VALIDATE,
+	WORKLOAD_COUNT,
+};
+
+static const char* workload_names[WORKLOAD_COUNT] = {
+	[OPEN] = "open",
+	[SCAN] = "scan",
+	[RANDOM_GET] = "random_get",
+	[BACKWARD] = "backward",
+	[VALIDATE] = "validate",
+};
+
+static int find_workload(workload* result, const char* name)
+{
+	for(int w = 0; w < WORKLOAD_COUNT; w++)
+		if(strcmp(workload_names[w], name) == 0)
+		{
+			(*result) = w;
+			return 1;
+		}
+	return 0;
+}
+
+typedef struct workload_result workload_result;
+struct workload_result
+{
+	uint64_t record_count;
+	uint64_t bytes;
+
+	// latencies of the random_get workload, in nanoseconds
+	uint64_t* latencies;
+};
+
+static int run_scan(wale* wale_p, int validate_only, workload_result* result)
+{
+	int error = NO_ERROR;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(wale_p); !are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); log_sequence_number = get_next_log_sequence_number_of(wale_p, log_sequence_number, &error))
+	{
+		uint32_t log_record_size;
+		if(validate_only)
+		{
+			if(!validate_log_record_at(wale_p, log_sequence_number, &log_record_size, &error))
+			{
+				fprintf(stderr, "validate_log_record_at failed, error = %d\n", error);
+				return 0;
+			}
+		}
+		else
+		{
+			void* log_record = get_log_record_at(wale_p, log_sequence_number, &log_record_size, &error);
+			if(log_record == NULL)
+			{
+				fprintf(stderr, "get_log_record_at failed, error = %d\n", error);
+				return 0;
+			}
+			release_log_record(wale_p, log_record, log_record_size);
+		}
+		result->record_count++;
+		result->bytes += log_record_size;
+	}
+	if(error)
+		fprintf(stderr, "get_next_log_sequence_number_of failed, error = %d\n", error);
+	return !error;
+}
+
+static int run_random_get(wale* wale_p, const log_handle* log, workload_result* result)
+{
+	result->latencies = malloc(sizeof(uint64_t) * log->sampled_count);
+	for(uint64_t i = 0; i < log->sampled_count; i++)
+	{
+		int error = NO_ERROR;
+		uint32_t log_record_size;
+		uint64_t start_time = now_ns();
+		void* log_record = get_log_record_at(wale_p, log->sampled_log_sequence_numbers[i], &log_record_size, &error);
+		uint64_t end_time = now_ns();
+		if(log_record == NULL)
+		{
+			fprintf(stderr, "get_log_record_at failed, error = %d\n", error);
+			return 0;
+		}
+		release_log_record(wale_p, log_record, log_record_size);
+		result->latencies[i] = end_time - start_time;
+		result->record_count++;
+		result->bytes += log_record_size;
+	}
+	return 1;
+}
+
+static int run_backward(wale* wale_p, const log_handle* log, workload_result* result)
+{
+	int error = NO_ERROR;
+	for(uint256 log_sequence_number = get_last_flushed_log_sequence_number(wale_p); !are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); log_sequence_number = get_prev_log_sequence_number_of(wale_p, log_sequence_number, &error))
+		result->record_count++;
+	if(error)
+	{
+		fprintf(stderr, "get_prev_log_sequence_number_of failed, error = %d\n", error);
+		return 0;
+	}
+
+	// the walk reads only the headers, but it walks over all the log records, so it is accounted in the same unit as the scan
+	if(result->record_count != log->record_count)
+	{
+		fprintf(stderr, "backward walk found %" PRIu64 " log records, expected %" PRIu64 "\n", result->record_count, log->record_count);
+		return 0;
+	}
+	result->bytes = log->record_bytes;
+	return 1;
+}
+
+// reopens the WALe, and runs the workload on it, printing its result as a JSON object to out
+static int run_workload(log_handle* log, workload w, const char* cache, FILE* out)
+{
+	const log_config* config = log->config;
+
+	if(!config->backend->is_memory)
+	{
+		if(strcmp(cache, "cold") == 0 && !drop_from_page_cache(config))
+			return 0;
+		if(strcmp(cache, "warm") == 0 && !load_into_page_cache(config))
+			return 0;
+	}
+
+	block_io_ops block_io_functions = open_log_backend(log, 0);
+	if(!config->backend->is_memory && !log->is_file_open)
+		return 0;
+
+	workload_result result = {};
+	int failed = 0;
+
+	int error = NO_ERROR;
+	uint64_t start_time = now_ns();
+	if(!initialize_wale(&(log->walE), 8, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, block_io_functions, config->buffer_block_count, &error))
+	{
+		fprintf(stderr, "failed to reopen wale : error = %d\n", error);
+		close_log_wale(log);
+		return 0;
+	}
+	log->is_wale_initialized = 1;
+	if(w != OPEN)
+		start_time = now_ns();
+
+	switch(w)
+	{
+		case OPEN :
+			break;
+		case SCAN :
+			failed = !run_scan(&(log->walE), 0, &result);
+			break;
+		case RANDOM_GET :
+			failed = !run_random_get(&(log->walE), log, &result);
+			break;
+		case BACKWARD :
+			failed = !run_backward(&(log->walE), log, &result);
+			break;
+		case VALIDATE :
+		default :
+			failed = !run_scan(&(log->walE), 1, &result);
+			break;
+	}
+	uint64_t elapsed_ns = now_ns() - start_time;
+
+	// every workload ran on a freshly initialized WALe, so these stats are of the workload alone (and of the initialize_wale, for the open workload)
+	wale_stats stats;
+	get_wale_stats(&(log->walE), &stats);
+
+	if(!failed)
+	{
+		double elapsed_s = ((double)elapsed_ns) / 1e9;
+		fprintf(out, "{\"backend\": \"%s\", \"record_sizes\": \"%s\", \"log_mb\": %" PRIu64 ", \"log_records\": %" PRIu64 ", \"cache\": \"%s\", \"workload\": \"%s\", ",
+			config->backend->name, config->record_sizes, config->log_bytes / (1024 * 1024), log->record_count, cache, workload_names[w]);
+		// the open workload reads no log records, only its restart time is reported
+		if(w == OPEN)
+			fprintf(out, "\"elapsed_s\": %.6f, ", elapsed_s);
+		else
+			fprintf(out, "\"records\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"elapsed_s\": %.6f, \"records_per_s\": %.1f, \"mb_per_s\": %.3f, ",
+				result.record_count, result.bytes, elapsed_s, result.record_count / elapsed_s, (result.bytes / elapsed_s) / (1024.0 * 1024.0));
+		fprintf(out, "\"read_ios\": %" PRIu64 ", \"read_bytes\": %" PRIu64, stats.counters[WALE_STATS_READ_IOS], stats.counters[WALE_STATS_READ_BYTES]);
+		if(w == RANDOM_GET)
+		{
+			fprintf(out, ", ");
+			print_latencies(out, "get_latency_ns", result.latencies, result.record_count);
+		}
+		fprintf(out, "}");
+
+		if(w == OPEN)
+			fprintf(stderr, "backend=%s record_sizes=%s log_mb=%" PRIu64 " cache=%s workload=%s : restarted in %.3f s\n",
+				config->backend->name, config->record_sizes, config->log_bytes / (1024 * 1024), cache, workload_names[w], elapsed_s);
+		else
+			fprintf(stderr, "backend=%s record_sizes=%s log_mb=%" PRIu64 " cache=%s workload=%s : %.1f records/s, %.3f s\n",
+				config->backend->name, config->record_sizes, config->log_bytes / (1024 * 1024), cache, workload_names[w], result.record_count / elapsed_s, elapsed_s);
+	}
+
+	free(result.latencies);
+	close_log_wale(log);
+	return !failed;
+}
+
+static void destroy_log(log_handle* log)
+{
+	close_log_wale(log);
+	free(log->sampled_log_sequence_numbers);
+	if(log->config->backend->is_memory)
+		close_memory_block_io(&(log->mbio));
+	else
+		unlink(log->config->file_path);
+}
+
+// -------------------------------------------------------------
+
+static void print_usage(const char* program)
+{
+	fprintf(stderr, "usage : %s [--log_mb=1024,51200] [--record_sizes=fixed:128,uniform:64-4096,exponential:256] [--backend=file,file_direct,ram] [--cache=cold,warm] [--workloads=open,scan,random_get,backward,validate] [--random_gets=100000] [--buffer_blocks=64] [--block_size=4096] [--seed=1] [--file=wale_read_bench.log] [--output=report.json]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+	char log_mb_arg[256] = "1024";
+	char record_sizes_arg[256] = "fixed:128,uniform:64-4096";
+	char backend_arg[256] = "file";
+	char cache_arg[256] = "cold,warm";
+	char workloads_arg[256] = "open,scan,random_get,backward,validate";
+	uint64_t random_get_count = 100000;
+	uint64_t buffer_block_count = 64;
+	uint64_t block_size = 4096;
+	uint64_t seed = 1;
+	const char* file_path = "wale_read_bench.log";
+	const char* output_path = NULL;
+
+	for(int i = 1; i < argc; i++)
+	{
+		char* value = strchr(argv[i], '=');
+		if(strncmp(argv[i], "--", 2) != 0 || value == NULL)
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+		(*value) = '\0';
+		value++;
+
+		const char* name = argv[i] + 2;
+		int valid = 1;
+		if(strcmp(name, "log_mb") == 0)
+			valid = (strlen(value) < sizeof(log_mb_arg)) && strcpy(log_mb_arg, value);
+		else if(strcmp(name, "record_sizes") == 0)
+			valid = (strlen(value) < sizeof(record_sizes_arg)) && strcpy(record_sizes_arg, value);
+		else if(strcmp(name, "backend") == 0)
+			valid = (strlen(value) < sizeof(backend_arg)) && strcpy(backend_arg, value);
+		else if(strcmp(name, "cache") == 0)
+			valid = (strlen(value) < sizeof(cache_arg)) && strcpy(cache_arg, value);
+		else if(strcmp(name, "workloads") == 0)
+			valid = (strlen(value) < sizeof(workloads_arg)) && strcpy(workloads_arg, value);
+		else if(strcmp(name, "random_gets") == 0)
+			valid = parse_uint64(&random_get_count, value) && random_get_count > 0;
+		else if(strcmp(name, "buffer_blocks") == 0)
+			valid = parse_uint64(&buffer_block_count, value) && buffer_block_count > 0;
+		else if(strcmp(name, "block_size") == 0)
+			valid = parse_uint64(&block_size, value) && block_size > 0;
+		else if(strcmp(name, "seed") == 0)
+			valid = parse_uint64(&seed, value);
+		else if(strcmp(name, "file") == 0)
+			file_path = value;
+		else if(strcmp(name, "output") == 0)
+			output_path = value;
+		else
+			valid = 0;
+
+		if(!valid)
+		{
+			fprintf(stderr, "invalid option --%s=%s\n", name, value);
+			print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	value_list log_mb_list, record_sizes_list, backend_list, cache_list, workloads_list;
+	if(!parse_value_list(&log_mb_list, log_mb_arg) || !parse_value_list(&record_sizes_list, record_sizes_arg) ||
+		!parse_value_list(&backend_list, backend_arg) || !parse_value_list(&cache_list, cache_arg) ||
+		!parse_value_list(&workloads_list, workloads_arg))
+	{
+		fprintf(stderr, "every list must have 1 to %d values\n", MAX_LIST_SIZE);
+		return -1;
+	}
+
+	// validate all the values, before building any of the logs
+	uint64_t log_mbs[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < log_mb_list.count; i++)
+		if(!parse_uint64(&(log_mbs[i]), log_mb_list.values[i]) || log_mbs[i] == 0)
+		{
+			fprintf(stderr, "invalid log size %s\n", log_mb_list.values[i]);
+			return -1;
+		}
+	record_size_distribution distributions[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < record_sizes_list.count; i++)
+		if(!parse_record_size_distribution(&(distributions[i]), record_sizes_list.values[i]))
+		{
+			fprintf(stderr, "invalid record size distribution %s\n", record_sizes_list.values[i]);
+			return -1;
+		}
+	const backend* selected_backends[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < backend_list.count; i++)
+		if((selected_backends[i] = find_backend(backend_list.values[i])) == NULL)
+		{
+			fprintf(stderr, "unknown backend %s\n", backend_list.values[i]);
+			return -1;
+		}
+	for(uint32_t i = 0; i < cache_list.count; i++)
+		if(strcmp(cache_list.values[i], "cold") != 0 && strcmp(cache_list.values[i], "warm") != 0)
+		{
+			fprintf(stderr, "invalid cache state %s\n", cache_list.values[i]);
+			return -1;
+		}
+	workload workloads[MAX_LIST_SIZE];
+	for(uint32_t i = 0; i < workloads_list.count; i++)
+		if(!find_workload(&(workloads[i]), workloads_list.values[i]))
+		{
+			fprintf(stderr, "unknown workload %s\n", workloads_list.values[i]);
+			return -1;
+		}
+
+	FILE* out = stdout;
+	if(output_path != NULL && (out = fopen(output_path, "w")) == NULL)
+	{
+		fprintf(stderr, "failed to open %s : errno = %d\n", output_path, errno);
+		return -1;
+	}
+
+	struct utsname host;
+	uname(&host);
+
+	fprintf(out, "{\n\"host\": {\"sysname\": \"%s\", \"release\": \"%s\", \"machine\": \"%s\", \"cpus\": %ld},\n", host.sysname, host.release, host.machine, sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(out, "\"random_gets\": %" PRIu64 ", \"buffer_blocks\": %" PRIu64 ", \"block_size\": %" PRIu64 ", \"seed\": %" PRIu64 ",\n", random_get_count, buffer_block_count, block_size, seed);
+	fprintf(out, "\"runs\": [\n");
+
+	int failed_runs = 0;
+	int first_run = 1;
+	for(uint32_t b = 0; b < backend_list.count; b++)
+		for(uint32_t r = 0; r < record_sizes_list.count; r++)
+			for(uint32_t m = 0; m < log_mb_list.count; m++)
+			{
+				log_config config = {
+					.backend = selected_backends[b],
+					.record_sizes = record_sizes_list.values[r],
+					.record_size_distribution = distributions[r],
+					.log_bytes = log_mbs[m] * 1024 * 1024,
+					.buffer_block_count = buffer_block_count,
+					.block_size = block_size,
+					.seed = seed,
+					.random_get_count = random_get_count,
+					.file_path = file_path,
+				};
+
+				log_handle log = {.config = &config};
+				int built = build_log(&log);
+
+				for(uint32_t c = 0; c < cache_list.count; c++)
+				{
+					// the WALe on the ram backend is never out of the memory
+					if(config.backend->is_memory && strcmp(cache_list.values[c], "cold") == 0)
+						continue;
+
+					for(uint32_t w = 0; w < workloads_list.count; w++)
+					{
+						if(!first_run)
+							fprintf(out, ",\n");
+						first_run = 0;
+
+						if(!built || !run_workload(&log, workloads[w], cache_list.values[c], out))
+						{
+							fprintf(out, "{\"backend\": \"%s\", \"record_sizes\": \"%s\", \"log_mb\": %" PRIu64 ", \"cache\": \"%s\", \"workload\": \"%s\", \"failed\": true}",
+								config.backend->name, config.record_sizes, log_mbs[m], cache_list.values[c], workload_names[workloads[w]]);
+							failed_runs++;
+						}
+					}
+				}
+
+				destroy_log(&log);
+			}
+
+	fprintf(out, "\n]\n}\n");
+
+	if(out != stdout)
+		fclose(out);
+
+	return (failed_runs == 0) ? 0 : -1;
+}
\ No newline at end of file
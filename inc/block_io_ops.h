@@ -8,6 +8,17 @@
 //  * what block_size buffer to use
 //  * alignment requirements of in memory buffer (to hold contiguous blocks and) to perform IO on contiguous blocks
 
+// a single contiguous run of blocks, that is read into or written from its buffer, as a part of a vectored io
+typedef struct block_io_vector block_io_vector;
+struct block_io_vector
+{
+	// dest for the read_blocks_v, src for the write_blocks_v (the write_blocks_v never modifies it)
+	void* buffer;
+
+	uint64_t block_id;
+	uint64_t block_count;
+};
+
 typedef struct block_io_ops block_io_ops;
 struct block_io_ops
 {
@@ -29,6 +40,22 @@ struct block_io_ops
 
 	// flush all write to underlying disk, all writes are assumed to be persistent after this call returns successfully
 	int (*flush_all_writes)(const void* block_io_ops_handle);
+
+	// below functions are optional, set them to NULL if your storage does not support them
+
+	// deallocate the storage for contiguous block_count number of blocks starting at block_id, without changing the size of the underlying storage
+	// these blocks will never be read again, unless they are written first, so their contents after this call are irrelevant
+	int (*punch_hole_blocks)(const void* block_io_ops_handle, uint64_t block_id, uint64_t block_count);
+
+	// read/write the vector_count runs of blocks in the vectors, as if by calling read_blocks/write_blocks for each of them in order, but with as few ios as the storage allows
+	// the runs may be non-contiguous on the disk, and the buffers may be non-contiguous in memory
+	// when these are NULL, the WALe falls back to calling the read_blocks/write_blocks for each of the vectors
+	int (*read_blocks_v)(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count);
+	int (*write_blocks_v)(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count);
+
+	// write contiguous block_count number of blocks, just as write_blocks, but return only after they are persistent, without flushing any other writes (e.g. using RWF_DSYNC, that becomes a FUA write on the devices that support it)
+	// when provided, the WALe writes all of its log records and its master record using it, and never calls flush_all_writes to persist them
+	int (*write_blocks_durable)(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count);
 };
 
 #endif
\ No newline at end of file
@@ -7,6 +7,15 @@ uint64_t get_block_id_from_file_offset(uint64_t file_offset, const block_io_ops*
 
 uint64_t get_block_offset_from_file_offset(uint64_t file_offset, const block_io_ops* block_io_functions);
 
+// number of blocks needed to hold size bytes, i.e. size / block_size rounded up
+uint64_t get_block_count_for_size(uint64_t size, const block_io_ops* block_io_functions);
+
 uint64_t get_file_offset_from_block_id_and_block_offset(uint64_t block_id, uint64_t block_offset, const block_io_ops* block_io_functions, int* error);
 
+// read/write the vectors using the read_blocks_v/write_blocks_v of the block_io_functions
+// or by calling its read_blocks/write_blocks for each of the vectors, if it does not provide them
+// returns 1 on success and 0 on failure
+int read_block_vectors(const block_io_ops* block_io_functions, const block_io_vector* vectors, uint64_t vector_count);
+int write_block_vectors(const block_io_ops* block_io_functions, const block_io_vector* vectors, uint64_t vector_count);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef DEFLATE_LOG_RECORD_CODEC_H
+#define DEFLATE_LOG_RECORD_CODEC_H
+
+#include<log_record_codec.h>
+
+// deflate log record codec is a bundled implementation of the log_record_codec, using zlib's deflate (which WALe already links against for crc32)
+// it compresses at Z_BEST_SPEED, since the log records are compressed by the appenders on their hot path
+
+#define DEFLATE_LOG_RECORD_CODEC_ID 1
+
+log_record_codec get_deflate_log_record_codec();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef FILE_BLOCK_IO_OPS_H
+#define FILE_BLOCK_IO_OPS_H
+
+#include<block_io_ops.h>
+
+// file_block_io is a bundled implementation of the block_io_ops, over a file (or a block device) on a linux system
+// it performs io using pread(v), pwrite(v) and fdatasync (or pwritev2(RWF_DSYNC)), and reclaims blocks using fallocate(FALLOC_FL_PUNCH_HOLE)
+
+typedef struct file_block_io file_block_io;
+struct file_block_io
+{
+	int file_descriptor;
+
+	// block size to be used for the file, it must be a multiple of the logical block size of the device, if the file is opened with O_DIRECT
+	uint64_t block_size;
+};
+
+// opens the file at file_path (creating it, if create is set), additional_flags are passed to the open call (like O_DIRECT)
+// returns 1 on success, and 0 on failure (errno is set by the failing system call)
+int open_file_block_io(file_block_io* fbio_p, const char* file_path, int create, uint64_t block_size, int additional_flags);
+
+int close_file_block_io(file_block_io* fbio_p);
+
+// the returned block_io_ops must not be used after the file_block_io is closed
+block_io_ops get_block_io_ops_for_file_block_io(const file_block_io* fbio_p);
+
+// same as the above, but it also provides the write_blocks_durable, using pwritev2(RWF_DSYNC)
+// a WALe over it makes only the blocks it writes durable, instead of an fdatasync of the whole file on every flush
+// open the file with O_DIRECT for this, so that on a device with FUA, every durable write is a single FUA write, with no cache flush
+// on a kernel without RWF_DSYNC, the durable writes fall back to a pwrite followed by an fdatasync
+block_io_ops get_durable_write_block_io_ops_for_file_block_io(const file_block_io* fbio_p);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef LATENCY_BLOCK_IO_OPS_H
+#define LATENCY_BLOCK_IO_OPS_H
+
+#include<block_io_ops.h>
+
+#include<pthread.h>
+
+// latency_block_io wraps any block_io_ops, and delays its calls, to simulate the latency and bandwidth of a slower device
+// use it over a memory_block_io (or a file_block_io), to model your production devices (like NVMe drives or network block devices) in benchmarks and tests
+
+// every delay is drawn from a latency_distribution
+// i.e. uniformly in [base_ns - jitter_ns, base_ns + jitter_ns], plus tail_ns for tail_per_million out of every million calls
+typedef struct latency_distribution latency_distribution;
+struct latency_distribution
+{
+	uint64_t base_ns;
+	uint64_t jitter_ns;
+
+	uint64_t tail_ns;
+	uint32_t tail_per_million;
+};
+
+typedef struct latency_block_io_config latency_block_io_config;
+struct latency_block_io_config
+{
+	// added to every call of the corresponding function, of the underlying block_io_ops
+	latency_distribution read_latency;
+	latency_distribution write_latency;
+	latency_distribution flush_latency;
+
+	// bandwidth caps for the reads and the writes, 0 implies no cap
+	// the reads (and the writes) are transferred serially at this rate, i.e. concurrent ios queue up behind one another
+	uint64_t read_bytes_per_second;
+	uint64_t write_bytes_per_second;
+
+	// seed for the pseudo random delays
+	uint64_t seed;
+};
+
+typedef struct latency_block_io latency_block_io;
+struct latency_block_io
+{
+	// block_io_ops that the calls are delayed for
+	block_io_ops underlying_block_io_functions;
+
+	latency_block_io_config config;
+
+	// protects the below attributes
+	pthread_mutex_t lock;
+
+	uint64_t random_state;
+
+	// the time (CLOCK_MONOTONIC, in nanoseconds) until which, the reads and the writes have reserved the bandwidth
+	uint64_t read_busy_until;
+	uint64_t write_busy_until;
+};
+
+// the underlying_block_io_functions must stay valid, until the latency_block_io is closed
+void open_latency_block_io(latency_block_io* lbio_p, block_io_ops underlying_block_io_functions, const latency_block_io_config* config);
+
+void close_latency_block_io(latency_block_io* lbio_p);
+
+// the returned block_io_ops must not be used after the latency_block_io is closed
+block_io_ops get_block_io_ops_for_latency_block_io(const latency_block_io* lbio_p);
+
+#endif
\ No newline at end of file
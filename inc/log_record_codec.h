@@ -0,0 +1,27 @@
+#ifndef LOG_RECORD_CODEC_H
+#define LOG_RECORD_CODEC_H
+
+#include<stdint.h>
+
+// log_record_codec is a structure accepted by the WALe, it is the interface that defines how to compress and decompress the log records
+// a WALe compresses the log records being appended, and decompresses the compressed log records being read, using the codec set by set_log_record_codec()
+
+typedef struct log_record_codec log_record_codec;
+struct log_record_codec
+{
+	const void* codec_handle;
+
+	// codec_id is stored with every log record compressed by this codec, it must not be 0
+	// a log record can only be decompressed by a codec with the same codec_id, as the one that compressed it
+	uint8_t codec_id;
+
+	// compress src_size bytes at src into dest, that can hold at most dest_size bytes
+	// returns the number of bytes written to the dest, it must return 0 on failure, or if the compressed data does not fit in dest_size bytes
+	uint32_t (*compress)(const void* codec_handle, void* dest, uint32_t dest_size, const void* src, uint32_t src_size);
+
+	// decompress src_size bytes at src into dest, that is exactly dest_size bytes (i.e. the size of the log record before it was compressed)
+	// returns 1 on success, and 0 on failure, or if the decompressed data is not exactly dest_size bytes
+	int (*decompress)(const void* codec_handle, void* dest, uint32_t dest_size, const void* src, uint32_t src_size);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef MEMORY_BLOCK_IO_OPS_H
+#define MEMORY_BLOCK_IO_OPS_H
+
+#include<block_io_ops.h>
+
+// memory_block_io is a bundled implementation of the block_io_ops, over an anonymous memory mapping
+// it lets you measure the cost of the WALe itself (cpu and locking), without any disk io, it is not persistent, so use it only for benchmarks and tests
+// the mapping reserves the address space for max_block_count blocks, the memory is allocated only as the blocks get written
+// the blocks that are never written read as zeros, flush_all_writes is a nop, and punch_hole_blocks returns the memory of the blocks back to the system
+
+typedef struct memory_block_io memory_block_io;
+struct memory_block_io
+{
+	void* memory;
+
+	uint64_t block_size;
+
+	// the blocks at and beyond max_block_count can not be read or written
+	uint64_t max_block_count;
+};
+
+// returns 1 on success, and 0 on failure (errno is set by the failing system call)
+int open_memory_block_io(memory_block_io* mbio_p, uint64_t block_size, uint64_t max_block_count);
+
+int close_memory_block_io(memory_block_io* mbio_p);
+
+// the returned block_io_ops must not be used after the memory_block_io is closed
+block_io_ops get_block_io_ops_for_memory_block_io(const memory_block_io* mbio_p);
+
+#endif
\ No newline at end of file
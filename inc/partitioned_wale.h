@@ -0,0 +1,138 @@
+#ifndef PARTITIONED_WALE_H
+#define PARTITIONED_WALE_H
+
+#include<wale.h>
+
+// partitioned_wale manages partition_count WALe-s (partitions), e.g. one per core group or one per device, so that the appenders of different partitions never contend on the same lock, buffer or device
+// every log record is appended to a single partition, and is stamped with a global_sequence_number, taken from a counter shared by all the partitions
+// within a partition the log records are in the increasing order of their global_sequence_numbers, so a merged cursor can yield the log records of all the partitions in the global order, for recovery
+// a transaction remembers the partitions it appended to, and its commit makes durable only those partitions
+
+/*
+	The log_record of every log record in a partition is stored in the below format
+	all of the integers are in little endian format
+
+	struct
+	{
+		uint64_t global_sequence_number;
+		char log_record[log_record_size];
+	};
+
+	the log_record_type of the log record is stored as is, by the partition
+	the global_sequence_number is stamped using append_prefixed_log_record(), so the log records of the partitions are never compressed
+*/
+
+// the transactions remember the partitions they appended to, in a bitmap of these many bits
+#define MAX_PARTITION_COUNT 64
+
+// size of the global_sequence_number prefixed to every log record, in a partition
+#define GLOBAL_SEQUENCE_NUMBER_SIZE 8
+
+typedef struct wale_partition wale_partition;
+struct wale_partition
+{
+	// WALe instance for this partition, it is initialized with an internal lock
+	// the global_sequence_numbers are taken under its global lock, as the log records take their slots, so they are appended in their increasing order
+	wale partition_wale;
+};
+
+typedef struct partitioned_wale partitioned_wale;
+struct partitioned_wale
+{
+	// array of partition_count partitions, indexed by their partition_id
+	// they are allocated once, since a wale can not be moved in memory after initialization
+	wale_partition* partitions;
+
+	uint32_t partition_count;
+
+	// the global_sequence_number for the next log record appended to any of the partitions
+	// it is incremented using atomic operations, so that the partitions share no lock
+	uint64_t next_global_sequence_number;
+};
+
+// a transaction spanning the partitions, initialize it to all zeros before the first append
+typedef struct partitioned_wale_transaction partitioned_wale_transaction;
+struct partitioned_wale_transaction
+{
+	// bit partition_id is set, if the transaction appended to the partition
+	uint64_t touched_partitions;
+
+	// log_sequence_number of the last log record, that the transaction appended to each of the touched partitions
+	uint256 last_log_sequence_numbers[MAX_PARTITION_COUNT];
+};
+
+// partition_block_io_functions is an array of partition_count block_io_ops, one for every partition
+// if next_log_sequence_number is INVALID_LOG_SEQUENCE_NUMBER
+//   -> all the partitions are existing WALe files, and the next_global_sequence_number is set to follow the largest global_sequence_number found in them
+// else
+//   -> all the partitions are new WALe files, each starting at the next_log_sequence_number, and the next_global_sequence_number is 1
+// it fails with PARAM_INVALID, if the partition_count is 0 or greater than MAX_PARTITION_COUNT
+int initialize_partitioned_wale(partitioned_wale* pwale_p, uint32_t partition_count, const block_io_ops* partition_block_io_functions, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t append_only_block_count, int* error);
+
+void deinitialize_partitioned_wale(partitioned_wale* pwale_p);
+
+// returns the WALe of the partition, to call the WALe functions that are not wrapped here (e.g. truncate_log_records_before)
+// do not append to it directly, as those log records would not carry a global_sequence_number
+wale* get_partition_wale(partitioned_wale* pwale_p, uint32_t partition_id);
+
+// -------------------------------------------------------------
+// writer functions
+
+// appends the log record to the partition, with APPEND_BUFFERED durability, stamping it with the next global_sequence_number
+// pick the partition local to the appender (e.g. its core group), appends to different partitions run in parallel
+// the appenders of the same partition serialize only for the reservation of their slots, they copy their log records in parallel
+// if transaction is not NULL, then the partition is remembered in it, to be made durable by commit_partitioned_wale_transaction()
+// returns the log_sequence_number of the log record in the partition, and sets the global_sequence_number (if not NULL)
+uint256 append_log_record_partitioned(partitioned_wale* pwale_p, uint32_t partition_id, partitioned_wale_transaction* transaction, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, uint64_t* global_sequence_number, int* error);
+
+// makes durable all the log records, that the transaction appended, flushing only the partitions that it touched
+// the flushes of the concurrent commits on a partition are joined, as with the APPEND_DURABLE appends of a WALe
+// the transaction may be reused, after being reset to all zeros
+int commit_partitioned_wale_transaction(partitioned_wale* pwale_p, const partitioned_wale_transaction* transaction, int* error);
+
+// flushes all the partitions, returns 1 only if all of them were flushed successfully
+int flush_all_log_records_partitioned(partitioned_wale* pwale_p, int* error);
+
+// -------------------------------------------------------------
+// merged scan
+
+// a merged cursor yields the flushed log records of all the partitions, in the increasing order of their global_sequence_numbers
+// it keeps the next log record of every partition read, and yields the one with the smallest global_sequence_number among them
+// only the flushed log records are yielded, so a log record with a larger global_sequence_number (in a partition that was flushed) may be yielded
+// while a log record with a smaller global_sequence_number (in a partition that was not flushed) is lost, the log records of the committed transactions are never lost
+typedef struct partitioned_wale_cursor_head partitioned_wale_cursor_head;
+struct partitioned_wale_cursor_head
+{
+	// log_sequence_number of the next log record of the partition, it is INVALID_LOG_SEQUENCE_NUMBER if the partition has no more log records
+	uint256 log_sequence_number;
+
+	// the next log record of the partition (including its global_sequence_number), as returned by the get_log_record_at()
+	void* log_record;
+	uint32_t log_record_size;
+
+	uint64_t global_sequence_number;
+};
+
+typedef struct partitioned_wale_cursor partitioned_wale_cursor;
+struct partitioned_wale_cursor
+{
+	partitioned_wale* pwale_p;
+
+	// array of partition_count heads, one for every partition
+	partitioned_wale_cursor_head* heads;
+};
+
+// positions the cursor before the first log record (i.e. the one with the smallest global_sequence_number) of all the partitions
+int initialize_partitioned_wale_cursor(partitioned_wale_cursor* cursor, partitioned_wale* pwale_p, int* error);
+
+// returns the next log record in the global order, along with its partition_id, log_sequence_number (in that partition) and global_sequence_number (all, if not NULL)
+// it returns NULL with no error, once all the log records have been yielded
+// you must release the returned log record using release_log_record_partitioned()
+void* get_next_log_record_partitioned(partitioned_wale_cursor* cursor, uint32_t* partition_id, uint256* log_sequence_number, uint64_t* global_sequence_number, uint32_t* log_record_size, int* error);
+
+// releases the log record returned by the get_next_log_record_partitioned(), along with its partition_id and log_record_size
+void release_log_record_partitioned(partitioned_wale* pwale_p, uint32_t partition_id, void* log_record, uint32_t log_record_size);
+
+void deinitialize_partitioned_wale_cursor(partitioned_wale_cursor* cursor);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#ifndef SEGMENTED_WALE_H
+#define SEGMENTED_WALE_H
+
+#include<wale.h>
+
+// segmented_wale manages a series of WALe files (segments), each identified by a segment_id
+// a new segment (with segment_id 1 more than the previous one) is started (rolled over to), at the next_log_sequence_number of the previous segment
+// once a log record starts at or beyond max_segment_size bytes (in log_sequence_number space) of the current last segment
+// all but the last segment are read-only, and can be deleted as a whole once all of their log records are of no concern to you
+
+// segment_ops is a structure accepted by the segmented_wale, it is the interface that defines how to create, open, close and delete the segments on the underlying storage
+
+typedef struct segment_ops segment_ops;
+struct segment_ops
+{
+	const void* segment_ops_handle;
+
+	// all the below functions return 1 on success and 0 on failure
+
+	// get the range of the segment_ids that exist on the storage, i.e. [(*first_segment_id), (*first_segment_id) + (*segment_count))
+	// set (*segment_count) to 0, if there are no segments on the storage
+	int (*get_segments_range)(const void* segment_ops_handle, uint64_t* first_segment_id, uint64_t* segment_count);
+
+	// open the segment with the given segment_id (creating it, if create is set) and fill the block_io_ops to perform io on it
+	int (*open_segment)(const void* segment_ops_handle, uint64_t segment_id, int create, block_io_ops* block_io_functions);
+
+	// close the segment with the given segment_id, the block_io_functions are not used after this call
+	int (*close_segment)(const void* segment_ops_handle, uint64_t segment_id, const block_io_ops* block_io_functions);
+
+	// delete the (already closed) segment with the given segment_id from the storage
+	int (*delete_segment)(const void* segment_ops_handle, uint64_t segment_id);
+};
+
+typedef struct wale_segment wale_segment;
+struct wale_segment
+{
+	uint64_t segment_id;
+
+	// the log_sequence_number at which this segment was started
+	// i.e. the next_log_sequence_number of the previous segment, at the time of the roll over
+	uint256 start_log_sequence_number;
+
+	// block_io_functions of this segment, as returned by the open_segment()
+	block_io_ops block_io_functions;
+
+	// WALe instance for this segment, it is initialized with an internal lock
+	// only the last segment has a non zero append only buffer
+	wale segment_wale;
+};
+
+typedef struct segmented_wale segmented_wale;
+struct segmented_wale
+{
+	// lock for the segments_lock
+	pthread_mutex_t segments_mutex;
+
+	// a reader writer lock protecting the segments array and the segment_count
+	// appenders, flushers and readers take it in shared mode, while roll overs and deletion of segments take it in exclusive mode
+	rwlock segments_lock;
+
+	// array of segment_count segments, ordered by their segment_ids (which are contiguous)
+	// they are stored as pointers, since a wale can not be moved in memory after initialization
+	wale_segment** segments;
+
+	uint64_t segment_count;
+
+	// capacity of the segments array
+	uint64_t segments_capacity;
+
+	// width of the log_sequence_numbers of all the segments
+	uint32_t log_sequence_number_width;
+
+	// a roll over to the new segment happens, once a log record starts at or beyond max_segment_size bytes of the last segment
+	uint64_t max_segment_size;
+
+	// number of blocks of the append only buffer of the last segment
+	uint64_t append_only_block_count;
+
+	segment_ops segment_functions;
+
+	// log_record_codec and min_log_record_size_to_compress, set on every segment (including the ones rolled over to)
+	log_record_codec log_record_codec;
+	uint32_t min_log_record_size_to_compress;
+};
+
+// if next_log_sequence_number is INVALID_LOG_SEQUENCE_NUMBER
+//   -> all existing segments are opened, all but the last one are opened read-only (with 0 append_only_block_count)
+// else
+//   -> there must not be any existing segments, a brand new segment with segment_id = 0 is created
+int initialize_segmented_wale(segmented_wale* swale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t max_segment_size, segment_ops segment_functions, uint64_t append_only_block_count, int* error);
+
+void deinitialize_segmented_wale(segmented_wale* swale_p);
+
+// sets the log_record_codec on all the segments, just like the set_log_record_codec() of the WALe
+// the segments created by the future roll overs also use this codec
+void set_log_record_codec_segmented(segmented_wale* swale_p, const log_record_codec* codec, uint32_t min_log_record_size_to_compress);
+
+// -------------------------------------------------------------
+// attributes of the segmented_wale, as stored in the on-disk master records of its segments
+
+uint256 get_first_log_sequence_number_segmented(segmented_wale* swale_p);
+
+uint256 get_last_flushed_log_sequence_number_segmented(segmented_wale* swale_p);
+
+uint256 get_check_point_log_sequence_number_segmented(segmented_wale* swale_p);
+
+uint256 get_next_log_sequence_number_segmented(segmented_wale* swale_p);
+
+// -------------------------------------------------------------
+// random reads, they work just like their WALe counterparts, but across all the segments
+// get_next_log_sequence_number_of_segmented() and get_prev_log_sequence_number_of_segmented() transparently move across segment boundaries
+
+uint256 get_next_log_sequence_number_of_segmented(segmented_wale* swale_p, uint256 log_sequence_number, int* error);
+
+uint256 get_prev_log_sequence_number_of_segmented(segmented_wale* swale_p, uint256 log_sequence_number, int* error);
+
+// you must release the returned memory using release_log_record_segmented()
+void* get_log_record_at_segmented(segmented_wale* swale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error);
+
+// releases the log_record returned by get_log_record_at_segmented() along with its log_record_size, it may be called after its segment has been removed
+void release_log_record_segmented(segmented_wale* swale_p, void* log_record, uint32_t log_record_size);
+
+int validate_log_record_at_segmented(segmented_wale* swale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error);
+
+// -------------------------------------------------------------
+// writer functions, they work on the last segment, just like their WALe counterparts
+
+// the append may roll over to a new segment, after the log record has been appended
+// the roll over flushes the current last segment and makes it read-only
+uint256 append_log_record_segmented(segmented_wale* swale_p, const void* log_record, uint32_t log_record_size, int is_check_point, append_durability durability, int* error);
+
+uint256 flush_all_log_records_segmented(segmented_wale* swale_p, int* error);
+
+uint256 discard_unflushed_log_records_segmented(segmented_wale* swale_p, int* error);
+
+// -------------------------------------------------------------
+// reclaiming storage
+
+// deletes all the segments whose log records are all strictly before the oldest_log_sequence_number_of_concern
+// the last segment is never deleted
+// returns the number of segments deleted, on an error the segments deleted so far remain deleted
+uint64_t discard_segments_before_segmented(segmented_wale* swale_p, uint256 oldest_log_sequence_number_of_concern, int* error);
+
+#endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 // returns 1, if the buffer was scrolled up and that there is still space in the buffer for any write
 // returns 0 on a failure
 // it will unlock the global mutex while performing the write IO, no other locks will be released or acquired during this call
+// the caller must wake up the scroll waiters after this call (see util_wait_for_scroll.h), as the appenders that arrive during the write IO wait for the scroll in their queue
 int scroll_append_only_buffer(wale* wale_p);
 
 // below function must be called with the global lock (get_wale_lock(wale_p)) held
@@ -20,4 +21,11 @@ int is_file_offset_within_append_only_buffer(wale* wale_p, uint64_t file_offset)
 // it may call scroll_append_only_buffer, i.e. it also may result in unlocking of the global mutex
 int resize_append_only_buffer(wale* wale_p, uint64_t buffer_block_count, int* error);
 
+// below function must be called with global lock (get_wale_lock(wale_p)) held, and with no lock on the wale_p->append_only_buffer_lock
+// if the append only buffer was released by the autosizing (on an idle WALe), it allocates it again with autosize_policy.min_buffer_block_count blocks
+// it takes the exclusive lock on the wale_p->append_only_buffer_lock for the resize, and releases it before returning
+// returns 1, if the append only buffer is not released anymore
+// returns 0 on a failure
+int reallocate_append_only_buffer_released_on_idle(wale* wale_p, int* error);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef UTIL_BLOCK_BUFFER_POOL_H
+#define UTIL_BLOCK_BUFFER_POOL_H
+
+#include<stdint.h>
+#include<pthread.h>
+
+#include<block_io_ops.h>
+#include<wale_allocator.h>
+
+// a pool of pre-aligned block buffers, so that the reads of the log records and the master record io do not allocate memory on every call
+// every buffer is block_count blocks in size, aligned to the block_buffer_alignment of the block_io_functions
+// a new buffer is allocated, only when all the buffers are in use, so the pool grows to the number of concurrent readers and is never shrunk
+
+// the reads larger than a buffer are performed in chunks of BLOCK_BUFFER_POOL_BUFFER_SIZE bytes
+#define BLOCK_BUFFER_POOL_BUFFER_SIZE UINT64_C(65536)
+
+typedef struct block_buffer_pool block_buffer_pool;
+struct block_buffer_pool
+{
+	// protects the free_buffers
+	pthread_mutex_t lock;
+
+	// stack of the free buffers, the first bytes of a free buffer point to the next free buffer
+	void* free_buffers;
+
+	// size of every buffer in blocks and in bytes
+	uint64_t block_count;
+	uint64_t buffer_size;
+
+	uint64_t block_buffer_alignment;
+
+	// the buffers are allocated using this allocator
+	wale_allocator allocator;
+};
+
+// block_count of the buffers is BLOCK_BUFFER_POOL_BUFFER_SIZE / block_size (atleast 1)
+void initialize_block_buffer_pool(block_buffer_pool* pool, const block_io_ops* block_io_functions, const wale_allocator* allocator);
+
+// all the buffers must be released back to the pool, before this call
+void deinitialize_block_buffer_pool(block_buffer_pool* pool);
+
+// returns a buffer of pool->block_count blocks, or NULL on an allocation failure
+void* acquire_block_buffer(block_buffer_pool* pool);
+
+void release_block_buffer(block_buffer_pool* pool, void* buffer);
+
+#endif
\ No newline at end of file
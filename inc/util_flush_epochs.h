@@ -0,0 +1,52 @@
+#ifndef UTIL_FLUSH_EPOCHS_H
+#define UTIL_FLUSH_EPOCHS_H
+
+#include<wale.h>
+
+// every flush_all_log_records() is a flush epoch, it scrolls the append only buffer, then flushes the written blocks and then writes and flushes the master record
+// the flushing of the blocks of an epoch happens without the flushed_log_records_lock, so it overlaps with the block writes and the master record write of the other epochs
+// but the master records must still be written and installed in to the on_disk_master_record in the order of the log_sequence_numbers, i.e. in the order that the epochs began
+// so an epoch waits for the completion of all the epochs before it, before writing its master record
+// the truncations also write the master record, hence they too are epochs
+
+// initializes the epoch counters and the condition variable
+void initialize_flush_epochs(wale* wale_p);
+
+void deinitialize_flush_epochs(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, along with a lock (shared or exclusive) on the append_only_buffer_lock
+// so that the epochs begin in the order of the in_memory_master_records that they will write
+// returns the epoch, that must be passed to the below functions
+uint64_t begin_flush_epoch(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held
+// waits until all the epochs before this epoch have completed, the global lock is released while waiting
+void wait_for_turn_of_flush_epoch(wale* wale_p, uint64_t flush_epoch);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, after wait_for_turn_of_flush_epoch(), even if the epoch failed
+// completes the epoch, allowing the next epoch to write its master record
+void complete_flush_epoch(wale* wale_p, uint64_t flush_epoch);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, by the flush_all_log_records(), as soon as it is called
+// the APPEND_DURABLE appenders wait for a pending flush to begin its epoch, since it will cover their log records
+void add_pending_flush(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, when the pending flush begins its epoch (after setting the last_flush_epoch), or fails before it
+void remove_pending_flush(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, by an APPEND_DURABLE appender after it has appended its log record
+// it joins the flush epoch that covers the log record at log_sequence_number, i.e. it waits for it to complete, the global lock is released while waiting
+// if the flush epoch in progress does not cover it, it waits for that epoch to complete, and then looks for a flush to join again
+// it returns when no epoch that covers it is in progress or pending, in that case (or if the joined epoch failed), the caller must flush on its own
+void join_flush_epoch_covering(wale* wale_p, uint256 log_sequence_number);
+
+// must be called with global lock (get_wale_lock(wale_p)) held
+// waits until the given epoch (and so all the epochs before it) have completed, the global lock is released while waiting
+void wait_for_completion_of_flush_epoch(wale* wale_p, uint64_t flush_epoch);
+
+// must be called with global lock (get_wale_lock(wale_p)) held
+// waits until all the begun epochs have completed, i.e. the on_disk_master_record is not going to be changed by any of them
+// the caller must hold an exclusive lock on the append_only_buffer_lock, so that no new epochs begin, while it waits
+void wait_for_all_flush_epochs(wale* wale_p);
+
+#endif
\ No newline at end of file
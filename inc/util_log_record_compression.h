@@ -0,0 +1,33 @@
+#ifndef UTIL_LOG_RECORD_COMPRESSION_H
+#define UTIL_LOG_RECORD_COMPRESSION_H
+
+#include<stdint.h>
+
+#include<log_record_codec.h>
+#include<wale_allocator.h>
+
+// the most significant bit of the curr_log_record_size in the log record header, is set for compressed log records
+#define COMPRESSED_LOG_RECORD_FLAG (UINT32_C(1) << 31)
+
+// a compressed log record starts with the uncompressed log record size (uint32_t in little endian format) and the codec_id (1 byte)
+// the compressed data follows this prefix
+#define COMPRESSED_LOG_RECORD_PREFIX_SIZE UINT32_C(5)
+
+// none of the below functions acquire or release any of the wale locks
+
+// returns the compressed log record, and its size in the compressed_log_record_size
+// it is allocated using the allocator, with size log_record_size - 1, and you must deallocate it
+// returns NULL, if the log_record could not be compressed to lesser than log_record_size bytes (or on an allocation failure)
+// in which case, the log_record must be stored as is
+void* compress_log_record(const log_record_codec* codec, const wale_allocator* allocator, const void* log_record, uint32_t log_record_size, uint32_t* compressed_log_record_size);
+
+// returns the uncompressed log record, and its size in the log_record_size
+// it is allocated using the allocator, with size max(log_record_size, 1), and you must deallocate it
+// returns NULL on failure with error set to LOG_RECORD_DECOMPRESSION_FAILED or ALLOCATION_FAILED
+void* decompress_log_record(const log_record_codec* codec, const wale_allocator* allocator, const void* compressed_log_record, uint32_t compressed_log_record_size, uint32_t* log_record_size, int* error);
+
+// parses the uncompressed log record size from the prefix of the compressed log record
+// returns 0, if the compressed_log_record_size can not even hold the prefix
+int parse_uncompressed_log_record_size(const void* compressed_log_record, uint32_t compressed_log_record_size, uint32_t* log_record_size);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef UTIL_LOG_SEQUENCE_NUMBER_H
+#define UTIL_LOG_SEQUENCE_NUMBER_H
+
+#include<wale.h>
+
+// the log_sequence_number arithmetic on the hot paths of the appends and the reads
+// almost all the WALe-s have a log_sequence_number_width of atmost 8 bytes, for them it is done with native uint64_t arithmetic
+// the wider ones fall back to the uint256 arithmetic, the path is selected once in initialize_wale(), see has_narrow_log_sequence_numbers
+
+// sets the narrow log_sequence_number path of the WALe, if its log_sequence_number_width is atmost 8 bytes
+void select_log_sequence_number_arithmetic(wale* wale_p);
+
+// returns 1 and sets result = log_sequence_number + size, it fails if the result reaches the max_limit of the WALe
+int add_size_to_log_sequence_number(const wale* wale_p, uint256* result, uint256 log_sequence_number, uint64_t size);
+
+// returns 1 and sets result = a - b, it fails if a < b or if the result does not fit in a uint64_t
+int get_log_sequence_number_difference(const wale* wale_p, uint64_t* result, uint256 a, uint256 b);
+
+#endif
\ No newline at end of file
@@ -4,19 +4,22 @@
 #include<stdint.h>
 
 #include<block_io_ops.h>
+#include<util_block_buffer_pool.h>
 
 // the below function does not acquire or release any of the wale locks,
 // it directly works with the provided buffer, reading appropriate data into it from underlying disk using the block_io_functions
+// the blocks are read into the buffers acquired from the pool, so no memory is allocated in the steady state
+// a read larger than a pooled buffer is scattered across a few of them, using a single vectored io (see read_blocks_v in block_io_ops.h)
 
 // both of the below functions must be called with atleast a shared lock held on wale_p->flushed_log_records_lock
 
 // if any of the below functions fail with a 0, then you may return READ_IO_ERROR error to external user
 
 // returns 1 on a successfull read, else returns 0
-int random_read_at(void* buffer, uint64_t buffer_size, uint64_t file_offset, const block_io_ops* block_io_functions);
+int random_read_at(void* buffer, uint64_t buffer_size, uint64_t file_offset, const block_io_ops* block_io_functions, block_buffer_pool* pool);
 
 // returns 1 on a successfull crc32 calculation
 // crc32 is an in-out parameter
-int crc32_at(uint32_t* crc32, uint64_t data_size, uint64_t file_offset, const block_io_ops* block_io_functions);
+int crc32_at(uint32_t* crc32, uint64_t data_size, uint64_t file_offset, const block_io_ops* block_io_functions, block_buffer_pool* pool);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef UTIL_RING_BLOCK_IO_H
+#define UTIL_RING_BLOCK_IO_H
+
+#include<wale.h>
+
+// returns the block_io_ops for the ring mode of the wale
+// they map the block 0 (the master record) as is, and the block_id >= 1 onto the block 1 + ((block_id - 1) mod wale_p->ring_block_count) of the wale_p->underlying_block_io_functions
+// an io spanning the end of the ring is split into multiple io calls on the underlying_block_io_functions
+// the returned block_io_ops hold a reference to the wale_p, it must not be moved in memory after this call
+block_io_ops get_ring_block_io_ops(const wale* wale_p);
+
+// must be called with the global lock (get_wale_lock(wale_p)) held, and mr must be the in_memory_master_record
+// returns 1, if the bytes upto the end_file_offset can be written to the ring, without overwriting the block of the first_log_sequence_number of the mr, or any of the blocks after it
+int is_there_space_in_ring_until(const wale* wale_p, const master_record* mr, uint64_t end_file_offset, int* error);
+
+// writes zeros to all the ring_block_count blocks of the ring and flushes them
+// this preallocates the file, so that the writes to the ring never need to grow the file
+// returns 1 on success and 0 on a failure, with error set appropriately
+int zero_out_ring_blocks(const block_io_ops* underlying_block_io_functions, uint64_t ring_block_count, int* error);
+
+#endif
\ No newline at end of file
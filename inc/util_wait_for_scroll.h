@@ -0,0 +1,51 @@
+#ifndef UTIL_WAIT_FOR_SCROLL_H
+#define UTIL_WAIT_FOR_SCROLL_H
+
+#include<wale.h>
+
+// the appenders, that find no space for their log record in the append only buffer, wait here for the next scroll
+// they wait in a FIFO queue, each on its own condition variable, so that a scroll wakes up only as many of them as the append only buffer has space for
+// before parking in the queue, an appender spins for a while (only on a multi-core machine), since a scroll is often just a single write away
+// the spin limit adapts, it grows when the spins are fruitful and shrinks otherwise
+
+// bounds of the spin limit, in number of pause instructions
+#define MIN_SCROLL_WAIT_SPIN_LIMIT 64
+#define MAX_SCROLL_WAIT_SPIN_LIMIT 8192
+
+struct wale_scroll_waiter
+{
+	// the waiter sleeps on this condition variable, with the global lock
+	pthread_cond_t wake_up;
+
+	// bytes that the waiter needs in the append only buffer
+	uint64_t total_bytes_to_write;
+
+	// set when the waiter is woken up (and removed from the queue)
+	int is_woken;
+
+	// bytes reserved for this waiter in wale_p->woken_scroll_waiters_bytes, when it was woken up
+	uint64_t reserved_bytes;
+
+	wale_scroll_waiter* next;
+};
+
+// initializes the queue of waiters and the spin limit
+void initialize_scroll_waiters(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, and with no lock on the append_only_buffer_lock
+// waits until the append only buffer is scrolled, or until the WALe changes its state (e.g. it is resized, truncated or it encounters a major scroll error)
+// the caller must then check for the space in the append only buffer again, and if there still isn't any, call this function again with is_retry set to its last return value
+// is_retry keeps the waiter at the front of the queue, so that the appenders that were woken but found no space (as the new appenders took it), do not lose their turn
+// returns 1, if it waited in the queue, and 0, if it only spun
+// the global lock is released while waiting, and is held again when this function returns
+int wait_for_scroll(wale* wale_p, uint64_t total_bytes_to_write, int is_retry);
+
+// must be called with global lock (get_wale_lock(wale_p)) held, after the append only buffer has been scrolled (or after an appender gave up on its space)
+// wakes up the waiters, in the order of their arrival, while the append only buffer (after the space reserved for the already woken waiters) has space for them
+void wake_up_scroll_waiters(wale* wale_p);
+
+// must be called with global lock (get_wale_lock(wale_p)) held
+// wakes up all the waiters, to be called when the WALe changes its state, i.e. is resized, truncated, discards its unflushed log records or encounters a major scroll error
+void wake_up_all_scroll_waiters(wale* wale_p);
+
+#endif
\ No newline at end of file
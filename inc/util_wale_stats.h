@@ -0,0 +1,61 @@
+#ifndef UTIL_WALE_STATS_H
+#define UTIL_WALE_STATS_H
+
+#include<wale.h>
+#include<wale_stats.h>
+
+// number of shards of the statistics of a WALe, the shard to be updated is picked using the cpu that the thread is running on
+#define WALE_STATS_SHARD_COUNT 8
+
+// a shard occupies its own cache lines, so that the threads on different cpus do not contend on them
+typedef struct wale_stats_shard wale_stats_shard;
+struct wale_stats_shard
+{
+	uint64_t counters[WALE_STATS_COUNTER_COUNT];
+
+	wale_stats_histogram latencies[WALE_STATS_LATENCY_COUNT];
+
+	uint64_t lock_waits[WALE_STATS_LOCK_COUNT];
+	uint64_t lock_wait_ns[WALE_STATS_LOCK_COUNT];
+} __attribute__((aligned(64)));
+
+// allocates the shards of the wale_p, returns 0, if the allocation fails
+int initialize_wale_stats(wale* wale_p);
+
+void deinitialize_wale_stats(wale* wale_p);
+
+// none of the below functions acquire or release any of the wale locks, they may be called with or without them
+
+// returns the current time in nanoseconds, from a monotonic clock
+uint64_t get_wale_stats_time();
+
+void add_to_wale_stats_counter(wale* wale_p, wale_stats_counter counter, uint64_t value);
+
+// records the time elapsed since the start_time in the latency histogram
+void record_wale_stats_latency(wale* wale_p, wale_stats_latency latency, uint64_t start_time);
+
+// -------------------------------------------------------------
+// the below functions acquire the lock just like the function in their name, the waits are timed only if the lock is contended
+
+void pthread_mutex_lock_recording_wait(wale* wale_p, pthread_mutex_t* mutex);
+
+void pthread_cond_wait_recording_wait(wale* wale_p, pthread_cond_t* cond, pthread_mutex_t* mutex);
+
+void read_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock, int lock_preference);
+
+void write_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock);
+
+void shared_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock, int lock_preference);
+
+void exclusive_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock);
+
+void upgrade_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock);
+
+// -------------------------------------------------------------
+
+// returns the block_io_ops that count the ios on the wale_p->counted_block_io_functions, and time their flush_all_writes
+// they also fire the read_io trace event (see wale_trace.h) for every read
+// the returned block_io_ops hold a reference to the wale_p, it must not be moved in memory after this call
+block_io_ops get_stats_block_io_ops(const wale* wale_p);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef UTIL_WALE_TRACE_H
+#define UTIL_WALE_TRACE_H
+
+#include<wale.h>
+#include<wale_trace.h>
+
+#if !defined(WALE_NO_USDT_PROBES) && defined(__has_include)
+	#if __has_include(<sys/sdt.h>)
+		#define WALE_USDT_PROBES
+	#endif
+#endif
+
+#ifdef WALE_USDT_PROBES
+
+// every USDT probe has a semaphore (defined in util_wale_trace.c), that is incremented by the tracers attached to it
+#define WALE_PROBE_SEMAPHORE(event) wale_##event##_semaphore
+#define WALE_PROBE_ENABLED(event) __builtin_expect(WALE_PROBE_SEMAPHORE(event), 0)
+
+extern unsigned short WALE_PROBE_SEMAPHORE(append_slot_reserved);
+extern unsigned short WALE_PROBE_SEMAPHORE(scroll_begin);
+extern unsigned short WALE_PROBE_SEMAPHORE(scroll_end);
+extern unsigned short WALE_PROBE_SEMAPHORE(wait_for_scroll_begin);
+extern unsigned short WALE_PROBE_SEMAPHORE(wait_for_scroll_end);
+extern unsigned short WALE_PROBE_SEMAPHORE(flush_begin);
+extern unsigned short WALE_PROBE_SEMAPHORE(flush_end);
+extern unsigned short WALE_PROBE_SEMAPHORE(master_record_written);
+extern unsigned short WALE_PROBE_SEMAPHORE(read_io);
+
+#else
+
+#define WALE_PROBE_ENABLED(event) 0
+
+#endif
+
+// an event is enabled, only if a tracer is attached to its USDT probe, or a callback is registered for it
+#define is_wale_trace_event_enabled(wale_p, event) (WALE_PROBE_ENABLED(event) || ((wale_p)->trace_callbacks != NULL && (wale_p)->trace_callbacks->event != NULL))
+
+// the below macros fire the events of wale_trace.h, i.e. the USDT probe and the registered callback
+// their arguments are evaluated (and the fire_trace_*() function is called), only if the event is enabled, so a disabled event costs only the above check
+// none of them acquire or release any of the wale locks
+
+#define trace_append_slot_reserved(wale_p, log_sequence_number, log_record_size, append_slot) \
+	do{ if(is_wale_trace_event_enabled(wale_p, append_slot_reserved)) fire_trace_append_slot_reserved(wale_p, log_sequence_number, log_record_size, append_slot); }while(0)
+void fire_trace_append_slot_reserved(const wale* wale_p, uint256 log_sequence_number, uint32_t log_record_size, uint64_t append_slot);
+
+#define trace_scroll_begin(wale_p, buffer_start_block_id, block_count) \
+	do{ if(is_wale_trace_event_enabled(wale_p, scroll_begin)) fire_trace_scroll_begin(wale_p, buffer_start_block_id, block_count); }while(0)
+void fire_trace_scroll_begin(const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count);
+
+#define trace_scroll_end(wale_p, buffer_start_block_id, block_count, success) \
+	do{ if(is_wale_trace_event_enabled(wale_p, scroll_end)) fire_trace_scroll_end(wale_p, buffer_start_block_id, block_count, success); }while(0)
+void fire_trace_scroll_end(const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count, int success);
+
+#define trace_wait_for_scroll_begin(wale_p) \
+	do{ if(is_wale_trace_event_enabled(wale_p, wait_for_scroll_begin)) fire_trace_wait_for_scroll_begin(wale_p); }while(0)
+void fire_trace_wait_for_scroll_begin(const wale* wale_p);
+
+#define trace_wait_for_scroll_end(wale_p) \
+	do{ if(is_wale_trace_event_enabled(wale_p, wait_for_scroll_end)) fire_trace_wait_for_scroll_end(wale_p); }while(0)
+void fire_trace_wait_for_scroll_end(const wale* wale_p);
+
+#define trace_flush_begin(wale_p) \
+	do{ if(is_wale_trace_event_enabled(wale_p, flush_begin)) fire_trace_flush_begin(wale_p); }while(0)
+void fire_trace_flush_begin(const wale* wale_p);
+
+#define trace_flush_end(wale_p, last_flushed_log_sequence_number, success) \
+	do{ if(is_wale_trace_event_enabled(wale_p, flush_end)) fire_trace_flush_end(wale_p, last_flushed_log_sequence_number, success); }while(0)
+void fire_trace_flush_end(const wale* wale_p, uint256 last_flushed_log_sequence_number, int success);
+
+#define trace_master_record_written(wale_p, last_flushed_log_sequence_number, success) \
+	do{ if(is_wale_trace_event_enabled(wale_p, master_record_written)) fire_trace_master_record_written(wale_p, last_flushed_log_sequence_number, success); }while(0)
+void fire_trace_master_record_written(const wale* wale_p, uint256 last_flushed_log_sequence_number, int success);
+
+#define trace_read_io(wale_p, block_id, block_count) \
+	do{ if(is_wale_trace_event_enabled(wale_p, read_io)) fire_trace_read_io(wale_p, block_id, block_count); }while(0)
+void fire_trace_read_io(const wale* wale_p, uint64_t block_id, uint64_t block_count);
+
+#endif
\ No newline at end of file
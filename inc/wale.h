@@ -8,15 +8,19 @@
 #include<rwlock.h>
 
 #include<block_io_ops.h>
+#include<log_record_codec.h>
+#include<wale_allocator.h>
 #include<large_uints.h>
 
 // 0 log sequence number will never show up in the wal file
 #define INVALID_LOG_SEQUENCE_NUMBER get_0_uint256()
 
 /*
-	Each log record has the following format.
+	Each log record is stored in one of the below formats, the format is fixed at the time of the creation of the WALe file and it is recorded in its master record.
 	all of the uint32_t's are in little endian format
 
+	LOG_RECORD_FORMAT_V1 :
+
 	struct
 	{
 		// header
@@ -31,8 +35,47 @@
 
 	There is a different crc32 for the header and the log_record,
 	This allows us to quickly traverse the log records in forward or backward direction using the information only in the header.
+
+	The most significant bit of the curr_log_record_size is set, if the log_record is compressed, the remaining bits are its size as stored.
+
+	prev_log_record_size is always the size of the previous log_record as stored, without the flag.
+
+	LOG_RECORD_FORMAT_V2 :
+
+	struct
+	{
+		// header
+		varint prev_log_record_slot_size;	// total bytes of the previous log record (header, log_record and crc32), 0 for the first log record of the WALe file
+		varint curr_log_record_size_and_flag;	// (curr_log_record_size << 1) | is_compressed
+		uint8_t log_record_type;			// log_record_type it was appended with, see append_typed_log_record()
+		uint16_t header_check;			// lower 16 bits of the crc32 of the above fields
+
+		// log record
+		char log_record[curr_log_record_size];
+		uint32_t crc32;					// crc32 of the header and the log_record, together
+	};
+
+	A varint is an unsigned integer stored 7 bits at a time, least significant bits first, with the most significant bit of each byte set if more bytes follow.
+	The header is 5 to 13 bytes wide, so a small log record carries 9 bytes of framing, instead of the 16 bytes in LOG_RECORD_FORMAT_V1.
+	The header_check lets us traverse the log records using only their headers, as with the crc32_header of the LOG_RECORD_FORMAT_V1.
+	The log records of LOG_RECORD_FORMAT_V1 have no log_record_type, they are all considered to be of log_record_type 0.
+
+	In both the formats, a compressed log_record is stored as below, and its crc32 is calculated over all of it.
+
+	struct
+	{
+		uint32_t uncompressed_log_record_size;
+		uint8_t codec_id;
+		char compressed_data[curr_log_record_size - 5];
+	};
 */
 
+#define LOG_RECORD_FORMAT_V1 1
+#define LOG_RECORD_FORMAT_V2 2
+
+// the largest log record that can be appended, the most significant bit of the curr_log_record_size is reserved for the compression flag
+#define MAX_LOG_RECORD_SIZE ((UINT32_C(1) << 31) - 1)
+
 typedef struct master_record master_record;
 struct master_record
 {
@@ -40,6 +83,11 @@ struct master_record
 	uint32_t log_sequence_number_width;
 
 	// the log sequence number at offset block_io_functions.block_size in the block file
+	// it is set to the first_log_sequence_number, when the first log record is appended to an empty WALe
+	// and it remains as is, when the log is truncated from the front using truncate_log_records_before()
+	uint256 base_log_sequence_number;
+
+	// the log sequence number of the first log record in the WALe
 	uint256 first_log_sequence_number;
 
 	// the last log sequence number flushed to the disk
@@ -50,6 +98,54 @@ struct master_record
 
 	// next log sequence number to allot
 	uint256 next_log_sequence_number;
+
+	// number of blocks (after the block 0) in the ring, if the WALe is in ring mode, else it is 0
+	// in ring mode the file never grows, and the blocks of the log records wrap around to the block 1, after the last block of the ring
+	// this is fixed at the time of the creation of the WALe file
+	uint64_t ring_block_count;
+
+	// format of the log records in this WALe file, LOG_RECORD_FORMAT_V1 or LOG_RECORD_FORMAT_V2
+	// this is fixed at the time of the creation of the WALe file, the new WALe files are always created with LOG_RECORD_FORMAT_V2
+	uint32_t log_record_format_version;
+};
+
+// defined in wale_archive.h
+typedef struct wale_archive wale_archive;
+
+// defined in wale_time_index.h
+typedef struct wale_time_index wale_time_index;
+
+// defined in util_wale_stats.h
+typedef struct wale_stats_shard wale_stats_shard;
+
+// defined in util_wait_for_scroll.h
+typedef struct wale_scroll_waiter wale_scroll_waiter;
+
+// defined in wale_trace.h
+typedef struct wale_trace_callbacks wale_trace_callbacks;
+
+// defined in util_block_buffer_pool.h
+typedef struct block_buffer_pool block_buffer_pool;
+
+// bounds and thresholds of the autosizing of the append only buffer, see set_append_only_buffer_autosize_policy()
+typedef struct wale_autosize_policy wale_autosize_policy;
+struct wale_autosize_policy
+{
+	// the autosizing keeps the buffer_block_count in the range [min_buffer_block_count, max_buffer_block_count], min_buffer_block_count must be atleast 1
+	uint64_t min_buffer_block_count;
+	uint64_t max_buffer_block_count;
+
+	// the buffer_block_count is doubled, if the appenders waited for a scroll atleast these many times since the last tick, 0 implies never grow
+	uint64_t grow_at_scroll_waits;
+
+	// the buffer_block_count is halved, if no appender waited for a scroll and the bytes appended since the last tick are less than this percent of the append only buffer
+	// 0 implies never shrink
+	uint32_t shrink_below_percent;
+
+	// the append only buffer is released (freed), after these many consecutive ticks without any appends, provided that all the appended log records have been flushed
+	// the next append_log_record() allocates it again with min_buffer_block_count blocks, 0 implies never release
+	// unlike an append only buffer with 0 blocks, a released append only buffer never fails with ZERO_BUFFER_BLOCK_COUNT, there is nothing to flush or discard in it
+	uint32_t release_after_idle_ticks;
 };
 
 typedef struct wale wale;
@@ -69,6 +165,23 @@ struct wale
 	// below reader writer lock protects the on_disk_master_record and the flushed logs on the disk (which are considered read-only)
 	rwlock flushed_log_records_lock;
 
+	// flush epochs, that order the master record writes of the concurrent flushes (and truncations), see util_flush_epochs.h
+	// both the below counters are protected by the global lock (get_wale_lock(wale_p))
+	uint64_t begun_flush_epochs;
+	uint64_t completed_flush_epochs;
+
+	// signalled with the global lock, every time an epoch completes
+	pthread_cond_t flush_epoch_completed;
+
+	// the latest epoch begun by a flush_all_log_records(), it flushes the log records before the last_flush_epoch_next_log_sequence_number
+	// the APPEND_DURABLE appenders join this epoch, if it covers their log records, both are protected by the global lock (get_wale_lock(wale_p))
+	uint64_t last_flush_epoch;
+	uint256 last_flush_epoch_next_log_sequence_number;
+
+	// number of flush_all_log_records() calls that are yet to begin their epochs, they will cover all the log records appended until now
+	// protected by the global lock (get_wale_lock(wale_p))
+	uint64_t pending_flushes;
+
 	// --------------------------------------------------------
 
 	// Append only buffer
@@ -77,7 +190,7 @@ struct wale
 	// protected by the append_only_buffer_lock
 	void* buffer;
 
-	// number of blocks pointed to by buffer, this is fixed for most part, unless you call modify_append_only_buffer_block_count()
+	// number of blocks pointed to by buffer, this is fixed for most part, unless you call modify_append_only_buffer_block_count() or enable the autosizing using set_append_only_buffer_autosize_policy()
 	// protected by the append_only_buffer_lock
 	uint64_t buffer_block_count;
 
@@ -108,7 +221,7 @@ struct wale
 
 	// in_memory_master_record and the append_offset must be accessed only while holding append_only_buffer_lock, either in shared or exclusive mode and the global lock (get_wale_lock(wale_p))
 	// This allows us to release the global lock while performing io and then grab the global lock again, while still holding append_only_buffer_lock (doesn't matter shared or exclusive), thus ensuring that the above 2 fields would not have changed
-	// Any modifications to append_offset or the in_memory_master_record must trigger the wait_for_scroll, hence any updates to them must happen inside the global mutex lock
+	// Any modifications to append_offset or the in_memory_master_record must wake up the scroll waiters, hence any updates to them must happen inside the global mutex lock
 	// Such elaborate locking scheme, allows us to release the global mutex lock, while performing read and write io-s
 
 	// this bit will be set, when an unrecoverable scroll error occurs, this error needs a restart of your system
@@ -116,23 +229,126 @@ struct wale
 	// protected by global lock
 	int major_scroll_error : 1;
 
-	// wait on this condition variable for the next scroll after which append_only_buffer contains the first byte for in_memory_master_record.next_log_sequence_number
+	// FIFO queue of the appenders waiting for the next scroll after which append_only_buffer contains the first byte for in_memory_master_record.next_log_sequence_number
+	// see util_wait_for_scroll.h, all the below attributes are protected by global lock (get_wale_lock(wale_p))
+	wale_scroll_waiter* scroll_waiters_head;
+	wale_scroll_waiter* scroll_waiters_tail;
+
+	// bytes of the append only buffer reserved for the waiters that have been woken up, but have not yet run
+	uint64_t woken_scroll_waiters_bytes;
+
+	// incremented every time the scroll waiters are woken up, it is also read without the global lock, by the spinning waiters
+	uint64_t scroll_generation;
+
+	// number of times to spin before parking in the queue, it is 0 on a single cpu machine
+	uint32_t scroll_wait_spin_limit;
+
+	// set while the append only buffer is being written to the disk by scroll_append_only_buffer() (with the global lock released)
+	// the appenders wait in the above queue while it is set, instead of blocking on the append_only_buffer_lock
+	int is_scrolling_append_only_buffer;
+
+	// file offset until which all the bytes of the appended log records have been handed to the write_blocks, by a scroll
 	// protected by global lock (get_wale_lock(wale_p))
-	pthread_cond_t wait_for_scroll;
+	uint64_t written_file_offset;
 
 
 	// --------------------------------------------------------
-	// functions to perform contiguous block io
+	// functions to perform contiguous block io, they count the ios for the statistics of this WALe
+	// in ring mode, these are the functions that map the blocks of the log records (at ever increasing file offsets) onto the blocks of the ring in the underlying_block_io_functions
+	// else these are over the underlying_block_io_functions
 	block_io_ops block_io_functions;
 
+	// functions to perform contiguous block io, as provided by the user
+	block_io_ops underlying_block_io_functions;
+
+	// copy of the ring_block_count of the master record, it never changes, so it can be read without any lock
+	uint64_t ring_block_count;
+
+	// the block_io_functions above count the ios, on these block_io_functions (i.e. the ring or the underlying_block_io_functions)
+	block_io_ops counted_block_io_functions;
+
+	// shards of the statistics of this WALe, see wale_stats.h
+	wale_stats_shard* stats_shards;
+
+	// --------------------------------------------------------
+	// memory of the WALe, see wale_allocator.h
+
+	// allocator of the append only buffer, the block buffers and the log records returned by get_log_record_at(), set by set_wale_allocator()
+	wale_allocator allocator;
+
+	// pool of the block buffers, used for reading the log records and for reading/writing the master record
+	block_buffer_pool* block_buffers;
+
+	// --------------------------------------------------------
+	// compression of the log records, set by set_log_record_codec()
+
+	// codec used to compress the appended log records and to decompress the compressed log records being read
+	// its codec_id is 0, if no codec is set
+	log_record_codec log_record_codec;
+
+	// only the log records of atleast this size are compressed on append, 0 implies that no log records are compressed on append
+	uint32_t min_log_record_size_to_compress;
+
+	// --------------------------------------------------------
+	// archive attached using attach_wale_archive(), the log_sequence_numbers before the first_log_sequence_number are read from it
+	// it is NULL, if no archive is attached
+	wale_archive* archive;
+
+	// --------------------------------------------------------
+	// time index attached using attach_wale_time_index(), every successful flush_all_log_records() records its time in it
+	// it is NULL, if no time index is attached
+	wale_time_index* time_index;
+
+	// --------------------------------------------------------
+	// callbacks registered using set_wale_trace_callbacks(), to receive the trace events of this WALe
+	// it is NULL, if no callbacks are registered
+	const wale_trace_callbacks* trace_callbacks;
+
+	// --------------------------------------------------------
+	// autosizing of the append only buffer, enabled by set_append_only_buffer_autosize_policy() and driven by tick_append_only_buffer_autosize()
+	// all the below attributes are protected by global lock (get_wale_lock(wale_p))
+
+	int is_autosize_enabled;
+	wale_autosize_policy autosize_policy;
+
+	// number of times the appenders waited for a scroll, since the last tick
+	uint64_t autosize_scroll_waits;
+
+	// bytes taken in the append only buffer by the appenders, since the last tick
+	uint64_t autosize_appended_bytes;
+
+	// number of consecutive ticks without any appends
+	uint32_t autosize_idle_ticks;
+
+	// set when the append only buffer of an idle WALe was released by the autosizing, the next append allocates it again
+	int is_append_only_buffer_released_on_idle;
+
+	// --------------------------------------------------------
+	// large log records begun by begin_large_log_record(), that are yet to end, see large_log_record_writer below
+	// both the below attributes are protected by global lock (get_wale_lock(wale_p))
+
+	// list of the writers of the large log records in progress, in the order of their log_sequence_numbers
+	struct large_log_record_writer* large_log_record_writers;
+
+	// signalled with the global lock, every time a large log record ends
+	pthread_cond_t large_log_record_ended;
+
 	// --------------------------------------------------------
 
 	// no log_sequence_number addition must cross this limit, if it crosses then it is an overflow in all of the system
 	uint256 max_limit;
+
+	// set in initialize_wale(), if the log_sequence_number_width is atmost 8 bytes, then the log_sequence_number arithmetic is done with uint64_t-s, see util_log_sequence_number.h
+	int has_narrow_log_sequence_numbers : 1;
+
+	// max_limit - 1, valid only if has_narrow_log_sequence_numbers is set
+	uint64_t max_narrow_log_sequence_number;
 };
 
 /*
-** offset of any log record in file = log_sequence_number - first_log_sequence_number + block_io_functions.block_size
+** offset of any log record in file = log_sequence_number - base_log_sequence_number + block_io_functions.block_size
+** in ring mode, the above offset is mapped onto the ring, i.e. the block at this offset is stored at the block
+** 1 + ((offset / block_io_functions.block_size) - 1) mod ring_block_count, of the underlying file
 */
 
 // -------------------------------------------------------------
@@ -143,7 +359,18 @@ struct wale
 // else
 //   -> a new wale file is initialized, a brand new master_record is written to disk
 
-int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, pthread_mutex_t* external_lock, block_io_ops block_io_functions, uint64_t append_only_block_count, int* error);
+// a new wale file stores its log records in the LOG_RECORD_FORMAT_V2, an existing wale file continues to use the log record format recorded in its master record
+
+// ring_block_count is used only when a new wale file is initialized, for an existing wale file it is read from the on-disk master record
+// if ring_block_count == 0
+//   -> the wale file grows as the log records are appended
+// else
+//   -> the wale file is a fixed size ring of ring_block_count blocks after the block 0, the log records wrap around the ring
+//      all the blocks of the ring are written with zeros when the new wale file is initialized, so that the file is preallocated and never grows
+//      an append that would overwrite the blocks of the log records after the first_log_sequence_number fails with a LOG_RING_FULL error
+//      you must call truncate_log_records_before() (or truncate_log_records()), to make space in the ring for the new log records
+
+int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t ring_block_count, pthread_mutex_t* external_lock, block_io_ops block_io_functions, uint64_t append_only_block_count, int* error);
 
 void deinitialize_wale(wale* wale_p);
 
@@ -170,12 +397,53 @@ uint256 get_next_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 
 uint256 get_prev_log_sequence_number_of(wale* wale_p, uint256 log_sequence_number, int* error);
 
-// you must free the returned memory
+// you must release the returned memory using release_log_record() (or free(), if you never called set_wale_allocator())
+// a compressed log record is transparently decompressed, using the log_record_codec of the WALe
 void* get_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error);
 
+// releases the log_record returned by get_log_record_at() along with its log_record_size, using the allocator of the WALe
+void release_log_record(wale* wale_p, void* log_record, uint32_t log_record_size);
+
+// a filter over the log_record_type-s, to traverse only the log records of the types in it, using only their headers
+// initialize it to all zeros, and then include the log_record_type-s that you want
+typedef struct log_record_type_filter log_record_type_filter;
+struct log_record_type_filter
+{
+	// bit (log_record_type % 64) of types[log_record_type / 64] is set, if the log_record_type is in the filter
+	uint64_t types[4];
+};
+
+void include_log_record_type_in_filter(log_record_type_filter* filter, uint8_t log_record_type);
+
+int is_log_record_type_in_filter(const log_record_type_filter* filter, uint8_t log_record_type);
+
+// the below functions step over the log records that are not in the filter, reading and checking only their headers, and never their log_record-s
+// they return the log_sequence_number of the first (or the next or the previous) log record, whose log_record_type is in the filter
+// if there is no such log record, they return INVALID_LOG_SEQUENCE_NUMBER with no error
+// they traverse the log records of the attached archive aswell, as if they were in the WALe file, reading only the chunks of the archive that they step over
+
+uint256 get_first_log_sequence_number_of_type(wale* wale_p, const log_record_type_filter* filter, int* error);
+
+uint256 get_next_log_sequence_number_of_type(wale* wale_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error);
+
+uint256 get_prev_log_sequence_number_of_type(wale* wale_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error);
+
+// returns 1, and sets log_record_type to that of the log record at log_sequence_number, reading only its header
+// the log records in the attached archive are read from it (those archived by an older version of the archive have the log_record_type 0)
+int get_log_record_type_at(wale* wale_p, uint256 log_sequence_number, uint8_t* log_record_type, int* error);
+
 // returns 1 if the log_record is not corrupted and passes all the crc checks (crc32 check for header and log_record itself)
+// for a compressed log record, the log_record_size is set to its uncompressed size, and it is not decompressed
 int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error);
 
+// for log shipping, copies the log records starting at the from_log_sequence_number into the raw_log_range, exactly as they are framed in the WALe file
+// it copies as many whole log records as fit in the max_bytes, stepping over their headers, and then reading all of them with a single random read
+// returns the number of bytes copied, the log record after them is at from_log_sequence_number + the returned value
+// it returns 0 with no error, if the from_log_sequence_number is the next_log_sequence_number, i.e. there are no more flushed log records to copy
+// it fails with PARAM_INVALID, if the first log record does not fit in the max_bytes
+// the log records are not checked against their crc32-s, that is left to the append_raw_log_range() on the receiving WALe
+uint64_t read_raw_log_range(wale* wale_p, uint256 from_log_sequence_number, uint64_t max_bytes, void* raw_log_range, int* error);
+
 // On a failure of any of the above functions, error will be set to anyone of the below
 // in the increasing order of severity, we consider data corruption as non-recoverable
 #define NO_ERROR                             0
@@ -191,33 +459,188 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 #define HEADER_CORRUPTED                    10 // CRC-32 checksum of log header check failed
 #define LOG_RECORD_CORRUPTED                11 // CRC-32 checksum of log record check failed
 #define MASTER_RECORD_CORRUPTED             12 // CRC-32 checksum of master record check failed, OR the contents of master record are illogical
+#define LOG_RING_FULL                       13 // appending log record could not succeed, because it would overwrite the unreclaimed log records in the ring, you may retry after truncating the log
+#define LOG_RECORD_DECOMPRESSION_FAILED     14 // the log record is compressed, but the log_record_codec of the WALe is not set or has a different codec_id, OR the compressed data could not be decompressed
+#define LOG_RECORD_APPLY_FAILED             15 // the apply callback of the replay_log_records() failed for a log record, see wale_replay.h
+#define LOG_SEQUENCE_NUMBER_GAP             16 // the attached archive does not end right where the WALe begins, i.e. some log records were truncated from the WALe without being archived
+#define LARGE_LOG_RECORD_IN_PROGRESS        17 // discarding or truncating the unflushed log records (or making the WALe read only) could not succeed, because a large log record is still being written, see begin_large_log_record()
+#define TIME_INDEX_CORRUPTED                18 // CRC-32 checksum of the header or of a block of entries of the time index check failed (or the block could not be read), OR its contents are illogical, see wale_time_index.h
 
 // -------------------------------------------------------------
 
 // update the number of blocks in the append only buffer at run time
+// it overrides the autosizing, until its next tick
 int modify_append_only_buffer_block_count(wale* wale_p, uint64_t buffer_block_count, int* error);
 
+// enables the autosizing of the append only buffer, a NULL policy disables it (the buffer_block_count then stays as it is)
+// the autosizing grows the append only buffer of the hot WALe-s, whose appenders keep waiting for the scroll, and shrinks (or releases) the append only buffer of the cold (or idle) WALe-s
+// the current buffer_block_count is clamped to the bounds of the policy, unless it is 0 (i.e. the WALe is read only, then the autosizing does not touch it)
+// it fails with PARAM_INVALID, if min_buffer_block_count is 0 or greater than max_buffer_block_count, or if shrink_below_percent is greater than 100
+int set_append_only_buffer_autosize_policy(wale* wale_p, const wale_autosize_policy* policy, int* error);
+
+// the autosizing decisions are taken only in this function, you must call it periodically (e.g. every 100 ms), the period decides how quickly the autosizing reacts
+// it compares the scroll waits and the appended bytes since the last tick against the policy, and resizes the append only buffer accordingly
+// returns 1, if the append only buffer was resized (or released), else it returns 0, with error set on a failure
+int tick_append_only_buffer_autosize(wale* wale_p, int* error);
+
+// sets the log_record_codec, that is used to decompress the compressed log records being read
+// and to compress the log records of size atleast min_log_record_size_to_compress, being appended (0 implies that the appended log records are never compressed)
+// a log record is stored compressed, only if it shrinks on compression, else it is stored as is
+// a NULL codec, unsets the log_record_codec, and then the compressed log records can not be read
+// it must be called before the WALe is used concurrently by other threads, preferably just after the initialize_wale()
+void set_log_record_codec(wale* wale_p, const log_record_codec* codec, uint32_t min_log_record_size_to_compress);
+
 // -------------------------------------------------------------
 // writer functions of WALe
 
+// durability of the log record, when the append_log_record() returns
+typedef enum append_durability append_durability;
+enum append_durability
+{
+	APPEND_BUFFERED = 0,	// the log record is in the append only buffer
+	APPEND_WRITTEN,			// the blocks containing the log record have been handed to the write_blocks of the block_io_functions, it survives a crash of the process, but not of the machine
+	APPEND_DURABLE,			// the log record is flushed, i.e. it is covered by the on-disk master record, it joins the flush in progress (if that flush covers it), instead of issuing its own
+};
+
 // returns the log_sequence_number of the last log record inserted
 // check_point is marked to be updated in the master record, if is_check_point is set
-// the appended log_record is not permanent (neither is it's being checkpointed-ness) until a flush is successfull
+// the appended log_record is not permanent (neither is it's being checkpointed-ness) until a flush is successfull, unless it is appended with APPEND_DURABLE
 // if the append was unsuccessfull INVALID_LOG_SEQUENCE_NUMBER will be returned, in such a situation it is best to exit the program
-uint256 append_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, int is_check_point, int* error);
+// if the log record was appended, but could not be made as durable as requested, INVALID_LOG_SEQUENCE_NUMBER is returned aswell, the log record may still be flushed by a later flush
+// log_record_size must not be more than MAX_LOG_RECORD_SIZE, else the append fails with PARAM_INVALID
+// the log_record is compressed before it is appended, if the log_record_codec is set and it is atleast min_log_record_size_to_compress bytes
+uint256 append_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, int is_check_point, append_durability durability, int* error);
+
+// same as append_log_record(), but the log record is tagged with a caller defined log_record_type, stored in its header
+// so that the readers can traverse only the log records of the log_record_type-s that they care about, see log_record_type_filter
+// append_log_record() appends the log records with log_record_type 0
+// a WALe file in the LOG_RECORD_FORMAT_V1 can only have log records of log_record_type 0, else the append fails with PARAM_INVALID
+uint256 append_typed_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, append_durability durability, int* error);
+
+// the prefix of a prefixed log record is atmost these many bytes
+#define MAX_LOG_RECORD_PREFIX_SIZE 64
+
+// fills the prefix_size bytes of the prefix of the log record at the log_sequence_number
+// it is called with the global lock of the WALe held, as the log record takes its slot, so the prefixes are filled in the order of the log_sequence_numbers
+// it must be quick, and it must not call any function of this WALe
+typedef void (*log_record_prefix_filler)(void* filler_handle, uint256 log_sequence_number, void* prefix, uint32_t prefix_size);
+
+// same as append_typed_log_record(), but the log record is the prefix of prefix_size bytes followed by the log_record, i.e. it is read back as a single log record of prefix_size + log_record_size bytes
+// the prefix is filled by the fill_prefix at the reservation of the slot (e.g. to stamp the log record with a counter, in the order of the log records), while the log_record is still copied without the global lock
+// the prefixed log records are never compressed, as their prefix is not known until they take their slot
+// it fails with PARAM_INVALID, if the prefix_size is greater than MAX_LOG_RECORD_PREFIX_SIZE, or if the prefix_size + log_record_size is greater than MAX_LOG_RECORD_SIZE
+uint256 append_prefixed_log_record(wale* wale_p, uint32_t prefix_size, log_record_prefix_filler fill_prefix, void* filler_handle, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, append_durability durability, int* error);
+
+// appends the raw_log_range read by read_raw_log_range() from another WALe, as is, at the same log sequence numbers, i.e. on a replica of that WALe
+// the log records are checked once (headers and crc32-s), and then copied into the append only buffer without reframing, in a single critical section
+// the from_log_sequence_number must be the next_log_sequence_number of this WALe (including the unflushed log records), and both the WALe-s must use the same log record format
+// so a replica is created with the first_log_sequence_number of the primary WALe, as its next_log_sequence_number
+// returns the log_sequence_number of the last log record in the raw_log_range, or INVALID_LOG_SEQUENCE_NUMBER on a failure
+// a corrupted raw_log_range fails with HEADER_CORRUPTED or LOG_RECORD_CORRUPTED, and one that does not follow the last log record of this WALe fails with PARAM_INVALID
+// the check_point_log_sequence_number is not shipped, and the durability works as in the append_log_record()
+uint256 append_raw_log_range(wale* wale_p, uint256 from_log_sequence_number, const void* raw_log_range, uint64_t raw_log_range_size, append_durability durability, int* error);
+
+// streaming append of a large log record, e.g. a multi-MB blob image, that the caller does not hold contiguous in memory
+// begin_large_log_record() reserves the slot for the log record of log_record_size, and the append only buffer skips over all of its blocks except the last partial one
+// so the appenders after it take their slots in the append only buffer right away, instead of waiting for the log record to pass through the append only buffer
+// the log_record is then passed in chunks to write_large_log_record_chunk(), the blocks of the log record are staged in a private buffer and written directly by the caller's thread
+// only the last partial block of the log record goes through the append only buffer, it is staged aswell, and copied into the append only buffer (or rewritten) by the end_large_log_record()
+// no lock is held between the calls, the flushes in the meantime write the master record only until the log record before it (so it is not durable, until it ends)
+// the APPEND_DURABLE appenders of the log records after it wait for it to end, so do not make them durable from the same thread, between the two calls
+// and the truncate_log_records(), discard_unflushed_log_records() and modify_append_only_buffer_block_count() to 0 fail with LARGE_LOG_RECORD_IN_PROGRESS, until it ends
+// the large log records are never compressed, and they can be read with all the reader functions once they are flushed
+typedef struct large_log_record_writer large_log_record_writer;
+struct large_log_record_writer
+{
+	wale* wale_p;
+
+	// log_sequence_number of the log record being written, and its log_record_size
+	uint256 log_sequence_number;
+	uint32_t log_record_size;
+
+	// bytes of the log_record received until now
+	uint32_t received_size;
+
+	// crc32 of the header and the bytes of the log_record received until now
+	uint32_t calculated_crc32;
+
+	// the log record becomes the checkpoint only once it is complete, at the end_large_log_record()
+	int is_check_point;
+
+	// log_sequence_number of the log record before this one (INVALID_LOG_SEQUENCE_NUMBER, if the WALe was empty), and the check_point_log_sequence_number until it
+	// the flushes write the master record with these, while this is the first large log record in progress
+	uint256 prev_log_sequence_number;
+	uint256 prev_check_point_log_sequence_number;
+
+	// next large log record in progress on the WALe, protected by global lock (get_wale_lock(wale_p))
+	large_log_record_writer* next_in_progress;
+
+	// file offset of the next byte of the log record to be written, and the one after its last byte
+	uint64_t next_file_offset;
+	uint64_t end_file_offset;
+
+	// the bytes of the log record from this file offset (i.e. in its last partial block) go through the append only buffer, the bytes before it are written directly
+	uint64_t buffered_file_offset;
+
+	// private buffer of staged_block_count blocks, for the blocks starting at staged_block_id, that are to be written directly
+	void* staged_blocks;
+	uint64_t staged_block_count;
+	uint64_t staged_block_id;
+
+	// private block (right after the staged_blocks), for the bytes of the log record from the buffered_file_offset, until the end_large_log_record()
+	void* tail_block;
+
+	// time at which the begin_large_log_record() was called, for the append latency
+	uint64_t start_time;
+
+	// error of the first failed direct write, it is reported by the calls after it
+	int error;
+};
+
+// reserves the slot of a log record of log_record_size and log_record_type, and initializes the writer for it
+// returns the log_sequence_number of the log record, or INVALID_LOG_SEQUENCE_NUMBER on a failure (in which case, you must not call the below functions)
+// it fails with PARAM_INVALID as the append_typed_log_record() would, and with ALLOCATION_FAILED if the private buffer of the writer could not be allocated
+uint256 begin_large_log_record(wale* wale_p, large_log_record_writer* writer, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, int* error);
+
+// appends the next chunk_size bytes of the log_record, the chunks may be of any size, but must not sum up to more than the log_record_size, else it fails with PARAM_INVALID
+// returns 0 on a failure, the failure of a direct write is a MAJOR_SCROLL_ERROR for the whole WALe, as the log would have a hole in it
+int write_large_log_record_chunk(large_log_record_writer* writer, const void* chunk, uint32_t chunk_size, int* error);
+
+// ends the log record, after its last chunk, and makes it as durable as requested (as in the append_log_record())
+// it must be called for every writer that begin_large_log_record() succeeded for, even after a failed write_large_log_record_chunk(), so that the writer releases its memory and the flushes may cover the log records after it
+// if fewer than log_record_size bytes were written, the rest of the log_record is filled with zeros (so that the log records after it can still be read) and it fails with PARAM_INVALID
+// such an abandoned log record is written with a wrong crc32, so reading it fails with LOG_RECORD_CORRUPTED, and it never becomes the checkpoint
+// returns the log_sequence_number of the log record, or INVALID_LOG_SEQUENCE_NUMBER on a failure
+uint256 end_large_log_record(large_log_record_writer* writer, append_durability durability, int* error);
 
 // returns the last_flushed_log_sequence_number, after the flush
 // it will first ensure that all the appended log records have been flushed and then it will rewrite the master record and flush it
 // making it point to the new last_flushed_log_sequence_number, next_log_sequence_number and check_point_log_sequence_number
+// concurrent flushes are pipelined, the fsync of a flush overlaps with the block writes of the next one, but their master records are installed in the order of their log_sequence_numbers
+// if the block_io_functions provide write_blocks_durable, then there is no fsync, as all the log records and the master record are written with it
 // if the flush was unsuccessfull INVALID_LOG_SEQUENCE_NUMBER will be returned, in such a situation, it is best to exit the program
 uint256 flush_all_log_records(wale* wale_p, int* error);
 
+// makes the log records until the log_sequence_number (that you appended with APPEND_BUFFERED or APPEND_WRITTEN) durable, just like an APPEND_DURABLE append would have
+// it joins the flush in progress (or pending), if that covers the log_sequence_number, else it issues a flush_all_log_records() on its own
+// returns 1, once the log_sequence_number is covered by the on-disk master record
+int make_log_records_durable_until(wale* wale_p, uint256 log_sequence_number, int* error);
+
 // returns the new last_flushed_log_sequence_number, after discarding all the unflushed records
 uint256 discard_unflushed_log_records(wale* wale_p, int* error);
 
 // truncates the log file logically, using only a write to the master record
 // making first_log_sequence_number, last_flushed_log_sequence_number and check_point_log_sequence_number = 0
 // next_log_sequence_number remains as it is, and that will be the next_log_sequence_number that will be alloted
+// the blocks of the discarded log records are then reclaimed using block_io_functions.punch_hole_blocks, if provided
 int truncate_log_records(wale* wale_p, int* error);
 
+// truncates the log file from the front, discarding all the log records before the given log_sequence_number
+// log_sequence_number must be a flushed log record, and it becomes the new first_log_sequence_number, with a write to the master record
+// if the check_point_log_sequence_number is discarded, then it is set to INVALID_LOG_SEQUENCE_NUMBER
+// the surviving log records are neither moved nor rewritten,
+// the blocks that contain only discarded log records are reclaimed using block_io_functions.punch_hole_blocks, if provided
+// failure to reclaim the blocks is not reported as an error, as the log has already been truncated logically
+int truncate_log_records_before(wale* wale_p, uint256 log_sequence_number, int* error);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef WALE_ALLOCATOR_H
+#define WALE_ALLOCATOR_H
+
+#include<stddef.h>
+
+// wale_allocator is the interface that a WALe uses to allocate all of its memory, that is proportional to its usage, i.e.
+//  * the append only buffer
+//  * the pool of block buffers, used for reading the log records and for reading/writing the master record
+//  * the log records returned by get_log_record_at() (and the compressed log records, while appending)
+// plug in your own allocator (e.g. backed by huge pages, or NUMA-local memory) using set_wale_allocator()
+
+typedef struct wale_allocator wale_allocator;
+struct wale_allocator
+{
+	void* allocator_handle;
+
+	// allocate size bytes, aligned to alignment (a power of 2), size is always a non-zero multiple of alignment
+	// returns NULL on failure
+	void* (*allocate)(void* allocator_handle, size_t alignment, size_t size);
+
+	// deallocate the memory at ptr, that was allocated with the same size
+	void (*deallocate)(void* allocator_handle, void* ptr, size_t size);
+};
+
+// allocator over the malloc() (or the aligned_alloc() for the larger alignments) and free(), used by every WALe until set_wale_allocator() is called
+// the memory allocated by it can be released using the free()
+extern const wale_allocator default_wale_allocator;
+
+// defined in wale.h
+typedef struct wale wale;
+
+// sets the allocator of the WALe, a NULL allocator sets the default_wale_allocator
+// the append only buffer and the pooled block buffers are reallocated using the new allocator
+// it must be called before the WALe is used concurrently by other threads, preferably just after the initialize_wale()
+// the log records returned by get_log_record_at() before this call, must still be released using the old allocator
+// returns 0 on an allocation failure (the old allocator then remains in use)
+int set_wale_allocator(wale* wale_p, const wale_allocator* allocator);
+
+#endif
\ No newline at end of file
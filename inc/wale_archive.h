@@ -0,0 +1,163 @@
+#ifndef WALE_ARCHIVE_H
+#define WALE_ARCHIVE_H
+
+#include<wale.h>
+
+// wale_archive is a read-only and compact copy of a range of the flushed log records of a WALe, stored using its own block_io_ops
+// the log records keep their log_sequence_numbers, and are packed into chunks, each of which is compressed (using a log_record_codec) and starts at a block boundary
+// a sparse index, holding the first log_sequence_number of every chunk, is kept in memory, so a lookup reads and decompresses only a single chunk
+// once archived, the range can be truncated from the live WALe using truncate_log_records_before()
+
+/*
+	Block 0 of the archive holds the archive header, in the following format
+	all of the integers are in little endian format
+
+	uint32_t log_sequence_number_width | (archive_version << 16)
+
+	// all the below log_sequence_numbers are log_sequence_number_width bytes wide
+	first_log_sequence_number
+	last_log_sequence_number
+	next_log_sequence_number
+
+	uint64_t chunk_count
+	uint64_t index_block_id
+	uint64_t index_size
+
+	uint32_t crc32					// crc32 of all the above bytes
+
+	The chunks are stored from the block 1 onwards, followed by the index (at index_block_id) that is index_size bytes long
+	The index has an entry for every chunk, followed by the crc32 of all the entries
+
+	struct
+	{
+		first_log_sequence_number	// log_sequence_number_width bytes wide
+		uint64_t block_id
+		uint32_t stored_size
+		uint32_t uncompressed_size
+		uint8_t codec_id
+		uint32_t crc32				// crc32 of the chunk as stored
+	};
+
+	A chunk after decompression, is a series of the log records in the below format
+
+	struct
+	{
+		uint32_t slot_size;			// next_log_sequence_number - log_sequence_number of this log record, in the WALe it was archived from
+		uint32_t log_record_size;
+		uint8_t log_record_type;	// only from the archive_version 1, the log records of the archive_version 0 are read with the log_record_type 0
+		char log_record[log_record_size];
+	};
+*/
+
+typedef struct wale_archive_chunk wale_archive_chunk;
+struct wale_archive_chunk
+{
+	// log_sequence_number of the first log record in the chunk
+	uint256 first_log_sequence_number;
+
+	// the chunk is stored starting at this block
+	uint64_t block_id;
+
+	// size of the chunk as stored, and after decompression
+	uint32_t stored_size;
+	uint32_t uncompressed_size;
+
+	// codec_id of the log_record_codec that compressed this chunk, it is 0, if the chunk is stored uncompressed
+	uint8_t codec_id;
+
+	// crc32 of the chunk, as stored
+	uint32_t crc32;
+};
+
+struct wale_archive
+{
+	// functions to perform block io on the archive
+	block_io_ops block_io_functions;
+
+	// codec to decompress the chunks with
+	log_record_codec log_record_codec;
+
+	uint32_t log_sequence_number_width;
+
+	// version of the format of the archive, as read from its header
+	uint32_t archive_version;
+
+	// log_sequence_number of the first and the last log record in the archive
+	uint256 first_log_sequence_number;
+	uint256 last_log_sequence_number;
+
+	// log_sequence_number right after the last log record, i.e. the first log_sequence_number that is not archived
+	uint256 next_log_sequence_number;
+
+	// the sparse index, ordered by the first_log_sequence_number of the chunks
+	wale_archive_chunk* chunks;
+	uint64_t chunk_count;
+
+	// the last decompressed chunk is cached, so that walking the log records does not decompress a chunk for every log record
+	// cached_chunk_index is chunk_count, if no chunk is cached
+	// protected by the cache_lock
+	pthread_mutex_t cache_lock;
+	uint64_t cached_chunk_index;
+	void* cached_chunk;
+
+	// no log_sequence_number addition must cross this limit
+	uint256 max_limit;
+};
+
+// the chunks are compressed using this chunk size, if a chunk_size of 0 is passed to the archive_log_records_before()
+#define DEFAULT_ARCHIVE_CHUNK_SIZE (UINT32_C(64) * 1024)
+
+// writes all the log records from from_log_sequence_number until (but not including) the log_sequence_number, of the wale_p into a new archive
+// both from_log_sequence_number and log_sequence_number must be flushed log records of the wale_p
+// the log records are read using get_log_record_at(), so the compressed log records of the wale_p require its log_record_codec to be set
+// chunks of (uncompressed) size atleast chunk_size are compressed using the codec, a chunk is stored as is, if the codec is NULL or if it does not shrink
+// the archive is written completely and flushed, before its header is written and flushed, so a partially written archive fails to open
+// returns 1 on success, and 0 on failure with the error set appropriately
+int archive_log_records_before(wale* wale_p, uint256 from_log_sequence_number, uint256 log_sequence_number, block_io_ops archive_block_io_functions, const log_record_codec* codec, uint32_t chunk_size, int* error);
+
+// opens an existing archive, reading its header and the index into memory
+// codec must be the one that the archive was created with, it may be NULL if the archive was created without a codec
+int open_wale_archive(wale_archive* archive_p, block_io_ops block_io_functions, const log_record_codec* codec, int* error);
+
+void close_wale_archive(wale_archive* archive_p);
+
+// -------------------------------------------------------------
+// random reads, they work just like their WALe counterparts, for the log_sequence_numbers in the archive
+// these functions are thread safe, the archive is never modified after it is opened
+
+uint256 get_next_log_sequence_number_of_archive(wale_archive* archive_p, uint256 log_sequence_number, int* error);
+
+uint256 get_prev_log_sequence_number_of_archive(wale_archive* archive_p, uint256 log_sequence_number, int* error);
+
+// you must release the returned memory using release_log_record_archive()
+void* get_log_record_at_archive(wale_archive* archive_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error);
+
+// releases the log_record returned by get_log_record_at_archive() along with its log_record_size
+void release_log_record_archive(wale_archive* archive_p, void* log_record, uint32_t log_record_size);
+
+int get_log_record_type_at_archive(wale_archive* archive_p, uint256 log_sequence_number, uint8_t* log_record_type, int* error);
+
+// the below functions step over the archived log records that are not in the filter, just as their WALe counterparts
+// if there is no such log record in the archive, they return INVALID_LOG_SEQUENCE_NUMBER with no error
+
+uint256 get_first_log_sequence_number_of_type_archive(wale_archive* archive_p, const log_record_type_filter* filter, int* error);
+
+uint256 get_last_log_sequence_number_of_type_archive(wale_archive* archive_p, const log_record_type_filter* filter, int* error);
+
+uint256 get_next_log_sequence_number_of_type_archive(wale_archive* archive_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error);
+
+uint256 get_prev_log_sequence_number_of_type_archive(wale_archive* archive_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error);
+
+// -------------------------------------------------------------
+// attaching the archive to a WALe
+
+// attaches the archive to the wale_p, so that the log_sequence_numbers before its first_log_sequence_number are read from the archive
+// i.e. get_first_log_sequence_number(), get_next_log_sequence_number_of(), get_prev_log_sequence_number_of(), get_log_record_at(), validate_log_record_at(), get_log_record_type_at()
+// and the get_*_log_sequence_number_of_type() functions see the archive followed by the WALe, as one continuous log_sequence_number space
+// stepping from the last archived log record to the first log record of the WALe (or back) fails with LOG_SEQUENCE_NUMBER_GAP, if the two are not contiguous
+// the archive must have the same log_sequence_number_width as the wale_p, and it must not be closed while it is attached
+// a NULL archive_p detaches the currently attached archive
+// it must be called before the WALe is used concurrently by other threads, preferably just after the initialize_wale()
+int attach_wale_archive(wale* wale_p, wale_archive* archive_p, int* error);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef WALE_REPLAY_H
+#define WALE_REPLAY_H
+
+#include<wale.h>
+
+// replay_log_records() applies the flushed log records of a WALe in parallel, for a redo on restart
+// a single reader (the calling thread) scans the log records forward, classifies each of them to a partition key (e.g. a page id) and hands them to the worker threads in batches
+// all the log records of a key go to the same worker, in their log_sequence_number order, so the log records of a key are applied in the order they were appended
+// the log records of different keys are applied concurrently, in no particular order
+
+// a barrier log record is applied by the reader alone, after all the log records before it have been applied, and before any of the log records after it are handed out
+// the log record at the check_point_log_sequence_number of the WALe is always a barrier, and the classify callback may make any other log record a barrier
+
+// returned by the classify callback, for a log record that must be applied as a barrier
+#define WALE_REPLAY_BARRIER_KEY UINT64_MAX
+
+// the log records are handed to the workers in batches of these many, if a batch_size of 0 is passed to the replay_log_records()
+#define DEFAULT_REPLAY_BATCH_SIZE 256
+
+// the queue of every worker holds atmost these many batches of log records, the reader waits for the worker, once its queue is full
+#define REPLAY_QUEUE_BATCHES_PER_WORKER 4
+
+typedef struct wale_replay_callbacks wale_replay_callbacks;
+struct wale_replay_callbacks
+{
+	// passed as is, as the first parameter to all the callbacks
+	void* replay_handle;
+
+	// called by the reader for every log record, in the log_sequence_number order, it returns the partition key of the log record, or WALE_REPLAY_BARRIER_KEY
+	uint64_t (*classify)(void* replay_handle, uint256 log_sequence_number, const void* log_record, uint32_t log_record_size);
+
+	// called concurrently by the workers (worker_id in the range [0, worker_count)), and by the reader for the barriers (with worker_id = worker_count)
+	// it returns 1 on success, on a failure (0) the workers stop applying the log records, and the replay_log_records() fails with LOG_RECORD_APPLY_FAILED
+	int (*apply)(void* replay_handle, uint32_t worker_id, uint256 log_sequence_number, const void* log_record, uint32_t log_record_size);
+};
+
+// replays all the flushed log records from the from_log_sequence_number (e.g. the first_log_sequence_number, the check_point_log_sequence_number or a find_log_sequence_number_at_time()),
+// until the last_flushed_log_sequence_number (as it was when the replay began), using worker_count worker threads
+// the log records are read using get_log_record_at(), so the compressed log records of the wale_p require its log_record_codec to be set
+// returns 1, once all the log records have been applied, and 0 on failure with the error set appropriately
+// on a failure, some of the log records after the failed one (of the other keys) may also have been applied
+int replay_log_records(wale* wale_p, uint256 from_log_sequence_number, uint32_t worker_count, uint32_t batch_size, const wale_replay_callbacks* callbacks, int* error);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef WALE_STATS_H
+#define WALE_STATS_H
+
+#include<wale.h>
+
+// every WALe maintains the below statistics, from its initialization
+// they are accumulated in per-cpu shards using relaxed atomic additions, so that they can be left on in production
+// get_wale_stats() sums up all the shards, into a snapshot that you may then inspect
+
+typedef enum wale_stats_counter wale_stats_counter;
+enum wale_stats_counter
+{
+	WALE_STATS_APPENDS,						// number of successfull append_log_record() calls
+	WALE_STATS_APPENDED_BYTES,				// sum of the log_record_size-s of the above appends, before compression
+	WALE_STATS_SCROLLS,						// number of times the append only buffer was written to the disk
+	WALE_STATS_FLUSHES,						// number of flush_all_log_records() calls
+	WALE_STATS_MASTER_RECORD_WRITES,		// number of times the master record was written and flushed
+	WALE_STATS_READ_IOS,					// number of read_blocks calls on the block_io_functions
+	WALE_STATS_READ_BYTES,
+	WALE_STATS_WRITE_IOS,					// number of write_blocks calls on the block_io_functions
+	WALE_STATS_WRITTEN_BYTES,
+	WALE_STATS_COUNTER_COUNT,
+};
+
+typedef enum wale_stats_latency wale_stats_latency;
+enum wale_stats_latency
+{
+	WALE_STATS_APPEND_LATENCY,				// of the append_log_record() calls
+	WALE_STATS_SCROLL_LATENCY,				// of the writes of the append only buffer
+	WALE_STATS_FLUSH_ALL_WRITES_LATENCY,	// of the flush_all_writes calls on the block_io_functions
+	WALE_STATS_MASTER_RECORD_WRITE_LATENCY,	// of the write_and_flush_master_record() calls
+	WALE_STATS_LATENCY_COUNT,
+};
+
+typedef enum wale_stats_lock wale_stats_lock;
+enum wale_stats_lock
+{
+	WALE_STATS_GLOBAL_LOCK,					// the global mutex lock, internal or external
+	WALE_STATS_APPEND_ONLY_BUFFER_LOCK,
+	WALE_STATS_FLUSHED_LOG_RECORDS_LOCK,
+	WALE_STATS_WAIT_FOR_SCROLL,				// waits in the queue of the appenders waiting for a scroll (the spins before it are not counted)
+	WALE_STATS_LOCK_COUNT,
+};
+
+// the latency histograms are log-linear, every power of 2 range of nanoseconds is divided into 2^WALE_STATS_SUB_BUCKET_BITS buckets
+// i.e. the bucket boundaries are within 25% of the recorded values
+#define WALE_STATS_SUB_BUCKET_BITS 2
+#define WALE_STATS_BUCKET_COUNT (64 << WALE_STATS_SUB_BUCKET_BITS)
+
+typedef struct wale_stats_histogram wale_stats_histogram;
+struct wale_stats_histogram
+{
+	uint64_t count;
+	uint64_t sum_ns;
+	uint64_t max_ns;
+
+	// buckets[i] is the number of values recorded in the range [get_wale_stats_bucket_lower_bound(i), get_wale_stats_bucket_lower_bound(i + 1))
+	uint64_t buckets[WALE_STATS_BUCKET_COUNT];
+};
+
+typedef struct wale_stats wale_stats;
+struct wale_stats
+{
+	uint64_t counters[WALE_STATS_COUNTER_COUNT];
+
+	wale_stats_histogram latencies[WALE_STATS_LATENCY_COUNT];
+
+	// the uncontended lock acquisitions are neither timed nor counted
+	// lock_waits[i] is the number of lock acquisitions that had to wait, and they cumulatively waited for lock_wait_ns[i] nanoseconds
+	uint64_t lock_waits[WALE_STATS_LOCK_COUNT];
+	uint64_t lock_wait_ns[WALE_STATS_LOCK_COUNT];
+};
+
+// takes a snapshot of the statistics of the wale_p, the shards are read without any locks, so the snapshot is not an atomic one
+void get_wale_stats(wale* wale_p, wale_stats* stats);
+
+// the smallest value (in nanoseconds), that falls in the bucket at bucket_index
+uint64_t get_wale_stats_bucket_lower_bound(uint32_t bucket_index);
+
+// returns the lower bound of the bucket, that holds the value at the given percentile (in range [0.0, 100.0]) of the histogram
+uint64_t get_wale_stats_percentile(const wale_stats_histogram* histogram, double percentile);
+
+#endif
\ No newline at end of file
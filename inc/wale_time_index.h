@@ -0,0 +1,101 @@
+#ifndef WALE_TIME_INDEX_H
+#define WALE_TIME_INDEX_H
+
+#include<wale.h>
+
+// wale_time_index is a compact persistent index from the wall clock time to the log_sequence_numbers of a WALe, stored using its own block_io_ops (a sidecar file)
+// once attached to a WALe, every successful flush_all_log_records() records an entry (time, next_log_sequence_number) in it, atmost one entry every min_interval_in_microseconds
+// an entry (time, next_log_sequence_number) says that all the log records before the next_log_sequence_number were flushed (and so appended) before the time
+// so find_log_sequence_number_at_time() answers a point-in-time recovery seek, with a binary search over the blocks of the index, followed by a short scan of the WALe
+
+// all the times are in microseconds since the Unix epoch (CLOCK_REALTIME), the recorded times never decrease even if the wall clock goes back
+
+/*
+	Block 0 of the time index holds its header, in the following format
+	all of the integers are in little endian format
+
+	uint32_t log_sequence_number_width | (time_index_version << 16)
+	uint64_t tail_block_id			// the block being appended to, this is only a hint, it is updated every time a new block is begun
+	uint32_t crc32					// crc32 of all the above bytes
+
+	The entries are stored from the block 1 onwards, every block in the below format
+	the entries of the blocks never decrease in their time, and always increase in their next_log_sequence_number
+
+	uint32_t entry_count
+	uint32_t crc32					// crc32 of the entry_count and the entries
+	struct
+	{
+		uint64_t time;
+		next_log_sequence_number	// log_sequence_number_width bytes wide
+	} entries[entry_count];
+
+	Only the tail block is ever rewritten, so the sidecar does not need to be flushed along with the WALe
+	the entries lost in a crash only make the find_log_sequence_number_at_time() return an earlier log_sequence_number, it is never wrong
+*/
+
+typedef struct wale_time_index wale_time_index;
+struct wale_time_index
+{
+	// functions to perform block io on the time index
+	block_io_ops block_io_functions;
+
+	uint32_t log_sequence_number_width;
+
+	// an entry is recorded, only if atleast these many microseconds have passed since the last entry
+	uint64_t min_interval_in_microseconds;
+
+	// the below attributes are protected by the tail_lock, the blocks before the tail_block_id are never modified, so they are read without it
+	pthread_mutex_t tail_lock;
+
+	// the block being appended to, and its contents (as on disk) in memory
+	uint64_t tail_block_id;
+	void* tail_block;
+	uint32_t tail_entry_count;
+
+	// set, once the tail_block in memory has been written to the disk
+	int is_tail_block_written;
+
+	// the last entry recorded, the next entry must not be before it
+	uint64_t last_time;
+	uint256 last_next_log_sequence_number;
+};
+
+// an entry is recorded atmost every second, if a min_interval_in_microseconds of 0 is passed to the open_wale_time_index()
+#define DEFAULT_TIME_INDEX_MIN_INTERVAL (UINT64_C(1000) * 1000)
+
+// opens the time index on the block_io_functions, a time index is created, if the block 0 of the block_io_functions is all zeros (e.g. an empty file)
+// the log_sequence_number_width must be the one of the WALe that the time index will be attached to
+// it fails with TIME_INDEX_CORRUPTED, if the header in the block 0 is corrupted
+// returns 1 on success, and 0 on failure with the error set appropriately
+int open_wale_time_index(wale_time_index* time_index_p, block_io_ops block_io_functions, uint32_t log_sequence_number_width, uint64_t min_interval_in_microseconds, int* error);
+
+// flushes the time index and releases its resources, it must not be attached to any WALe
+void close_wale_time_index(wale_time_index* time_index_p);
+
+// records that all the log records before the next_log_sequence_number were flushed before the time
+// the attached WALe calls this on every flush, you may call it yourself for a detached time index, e.g. to build one for an existing WALe
+// an entry that is too close to the last one (as per the min_interval_in_microseconds), or whose next_log_sequence_number does not increase, is not recorded, and it still succeeds
+// returns 1 on success, and 0 on failure with the error set appropriately, this function is thread safe
+int record_in_wale_time_index(wale_time_index* time_index_p, uint64_t time, uint256 next_log_sequence_number, int* error);
+
+// returns the current time in microseconds since the Unix epoch, as recorded by the attached WALe-s
+uint64_t get_wale_time_index_now();
+
+// -------------------------------------------------------------
+// attaching the time index to a WALe
+
+// attaches the time index to the wale_p, so that its flushes are recorded in it
+// the time index must have the same log_sequence_number_width as the wale_p, and it must not be closed while it is attached
+// a NULL time_index_p detaches the currently attached time index
+// it must be called before the WALe is used concurrently by other threads, preferably just after the initialize_wale()
+int attach_wale_time_index(wale* wale_p, wale_time_index* time_index_p, int* error);
+
+// returns the log_sequence_number to begin the scan from, to find all the log records appended at or after the time
+// i.e. every flushed log record appended at or after the time, is at or after the returned log_sequence_number
+// it performs a binary search over the blocks of the attached time index, reading O(log n) blocks
+// it returns the first_log_sequence_number, if no entry is before the time or if no time index is attached, then the scan must begin from the start
+// it returns INVALID_LOG_SEQUENCE_NUMBER with NO_ERROR, if no flushed log record was appended at or after the time
+// it fails with TIME_INDEX_CORRUPTED, if a block of entries that the binary search lands on could not be read or is corrupted, you may then scan from the first_log_sequence_number instead
+uint256 find_log_sequence_number_at_time(wale* wale_p, uint64_t time, int* error);
+
+#endif
\ No newline at end of file
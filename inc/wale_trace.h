@@ -0,0 +1,61 @@
+#ifndef WALE_TRACE_H
+#define WALE_TRACE_H
+
+#include<wale.h>
+
+// a WALe fires the below trace events at its key transitions, so that its stalls can be correlated with the latencies of your requests
+// every event is a USDT probe (provider "wale"), and a call to the corresponding function of the wale_trace_callbacks registered with the WALe (if any)
+
+// the USDT probes are compiled in, only if <sys/sdt.h> (from systemtap) is available while building this library, define WALE_NO_USDT_PROBES to leave them out
+// a USDT probe is just a nop instruction, until a tracer (bpftrace, perf or systemtap) attaches to it, e.g.
+// bpftrace -e 'usdt:/path/to/your/binary:wale:scroll_begin { @s[tid] = nsecs; } usdt:/path/to/your/binary:wale:scroll_end { @ns = hist(nsecs - @s[tid]); }'
+// every probe has a semaphore, that the tracer increments while attached, and until then (with no callback registered for it) the WALe does not even compute the arguments of the event
+
+/*
+	event						USDT probe arguments
+
+	append_slot_reserved		wale_p, log_sequence_number, log_record_size (as stored), append_slot (the offset in the append only buffer)
+	scroll_begin				wale_p, buffer_start_block_id, block_count
+	scroll_end					wale_p, buffer_start_block_id, block_count, success
+	wait_for_scroll_begin		wale_p
+	wait_for_scroll_end			wale_p
+	flush_begin					wale_p
+	flush_end					wale_p, last_flushed_log_sequence_number, success
+	master_record_written		wale_p, last_flushed_log_sequence_number, success
+	read_io						wale_p, block_id, block_count
+
+	the USDT probes receive the log_sequence_numbers as uint64_t, saturated at UINT64_MAX
+	the callbacks receive them as is
+*/
+
+// all the callbacks are called in the thread that fired the event, often while it holds the locks of the wale_p
+// so they must be quick, and they must not call any of the functions of the wale_p
+// any of the function pointers may be NULL, to not receive that event
+typedef struct wale_trace_callbacks wale_trace_callbacks;
+struct wale_trace_callbacks
+{
+	// passed as is, as the first parameter to all the callbacks
+	void* trace_handle;
+
+	void (*append_slot_reserved)(void* trace_handle, const wale* wale_p, uint256 log_sequence_number, uint32_t log_record_size, uint64_t append_slot);
+
+	void (*scroll_begin)(void* trace_handle, const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count);
+	void (*scroll_end)(void* trace_handle, const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count, int success);
+
+	void (*wait_for_scroll_begin)(void* trace_handle, const wale* wale_p);
+	void (*wait_for_scroll_end)(void* trace_handle, const wale* wale_p);
+
+	void (*flush_begin)(void* trace_handle, const wale* wale_p);
+	void (*flush_end)(void* trace_handle, const wale* wale_p, uint256 last_flushed_log_sequence_number, int success);
+
+	void (*master_record_written)(void* trace_handle, const wale* wale_p, uint256 last_flushed_log_sequence_number, int success);
+
+	void (*read_io)(void* trace_handle, const wale* wale_p, uint64_t block_id, uint64_t block_count);
+};
+
+// registers the callbacks with the wale_p, a NULL callbacks unregisters the current ones
+// the callbacks are not copied, they must stay valid (and unmodified) until they are unregistered
+// it must be called before the WALe is used concurrently by other threads, preferably just after the initialize_wale()
+void set_wale_trace_callbacks(wale* wale_p, const wale_trace_callbacks* callbacks);
+
+#endif
\ No newline at end of file
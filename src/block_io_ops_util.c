@@ -5,16 +5,32 @@
 
 #include<wale.h> // only to include errors
 
+// the block_size is almost always a power of two (e.g. 512 or 4096), then the block math is a shift and a mask instead of a division
+// the check is a single mask test on the block_size, that is never changed after the initialization, so it is always predicted
+static int is_block_size_power_of_two(const block_io_ops* block_io_functions)
+{
+	return (block_io_functions->block_size & (block_io_functions->block_size - 1)) == 0;
+}
+
 uint64_t get_block_id_from_file_offset(uint64_t file_offset, const block_io_ops* block_io_functions)
 {
-	return UINT_ALIGN_DOWN(file_offset, block_io_functions->block_size) / block_io_functions->block_size;
+	if(is_block_size_power_of_two(block_io_functions))
+		return file_offset >> __builtin_ctzll(block_io_functions->block_size);
+	return file_offset / block_io_functions->block_size;
 }
 
 uint64_t get_block_offset_from_file_offset(uint64_t file_offset, const block_io_ops* block_io_functions)
 {
+	if(is_block_size_power_of_two(block_io_functions))
+		return file_offset & (block_io_functions->block_size - 1);
 	return file_offset % block_io_functions->block_size;
 }
 
+uint64_t get_block_count_for_size(uint64_t size, const block_io_ops* block_io_functions)
+{
+	return get_block_id_from_file_offset(size, block_io_functions) + (get_block_offset_from_file_offset(size, block_io_functions) != 0);
+}
+
 uint64_t get_file_offset_from_block_id_and_block_offset(uint64_t block_id, uint64_t block_offset, const block_io_ops* block_io_functions, int* error)
 {
 	if(will_unsigned_mul_overflow(uint64_t, block_id, block_io_functions->block_size) ||
@@ -25,4 +41,34 @@ uint64_t get_file_offset_from_block_id_and_block_offset(uint64_t block_id, uint6
 	}
 
 	return (block_id * block_io_functions->block_size) + block_offset;
+}
+
+int read_block_vectors(const block_io_ops* block_io_functions, const block_io_vector* vectors, uint64_t vector_count)
+{
+	if(vector_count == 0)
+		return 1;
+
+	if(block_io_functions->read_blocks_v != NULL)
+		return block_io_functions->read_blocks_v(block_io_functions->block_io_ops_handle, vectors, vector_count);
+
+	for(uint64_t i = 0; i < vector_count; i++)
+		if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, vectors[i].buffer, vectors[i].block_id, vectors[i].block_count))
+			return 0;
+
+	return 1;
+}
+
+int write_block_vectors(const block_io_ops* block_io_functions, const block_io_vector* vectors, uint64_t vector_count)
+{
+	if(vector_count == 0)
+		return 1;
+
+	if(block_io_functions->write_blocks_v != NULL)
+		return block_io_functions->write_blocks_v(block_io_functions->block_io_ops_handle, vectors, vector_count);
+
+	for(uint64_t i = 0; i < vector_count; i++)
+		if(!block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, vectors[i].buffer, vectors[i].block_id, vectors[i].block_count))
+			return 0;
+
+	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include<deflate_log_record_codec.h>
+
+#include<zlib.h>
+
+static uint32_t compress_using_deflate(const void* codec_handle, void* dest, uint32_t dest_size, const void* src, uint32_t src_size)
+{
+	uLongf compressed_size = dest_size;
+	if(compress2(dest, &compressed_size, src, src_size, Z_BEST_SPEED) != Z_OK)
+		return 0;
+	return compressed_size;
+}
+
+static int decompress_using_inflate(const void* codec_handle, void* dest, uint32_t dest_size, const void* src, uint32_t src_size)
+{
+	uLongf decompressed_size = dest_size;
+	if(uncompress(dest, &decompressed_size, src, src_size) != Z_OK)
+		return 0;
+	return decompressed_size == dest_size;
+}
+
+log_record_codec get_deflate_log_record_codec()
+{
+	return (log_record_codec){
+		.codec_handle = NULL,
+		.codec_id = DEFLATE_LOG_RECORD_CODEC_ID,
+		.compress = compress_using_deflate,
+		.decompress = decompress_using_inflate,
+	};
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#define _GNU_SOURCE
+
+#include<file_block_io_ops.h>
+
+#include<fcntl.h>
+#include<sys/stat.h>
+#include<sys/uio.h>
+#include<unistd.h>
+#include<errno.h>
+
+int open_file_block_io(file_block_io* fbio_p, const char* file_path, int create, uint64_t block_size, int additional_flags)
+{
+	if(block_size == 0)
+		return 0;
+
+	fbio_p->block_size = block_size;
+	fbio_p->file_descriptor = open(file_path, O_RDWR | (create ? (O_CREAT | O_EXCL) : 0) | additional_flags, S_IRUSR | S_IWUSR);
+
+	return fbio_p->file_descriptor >= 0;
+}
+
+int close_file_block_io(file_block_io* fbio_p)
+{
+	return close(fbio_p->file_descriptor) == 0;
+}
+
+static int read_blocks_from_file(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+
+	uint64_t bytes_to_read = block_count * fbio_p->block_size;
+	uint64_t file_offset = block_id * fbio_p->block_size;
+
+	uint64_t bytes_read = 0;
+	while(bytes_read < bytes_to_read)
+	{
+		ssize_t res = pread(fbio_p->file_descriptor, dest + bytes_read, bytes_to_read - bytes_read, file_offset + bytes_read);
+		if(res == -1 && errno == EINTR)
+			continue;
+		if(res == -1)
+			return 0;
+
+		// reading past the end of the file, the rest of the blocks have never been written, so we read them as zeros
+		if(res == 0)
+		{
+			for(; bytes_read < bytes_to_read; bytes_read++)
+				((char*)dest)[bytes_read] = 0;
+			break;
+		}
+
+		bytes_read += res;
+	}
+
+	return 1;
+}
+
+static int write_blocks_to_file(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+
+	uint64_t bytes_to_write = block_count * fbio_p->block_size;
+	uint64_t file_offset = block_id * fbio_p->block_size;
+
+	uint64_t bytes_written = 0;
+	while(bytes_written < bytes_to_write)
+	{
+		ssize_t res = pwrite(fbio_p->file_descriptor, src + bytes_written, bytes_to_write - bytes_written, file_offset + bytes_written);
+		if(res == -1 && errno == EINTR)
+			continue;
+		if(res == -1)
+			return 0;
+		bytes_written += res;
+	}
+
+	return 1;
+}
+
+// the vectors that are contiguous on disk are read/written with a single preadv/pwritev, of upto FILE_BLOCK_IO_MAX_IOVECS iovecs
+#define FILE_BLOCK_IO_MAX_IOVECS 64
+
+// fills the iovecs for the longest prefix of the vectors that is contiguous on disk, returns the number of iovecs filled
+static int fill_iovecs_for_contiguous_vectors(const file_block_io* fbio_p, struct iovec* iovecs, const block_io_vector* vectors, uint64_t vector_count, uint64_t* bytes_to_transfer)
+{
+	int iovec_count = 0;
+	(*bytes_to_transfer) = 0;
+	while(iovec_count < FILE_BLOCK_IO_MAX_IOVECS && iovec_count < vector_count)
+	{
+		if(iovec_count > 0 && vectors[iovec_count].block_id != vectors[iovec_count - 1].block_id + vectors[iovec_count - 1].block_count)
+			break;
+		iovecs[iovec_count].iov_base = vectors[iovec_count].buffer;
+		iovecs[iovec_count].iov_len = vectors[iovec_count].block_count * fbio_p->block_size;
+		(*bytes_to_transfer) += iovecs[iovec_count].iov_len;
+		iovec_count++;
+	}
+	return iovec_count;
+}
+
+// skips the first bytes of the iovecs, that were transferred by a short preadv/pwritev
+static void consume_iovecs(struct iovec* iovecs, int iovec_count, int* iovec_index, uint64_t bytes)
+{
+	while(bytes > 0 && (*iovec_index) < iovec_count)
+	{
+		uint64_t bytes_consumed = (bytes < iovecs[(*iovec_index)].iov_len) ? bytes : iovecs[(*iovec_index)].iov_len;
+		iovecs[(*iovec_index)].iov_base += bytes_consumed;
+		iovecs[(*iovec_index)].iov_len -= bytes_consumed;
+		bytes -= bytes_consumed;
+		if(iovecs[(*iovec_index)].iov_len == 0)
+			(*iovec_index)++;
+	}
+}
+
+static int read_blocks_v_from_file(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+
+	while(vector_count > 0)
+	{
+		struct iovec iovecs[FILE_BLOCK_IO_MAX_IOVECS];
+		uint64_t bytes_to_read;
+		int iovec_count = fill_iovecs_for_contiguous_vectors(fbio_p, iovecs, vectors, vector_count, &bytes_to_read);
+		uint64_t file_offset = vectors[0].block_id * fbio_p->block_size;
+
+		int iovec_index = 0;
+		uint64_t bytes_read = 0;
+		while(bytes_read < bytes_to_read)
+		{
+			ssize_t res = preadv(fbio_p->file_descriptor, iovecs + iovec_index, iovec_count - iovec_index, file_offset + bytes_read);
+			if(res == -1 && errno == EINTR)
+				continue;
+			if(res == -1)
+				return 0;
+
+			// reading past the end of the file, the rest of the blocks have never been written, so we read them as zeros
+			if(res == 0)
+			{
+				for(; iovec_index < iovec_count; iovec_index++)
+					for(uint64_t i = 0; i < iovecs[iovec_index].iov_len; i++)
+						((char*)(iovecs[iovec_index].iov_base))[i] = 0;
+				break;
+			}
+
+			bytes_read += res;
+			consume_iovecs(iovecs, iovec_count, &iovec_index, res);
+		}
+
+		vectors += iovec_count;
+		vector_count -= iovec_count;
+	}
+
+	return 1;
+}
+
+static int write_blocks_v_to_file(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+
+	while(vector_count > 0)
+	{
+		struct iovec iovecs[FILE_BLOCK_IO_MAX_IOVECS];
+		uint64_t bytes_to_write;
+		int iovec_count = fill_iovecs_for_contiguous_vectors(fbio_p, iovecs, vectors, vector_count, &bytes_to_write);
+		uint64_t file_offset = vectors[0].block_id * fbio_p->block_size;
+
+		int iovec_index = 0;
+		uint64_t bytes_written = 0;
+		while(bytes_written < bytes_to_write)
+		{
+			ssize_t res = pwritev(fbio_p->file_descriptor, iovecs + iovec_index, iovec_count - iovec_index, file_offset + bytes_written);
+			if(res == -1 && errno == EINTR)
+				continue;
+			if(res == -1)
+				return 0;
+
+			bytes_written += res;
+			consume_iovecs(iovecs, iovec_count, &iovec_index, res);
+		}
+
+		vectors += iovec_count;
+		vector_count -= iovec_count;
+	}
+
+	return 1;
+}
+
+static int flush_all_writes_to_file(const void* block_io_ops_handle)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+	return fdatasync(fbio_p->file_descriptor) == 0;
+}
+
+static int write_blocks_durable_to_file(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+#ifdef RWF_DSYNC
+	const file_block_io* fbio_p = block_io_ops_handle;
+
+	uint64_t bytes_to_write = block_count * fbio_p->block_size;
+	uint64_t file_offset = block_id * fbio_p->block_size;
+
+	uint64_t bytes_written = 0;
+	while(bytes_written < bytes_to_write)
+	{
+		struct iovec iov = {.iov_base = (void*)(src + bytes_written), .iov_len = bytes_to_write - bytes_written};
+		ssize_t res = pwritev2(fbio_p->file_descriptor, &iov, 1, file_offset + bytes_written, RWF_DSYNC);
+		if(res == -1 && errno == EINTR)
+			continue;
+
+		// the kernel does not support RWF_DSYNC, nothing has been written by this call
+		if(res == -1 && (errno == EOPNOTSUPP || errno == ENOSYS))
+			break;
+
+		if(res == -1)
+			return 0;
+		bytes_written += res;
+	}
+
+	if(bytes_written == bytes_to_write)
+		return 1;
+
+	// fallback for the rest of the blocks
+	uint64_t blocks_written = bytes_written / fbio_p->block_size;
+	return write_blocks_to_file(block_io_ops_handle, src + blocks_written * fbio_p->block_size, block_id + blocks_written, block_count - blocks_written)
+		&& flush_all_writes_to_file(block_io_ops_handle);
+#else
+	return write_blocks_to_file(block_io_ops_handle, src, block_id, block_count)
+		&& flush_all_writes_to_file(block_io_ops_handle);
+#endif
+}
+
+static int punch_hole_blocks_in_file(const void* block_io_ops_handle, uint64_t block_id, uint64_t block_count)
+{
+	const file_block_io* fbio_p = block_io_ops_handle;
+	return fallocate(fbio_p->file_descriptor, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, block_id * fbio_p->block_size, block_count * fbio_p->block_size) == 0;
+}
+
+block_io_ops get_block_io_ops_for_file_block_io(const file_block_io* fbio_p)
+{
+	return (block_io_ops){
+		.block_io_ops_handle = fbio_p,
+		.block_size = fbio_p->block_size,
+		.block_buffer_alignment = fbio_p->block_size,
+		.read_blocks = read_blocks_from_file,
+		.write_blocks = write_blocks_to_file,
+		.flush_all_writes = flush_all_writes_to_file,
+		.punch_hole_blocks = punch_hole_blocks_in_file,
+		.read_blocks_v = read_blocks_v_from_file,
+		.write_blocks_v = write_blocks_v_to_file,
+	};
+}
+
+block_io_ops get_durable_write_block_io_ops_for_file_block_io(const file_block_io* fbio_p)
+{
+	block_io_ops block_io_functions = get_block_io_ops_for_file_block_io(fbio_p);
+	block_io_functions.write_blocks_durable = write_blocks_durable_to_file;
+	return block_io_functions;
+}
\ No newline at end of file
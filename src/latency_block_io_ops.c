@@ -0,0 +1,177 @@
+#include<latency_block_io_ops.h>
+
+#include<block_io_ops_util.h>
+
+#include<time.h>
+#include<errno.h>
+
+void open_latency_block_io(latency_block_io* lbio_p, block_io_ops underlying_block_io_functions, const latency_block_io_config* config)
+{
+	lbio_p->underlying_block_io_functions = underlying_block_io_functions;
+	lbio_p->config = (*config);
+	pthread_mutex_init(&(lbio_p->lock), NULL);
+	lbio_p->random_state = config->seed;
+	lbio_p->read_busy_until = 0;
+	lbio_p->write_busy_until = 0;
+}
+
+void close_latency_block_io(latency_block_io* lbio_p)
+{
+	pthread_mutex_destroy(&(lbio_p->lock));
+}
+
+static uint64_t get_time_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec) * UINT64_C(1000000000) + ((uint64_t)now.tv_nsec);
+}
+
+static void sleep_until(uint64_t time_ns)
+{
+	struct timespec until = {.tv_sec = time_ns / UINT64_C(1000000000), .tv_nsec = time_ns % UINT64_C(1000000000)};
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR);
+}
+
+// must be called with the lock held
+static uint64_t next_random(latency_block_io* lbio_p)
+{
+	// splitmix64
+	uint64_t z = (lbio_p->random_state += UINT64_C(0x9E3779B97F4A7C15));
+	z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+	return z ^ (z >> 31);
+}
+
+// must be called with the lock held
+static uint64_t draw_latency(latency_block_io* lbio_p, const latency_distribution* distribution)
+{
+	uint64_t latency = distribution->base_ns;
+
+	if(distribution->jitter_ns > 0)
+	{
+		uint64_t offset = next_random(lbio_p) % (2 * distribution->jitter_ns + 1);
+		latency = (latency + offset < distribution->jitter_ns) ? 0 : (latency + offset - distribution->jitter_ns);
+	}
+
+	if(distribution->tail_per_million > 0 && (next_random(lbio_p) % 1000000) < distribution->tail_per_million)
+		latency += distribution->tail_ns;
+
+	return latency;
+}
+
+// delays the calling thread for a latency drawn from the distribution, and for the transfer of byte_count bytes at bytes_per_second, after all the earlier transfers
+// busy_until is the read_busy_until or the write_busy_until, it is NULL for the ios that transfer nothing
+static void delay(const void* block_io_ops_handle, const latency_distribution* distribution, uint64_t* busy_until, uint64_t bytes_per_second, uint64_t byte_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+
+	uint64_t now = get_time_ns();
+
+	pthread_mutex_lock(&(lbio_p->lock));
+
+	uint64_t done_at = now + draw_latency(lbio_p, distribution);
+
+	if(busy_until != NULL && bytes_per_second > 0)
+	{
+		uint64_t transfer_ns = (uint64_t)((((double)byte_count) * 1e9) / bytes_per_second);
+		uint64_t transfer_start = ((*busy_until) > now) ? (*busy_until) : now;
+		(*busy_until) = transfer_start + transfer_ns;
+		if((*busy_until) > done_at)
+			done_at = (*busy_until);
+	}
+
+	pthread_mutex_unlock(&(lbio_p->lock));
+
+	if(done_at > now)
+		sleep_until(done_at);
+}
+
+static int read_blocks_with_latency(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.read_latency), &(lbio_p->read_busy_until), lbio_p->config.read_bytes_per_second, block_count * underlying->block_size);
+	return underlying->read_blocks(underlying->block_io_ops_handle, dest, block_id, block_count);
+}
+
+static int write_blocks_with_latency(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.write_latency), &(lbio_p->write_busy_until), lbio_p->config.write_bytes_per_second, block_count * underlying->block_size);
+	return underlying->write_blocks(underlying->block_io_ops_handle, src, block_id, block_count);
+}
+
+static uint64_t get_total_block_count(const block_io_vector* vectors, uint64_t vector_count)
+{
+	uint64_t total_block_count = 0;
+	for(uint64_t i = 0; i < vector_count; i++)
+		total_block_count += vectors[i].block_count;
+	return total_block_count;
+}
+
+// a vectored io is delayed once, as a single io transferring all of its blocks
+static int read_blocks_v_with_latency(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.read_latency), &(lbio_p->read_busy_until), lbio_p->config.read_bytes_per_second, get_total_block_count(vectors, vector_count) * underlying->block_size);
+	return read_block_vectors(underlying, vectors, vector_count);
+}
+
+static int write_blocks_v_with_latency(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.write_latency), &(lbio_p->write_busy_until), lbio_p->config.write_bytes_per_second, get_total_block_count(vectors, vector_count) * underlying->block_size);
+	return write_block_vectors(underlying, vectors, vector_count);
+}
+
+static int flush_all_writes_with_latency(const void* block_io_ops_handle)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.flush_latency), NULL, 0, 0);
+	return underlying->flush_all_writes(underlying->block_io_ops_handle);
+}
+
+// a durable write is delayed as a write followed by a flush, as on a device without FUA
+static int write_blocks_durable_with_latency(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	latency_block_io* lbio_p = (latency_block_io*) block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	delay(lbio_p, &(lbio_p->config.write_latency), &(lbio_p->write_busy_until), lbio_p->config.write_bytes_per_second, block_count * underlying->block_size);
+	delay(lbio_p, &(lbio_p->config.flush_latency), NULL, 0, 0);
+	return underlying->write_blocks_durable(underlying->block_io_ops_handle, src, block_id, block_count);
+}
+
+static int punch_hole_blocks_with_latency(const void* block_io_ops_handle, uint64_t block_id, uint64_t block_count)
+{
+	const latency_block_io* lbio_p = block_io_ops_handle;
+	const block_io_ops* underlying = &(lbio_p->underlying_block_io_functions);
+
+	return underlying->punch_hole_blocks(underlying->block_io_ops_handle, block_id, block_count);
+}
+
+block_io_ops get_block_io_ops_for_latency_block_io(const latency_block_io* lbio_p)
+{
+	return (block_io_ops){
+		.block_io_ops_handle = lbio_p,
+		.block_size = lbio_p->underlying_block_io_functions.block_size,
+		.block_buffer_alignment = lbio_p->underlying_block_io_functions.block_buffer_alignment,
+		.read_blocks = read_blocks_with_latency,
+		.write_blocks = write_blocks_with_latency,
+		.flush_all_writes = flush_all_writes_with_latency,
+		.punch_hole_blocks = (lbio_p->underlying_block_io_functions.punch_hole_blocks == NULL) ? NULL : punch_hole_blocks_with_latency,
+		.read_blocks_v = read_blocks_v_with_latency,
+		.write_blocks_v = write_blocks_v_with_latency,
+		.write_blocks_durable = (lbio_p->underlying_block_io_functions.write_blocks_durable == NULL) ? NULL : write_blocks_durable_with_latency,
+	};
+}
\ No newline at end of file
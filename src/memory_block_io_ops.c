@@ -0,0 +1,97 @@
+#define _GNU_SOURCE
+
+#include<memory_block_io_ops.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<sys/mman.h>
+#include<unistd.h>
+
+int open_memory_block_io(memory_block_io* mbio_p, uint64_t block_size, uint64_t max_block_count)
+{
+	if(block_size == 0 || max_block_count == 0 || will_unsigned_mul_overflow(uint64_t, block_size, max_block_count))
+		return 0;
+
+	mbio_p->block_size = block_size;
+	mbio_p->max_block_count = max_block_count;
+	mbio_p->memory = mmap(NULL, block_size * max_block_count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	return mbio_p->memory != MAP_FAILED;
+}
+
+int close_memory_block_io(memory_block_io* mbio_p)
+{
+	return munmap(mbio_p->memory, mbio_p->block_size * mbio_p->max_block_count) == 0;
+}
+
+static int is_within_memory_block_io(const memory_block_io* mbio_p, uint64_t block_id, uint64_t block_count)
+{
+	return block_id < mbio_p->max_block_count && block_count <= mbio_p->max_block_count - block_id;
+}
+
+static int read_blocks_from_memory(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	const memory_block_io* mbio_p = block_io_ops_handle;
+
+	if(!is_within_memory_block_io(mbio_p, block_id, block_count))
+		return 0;
+
+	memory_move(dest, mbio_p->memory + block_id * mbio_p->block_size, block_count * mbio_p->block_size);
+	return 1;
+}
+
+static int write_blocks_to_memory(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	const memory_block_io* mbio_p = block_io_ops_handle;
+
+	if(!is_within_memory_block_io(mbio_p, block_id, block_count))
+		return 0;
+
+	memory_move(mbio_p->memory + block_id * mbio_p->block_size, src, block_count * mbio_p->block_size);
+	return 1;
+}
+
+static int flush_all_writes_to_memory(const void* block_io_ops_handle)
+{
+	return 1;
+}
+
+static int punch_hole_blocks_in_memory(const void* block_io_ops_handle, uint64_t block_id, uint64_t block_count)
+{
+	const memory_block_io* mbio_p = block_io_ops_handle;
+
+	if(!is_within_memory_block_io(mbio_p, block_id, block_count))
+		return 0;
+
+	uint64_t start = block_id * mbio_p->block_size;
+	uint64_t end = start + block_count * mbio_p->block_size;
+
+	// the whole pages in the range are returned to the system using madvise, they read as zeros after this
+	// and the partial pages at the ends of the range are zeroed
+	uint64_t page_size = sysconf(_SC_PAGESIZE);
+	uint64_t page_start = UINT_ALIGN_UP(start, page_size);
+	uint64_t page_end = UINT_ALIGN_DOWN(end, page_size);
+	if(page_start >= page_end)
+	{
+		memory_set(mbio_p->memory + start, 0, end - start);
+		return 1;
+	}
+
+	memory_set(mbio_p->memory + start, 0, page_start - start);
+	memory_set(mbio_p->memory + page_end, 0, end - page_end);
+	return madvise(mbio_p->memory + page_start, page_end - page_start, MADV_DONTNEED) == 0;
+}
+
+block_io_ops get_block_io_ops_for_memory_block_io(const memory_block_io* mbio_p)
+{
+	return (block_io_ops){
+		.block_io_ops_handle = mbio_p,
+		.block_size = mbio_p->block_size,
+		.block_buffer_alignment = 1,
+		.read_blocks = read_blocks_from_memory,
+		.write_blocks = write_blocks_to_memory,
+		.flush_all_writes = flush_all_writes_to_memory,
+		.punch_hole_blocks = punch_hole_blocks_in_memory,
+	};
+}
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include<partitioned_wale.h>
+
+#include<serial_int.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<stdlib.h>
+
+// reads the global_sequence_number of the log record at log_sequence_number in the partition
+// on success, the log record is returned along with its global_sequence_number, you must release it
+static void* get_stamped_log_record_at(wale_partition* partition, uint256 log_sequence_number, uint32_t* log_record_size, uint64_t* global_sequence_number, int* error)
+{
+	void* log_record = get_log_record_at(&(partition->partition_wale), log_sequence_number, log_record_size, error);
+	if(log_record == NULL)
+		return NULL;
+
+	// every log record of a partition starts with its global_sequence_number
+	if((*log_record_size) < GLOBAL_SEQUENCE_NUMBER_SIZE)
+	{
+		release_log_record(&(partition->partition_wale), log_record, (*log_record_size));
+		(*error) = LOG_RECORD_CORRUPTED;
+		return NULL;
+	}
+
+	(*global_sequence_number) = deserialize_uint64(log_record, GLOBAL_SEQUENCE_NUMBER_SIZE);
+	return log_record;
+}
+
+// sets the next_global_sequence_number to follow the global_sequence_numbers of the last flushed log records of all the partitions
+static int recover_next_global_sequence_number(partitioned_wale* pwale_p, int* error)
+{
+	pwale_p->next_global_sequence_number = 1;
+
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+	{
+		wale_partition* partition = &(pwale_p->partitions[i]);
+
+		uint256 last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(&(partition->partition_wale));
+		if(are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+			continue;
+
+		uint32_t log_record_size;
+		uint64_t global_sequence_number;
+		void* log_record = get_stamped_log_record_at(partition, last_flushed_log_sequence_number, &log_record_size, &global_sequence_number, error);
+		if(log_record == NULL)
+			return 0;
+		release_log_record(&(partition->partition_wale), log_record, log_record_size);
+
+		pwale_p->next_global_sequence_number = max(pwale_p->next_global_sequence_number, global_sequence_number + 1);
+	}
+
+	return 1;
+}
+
+int initialize_partitioned_wale(partitioned_wale* pwale_p, uint32_t partition_count, const block_io_ops* partition_block_io_functions, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t append_only_block_count, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(partition_count == 0 || partition_count > MAX_PARTITION_COUNT)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	pwale_p->partitions = malloc(sizeof(wale_partition) * partition_count);
+	if(pwale_p->partitions == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+	pwale_p->partition_count = 0;
+
+	for(uint32_t i = 0; i < partition_count; i++)
+	{
+		wale_partition* partition = &(pwale_p->partitions[i]);
+
+		if(!initialize_wale(&(partition->partition_wale), log_sequence_number_width, next_log_sequence_number, 0, NULL, partition_block_io_functions[i], append_only_block_count, error))
+			goto FAIL;
+
+		pwale_p->partition_count++;
+	}
+
+	if(!recover_next_global_sequence_number(pwale_p, error))
+		goto FAIL;
+
+	return 1;
+
+	FAIL:;
+	deinitialize_partitioned_wale(pwale_p);
+	return 0;
+}
+
+void deinitialize_partitioned_wale(partitioned_wale* pwale_p)
+{
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+		deinitialize_wale(&(pwale_p->partitions[i].partition_wale));
+	free(pwale_p->partitions);
+	pwale_p->partitions = NULL;
+	pwale_p->partition_count = 0;
+}
+
+wale* get_partition_wale(partitioned_wale* pwale_p, uint32_t partition_id)
+{
+	if(partition_id >= pwale_p->partition_count)
+		return NULL;
+	return &(pwale_p->partitions[partition_id].partition_wale);
+}
+
+typedef struct global_sequence_number_stamper global_sequence_number_stamper;
+struct global_sequence_number_stamper
+{
+	partitioned_wale* pwale_p;
+
+	// the global_sequence_number that the log record was stamped with
+	uint64_t stamp;
+};
+
+// fills the prefix of the log record with the next global_sequence_number
+// it is called with the global lock of the partition held, at the reservation of the slot, so the log records of the partition are stamped in their log_sequence_number order
+// a failed append leaves a gap in the global_sequence_numbers, which is harmless
+static void stamp_global_sequence_number(void* stamper_p, uint256 log_sequence_number, void* prefix, uint32_t prefix_size)
+{
+	global_sequence_number_stamper* stamper = stamper_p;
+	stamper->stamp = __atomic_fetch_add(&(stamper->pwale_p->next_global_sequence_number), 1, __ATOMIC_RELAXED);
+	serialize_uint64(prefix, prefix_size, stamper->stamp);
+}
+
+uint256 append_log_record_partitioned(partitioned_wale* pwale_p, uint32_t partition_id, partitioned_wale_transaction* transaction, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, uint64_t* global_sequence_number, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(partition_id >= pwale_p->partition_count || log_record_size > MAX_LOG_RECORD_SIZE - GLOBAL_SEQUENCE_NUMBER_SIZE)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	wale_partition* partition = &(pwale_p->partitions[partition_id]);
+
+	// the global_sequence_number is taken as the log record takes its slot in the partition, and the log record is then copied in parallel with the other appenders
+	global_sequence_number_stamper stamper = {.pwale_p = pwale_p};
+	uint256 log_sequence_number = append_prefixed_log_record(&(partition->partition_wale), GLOBAL_SEQUENCE_NUMBER_SIZE, stamp_global_sequence_number, &stamper, log_record, log_record_size, log_record_type, 0, APPEND_BUFFERED, error);
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		return INVALID_LOG_SEQUENCE_NUMBER;
+
+	if(transaction != NULL)
+	{
+		transaction->touched_partitions |= (UINT64_C(1) << partition_id);
+		transaction->last_log_sequence_numbers[partition_id] = log_sequence_number;
+	}
+
+	if(global_sequence_number != NULL)
+		(*global_sequence_number) = stamper.stamp;
+
+	return log_sequence_number;
+}
+
+int commit_partitioned_wale_transaction(partitioned_wale* pwale_p, const partitioned_wale_transaction* transaction, int* error)
+{
+	(*error) = NO_ERROR;
+
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+	{
+		if(!(transaction->touched_partitions & (UINT64_C(1) << i)))
+			continue;
+
+		if(!make_log_records_durable_until(&(pwale_p->partitions[i].partition_wale), transaction->last_log_sequence_numbers[i], error))
+			return 0;
+	}
+
+	return 1;
+}
+
+int flush_all_log_records_partitioned(partitioned_wale* pwale_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+	{
+		flush_all_log_records(&(pwale_p->partitions[i].partition_wale), error);
+		if(*error)
+			return 0;
+	}
+
+	return 1;
+}
+
+// reads the log record at the log_sequence_number of the partition into the head, an INVALID_LOG_SEQUENCE_NUMBER marks the partition as exhausted
+static int load_cursor_head(partitioned_wale_cursor* cursor, uint32_t partition_id, uint256 log_sequence_number, int* error)
+{
+	partitioned_wale_cursor_head* head = &(cursor->heads[partition_id]);
+
+	head->log_sequence_number = log_sequence_number;
+	head->log_record = NULL;
+	head->log_record_size = 0;
+	head->global_sequence_number = 0;
+
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		return 1;
+
+	head->log_record = get_stamped_log_record_at(&(cursor->pwale_p->partitions[partition_id]), log_sequence_number, &(head->log_record_size), &(head->global_sequence_number), error);
+	if(head->log_record == NULL)
+	{
+		head->log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+		return 0;
+	}
+
+	return 1;
+}
+
+int initialize_partitioned_wale_cursor(partitioned_wale_cursor* cursor, partitioned_wale* pwale_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	cursor->pwale_p = pwale_p;
+	cursor->heads = malloc(sizeof(partitioned_wale_cursor_head) * pwale_p->partition_count);
+	if(cursor->heads == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+		load_cursor_head(cursor, i, INVALID_LOG_SEQUENCE_NUMBER, error);
+
+	for(uint32_t i = 0; i < pwale_p->partition_count; i++)
+	{
+		if(!load_cursor_head(cursor, i, get_first_log_sequence_number(&(pwale_p->partitions[i].partition_wale)), error))
+		{
+			deinitialize_partitioned_wale_cursor(cursor);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void* get_next_log_record_partitioned(partitioned_wale_cursor* cursor, uint32_t* partition_id, uint256* log_sequence_number, uint64_t* global_sequence_number, uint32_t* log_record_size, int* error)
+{
+	(*error) = NO_ERROR;
+
+	// the partition, whose next log record has the smallest global_sequence_number
+	uint32_t min_partition_id = cursor->pwale_p->partition_count;
+	for(uint32_t i = 0; i < cursor->pwale_p->partition_count; i++)
+	{
+		if(cursor->heads[i].log_record == NULL)
+			continue;
+		if(min_partition_id == cursor->pwale_p->partition_count || cursor->heads[i].global_sequence_number < cursor->heads[min_partition_id].global_sequence_number)
+			min_partition_id = i;
+	}
+
+	// all the partitions are exhausted
+	if(min_partition_id == cursor->pwale_p->partition_count)
+		return NULL;
+
+	partitioned_wale_cursor_head head = cursor->heads[min_partition_id];
+	wale_partition* partition = &(cursor->pwale_p->partitions[min_partition_id]);
+
+	// the yielded log record is now owned by the caller (or released below on a failure), so the head must not hold it any more
+	// the partition stays exhausted, if it can not be advanced
+	cursor->heads[min_partition_id].log_record = NULL;
+	cursor->heads[min_partition_id].log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	// advance the partition
+	uint256 next_log_sequence_number = get_next_log_sequence_number_of(&(partition->partition_wale), head.log_sequence_number, error);
+	if((*error) || !load_cursor_head(cursor, min_partition_id, next_log_sequence_number, error))
+	{
+		release_log_record(&(partition->partition_wale), head.log_record, head.log_record_size);
+		return NULL;
+	}
+
+	if(partition_id != NULL)
+		(*partition_id) = min_partition_id;
+	if(log_sequence_number != NULL)
+		(*log_sequence_number) = head.log_sequence_number;
+	if(global_sequence_number != NULL)
+		(*global_sequence_number) = head.global_sequence_number;
+
+	// the global_sequence_number is not a part of the log record, that the caller appended
+	(*log_record_size) = head.log_record_size - GLOBAL_SEQUENCE_NUMBER_SIZE;
+	return head.log_record + GLOBAL_SEQUENCE_NUMBER_SIZE;
+}
+
+void release_log_record_partitioned(partitioned_wale* pwale_p, uint32_t partition_id, void* log_record, uint32_t log_record_size)
+{
+	if(log_record == NULL)
+		return;
+	release_log_record(&(pwale_p->partitions[partition_id].partition_wale), log_record - GLOBAL_SEQUENCE_NUMBER_SIZE, log_record_size + GLOBAL_SEQUENCE_NUMBER_SIZE);
+}
+
+void deinitialize_partitioned_wale_cursor(partitioned_wale_cursor* cursor)
+{
+	for(uint32_t i = 0; i < cursor->pwale_p->partition_count; i++)
+		release_log_record(&(cursor->pwale_p->partitions[i].partition_wale), cursor->heads[i].log_record, cursor->heads[i].log_record_size);
+	free(cursor->heads);
+	cursor->heads = NULL;
+}
\ No newline at end of file
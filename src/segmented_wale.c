@@ -0,0 +1,576 @@
+#include<segmented_wale.h>
+
+#include<cutlery_stds.h>
+
+#include<stdlib.h>
+
+static void shared_lock_segments(segmented_wale* swale_p)
+{
+	pthread_mutex_lock(&(swale_p->segments_mutex));
+	shared_lock(&(swale_p->segments_lock), WRITE_PREFERRING, BLOCKING);
+	pthread_mutex_unlock(&(swale_p->segments_mutex));
+}
+
+static void shared_unlock_segments(segmented_wale* swale_p)
+{
+	pthread_mutex_lock(&(swale_p->segments_mutex));
+	shared_unlock(&(swale_p->segments_lock));
+	pthread_mutex_unlock(&(swale_p->segments_mutex));
+}
+
+static void exclusive_lock_segments(segmented_wale* swale_p)
+{
+	pthread_mutex_lock(&(swale_p->segments_mutex));
+	exclusive_lock(&(swale_p->segments_lock), BLOCKING);
+	pthread_mutex_unlock(&(swale_p->segments_mutex));
+}
+
+static void exclusive_unlock_segments(segmented_wale* swale_p)
+{
+	pthread_mutex_lock(&(swale_p->segments_mutex));
+	exclusive_unlock(&(swale_p->segments_lock));
+	pthread_mutex_unlock(&(swale_p->segments_mutex));
+}
+
+static wale_segment* get_last_segment(segmented_wale* swale_p)
+{
+	return swale_p->segments[swale_p->segment_count - 1];
+}
+
+// returns the index of the segment that may contain the log_sequence_number
+// i.e. the last segment with start_log_sequence_number <= log_sequence_number
+// returns segment_count, if there is no such segment
+// must be called with atleast a shared lock on segments_lock
+static uint64_t find_segment_index_for_log_sequence_number(segmented_wale* swale_p, uint256 log_sequence_number)
+{
+	uint64_t result = swale_p->segment_count;
+
+	uint64_t low = 0;
+	uint64_t high = swale_p->segment_count;
+	while(low < high)
+	{
+		uint64_t mid = low + (high - low) / 2;
+		if(compare_uint256(swale_p->segments[mid]->start_log_sequence_number, log_sequence_number) <= 0)
+		{
+			result = mid;
+			low = mid + 1;
+		}
+		else
+			high = mid;
+	}
+
+	return result;
+}
+
+// opens the segment with the given segment_id and initializes a WALe for it
+// if next_log_sequence_number is not INVALID_LOG_SEQUENCE_NUMBER, then the segment is created
+static wale_segment* open_wale_segment(segmented_wale* swale_p, uint64_t segment_id, uint256 next_log_sequence_number, uint64_t append_only_block_count, int* error)
+{
+	int create = !are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER);
+
+	wale_segment* segment = malloc(sizeof(wale_segment));
+	if(segment == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return NULL;
+	}
+
+	segment->segment_id = segment_id;
+
+	if(!swale_p->segment_functions.open_segment(swale_p->segment_functions.segment_ops_handle, segment_id, create, &(segment->block_io_functions)))
+	{
+		(*error) = create ? WRITE_IO_ERROR : READ_IO_ERROR;
+		free(segment);
+		return NULL;
+	}
+
+	if(!initialize_wale(&(segment->segment_wale), swale_p->log_sequence_number_width, next_log_sequence_number, 0, NULL, segment->block_io_functions, append_only_block_count, error))
+	{
+		swale_p->segment_functions.close_segment(swale_p->segment_functions.segment_ops_handle, segment_id, &(segment->block_io_functions));
+		free(segment);
+		return NULL;
+	}
+
+	// every segment uses the log_record_codec of the segmented_wale
+	if(swale_p->log_record_codec.codec_id != 0)
+		set_log_record_codec(&(segment->segment_wale), &(swale_p->log_record_codec), swale_p->min_log_record_size_to_compress);
+
+	// a segment always starts at its first log record, OR at its next_log_sequence_number if it is empty
+	// this holds, since the segments are never truncated individually
+	segment->start_log_sequence_number = get_first_log_sequence_number(&(segment->segment_wale));
+	if(are_equal_uint256(segment->start_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		segment->start_log_sequence_number = get_next_log_sequence_number(&(segment->segment_wale));
+
+	return segment;
+}
+
+static void close_wale_segment(segmented_wale* swale_p, wale_segment* segment)
+{
+	deinitialize_wale(&(segment->segment_wale));
+	swale_p->segment_functions.close_segment(swale_p->segment_functions.segment_ops_handle, segment->segment_id, &(segment->block_io_functions));
+	free(segment);
+}
+
+// inserts the segment at the end of the segments array
+static int push_segment(segmented_wale* swale_p, wale_segment* segment)
+{
+	if(swale_p->segment_count == swale_p->segments_capacity)
+	{
+		uint64_t new_segments_capacity = (swale_p->segments_capacity * 2) + 4;
+		wale_segment** new_segments = realloc(swale_p->segments, new_segments_capacity * sizeof(wale_segment*));
+		if(new_segments == NULL)
+			return 0;
+		swale_p->segments = new_segments;
+		swale_p->segments_capacity = new_segments_capacity;
+	}
+
+	swale_p->segments[swale_p->segment_count++] = segment;
+	return 1;
+}
+
+int initialize_segmented_wale(segmented_wale* swale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t max_segment_size, segment_ops segment_functions, uint64_t append_only_block_count, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(max_segment_size == 0)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	swale_p->segments = NULL;
+	swale_p->segment_count = 0;
+	swale_p->segments_capacity = 0;
+	swale_p->log_sequence_number_width = log_sequence_number_width;
+	swale_p->max_segment_size = max_segment_size;
+	swale_p->append_only_block_count = append_only_block_count;
+	swale_p->segment_functions = segment_functions;
+	swale_p->log_record_codec = (log_record_codec){.codec_handle = NULL, .codec_id = 0, .compress = NULL, .decompress = NULL};
+	swale_p->min_log_record_size_to_compress = 0;
+
+	uint64_t first_segment_id = 0;
+	uint64_t segment_count = 0;
+	if(!segment_functions.get_segments_range(segment_functions.segment_ops_handle, &first_segment_id, &segment_count))
+	{
+		(*error) = READ_IO_ERROR;
+		return 0;
+	}
+
+	if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		// there must be segments to open
+		if(segment_count == 0)
+		{
+			(*error) = PARAM_INVALID;
+			return 0;
+		}
+
+		for(uint64_t i = 0; i < segment_count; i++)
+		{
+			// only the last segment gets an append only buffer
+			uint64_t segment_append_only_block_count = (i == segment_count - 1) ? append_only_block_count : 0;
+
+			wale_segment* segment = open_wale_segment(swale_p, first_segment_id + i, INVALID_LOG_SEQUENCE_NUMBER, segment_append_only_block_count, error);
+			if(segment == NULL || !push_segment(swale_p, segment))
+			{
+				if(segment != NULL)
+				{
+					close_wale_segment(swale_p, segment);
+					(*error) = ALLOCATION_FAILED;
+				}
+				goto FAIL;
+			}
+		}
+
+		// width of the log_sequence_number is as found on the disk
+		swale_p->log_sequence_number_width = get_log_sequence_number_width(&(swale_p->segments[0]->segment_wale));
+	}
+	else
+	{
+		// we will not overwrite existing segments
+		if(segment_count != 0)
+		{
+			(*error) = PARAM_INVALID;
+			return 0;
+		}
+
+		wale_segment* segment = open_wale_segment(swale_p, 0, next_log_sequence_number, append_only_block_count, error);
+		if(segment == NULL || !push_segment(swale_p, segment))
+		{
+			if(segment != NULL)
+			{
+				close_wale_segment(swale_p, segment);
+				(*error) = ALLOCATION_FAILED;
+			}
+			goto FAIL;
+		}
+	}
+
+	pthread_mutex_init(&(swale_p->segments_mutex), NULL);
+	initialize_rwlock(&(swale_p->segments_lock), &(swale_p->segments_mutex));
+
+	return 1;
+
+	FAIL:;
+	for(uint64_t i = 0; i < swale_p->segment_count; i++)
+		close_wale_segment(swale_p, swale_p->segments[i]);
+	free(swale_p->segments);
+	swale_p->segments = NULL;
+	swale_p->segment_count = 0;
+	return 0;
+}
+
+void deinitialize_segmented_wale(segmented_wale* swale_p)
+{
+	for(uint64_t i = 0; i < swale_p->segment_count; i++)
+		close_wale_segment(swale_p, swale_p->segments[i]);
+	free(swale_p->segments);
+
+	deinitialize_rwlock(&(swale_p->segments_lock));
+	pthread_mutex_destroy(&(swale_p->segments_mutex));
+}
+
+void set_log_record_codec_segmented(segmented_wale* swale_p, const log_record_codec* codec, uint32_t min_log_record_size_to_compress)
+{
+	exclusive_lock_segments(swale_p);
+
+	if(codec == NULL)
+	{
+		swale_p->log_record_codec = (log_record_codec){.codec_handle = NULL, .codec_id = 0, .compress = NULL, .decompress = NULL};
+		swale_p->min_log_record_size_to_compress = 0;
+	}
+	else
+	{
+		swale_p->log_record_codec = (*codec);
+		swale_p->min_log_record_size_to_compress = min_log_record_size_to_compress;
+	}
+
+	for(uint64_t i = 0; i < swale_p->segment_count; i++)
+		set_log_record_codec(&(swale_p->segments[i]->segment_wale), codec, min_log_record_size_to_compress);
+
+	exclusive_unlock_segments(swale_p);
+}
+
+uint256 get_first_log_sequence_number_segmented(segmented_wale* swale_p)
+{
+	shared_lock_segments(swale_p);
+
+	// the first segment with a valid first_log_sequence_number
+	uint256 first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(uint64_t i = 0; i < swale_p->segment_count && are_equal_uint256(first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i++)
+		first_log_sequence_number = get_first_log_sequence_number(&(swale_p->segments[i]->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return first_log_sequence_number;
+}
+
+uint256 get_last_flushed_log_sequence_number_segmented(segmented_wale* swale_p)
+{
+	shared_lock_segments(swale_p);
+
+	// the last segment with a valid last_flushed_log_sequence_number
+	uint256 last_flushed_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(uint64_t i = swale_p->segment_count; i > 0 && are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i--)
+		last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(&(swale_p->segments[i - 1]->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return last_flushed_log_sequence_number;
+}
+
+uint256 get_check_point_log_sequence_number_segmented(segmented_wale* swale_p)
+{
+	shared_lock_segments(swale_p);
+
+	// the last segment with a valid check_point_log_sequence_number
+	uint256 check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(uint64_t i = swale_p->segment_count; i > 0 && are_equal_uint256(check_point_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i--)
+		check_point_log_sequence_number = get_check_point_log_sequence_number(&(swale_p->segments[i - 1]->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return check_point_log_sequence_number;
+}
+
+uint256 get_next_log_sequence_number_segmented(segmented_wale* swale_p)
+{
+	shared_lock_segments(swale_p);
+
+	uint256 next_log_sequence_number = get_next_log_sequence_number(&(get_last_segment(swale_p)->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return next_log_sequence_number;
+}
+
+uint256 get_next_log_sequence_number_of_segmented(segmented_wale* swale_p, uint256 log_sequence_number, int* error)
+{
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	(*error) = NO_ERROR;
+
+	shared_lock_segments(swale_p);
+
+	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	uint64_t segment_index = find_segment_index_for_log_sequence_number(swale_p, log_sequence_number);
+	if(segment_index == swale_p->segment_count)
+	{
+		(*error) = PARAM_INVALID;
+		goto EXIT;
+	}
+
+	next_log_sequence_number = get_next_log_sequence_number_of(&(swale_p->segments[segment_index]->segment_wale), log_sequence_number, error);
+	if((*error) || !are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		goto EXIT;
+
+	// log_sequence_number is the last flushed log record of its segment, so its next is the first log record of the following non-empty segment
+	for(uint64_t i = segment_index + 1; i < swale_p->segment_count && are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i++)
+		next_log_sequence_number = get_first_log_sequence_number(&(swale_p->segments[i]->segment_wale));
+
+	EXIT:;
+	shared_unlock_segments(swale_p);
+
+	return next_log_sequence_number;
+}
+
+uint256 get_prev_log_sequence_number_of_segmented(segmented_wale* swale_p, uint256 log_sequence_number, int* error)
+{
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	(*error) = NO_ERROR;
+
+	shared_lock_segments(swale_p);
+
+	uint256 prev_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	uint64_t segment_index = find_segment_index_for_log_sequence_number(swale_p, log_sequence_number);
+	if(segment_index == swale_p->segment_count)
+	{
+		(*error) = PARAM_INVALID;
+		goto EXIT;
+	}
+
+	prev_log_sequence_number = get_prev_log_sequence_number_of(&(swale_p->segments[segment_index]->segment_wale), log_sequence_number, error);
+	if((*error) || !are_equal_uint256(prev_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		goto EXIT;
+
+	// log_sequence_number is the first log record of its segment, so its prev is the last flushed log record of the preceding non-empty segment
+	for(uint64_t i = segment_index; i > 0 && are_equal_uint256(prev_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i--)
+		prev_log_sequence_number = get_last_flushed_log_sequence_number(&(swale_p->segments[i - 1]->segment_wale));
+
+	EXIT:;
+	shared_unlock_segments(swale_p);
+
+	return prev_log_sequence_number;
+}
+
+void* get_log_record_at_segmented(segmented_wale* swale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+{
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return NULL;
+	}
+
+	shared_lock_segments(swale_p);
+
+	void* log_record = NULL;
+
+	uint64_t segment_index = find_segment_index_for_log_sequence_number(swale_p, log_sequence_number);
+	if(segment_index == swale_p->segment_count)
+		(*error) = PARAM_INVALID;
+	else
+		log_record = get_log_record_at(&(swale_p->segments[segment_index]->segment_wale), log_sequence_number, log_record_size, error);
+
+	shared_unlock_segments(swale_p);
+
+	return log_record;
+}
+
+void release_log_record_segmented(segmented_wale* swale_p, void* log_record, uint32_t log_record_size)
+{
+	if(log_record == NULL)
+		return;
+
+	// all the segments are opened with the default_wale_allocator, so any segment may release it, even if the one it was read from is removed
+	shared_lock_segments(swale_p);
+
+	release_log_record(&(get_last_segment(swale_p)->segment_wale), log_record, log_record_size);
+
+	shared_unlock_segments(swale_p);
+}
+
+int validate_log_record_at_segmented(segmented_wale* swale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+{
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	shared_lock_segments(swale_p);
+
+	int valid = 0;
+
+	uint64_t segment_index = find_segment_index_for_log_sequence_number(swale_p, log_sequence_number);
+	if(segment_index == swale_p->segment_count)
+		(*error) = PARAM_INVALID;
+	else
+		valid = validate_log_record_at(&(swale_p->segments[segment_index]->segment_wale), log_sequence_number, log_record_size, error);
+
+	shared_unlock_segments(swale_p);
+
+	return valid;
+}
+
+// returns 1, if a log record at log_sequence_number in the segment, starts at or beyond the max_segment_size of the segment
+static int is_segment_full(segmented_wale* swale_p, const wale_segment* segment, uint256 log_sequence_number)
+{
+	uint256 bytes_in_segment;
+	uint64_t bytes_in_segment_64;
+	if(!sub_underflow_safe_uint256(&bytes_in_segment, log_sequence_number, segment->start_log_sequence_number) ||
+		!cast_to_uint64_from_uint256(&bytes_in_segment_64, bytes_in_segment))
+		return 1;
+	return bytes_in_segment_64 >= swale_p->max_segment_size;
+}
+
+// rolls over to a new segment, if the last segment is still the one with the segment_id and is full
+// must be called with an exclusive lock on segments_lock
+static int roll_over_segment(segmented_wale* swale_p, uint64_t full_segment_id, uint256 log_sequence_number, int* error)
+{
+	wale_segment* last_segment = get_last_segment(swale_p);
+
+	// someone else already rolled over the segment
+	if(last_segment->segment_id != full_segment_id || !is_segment_full(swale_p, last_segment, log_sequence_number))
+		return 1;
+
+	// make all the log records of the last segment persistent, no one can append to it, while we hold the exclusive lock
+	flush_all_log_records(&(last_segment->segment_wale), error);
+	if(*error)
+		return 0;
+
+	// the new segment starts at the next_log_sequence_number of the last segment
+	uint256 next_log_sequence_number = get_next_log_sequence_number(&(last_segment->segment_wale));
+
+	wale_segment* new_segment = open_wale_segment(swale_p, last_segment->segment_id + 1, next_log_sequence_number, swale_p->append_only_block_count, error);
+	if(new_segment == NULL)
+		return 0;
+
+	if(!push_segment(swale_p, new_segment))
+	{
+		close_wale_segment(swale_p, new_segment);
+		swale_p->segment_functions.delete_segment(swale_p->segment_functions.segment_ops_handle, last_segment->segment_id + 1);
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	// the old last segment is now read-only, release its append only buffer
+	modify_append_only_buffer_block_count(&(last_segment->segment_wale), 0, error);
+
+	return 1;
+}
+
+uint256 append_log_record_segmented(segmented_wale* swale_p, const void* log_record, uint32_t log_record_size, int is_check_point, append_durability durability, int* error)
+{
+	shared_lock_segments(swale_p);
+
+	wale_segment* last_segment = get_last_segment(swale_p);
+
+	uint256 log_sequence_number = append_log_record(&(last_segment->segment_wale), log_record, log_record_size, is_check_point, durability, error);
+
+	int roll_over_needed = !are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) && is_segment_full(swale_p, last_segment, log_sequence_number);
+	uint64_t full_segment_id = last_segment->segment_id;
+
+	shared_unlock_segments(swale_p);
+
+	if(roll_over_needed)
+	{
+		exclusive_lock_segments(swale_p);
+
+		// a failed roll over does not fail the append, the log record is already appended
+		// roll over will be reattempted by the next append
+		int roll_over_error = NO_ERROR;
+		roll_over_segment(swale_p, full_segment_id, log_sequence_number, &roll_over_error);
+
+		exclusive_unlock_segments(swale_p);
+	}
+
+	return log_sequence_number;
+}
+
+uint256 flush_all_log_records_segmented(segmented_wale* swale_p, int* error)
+{
+	shared_lock_segments(swale_p);
+
+	// all the segments except the last one are already flushed, during the roll over
+	uint256 last_flushed_log_sequence_number = flush_all_log_records(&(get_last_segment(swale_p)->segment_wale), error);
+
+	// if the last segment has no log records, then the last flushed log record is in some previous segment
+	for(uint64_t i = swale_p->segment_count - 1; (*error) == NO_ERROR && i > 0 && are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i--)
+		last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(&(swale_p->segments[i - 1]->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return last_flushed_log_sequence_number;
+}
+
+uint256 discard_unflushed_log_records_segmented(segmented_wale* swale_p, int* error)
+{
+	shared_lock_segments(swale_p);
+
+	uint256 last_flushed_log_sequence_number = discard_unflushed_log_records(&(get_last_segment(swale_p)->segment_wale), error);
+
+	// if the last segment has no log records, then the last flushed log record is in some previous segment
+	for(uint64_t i = swale_p->segment_count - 1; (*error) == NO_ERROR && i > 0 && are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); i--)
+		last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(&(swale_p->segments[i - 1]->segment_wale));
+
+	shared_unlock_segments(swale_p);
+
+	return last_flushed_log_sequence_number;
+}
+
+uint64_t discard_segments_before_segmented(segmented_wale* swale_p, uint256 oldest_log_sequence_number_of_concern, int* error)
+{
+	(*error) = NO_ERROR;
+
+	exclusive_lock_segments(swale_p);
+
+	// the first segment can be deleted, if the segment following it starts at or before the oldest_log_sequence_number_of_concern
+	uint64_t segments_to_delete = 0;
+	while(segments_to_delete + 1 < swale_p->segment_count &&
+		compare_uint256(swale_p->segments[segments_to_delete + 1]->start_log_sequence_number, oldest_log_sequence_number_of_concern) <= 0)
+		segments_to_delete++;
+
+	uint64_t segments_deleted = 0;
+	for(; segments_deleted < segments_to_delete; segments_deleted++)
+	{
+		uint64_t segment_id = swale_p->segments[segments_deleted]->segment_id;
+		close_wale_segment(swale_p, swale_p->segments[segments_deleted]);
+		if(!swale_p->segment_functions.delete_segment(swale_p->segment_functions.segment_ops_handle, segment_id))
+		{
+			(*error) = WRITE_IO_ERROR;
+
+			// a closed segment can not stay in the segments array, so it is removed from it, even if it could not be deleted from the storage
+			segments_deleted++;
+			break;
+		}
+	}
+
+	// shift the remaining segments to the front
+	memory_move(swale_p->segments, swale_p->segments + segments_deleted, (swale_p->segment_count - segments_deleted) * sizeof(wale_segment*));
+	swale_p->segment_count -= segments_deleted;
+
+	exclusive_unlock_segments(swale_p);
+
+	return segments_deleted;
+}
\ No newline at end of file
@@ -3,34 +3,48 @@
 #include<wale_get_lock_util.h>
 #include<util_master_record.h>
 #include<block_io_ops_util.h>
+#include<util_wale_stats.h>
+#include<util_wale_trace.h>
+#include<util_wait_for_scroll.h>
+#include<util_flush_epochs.h>
 
 #include<cutlery_stds.h>
 
-#include<stdlib.h>
-
 int scroll_append_only_buffer(wale* wale_p)
 {
-	uint64_t block_count_to_write = UINT_ALIGN_UP(wale_p->append_offset, wale_p->block_io_functions.block_size) / wale_p->block_io_functions.block_size;
+	uint64_t block_count_to_write = get_block_count_for_size(wale_p->append_offset, &(wale_p->block_io_functions));
 	if(block_count_to_write == 0)
 		return 1;
 
 	// unlock the global lock while performing a write syscall
+	// the new appenders wait for the scroll waiters to be woken up, by the caller after this scroll
+	wale_p->is_scrolling_append_only_buffer = 1;
 	pthread_mutex_unlock(get_wale_lock(wale_p));
 
 	// write the current contents of the append only buffer to disk at its start offset
-	if(!wale_p->block_io_functions.write_blocks(wale_p->block_io_functions.block_io_ops_handle, wale_p->buffer, wale_p->buffer_start_block_id, block_count_to_write))
-	{
-		pthread_mutex_lock(get_wale_lock(wale_p));
+	trace_scroll_begin(wale_p, wale_p->buffer_start_block_id, block_count_to_write);
+	uint64_t start_time = get_wale_stats_time();
+	// with write_blocks_durable, every scroll is durable, so that the flushes need not flush all the writes
+	int io_success = (wale_p->block_io_functions.write_blocks_durable != NULL)
+		? wale_p->block_io_functions.write_blocks_durable(wale_p->block_io_functions.block_io_ops_handle, wale_p->buffer, wale_p->buffer_start_block_id, block_count_to_write)
+		: wale_p->block_io_functions.write_blocks(wale_p->block_io_functions.block_io_ops_handle, wale_p->buffer, wale_p->buffer_start_block_id, block_count_to_write);
+	record_wale_stats_latency(wale_p, WALE_STATS_SCROLL_LATENCY, start_time);
+	add_to_wale_stats_counter(wale_p, WALE_STATS_SCROLLS, 1);
+	trace_scroll_end(wale_p, wale_p->buffer_start_block_id, block_count_to_write, io_success);
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+	wale_p->is_scrolling_append_only_buffer = 0;
+
+	if(!io_success)
 		return 0;
-	}
 
-	pthread_mutex_lock(get_wale_lock(wale_p));
+	// all the bytes until the append_offset are now handed to the write_blocks
+	wale_p->written_file_offset = wale_p->buffer_start_block_id * wale_p->block_io_functions.block_size + wale_p->append_offset;
 
 	// perform the actual scrolling here
-	uint64_t new_buffer_start_block_id = wale_p->buffer_start_block_id + UINT_ALIGN_DOWN(wale_p->append_offset, wale_p->block_io_functions.block_size) / wale_p->block_io_functions.block_size;
-	uint64_t new_append_offset = wale_p->append_offset % wale_p->block_io_functions.block_size;
+	uint64_t new_buffer_start_block_id = wale_p->buffer_start_block_id + get_block_id_from_file_offset(wale_p->append_offset, &(wale_p->block_io_functions));
+	uint64_t new_append_offset = get_block_offset_from_file_offset(wale_p->append_offset, &(wale_p->block_io_functions));
 
-	memory_move(wale_p->buffer, wale_p->buffer + UINT_ALIGN_DOWN(wale_p->append_offset, wale_p->block_io_functions.block_size), new_append_offset);
+	memory_move(wale_p->buffer, wale_p->buffer + (wale_p->append_offset - new_append_offset), new_append_offset);
 
 	wale_p->buffer_start_block_id = new_buffer_start_block_id;
 	wale_p->append_offset = new_append_offset;
@@ -53,15 +67,16 @@ int resize_append_only_buffer(wale* wale_p, uint64_t new_buffer_block_count, int
 	// this is all if we want to make the buffer read only
 	if(new_buffer_block_count == 0)
 	{
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, wale_p->buffer, wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
 		wale_p->buffer_block_count = 0;
-		free(wale_p->buffer);
 		wale_p->buffer = NULL;
 		return 1;
 	}
 
 	uint64_t old_buffer_block_count = wale_p->buffer_block_count;
 
-	void* new_buffer = aligned_alloc(wale_p->block_io_functions.block_buffer_alignment, (new_buffer_block_count * wale_p->block_io_functions.block_size));
+	uint64_t new_buffer_size = new_buffer_block_count * wale_p->block_io_functions.block_size;
+	void* new_buffer = wale_p->allocator.allocate(wale_p->allocator.allocator_handle, wale_p->block_io_functions.block_buffer_alignment, new_buffer_size);
 
 	// failed memory allocation
 	if(new_buffer == NULL)
@@ -82,14 +97,14 @@ int resize_append_only_buffer(wale* wale_p, uint64_t new_buffer_block_count, int
 			if(scroll_error)
 			{
 				(*error) = MAJOR_SCROLL_ERROR;
-				free(new_buffer);
+				wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, new_buffer, new_buffer_size);
 				return 0;
 			}
 		}
 
 		memory_move(new_buffer, wale_p->buffer, wale_p->append_offset);
 
-		free(wale_p->buffer);
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, wale_p->buffer, old_buffer_block_count * wale_p->block_io_functions.block_size);
 		wale_p->buffer = new_buffer;
 		wale_p->buffer_block_count = new_buffer_block_count;
 
@@ -97,7 +112,10 @@ int resize_append_only_buffer(wale* wale_p, uint64_t new_buffer_block_count, int
 	}
 	else // this implies that the buffer_block_count was previously 0, hence to stay updated we need to read contents from the on_disk_master_record
 	{
-		read_lock(&(wale_p->flushed_log_records_lock), READ_PREFERRING, BLOCKING);
+		// the ongoing flushes (if any) must install their master records first
+		wait_for_all_flush_epochs(wale_p);
+
+		read_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK, READ_PREFERRING);
 
 		master_record new_in_memory_master_record = wale_p->on_disk_master_record;
 
@@ -108,20 +126,49 @@ int resize_append_only_buffer(wale* wale_p, uint64_t new_buffer_block_count, int
 
 		uint64_t file_offset_for_next_log_sequence_number = read_latest_vacant_block_using_master_record(new_buffer, &new_in_memory_master_record, &(wale_p->block_io_functions), error);
 
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 		if(*error)
 		{
-			free(new_buffer);
+			wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, new_buffer, new_buffer_size);
 			return 0;
 		}
 
 		wale_p->in_memory_master_record = new_in_memory_master_record;
 		wale_p->buffer_start_block_id = get_block_id_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
 		wale_p->append_offset = get_block_offset_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
+		wale_p->written_file_offset = file_offset_for_next_log_sequence_number;
 		wale_p->buffer = new_buffer;
 		wale_p->buffer_block_count = new_buffer_block_count;
 
 		return 1;
 	}
+}
+
+int reallocate_append_only_buffer_released_on_idle(wale* wale_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	int res = 1;
+
+	// some other appender may have already allocated it, while we were waiting for the exclusive lock
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle)
+	{
+		res = resize_append_only_buffer(wale_p, wale_p->autosize_policy.min_buffer_block_count, error);
+
+		if(res)
+		{
+			wale_p->is_append_only_buffer_released_on_idle = 0;
+			wale_p->autosize_idle_ticks = 0;
+		}
+
+		// the appenders that arrived while we were reading the latest vacant block, may now take their slots
+		wake_up_all_scroll_waiters(wale_p);
+	}
+
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	return res;
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include<util_block_buffer_pool.h>
+
+void initialize_block_buffer_pool(block_buffer_pool* pool, const block_io_ops* block_io_functions, const wale_allocator* allocator)
+{
+	pthread_mutex_init(&(pool->lock), NULL);
+	pool->free_buffers = NULL;
+	pool->block_count = BLOCK_BUFFER_POOL_BUFFER_SIZE / block_io_functions->block_size;
+	if(pool->block_count == 0)
+		pool->block_count = 1;
+	pool->buffer_size = pool->block_count * block_io_functions->block_size;
+	// a free buffer holds the pointer to the next free buffer in its first bytes
+	pool->block_buffer_alignment = (block_io_functions->block_buffer_alignment > _Alignof(void*)) ? block_io_functions->block_buffer_alignment : _Alignof(void*);
+	pool->allocator = (*allocator);
+}
+
+void deinitialize_block_buffer_pool(block_buffer_pool* pool)
+{
+	while(pool->free_buffers != NULL)
+	{
+		void* buffer = pool->free_buffers;
+		pool->free_buffers = *((void**)buffer);
+		pool->allocator.deallocate(pool->allocator.allocator_handle, buffer, pool->buffer_size);
+	}
+	pthread_mutex_destroy(&(pool->lock));
+}
+
+void* acquire_block_buffer(block_buffer_pool* pool)
+{
+	pthread_mutex_lock(&(pool->lock));
+	void* buffer = pool->free_buffers;
+	if(buffer != NULL)
+		pool->free_buffers = *((void**)buffer);
+	pthread_mutex_unlock(&(pool->lock));
+
+	if(buffer == NULL)
+		buffer = pool->allocator.allocate(pool->allocator.allocator_handle, pool->block_buffer_alignment, pool->buffer_size);
+
+	return buffer;
+}
+
+void release_block_buffer(block_buffer_pool* pool, void* buffer)
+{
+	pthread_mutex_lock(&(pool->lock));
+	*((void**)buffer) = pool->free_buffers;
+	pool->free_buffers = buffer;
+	pthread_mutex_unlock(&(pool->lock));
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include<util_flush_epochs.h>
+
+#include<wale_get_lock_util.h>
+#include<util_wale_stats.h>
+
+void initialize_flush_epochs(wale* wale_p)
+{
+	wale_p->begun_flush_epochs = 0;
+	wale_p->completed_flush_epochs = 0;
+	wale_p->last_flush_epoch = 0;
+	wale_p->last_flush_epoch_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	wale_p->pending_flushes = 0;
+	pthread_cond_init(&(wale_p->flush_epoch_completed), NULL);
+}
+
+void deinitialize_flush_epochs(wale* wale_p)
+{
+	pthread_cond_destroy(&(wale_p->flush_epoch_completed));
+}
+
+uint64_t begin_flush_epoch(wale* wale_p)
+{
+	return ++(wale_p->begun_flush_epochs);
+}
+
+void wait_for_turn_of_flush_epoch(wale* wale_p, uint64_t flush_epoch)
+{
+	while(wale_p->completed_flush_epochs + 1 != flush_epoch)
+		pthread_cond_wait_recording_wait(wale_p, &(wale_p->flush_epoch_completed), get_wale_lock(wale_p));
+}
+
+void complete_flush_epoch(wale* wale_p, uint64_t flush_epoch)
+{
+	wale_p->completed_flush_epochs = flush_epoch;
+	pthread_cond_broadcast(&(wale_p->flush_epoch_completed));
+}
+
+void add_pending_flush(wale* wale_p)
+{
+	wale_p->pending_flushes++;
+}
+
+void remove_pending_flush(wale* wale_p)
+{
+	wale_p->pending_flushes--;
+
+	// let the APPEND_DURABLE appenders waiting for this flush know, that it has begun (or failed)
+	pthread_cond_broadcast(&(wale_p->flush_epoch_completed));
+}
+
+void join_flush_epoch_covering(wale* wale_p, uint256 log_sequence_number)
+{
+	while(1)
+	{
+		if(wale_p->last_flush_epoch > wale_p->completed_flush_epochs)
+		{
+			// the latest flush epoch covers the log record, so wait for it
+			if(compare_uint256(log_sequence_number, wale_p->last_flush_epoch_next_log_sequence_number) < 0)
+			{
+				wait_for_completion_of_flush_epoch(wale_p, wale_p->last_flush_epoch);
+				return;
+			}
+
+			// else wait for it anyway, the log records of all the APPEND_DURABLE appenders that pile up meanwhile, are then covered by a single flush
+			wait_for_completion_of_flush_epoch(wale_p, wale_p->last_flush_epoch);
+			continue;
+		}
+
+		// no flush is going to cover the log record
+		if(wale_p->pending_flushes == 0)
+			return;
+
+		// a pending flush will cover it, once it begins its epoch
+		pthread_cond_wait_recording_wait(wale_p, &(wale_p->flush_epoch_completed), get_wale_lock(wale_p));
+	}
+}
+
+void wait_for_completion_of_flush_epoch(wale* wale_p, uint64_t flush_epoch)
+{
+	while(wale_p->completed_flush_epochs < flush_epoch)
+		pthread_cond_wait_recording_wait(wale_p, &(wale_p->flush_epoch_completed), get_wale_lock(wale_p));
+}
+
+void wait_for_all_flush_epochs(wale* wale_p)
+{
+	while(wale_p->completed_flush_epochs != wale_p->begun_flush_epochs)
+		pthread_cond_wait_recording_wait(wale_p, &(wale_p->flush_epoch_completed), get_wale_lock(wale_p));
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include<util_log_record_compression.h>
+
+#include<wale.h>
+
+#include<serial_int.h>
+
+void* compress_log_record(const log_record_codec* codec, const wale_allocator* allocator, const void* log_record, uint32_t log_record_size, uint32_t* compressed_log_record_size)
+{
+	// there is no point in compressing, if even the prefix does not fit in lesser than log_record_size bytes
+	if(log_record_size <= COMPRESSED_LOG_RECORD_PREFIX_SIZE + 1)
+		return NULL;
+
+	// the compressed log record must be smaller than the log record itself
+	// so we do not allocate (or allow the codec to write) more than log_record_size - 1 bytes
+	void* compressed_log_record = allocator->allocate(allocator->allocator_handle, 1, log_record_size - 1);
+	if(compressed_log_record == NULL)
+		return NULL;
+
+	uint32_t compressed_data_size = codec->compress(codec->codec_handle, compressed_log_record + COMPRESSED_LOG_RECORD_PREFIX_SIZE, log_record_size - 1 - COMPRESSED_LOG_RECORD_PREFIX_SIZE, log_record, log_record_size);
+	if(compressed_data_size == 0)
+	{
+		allocator->deallocate(allocator->allocator_handle, compressed_log_record, log_record_size - 1);
+		return NULL;
+	}
+
+	serialize_uint32(compressed_log_record, sizeof(uint32_t), log_record_size);
+	((uint8_t*)compressed_log_record)[4] = codec->codec_id;
+
+	(*compressed_log_record_size) = COMPRESSED_LOG_RECORD_PREFIX_SIZE + compressed_data_size;
+	return compressed_log_record;
+}
+
+void* decompress_log_record(const log_record_codec* codec, const wale_allocator* allocator, const void* compressed_log_record, uint32_t compressed_log_record_size, uint32_t* log_record_size, int* error)
+{
+	if(!parse_uncompressed_log_record_size(compressed_log_record, compressed_log_record_size, log_record_size))
+	{
+		(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+		return NULL;
+	}
+
+	// the log record must have been compressed by the same codec
+	uint8_t codec_id = ((const uint8_t*)compressed_log_record)[4];
+	if(codec->codec_id == 0 || codec->codec_id != codec_id)
+	{
+		(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+		return NULL;
+	}
+
+	// the allocator is never asked for 0 bytes, so allocate atleast 1 byte
+	void* log_record = allocator->allocate(allocator->allocator_handle, 1, ((*log_record_size) == 0) ? 1 : (*log_record_size));
+	if(log_record == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return NULL;
+	}
+
+	if(!codec->decompress(codec->codec_handle, log_record, (*log_record_size), compressed_log_record + COMPRESSED_LOG_RECORD_PREFIX_SIZE, compressed_log_record_size - COMPRESSED_LOG_RECORD_PREFIX_SIZE))
+	{
+		(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+		allocator->deallocate(allocator->allocator_handle, log_record, ((*log_record_size) == 0) ? 1 : (*log_record_size));
+		return NULL;
+	}
+
+	return log_record;
+}
+
+int parse_uncompressed_log_record_size(const void* compressed_log_record, uint32_t compressed_log_record_size, uint32_t* log_record_size)
+{
+	if(compressed_log_record_size < COMPRESSED_LOG_RECORD_PREFIX_SIZE)
+		return 0;
+
+	(*log_record_size) = deserialize_uint32(compressed_log_record, sizeof(uint32_t));
+	return 1;
+}
\ No newline at end of file
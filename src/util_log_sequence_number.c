@@ -0,0 +1,48 @@
+#include<util_log_sequence_number.h>
+
+#include<limits.h>
+
+void select_log_sequence_number_arithmetic(wale* wale_p)
+{
+	uint32_t log_sequence_number_width = wale_p->in_memory_master_record.log_sequence_number_width;
+
+	wale_p->has_narrow_log_sequence_numbers = (log_sequence_number_width <= sizeof(uint64_t));
+
+	// the largest narrow log_sequence_number, i.e. max_limit - 1
+	if(log_sequence_number_width >= sizeof(uint64_t))
+		wale_p->max_narrow_log_sequence_number = UINT64_MAX;
+	else
+		wale_p->max_narrow_log_sequence_number = (UINT64_C(1) << (log_sequence_number_width * CHAR_BIT)) - 1;
+}
+
+int add_size_to_log_sequence_number(const wale* wale_p, uint256* result, uint256 log_sequence_number, uint64_t size)
+{
+	if(!wale_p->has_narrow_log_sequence_numbers)
+		return add_overflow_safe_uint256(result, log_sequence_number, get_uint256(size), wale_p->max_limit);
+
+	// a narrow log_sequence_number always fits in a uint64_t
+	uint64_t log_sequence_number_64;
+	cast_to_uint64_from_uint256(&log_sequence_number_64, log_sequence_number);
+	if(log_sequence_number_64 > wale_p->max_narrow_log_sequence_number || size > wale_p->max_narrow_log_sequence_number - log_sequence_number_64)
+		return 0;
+
+	(*result) = get_uint256(log_sequence_number_64 + size);
+	return 1;
+}
+
+int get_log_sequence_number_difference(const wale* wale_p, uint64_t* result, uint256 a, uint256 b)
+{
+	if(!wale_p->has_narrow_log_sequence_numbers)
+	{
+		uint256 temp;
+		return sub_underflow_safe_uint256(&temp, a, b) && cast_to_uint64_from_uint256(result, temp);
+	}
+
+	uint64_t a_64;
+	uint64_t b_64;
+	if(!cast_to_uint64_from_uint256(&a_64, a) || !cast_to_uint64_from_uint256(&b_64, b) || a_64 < b_64)
+		return 0;
+
+	(*result) = a_64 - b_64;
+	return 1;
+}
\ No newline at end of file
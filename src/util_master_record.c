@@ -5,11 +5,46 @@
 
 #include<serial_int.h>
 
-#include<stdlib.h>
+#include<cutlery_math.h>
 
-int read_master_record(master_record* mr, const block_io_ops* block_io_functions, int* error)
+/*
+	On-disk master record is serialized at the start of the block 0, in the following format
+
+	uint32_t log_sequence_number_width | (master_record_version << 16)
+
+	// all the below log_sequence_numbers are log_sequence_number_width bytes wide
+	first_log_sequence_number
+	last_flushed_log_sequence_number
+	check_point_log_sequence_number
+	next_log_sequence_number
+	base_log_sequence_number			// only for master_record_version >= 1, else it is assumed to be the first_log_sequence_number
+
+	uint64_t ring_block_count			// only for master_record_version >= 2, else it is assumed to be 0
+
+	uint32_t log_record_format_version	// only for master_record_version >= 3, else it is assumed to be LOG_RECORD_FORMAT_V1
+
+	uint32_t crc32						// crc32 of all the above bytes
+*/
+
+// the master_record_version that we write
+#define MASTER_RECORD_VERSION 3
+
+#define MASTER_RECORD_VERSION_BITS_OFFSET 16
+
+static uint32_t get_log_sequence_number_count_for_master_record_version(uint32_t master_record_version)
+{
+	return (master_record_version >= 1) ? 5 : 4;
+}
+
+// size of the serialized master record, excluding its crc32
+static uint64_t get_master_record_size_for_master_record_version(uint32_t master_record_version, uint32_t log_sequence_number_width)
 {
-	void* mr_serial = aligned_alloc(block_io_functions->block_size, block_io_functions->block_buffer_alignment);
+	return sizeof(uint32_t) + get_log_sequence_number_count_for_master_record_version(master_record_version) * log_sequence_number_width + ((master_record_version >= 2) ? sizeof(uint64_t) : 0) + ((master_record_version >= 3) ? sizeof(uint32_t) : 0);
+}
+
+int read_master_record(master_record* mr, const block_io_ops* block_io_functions, block_buffer_pool* pool, int* error)
+{
+	void* mr_serial = acquire_block_buffer(pool);
 	if(mr_serial == NULL)
 	{
 		(*error) = ALLOCATION_FAILED;
@@ -20,34 +55,58 @@ int read_master_record(master_record* mr, const block_io_ops* block_io_functions
 	if(!io_success)
 	{
 		(*error) = READ_IO_ERROR;
-		free(mr_serial);
+		release_block_buffer(pool, mr_serial);
 		return 0;
 	}
 
 	// deserialize
-	mr->log_sequence_number_width = deserialize_uint32(mr_serial, sizeof(uint32_t));
+	uint32_t width_and_version = deserialize_uint32(mr_serial, sizeof(uint32_t));
+	uint32_t master_record_version = width_and_version >> MASTER_RECORD_VERSION_BITS_OFFSET;
+	mr->log_sequence_number_width = width_and_version & ((UINT32_C(1) << MASTER_RECORD_VERSION_BITS_OFFSET) - 1);
+
+	if(master_record_version > MASTER_RECORD_VERSION)
+	{
+		(*error) = MASTER_RECORD_CORRUPTED;
+		release_block_buffer(pool, mr_serial);
+		return 0;
+	}
 
 	if(mr->log_sequence_number_width == 0 || mr->log_sequence_number_width > get_max_bytes_uint256())
 	{
 		(*error) = LOG_SEQUENCE_NUMBER_UNREPRESENTABLE;
-		free(mr_serial);
+		release_block_buffer(pool, mr_serial);
 		return 0;
 	}
 
+	uint32_t log_sequence_number_count = get_log_sequence_number_count_for_master_record_version(master_record_version);
+	uint64_t master_record_size = get_master_record_size_for_master_record_version(master_record_version, mr->log_sequence_number_width);
+
 	mr->first_log_sequence_number = deserialize_uint256(mr_serial + sizeof(uint32_t), mr->log_sequence_number_width);
 	mr->last_flushed_log_sequence_number = deserialize_uint256(mr_serial + sizeof(uint32_t) + mr->log_sequence_number_width, mr->log_sequence_number_width);
 	mr->check_point_log_sequence_number = deserialize_uint256(mr_serial + sizeof(uint32_t) + 2 * mr->log_sequence_number_width, mr->log_sequence_number_width);
 	mr->next_log_sequence_number = deserialize_uint256(mr_serial + sizeof(uint32_t) + 3 * mr->log_sequence_number_width, mr->log_sequence_number_width);
-
-	uint32_t parsed_crc32 = deserialize_uint32(mr_serial + sizeof(uint32_t) + 4 * mr->log_sequence_number_width, sizeof(uint32_t));
+	if(master_record_version >= 1)
+		mr->base_log_sequence_number = deserialize_uint256(mr_serial + sizeof(uint32_t) + 4 * mr->log_sequence_number_width, mr->log_sequence_number_width);
+	else // older master records were never truncated from the front
+		mr->base_log_sequence_number = mr->first_log_sequence_number;
+	if(master_record_version >= 2)
+		mr->ring_block_count = deserialize_uint64(mr_serial + sizeof(uint32_t) + log_sequence_number_count * mr->log_sequence_number_width, sizeof(uint64_t));
+	else // older master records were never in ring mode
+		mr->ring_block_count = 0;
+	if(master_record_version >= 3)
+		mr->log_record_format_version = deserialize_uint32(mr_serial + sizeof(uint32_t) + log_sequence_number_count * mr->log_sequence_number_width + sizeof(uint64_t), sizeof(uint32_t));
+	else // older master records only had the log records in the LOG_RECORD_FORMAT_V1
+		mr->log_record_format_version = LOG_RECORD_FORMAT_V1;
+
+	uint32_t parsed_crc32 = deserialize_uint32(mr_serial + master_record_size, sizeof(uint32_t));
 
 	// calculate crc32 for master record, NOTE :: we can not calculate crc32 without reading the log_sequence_number_width
 	uint32_t calculated_crc32 = crc32_init();
-	calculated_crc32 = crc32_util(calculated_crc32, mr_serial, sizeof(uint32_t) + 4 * mr->log_sequence_number_width);
+	calculated_crc32 = crc32_util(calculated_crc32, mr_serial, master_record_size);
 
-	free(mr_serial);
+	release_block_buffer(pool, mr_serial);
 
-	if(calculated_crc32 != parsed_crc32)
+	if(calculated_crc32 != parsed_crc32 || mr->log_record_format_version < LOG_RECORD_FORMAT_V1 || mr->log_record_format_version > LOG_RECORD_FORMAT_V2)
 	{
 		(*error) = MASTER_RECORD_CORRUPTED;
 		return 0;
@@ -56,33 +115,42 @@ int read_master_record(master_record* mr, const block_io_ops* block_io_functions
 	return 1;
 }
 
-int write_and_flush_master_record(const master_record* mr, const block_io_ops* block_io_functions, int* error)
+int write_and_flush_master_record(const master_record* mr, const block_io_ops* block_io_functions, block_buffer_pool* pool, int* error)
 {
-	void* mr_serial = aligned_alloc(block_io_functions->block_size, block_io_functions->block_buffer_alignment);
+	void* mr_serial = acquire_block_buffer(pool);
 	if(mr_serial == NULL)
 	{
 		(*error) = ALLOCATION_FAILED;
 		return 0;
 	}
 
+	uint32_t log_sequence_number_count = get_log_sequence_number_count_for_master_record_version(MASTER_RECORD_VERSION);
+	uint64_t master_record_size = get_master_record_size_for_master_record_version(MASTER_RECORD_VERSION, mr->log_sequence_number_width);
+
 	// serialize
-	serialize_uint32(mr_serial, sizeof(uint32_t), mr->log_sequence_number_width);
+	serialize_uint32(mr_serial, sizeof(uint32_t), mr->log_sequence_number_width | (MASTER_RECORD_VERSION << MASTER_RECORD_VERSION_BITS_OFFSET));
 	serialize_uint256(mr_serial + sizeof(uint32_t), mr->log_sequence_number_width, mr->first_log_sequence_number);
 	serialize_uint256(mr_serial + sizeof(uint32_t) + mr->log_sequence_number_width, mr->log_sequence_number_width, mr->last_flushed_log_sequence_number);
 	serialize_uint256(mr_serial + sizeof(uint32_t) + 2 * mr->log_sequence_number_width, mr->log_sequence_number_width, mr->check_point_log_sequence_number);
 	serialize_uint256(mr_serial + sizeof(uint32_t) + 3 * mr->log_sequence_number_width, mr->log_sequence_number_width, mr->next_log_sequence_number);
+	serialize_uint256(mr_serial + sizeof(uint32_t) + 4 * mr->log_sequence_number_width, mr->log_sequence_number_width, mr->base_log_sequence_number);
+	serialize_uint64(mr_serial + sizeof(uint32_t) + log_sequence_number_count * mr->log_sequence_number_width, sizeof(uint64_t), mr->ring_block_count);
+	serialize_uint32(mr_serial + sizeof(uint32_t) + log_sequence_number_count * mr->log_sequence_number_width + sizeof(uint64_t), sizeof(uint32_t), mr->log_record_format_version);
 
 	// calculate crc32 for master record
 	uint32_t calculated_crc32 = crc32_init();
-	calculated_crc32 = crc32_util(calculated_crc32, mr_serial, sizeof(uint32_t) + 4 * mr->log_sequence_number_width);
+	calculated_crc32 = crc32_util(calculated_crc32, mr_serial, master_record_size);
 
 	// write calculated_crc32 on the mr_serial
-	serialize_uint32(mr_serial + sizeof(uint32_t) + 4 * mr->log_sequence_number_width, sizeof(uint32_t), calculated_crc32);
+	serialize_uint32(mr_serial + master_record_size, sizeof(uint32_t), calculated_crc32);
 
-	int io_success = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, mr_serial, 0, 1)
-						&& block_io_functions->flush_all_writes(block_io_functions->block_io_ops_handle);
+	// a durable write of the block 0 persists only the master record, without flushing any other writes
+	int io_success = (block_io_functions->write_blocks_durable != NULL)
+						? block_io_functions->write_blocks_durable(block_io_functions->block_io_ops_handle, mr_serial, 0, 1)
+						: (block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, mr_serial, 0, 1)
+						&& block_io_functions->flush_all_writes(block_io_functions->block_io_ops_handle));
 
-	free(mr_serial);
+	release_block_buffer(pool, mr_serial);
 
 	if(!io_success)
 	{
@@ -115,6 +183,31 @@ uint64_t read_latest_vacant_block_using_master_record(void* buffer, const master
 	return file_offset;
 }
 
+// file_offset = log_sequence_number - base_log_sequence_number + block_size
+// the log_sequence_numbers of atmost 8 bytes (almost all the WALe-s) are subtracted as uint64_t-s, the wider ones with the uint256 arithmetic
+// returns 0, if the log_sequence_number is before the base_log_sequence_number, or if the file_offset overflows
+static int get_file_offset_from_base_log_sequence_number(uint64_t* file_offset, uint256 log_sequence_number, const master_record* mr, const block_io_ops* block_io_functions)
+{
+	if(mr->log_sequence_number_width <= sizeof(uint64_t))
+	{
+		uint64_t log_sequence_number_64;
+		uint64_t base_log_sequence_number_64;
+		if(!cast_to_uint64_from_uint256(&log_sequence_number_64, log_sequence_number) ||
+			!cast_to_uint64_from_uint256(&base_log_sequence_number_64, mr->base_log_sequence_number) ||
+			log_sequence_number_64 < base_log_sequence_number_64 ||
+			will_unsigned_sum_overflow(uint64_t, (log_sequence_number_64 - base_log_sequence_number_64), block_io_functions->block_size))
+			return 0;
+
+		(*file_offset) = (log_sequence_number_64 - base_log_sequence_number_64) + block_io_functions->block_size;
+		return 1;
+	}
+
+	uint256 temp;
+	return sub_underflow_safe_uint256(&temp, log_sequence_number, mr->base_log_sequence_number) &&
+		add_overflow_safe_uint256(&temp, temp, get_uint256(block_io_functions->block_size), get_0_uint256()) &&
+		cast_to_uint64_from_uint256(file_offset, temp);
+}
+
 uint64_t get_file_offset_for_log_sequence_number(uint256 log_sequence_number, const master_record* mr, const block_io_ops* block_io_functions, int* error)
 {
 	// if the wale has no records, OR the log_sequence_number is not within first and last_flushed log_sequence_number then fail
@@ -129,17 +222,12 @@ uint64_t get_file_offset_for_log_sequence_number(uint256 log_sequence_number, co
 	}
 
 	// calculate the offset in file of the log_record at log_sequence_number
-	uint64_t file_offset; // = log_sequence_number - wale_p->on_disk_master_record.first_log_sequence_number + wale_p->block_io_functions.block_size;
+	uint64_t file_offset; // = log_sequence_number - wale_p->on_disk_master_record.base_log_sequence_number + wale_p->block_io_functions.block_size;
+	if(!get_file_offset_from_base_log_sequence_number(&file_offset, log_sequence_number, mr, block_io_functions))
 	{
-		uint256 temp;
-		if(	!sub_underflow_safe_uint256(&temp, log_sequence_number, mr->first_log_sequence_number) ||
-			!add_overflow_safe_uint256(&temp, temp, get_uint256(block_io_functions->block_size), get_0_uint256()) ||
-			!cast_to_uint64_from_uint256(&file_offset, temp))
-		{
-			// this case will not ever happen, but just so to handle it
-			(*error) = PARAM_INVALID;
-			return 0;
-		}
+		// this case will not ever happen, but just so to handle it
+		(*error) = PARAM_INVALID;
+		return 0;
 	}
 
 	return file_offset;
@@ -153,18 +241,13 @@ uint64_t get_file_offset_for_next_log_sequence_number(const master_record* mr, c
 		return block_io_functions->block_size;
 
 	// calculate file_offset of next_log_sequence_number
-	// = next_log_sequence_number - first_log_sequence_number + block_size
+	// = next_log_sequence_number - base_log_sequence_number + block_size
 	uint64_t file_offset;
+	if(!get_file_offset_from_base_log_sequence_number(&file_offset, mr->next_log_sequence_number, mr, block_io_functions))
 	{
-		uint256 temp; // = next_log_sequence_number - first_log_sequence_number + block_size
-		if(	(!sub_underflow_safe_uint256(&temp, mr->next_log_sequence_number, mr->first_log_sequence_number)) ||
-			(!add_overflow_safe_uint256(&temp, temp, get_uint256(block_io_functions->block_size), get_0_uint256())) ||
-			(!cast_to_uint64_from_uint256(&file_offset, temp)) )
-		{
-			// this implies master record is corrupted
-			(*error) = MASTER_RECORD_CORRUPTED;
-			return 0;
-		}
+		// this implies master record is corrupted
+		(*error) = MASTER_RECORD_CORRUPTED;
+		return 0;
 	}
 
 	return file_offset;
@@ -1,82 +1,94 @@
 #include<util_random_read.h>
 
+#include<block_io_ops_util.h>
+#include<crc32_util.h>
+
 #include<cutlery_stds.h>
 #include<cutlery_math.h>
 
-#include<stdlib.h>
+// a large read is scattered into upto BLOCK_BUFFERS_PER_READ pooled buffers, with a single vectored io
+#define BLOCK_BUFFERS_PER_READ 4
 
-int random_read_at(void* buffer, uint64_t buffer_size, uint64_t file_offset, const block_io_ops* block_io_functions)
+// reads the bytes in the range [file_offset, file_offset + data_size) block by block, through the pooled buffers
+// and passes them in order to the consume function, as (data, offset of data from file_offset, size of data)
+static int read_through_block_buffers(uint64_t data_size, uint64_t file_offset, const block_io_ops* block_io_functions, block_buffer_pool* pool, void (*consume)(void* context, const void* data, uint64_t data_offset, uint64_t size), void* context)
 {
-	if(buffer_size == 0)
-		return 1;
-
-	// make sure that the last offset to be written does not overflow (as we know buffer_size != 0)
-	// last_offset to be written = file_offset + (buffer_size - 1)
-	if(will_unsigned_sum_overflow(uint64_t, file_offset, (buffer_size - 1)))
+	// make sure that the last offset to be read does not overflow (as we know data_size != 0)
+	// last_offset to be read = file_offset + (data_size - 1)
+	if(will_unsigned_sum_overflow(uint64_t, file_offset, (data_size - 1)))
 		return 0;
 
 	// calculate the end offset
-	uint64_t end_offset = file_offset + buffer_size;
+	uint64_t end_offset = file_offset + data_size;
 
-	uint64_t first_block_id = UINT_ALIGN_DOWN(file_offset, block_io_functions->block_size) / block_io_functions->block_size;
-	uint64_t end_block_id = UINT_ALIGN_UP(end_offset, block_io_functions->block_size) / block_io_functions->block_size;
+	uint64_t first_block_id = get_block_id_from_file_offset(file_offset, block_io_functions);
+	uint64_t end_block_id = get_block_count_for_size(end_offset, block_io_functions);
 
-	void* blocks_of_concern = aligned_alloc(block_io_functions->block_buffer_alignment, (end_block_id - first_block_id) * block_io_functions->block_size);
-	if(blocks_of_concern == NULL)
+	// acquire only as many buffers as the blocks need, it is alright to go with lesser buffers, if the pool fails to allocate them
+	void* buffers[BLOCK_BUFFERS_PER_READ];
+	uint64_t buffers_needed = min(UINT_ALIGN_UP(end_block_id - first_block_id, pool->block_count) / pool->block_count, BLOCK_BUFFERS_PER_READ);
+	uint64_t buffer_count = 0;
+	for(; buffer_count < buffers_needed; buffer_count++)
+	{
+		buffers[buffer_count] = acquire_block_buffer(pool);
+		if(buffers[buffer_count] == NULL)
+			break;
+	}
+	if(buffer_count == 0)
 		return 0;
 
-	if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, blocks_of_concern, first_block_id, end_block_id - first_block_id))
+	int io_success = 1;
+	for(uint64_t block_id = first_block_id; block_id < end_block_id && io_success; block_id += buffer_count * pool->block_count)
 	{
-		free(blocks_of_concern);
-		return 0;
-	}
+		// scatter the next run of blocks across the buffers
+		block_io_vector vectors[BLOCK_BUFFERS_PER_READ];
+		uint64_t vector_count = 0;
+		for(uint64_t vector_block_id = block_id; vector_block_id < end_block_id && vector_count < buffer_count; vector_block_id += pool->block_count, vector_count++)
+			vectors[vector_count] = (block_io_vector){.buffer = buffers[vector_count], .block_id = vector_block_id, .block_count = min(pool->block_count, end_block_id - vector_block_id)};
 
-	memory_move(buffer, blocks_of_concern + (file_offset % block_io_functions->block_size), buffer_size);
+		io_success = read_block_vectors(block_io_functions, vectors, vector_count);
+		if(!io_success)
+			break;
 
-	free(blocks_of_concern);
-	return 1;
+		for(uint64_t i = 0; i < vector_count; i++)
+		{
+			uint64_t start = max(file_offset, vectors[i].block_id * block_io_functions->block_size);
+			uint64_t end = min(end_offset, (vectors[i].block_id + vectors[i].block_count) * block_io_functions->block_size);
+
+			consume(context, vectors[i].buffer + (start - vectors[i].block_id * block_io_functions->block_size), start - file_offset, end - start);
+		}
+	}
+
+	for(uint64_t i = 0; i < buffer_count; i++)
+		release_block_buffer(pool, buffers[i]);
+	return io_success;
 }
 
-#include<crc32_util.h>
+static void copy_into_buffer(void* buffer, const void* data, uint64_t data_offset, uint64_t size)
+{
+	memory_move(buffer + data_offset, data, size);
+}
 
-// this function is implemented with minimal memory usage
-int crc32_at(uint32_t* crc, uint64_t data_size, uint64_t file_offset, const block_io_ops* block_io_functions)
+int random_read_at(void* buffer, uint64_t buffer_size, uint64_t file_offset, const block_io_ops* block_io_functions, block_buffer_pool* pool)
 {
-	if(data_size == 0)
-	{
-		(*crc) = crc32_util((*crc), NULL, 0);
+	if(buffer_size == 0)
 		return 1;
-	}
-
-	// make sure that the last offset to be crc-ed does not overflow (as we know buffer_size != 0)
-	// last_offset to be crc-ed = file_offset + (buffer_size - 1)
-	if(will_unsigned_sum_overflow(uint64_t, file_offset, (data_size - 1)))
-		return 0;
 
-	// calculate the end offset
-	uint64_t end_offset = file_offset + data_size;
-
-	uint64_t first_block_id = UINT_ALIGN_DOWN(file_offset, block_io_functions->block_size) / block_io_functions->block_size;
-	uint64_t end_block_id = UINT_ALIGN_UP(end_offset, block_io_functions->block_size) / block_io_functions->block_size;
+	return read_through_block_buffers(buffer_size, file_offset, block_io_functions, pool, copy_into_buffer, buffer);
+}
 
-	void* block = aligned_alloc(block_io_functions->block_buffer_alignment, block_io_functions->block_size);
-	if(block == NULL)
-		return 0;
+static void accumulate_crc32(void* crc, const void* data, uint64_t data_offset, uint64_t size)
+{
+	(*((uint32_t*)crc)) = crc32_util((*((uint32_t*)crc)), data, size);
+}
 
-	for(uint64_t block_id = first_block_id; block_id != end_block_id; block_id++)
+int crc32_at(uint32_t* crc, uint64_t data_size, uint64_t file_offset, const block_io_ops* block_io_functions, block_buffer_pool* pool)
+{
+	if(data_size == 0)
 	{
-		if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, block, block_id, 1))
-		{
-			free(block);
-			return 0;
-		}
-
-		uint64_t start = max(file_offset, block_id * block_io_functions->block_size);
-		uint64_t end = min(end_offset, (block_id + 1) * block_io_functions->block_size);
-
-		(*crc) = crc32_util((*crc), block + (start % block_io_functions->block_size), end - start);
+		(*crc) = crc32_util((*crc), NULL, 0);
+		return 1;
 	}
 
-	free(block);
-	return 1;
+	return read_through_block_buffers(data_size, file_offset, block_io_functions, pool, accumulate_crc32, crc);
 }
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include<util_ring_block_io.h>
+
+#include<util_master_record.h>
+#include<block_io_ops_util.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<stdlib.h>
+
+// maps the block_id onto the ring, and returns the number of contiguous blocks (upto block_count) that can be accessed at the returned block_id in the underlying_block_io_functions
+static uint64_t map_block_id_onto_ring(const wale* wale_p, uint64_t block_id, uint64_t block_count, uint64_t* ring_block_id)
+{
+	// block 0 is the master record, and is not a part of the ring
+	if(block_id == 0)
+	{
+		(*ring_block_id) = 0;
+		return 1;
+	}
+
+	uint64_t ring_block_index = (block_id - 1) % wale_p->ring_block_count;
+	(*ring_block_id) = 1 + ring_block_index;
+	return min(block_count, wale_p->ring_block_count - ring_block_index);
+}
+
+// number of the runs of blocks in the underlying_block_io_functions, that are performed with a single vectored io
+#define RING_VECTORS_PER_IO 16
+
+// maps the vectors onto the ring, splitting the runs that wrap around the end of the ring
+// so that a run that wraps around is still performed with a single vectored io on the underlying_block_io_functions
+static int perform_block_vectors_on_ring(const wale* wale_p, const block_io_vector* vectors, uint64_t vector_count, int is_write)
+{
+	const block_io_ops* underlying = &(wale_p->underlying_block_io_functions);
+
+	block_io_vector ring_vectors[RING_VECTORS_PER_IO];
+	uint64_t ring_vector_count = 0;
+
+	for(uint64_t i = 0; i < vector_count; i++)
+	{
+		void* buffer = vectors[i].buffer;
+		uint64_t block_id = vectors[i].block_id;
+		uint64_t block_count = vectors[i].block_count;
+
+		while(block_count > 0)
+		{
+			if(ring_vector_count == RING_VECTORS_PER_IO)
+			{
+				if(!(is_write ? write_block_vectors(underlying, ring_vectors, ring_vector_count) : read_block_vectors(underlying, ring_vectors, ring_vector_count)))
+					return 0;
+				ring_vector_count = 0;
+			}
+
+			uint64_t ring_block_id;
+			uint64_t blocks_to_access = map_block_id_onto_ring(wale_p, block_id, block_count, &ring_block_id);
+
+			ring_vectors[ring_vector_count++] = (block_io_vector){.buffer = buffer, .block_id = ring_block_id, .block_count = blocks_to_access};
+
+			buffer += (blocks_to_access * underlying->block_size);
+			block_id += blocks_to_access;
+			block_count -= blocks_to_access;
+		}
+	}
+
+	return is_write ? write_block_vectors(underlying, ring_vectors, ring_vector_count) : read_block_vectors(underlying, ring_vectors, ring_vector_count);
+}
+
+static int read_blocks_from_ring(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	return perform_block_vectors_on_ring(block_io_ops_handle, &((block_io_vector){.buffer = dest, .block_id = block_id, .block_count = block_count}), 1, 0);
+}
+
+static int write_blocks_to_ring(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	return perform_block_vectors_on_ring(block_io_ops_handle, &((block_io_vector){.buffer = (void*)src, .block_id = block_id, .block_count = block_count}), 1, 1);
+}
+
+static int read_blocks_v_from_ring(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	return perform_block_vectors_on_ring(block_io_ops_handle, vectors, vector_count, 0);
+}
+
+static int write_blocks_v_to_ring(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	return perform_block_vectors_on_ring(block_io_ops_handle, vectors, vector_count, 1);
+}
+
+// a durable write that wraps around the ring, is performed as a durable write on both the sides of the wrap around
+static int write_blocks_durable_to_ring(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	const wale* wale_p = block_io_ops_handle;
+	const block_io_ops* underlying = &(wale_p->underlying_block_io_functions);
+
+	while(block_count > 0)
+	{
+		uint64_t ring_block_id;
+		uint64_t blocks_to_write = map_block_id_onto_ring(wale_p, block_id, block_count, &ring_block_id);
+
+		if(!underlying->write_blocks_durable(underlying->block_io_ops_handle, src, ring_block_id, blocks_to_write))
+			return 0;
+
+		src += (blocks_to_write * underlying->block_size);
+		block_id += blocks_to_write;
+		block_count -= blocks_to_write;
+	}
+
+	return 1;
+}
+
+static int flush_all_writes_to_ring(const void* block_io_ops_handle)
+{
+	const wale* wale_p = block_io_ops_handle;
+	const block_io_ops* underlying = &(wale_p->underlying_block_io_functions);
+
+	return underlying->flush_all_writes(underlying->block_io_ops_handle);
+}
+
+block_io_ops get_ring_block_io_ops(const wale* wale_p)
+{
+	return (block_io_ops){
+		.block_io_ops_handle = wale_p,
+		.block_size = wale_p->underlying_block_io_functions.block_size,
+		.block_buffer_alignment = wale_p->underlying_block_io_functions.block_buffer_alignment,
+		.read_blocks = read_blocks_from_ring,
+		.write_blocks = write_blocks_to_ring,
+		.flush_all_writes = flush_all_writes_to_ring,
+		.punch_hole_blocks = NULL, // blocks of the ring are reused, they are never to be reclaimed
+		.read_blocks_v = read_blocks_v_from_ring,
+		.write_blocks_v = write_blocks_v_to_ring,
+		.write_blocks_durable = (wale_p->underlying_block_io_functions.write_blocks_durable == NULL) ? NULL : write_blocks_durable_to_ring,
+	};
+}
+
+int is_there_space_in_ring_until(const wale* wale_p, const master_record* mr, uint64_t end_file_offset, int* error)
+{
+	// if there are no log records, then the next log record goes at the block 1
+	uint64_t first_file_offset = wale_p->block_io_functions.block_size;
+	if(!are_equal_uint256(mr->first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		first_file_offset = get_file_offset_for_log_sequence_number(mr->first_log_sequence_number, mr, &(wale_p->block_io_functions), error);
+		if(*error)
+			return 0;
+	}
+
+	// the ring can hold ring_block_count blocks starting with the block of the first log record
+	uint64_t first_block_file_offset = UINT_ALIGN_DOWN(first_file_offset, wale_p->block_io_functions.block_size);
+	if(will_unsigned_mul_overflow(uint64_t, wale_p->ring_block_count, wale_p->block_io_functions.block_size) ||
+		will_unsigned_sum_overflow(uint64_t, first_block_file_offset, wale_p->ring_block_count * wale_p->block_io_functions.block_size))
+		return 1;
+
+	return end_file_offset <= first_block_file_offset + wale_p->ring_block_count * wale_p->block_io_functions.block_size;
+}
+
+// number of blocks in the zeroed buffer, it is written ZERO_OUT_WRITES_PER_IO times with a single vectored io
+#define ZERO_OUT_BLOCKS_PER_WRITE UINT64_C(64)
+#define ZERO_OUT_WRITES_PER_IO 16
+
+int zero_out_ring_blocks(const block_io_ops* underlying_block_io_functions, uint64_t ring_block_count, int* error)
+{
+	uint64_t blocks_per_write = min(ring_block_count, ZERO_OUT_BLOCKS_PER_WRITE);
+
+	void* zero_blocks = aligned_alloc(underlying_block_io_functions->block_buffer_alignment, blocks_per_write * underlying_block_io_functions->block_size);
+	if(zero_blocks == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+	memory_set(zero_blocks, 0, blocks_per_write * underlying_block_io_functions->block_size);
+
+	block_io_vector zero_vectors[ZERO_OUT_WRITES_PER_IO];
+	uint64_t zero_vector_count = 0;
+	for(uint64_t block_id = 1; block_id <= ring_block_count; block_id += blocks_per_write)
+	{
+		zero_vectors[zero_vector_count++] = (block_io_vector){.buffer = zero_blocks, .block_id = block_id, .block_count = min(blocks_per_write, ring_block_count + 1 - block_id)};
+
+		// write out the vectors, once they are full or at the last of the ring blocks
+		if(zero_vector_count == ZERO_OUT_WRITES_PER_IO || block_id + blocks_per_write > ring_block_count)
+		{
+			if(!write_block_vectors(underlying_block_io_functions, zero_vectors, zero_vector_count))
+			{
+				(*error) = WRITE_IO_ERROR;
+				free(zero_blocks);
+				return 0;
+			}
+			zero_vector_count = 0;
+		}
+	}
+
+	free(zero_blocks);
+
+	if(!underlying_block_io_functions->flush_all_writes(underlying_block_io_functions->block_io_ops_handle))
+	{
+		(*error) = WRITE_IO_ERROR;
+		return 0;
+	}
+
+	return 1;
+}
\ No newline at end of file
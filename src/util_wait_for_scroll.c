@@ -0,0 +1,136 @@
+#include<util_wait_for_scroll.h>
+
+#include<wale_get_lock_util.h>
+#include<util_wale_stats.h>
+
+#include<unistd.h>
+
+static void cpu_relax()
+{
+	#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+	#elif defined(__aarch64__)
+		__asm__ __volatile__("yield");
+	#endif
+}
+
+void initialize_scroll_waiters(wale* wale_p)
+{
+	wale_p->scroll_waiters_head = NULL;
+	wale_p->scroll_waiters_tail = NULL;
+	wale_p->woken_scroll_waiters_bytes = 0;
+	wale_p->scroll_generation = 0;
+	wale_p->is_scrolling_append_only_buffer = 0;
+
+	// spinning is just a waste of cpu, if the scroller can not run in parallel
+	wale_p->scroll_wait_spin_limit = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MIN_SCROLL_WAIT_SPIN_LIMIT : 0;
+}
+
+// spins with the global lock released, until the scroll_generation changes or the spin limit is reached
+// returns 1, if the scroll_generation changed
+static int spin_for_scroll(wale* wale_p)
+{
+	uint64_t scroll_generation = wale_p->scroll_generation;
+	uint32_t spin_limit = wale_p->scroll_wait_spin_limit;
+
+	pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	int scrolled = 0;
+	for(uint32_t i = 0; i < spin_limit && !scrolled; i++)
+	{
+		cpu_relax();
+		scrolled = (__atomic_load_n(&(wale_p->scroll_generation), __ATOMIC_RELAXED) != scroll_generation);
+	}
+
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	scrolled = (wale_p->scroll_generation != scroll_generation);
+
+	// adapt the spin limit, for the next waiter
+	if(scrolled)
+		wale_p->scroll_wait_spin_limit = (spin_limit * 2 > MAX_SCROLL_WAIT_SPIN_LIMIT) ? MAX_SCROLL_WAIT_SPIN_LIMIT : (spin_limit * 2);
+	else
+		wale_p->scroll_wait_spin_limit = (spin_limit / 2 < MIN_SCROLL_WAIT_SPIN_LIMIT) ? MIN_SCROLL_WAIT_SPIN_LIMIT : (spin_limit / 2);
+
+	return scrolled;
+}
+
+int wait_for_scroll(wale* wale_p, uint64_t total_bytes_to_write, int is_retry)
+{
+	// a retrying waiter has already waited its turn in the queue, so it does not spin again
+	if(!is_retry && wale_p->scroll_wait_spin_limit > 0 && spin_for_scroll(wale_p))
+		return 0;
+
+	wale_scroll_waiter waiter = {
+		.total_bytes_to_write = total_bytes_to_write,
+		.is_woken = 0,
+		.reserved_bytes = 0,
+		.next = NULL,
+	};
+	pthread_cond_init(&(waiter.wake_up), NULL);
+
+	// enqueue the waiter, at the front if it is retrying, else at the back
+	if(wale_p->scroll_waiters_head == NULL)
+		wale_p->scroll_waiters_head = wale_p->scroll_waiters_tail = &waiter;
+	else if(is_retry)
+	{
+		waiter.next = wale_p->scroll_waiters_head;
+		wale_p->scroll_waiters_head = &waiter;
+	}
+	else
+	{
+		wale_p->scroll_waiters_tail->next = &waiter;
+		wale_p->scroll_waiters_tail = &waiter;
+	}
+
+	// the waiter is dequeued by the thread that wakes it up
+	while(!waiter.is_woken)
+		pthread_cond_wait_recording_wait(wale_p, &(waiter.wake_up), get_wale_lock(wale_p));
+
+	// the space reserved for this waiter is now for it to take, (or to lose to the new appenders)
+	wale_p->woken_scroll_waiters_bytes -= waiter.reserved_bytes;
+
+	pthread_cond_destroy(&(waiter.wake_up));
+
+	return 1;
+}
+
+// dequeues and wakes up the waiter at the head of the queue, reserving reserved_bytes for it
+static void wake_up_first_scroll_waiter(wale* wale_p, uint64_t reserved_bytes)
+{
+	wale_scroll_waiter* waiter = wale_p->scroll_waiters_head;
+
+	wale_p->scroll_waiters_head = waiter->next;
+	if(wale_p->scroll_waiters_head == NULL)
+		wale_p->scroll_waiters_tail = NULL;
+
+	waiter->is_woken = 1;
+	waiter->reserved_bytes = reserved_bytes;
+	wale_p->woken_scroll_waiters_bytes += reserved_bytes;
+
+	pthread_cond_signal(&(waiter->wake_up));
+}
+
+void wake_up_scroll_waiters(wale* wale_p)
+{
+	__atomic_store_n(&(wale_p->scroll_generation), wale_p->scroll_generation + 1, __ATOMIC_RELAXED);
+
+	// a waiter can take a slot, if its log record starts within the append only buffer
+	// the woken waiters take their slots in the order that they were woken up (unless new appenders take them first)
+	uint64_t buffer_size = wale_p->buffer_block_count * wale_p->block_io_functions.block_size;
+	uint64_t next_slot = wale_p->append_offset + wale_p->woken_scroll_waiters_bytes;
+	while(wale_p->scroll_waiters_head != NULL && next_slot < buffer_size)
+	{
+		uint64_t total_bytes_to_write = wale_p->scroll_waiters_head->total_bytes_to_write;
+		wake_up_first_scroll_waiter(wale_p, total_bytes_to_write);
+		next_slot += total_bytes_to_write;
+	}
+}
+
+void wake_up_all_scroll_waiters(wale* wale_p)
+{
+	__atomic_store_n(&(wale_p->scroll_generation), wale_p->scroll_generation + 1, __ATOMIC_RELAXED);
+
+	while(wale_p->scroll_waiters_head != NULL)
+		wake_up_first_scroll_waiter(wale_p, 0);
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+
+#include<util_wale_stats.h>
+#include<util_wale_trace.h>
+#include<block_io_ops_util.h>
+
+#include<cutlery_stds.h>
+
+#include<stdlib.h>
+#include<sched.h>
+#include<time.h>
+
+int initialize_wale_stats(wale* wale_p)
+{
+	wale_p->stats_shards = aligned_alloc(_Alignof(wale_stats_shard), WALE_STATS_SHARD_COUNT * sizeof(wale_stats_shard));
+	if(wale_p->stats_shards == NULL)
+		return 0;
+
+	memory_set(wale_p->stats_shards, 0, WALE_STATS_SHARD_COUNT * sizeof(wale_stats_shard));
+	return 1;
+}
+
+void deinitialize_wale_stats(wale* wale_p)
+{
+	free(wale_p->stats_shards);
+	wale_p->stats_shards = NULL;
+}
+
+uint64_t get_wale_stats_time()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec) * UINT64_C(1000000000) + ((uint64_t)now.tv_nsec);
+}
+
+static wale_stats_shard* get_wale_stats_shard(wale* wale_p)
+{
+	int cpu = sched_getcpu();
+	return &(wale_p->stats_shards[(cpu < 0) ? 0 : (((unsigned int)cpu) % WALE_STATS_SHARD_COUNT)]);
+}
+
+static void atomic_add(uint64_t* value_p, uint64_t value)
+{
+	__atomic_fetch_add(value_p, value, __ATOMIC_RELAXED);
+}
+
+static void atomic_max(uint64_t* value_p, uint64_t value)
+{
+	uint64_t curr_value = __atomic_load_n(value_p, __ATOMIC_RELAXED);
+	while(curr_value < value && !__atomic_compare_exchange_n(value_p, &curr_value, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+// index of the bucket of the log-linear histogram, that the value falls in
+static uint32_t get_wale_stats_bucket_index(uint64_t value)
+{
+	if(value < (UINT64_C(1) << WALE_STATS_SUB_BUCKET_BITS))
+		return value;
+
+	uint32_t most_significant_bit = 63 - __builtin_clzll(value);
+	uint32_t sub_bucket = (value >> (most_significant_bit - WALE_STATS_SUB_BUCKET_BITS)) & ((UINT64_C(1) << WALE_STATS_SUB_BUCKET_BITS) - 1);
+	return ((most_significant_bit - WALE_STATS_SUB_BUCKET_BITS + 1) << WALE_STATS_SUB_BUCKET_BITS) + sub_bucket;
+}
+
+void add_to_wale_stats_counter(wale* wale_p, wale_stats_counter counter, uint64_t value)
+{
+	atomic_add(&(get_wale_stats_shard(wale_p)->counters[counter]), value);
+}
+
+void record_wale_stats_latency(wale* wale_p, wale_stats_latency latency, uint64_t start_time)
+{
+	uint64_t elapsed_ns = get_wale_stats_time() - start_time;
+
+	wale_stats_histogram* histogram = &(get_wale_stats_shard(wale_p)->latencies[latency]);
+	atomic_add(&(histogram->count), 1);
+	atomic_add(&(histogram->sum_ns), elapsed_ns);
+	atomic_max(&(histogram->max_ns), elapsed_ns);
+	atomic_add(&(histogram->buckets[get_wale_stats_bucket_index(elapsed_ns)]), 1);
+}
+
+static void record_wale_stats_lock_wait(wale* wale_p, wale_stats_lock lock, uint64_t start_time)
+{
+	uint64_t elapsed_ns = get_wale_stats_time() - start_time;
+
+	wale_stats_shard* shard = get_wale_stats_shard(wale_p);
+	atomic_add(&(shard->lock_waits[lock]), 1);
+	atomic_add(&(shard->lock_wait_ns[lock]), elapsed_ns);
+}
+
+void pthread_mutex_lock_recording_wait(wale* wale_p, pthread_mutex_t* mutex)
+{
+	if(pthread_mutex_trylock(mutex) == 0)
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	pthread_mutex_lock(mutex);
+	record_wale_stats_lock_wait(wale_p, WALE_STATS_GLOBAL_LOCK, start_time);
+}
+
+void pthread_cond_wait_recording_wait(wale* wale_p, pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+	uint64_t start_time = get_wale_stats_time();
+	pthread_cond_wait(cond, mutex);
+	record_wale_stats_lock_wait(wale_p, WALE_STATS_WAIT_FOR_SCROLL, start_time);
+}
+
+void read_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock, int lock_preference)
+{
+	if(read_lock(rwlock_p, lock_preference, NON_BLOCKING))
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	read_lock(rwlock_p, lock_preference, BLOCKING);
+	record_wale_stats_lock_wait(wale_p, lock, start_time);
+}
+
+void write_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock)
+{
+	if(write_lock(rwlock_p, NON_BLOCKING))
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	write_lock(rwlock_p, BLOCKING);
+	record_wale_stats_lock_wait(wale_p, lock, start_time);
+}
+
+void shared_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock, int lock_preference)
+{
+	if(shared_lock(rwlock_p, lock_preference, NON_BLOCKING))
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	shared_lock(rwlock_p, lock_preference, BLOCKING);
+	record_wale_stats_lock_wait(wale_p, lock, start_time);
+}
+
+void exclusive_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock)
+{
+	if(exclusive_lock(rwlock_p, NON_BLOCKING))
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	exclusive_lock(rwlock_p, BLOCKING);
+	record_wale_stats_lock_wait(wale_p, lock, start_time);
+}
+
+void upgrade_lock_recording_wait(wale* wale_p, rwlock* rwlock_p, wale_stats_lock lock)
+{
+	if(upgrade_lock(rwlock_p, NON_BLOCKING))
+		return;
+
+	uint64_t start_time = get_wale_stats_time();
+	upgrade_lock(rwlock_p, BLOCKING);
+	record_wale_stats_lock_wait(wale_p, lock, start_time);
+}
+
+static int read_blocks_counted(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	add_to_wale_stats_counter(wale_p, WALE_STATS_READ_IOS, 1);
+	add_to_wale_stats_counter(wale_p, WALE_STATS_READ_BYTES, block_count * counted->block_size);
+	trace_read_io(wale_p, block_id, block_count);
+
+	return counted->read_blocks(counted->block_io_ops_handle, dest, block_id, block_count);
+}
+
+static int write_blocks_counted(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	add_to_wale_stats_counter(wale_p, WALE_STATS_WRITE_IOS, 1);
+	add_to_wale_stats_counter(wale_p, WALE_STATS_WRITTEN_BYTES, block_count * counted->block_size);
+
+	return counted->write_blocks(counted->block_io_ops_handle, src, block_id, block_count);
+}
+
+// a vectored io is counted as a single io, as it is issued with a single call to the counted_block_io_functions
+static int read_blocks_v_counted(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	add_to_wale_stats_counter(wale_p, WALE_STATS_READ_IOS, 1);
+	for(uint64_t i = 0; i < vector_count; i++)
+	{
+		add_to_wale_stats_counter(wale_p, WALE_STATS_READ_BYTES, vectors[i].block_count * counted->block_size);
+		trace_read_io(wale_p, vectors[i].block_id, vectors[i].block_count);
+	}
+
+	return read_block_vectors(counted, vectors, vector_count);
+}
+
+static int write_blocks_v_counted(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	add_to_wale_stats_counter(wale_p, WALE_STATS_WRITE_IOS, 1);
+	for(uint64_t i = 0; i < vector_count; i++)
+		add_to_wale_stats_counter(wale_p, WALE_STATS_WRITTEN_BYTES, vectors[i].block_count * counted->block_size);
+
+	return write_block_vectors(counted, vectors, vector_count);
+}
+
+static int write_blocks_durable_counted(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	add_to_wale_stats_counter(wale_p, WALE_STATS_WRITE_IOS, 1);
+	add_to_wale_stats_counter(wale_p, WALE_STATS_WRITTEN_BYTES, block_count * counted->block_size);
+
+	return counted->write_blocks_durable(counted->block_io_ops_handle, src, block_id, block_count);
+}
+
+static int flush_all_writes_timed(const void* block_io_ops_handle)
+{
+	wale* wale_p = (wale*) block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	uint64_t start_time = get_wale_stats_time();
+	int result = counted->flush_all_writes(counted->block_io_ops_handle);
+	record_wale_stats_latency(wale_p, WALE_STATS_FLUSH_ALL_WRITES_LATENCY, start_time);
+
+	return result;
+}
+
+static int punch_hole_blocks_counted(const void* block_io_ops_handle, uint64_t block_id, uint64_t block_count)
+{
+	const wale* wale_p = block_io_ops_handle;
+	const block_io_ops* counted = &(wale_p->counted_block_io_functions);
+
+	return counted->punch_hole_blocks(counted->block_io_ops_handle, block_id, block_count);
+}
+
+block_io_ops get_stats_block_io_ops(const wale* wale_p)
+{
+	return (block_io_ops){
+		.block_io_ops_handle = wale_p,
+		.block_size = wale_p->counted_block_io_functions.block_size,
+		.block_buffer_alignment = wale_p->counted_block_io_functions.block_buffer_alignment,
+		.read_blocks = read_blocks_counted,
+		.write_blocks = write_blocks_counted,
+		.flush_all_writes = flush_all_writes_timed,
+		.punch_hole_blocks = (wale_p->counted_block_io_functions.punch_hole_blocks == NULL) ? NULL : punch_hole_blocks_counted,
+		.read_blocks_v = read_blocks_v_counted,
+		.write_blocks_v = write_blocks_v_counted,
+		.write_blocks_durable = (wale_p->counted_block_io_functions.write_blocks_durable == NULL) ? NULL : write_blocks_durable_counted,
+	};
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include<util_wale_trace.h>
+
+#ifdef WALE_USDT_PROBES
+
+// the probes record the addresses of their semaphores, so that the tracers may enable them
+#define _SDT_HAS_SEMAPHORES 1
+#include<sys/sdt.h>
+
+#define DEFINE_WALE_PROBE_SEMAPHORE(event) unsigned short WALE_PROBE_SEMAPHORE(event) __attribute__((unused)) __attribute__((section(".probes")))
+
+DEFINE_WALE_PROBE_SEMAPHORE(append_slot_reserved);
+DEFINE_WALE_PROBE_SEMAPHORE(scroll_begin);
+DEFINE_WALE_PROBE_SEMAPHORE(scroll_end);
+DEFINE_WALE_PROBE_SEMAPHORE(wait_for_scroll_begin);
+DEFINE_WALE_PROBE_SEMAPHORE(wait_for_scroll_end);
+DEFINE_WALE_PROBE_SEMAPHORE(flush_begin);
+DEFINE_WALE_PROBE_SEMAPHORE(flush_end);
+DEFINE_WALE_PROBE_SEMAPHORE(master_record_written);
+DEFINE_WALE_PROBE_SEMAPHORE(read_io);
+
+// the USDT probes receive the log_sequence_numbers saturated to a uint64_t
+static uint64_t get_uint64_for_probe(uint256 log_sequence_number)
+{
+	uint64_t result;
+	if(!cast_to_uint64_from_uint256(&result, log_sequence_number))
+		return UINT64_MAX;
+	return result;
+}
+
+#else
+
+// without the USDT probes, the events only call the registered callbacks
+#define DTRACE_PROBE1(provider, name, a1)
+#define DTRACE_PROBE3(provider, name, a1, a2, a3)
+#define DTRACE_PROBE4(provider, name, a1, a2, a3, a4)
+
+#endif
+
+#define CALLBACK_OF(wale_p, event) (((wale_p)->trace_callbacks != NULL) ? (wale_p)->trace_callbacks->event : NULL)
+
+void fire_trace_append_slot_reserved(const wale* wale_p, uint256 log_sequence_number, uint32_t log_record_size, uint64_t append_slot)
+{
+	DTRACE_PROBE4(wale, append_slot_reserved, wale_p, get_uint64_for_probe(log_sequence_number), log_record_size, append_slot);
+	if(CALLBACK_OF(wale_p, append_slot_reserved) != NULL)
+		wale_p->trace_callbacks->append_slot_reserved(wale_p->trace_callbacks->trace_handle, wale_p, log_sequence_number, log_record_size, append_slot);
+}
+
+void fire_trace_scroll_begin(const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count)
+{
+	DTRACE_PROBE3(wale, scroll_begin, wale_p, buffer_start_block_id, block_count);
+	if(CALLBACK_OF(wale_p, scroll_begin) != NULL)
+		wale_p->trace_callbacks->scroll_begin(wale_p->trace_callbacks->trace_handle, wale_p, buffer_start_block_id, block_count);
+}
+
+void fire_trace_scroll_end(const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count, int success)
+{
+	DTRACE_PROBE4(wale, scroll_end, wale_p, buffer_start_block_id, block_count, success);
+	if(CALLBACK_OF(wale_p, scroll_end) != NULL)
+		wale_p->trace_callbacks->scroll_end(wale_p->trace_callbacks->trace_handle, wale_p, buffer_start_block_id, block_count, success);
+}
+
+void fire_trace_wait_for_scroll_begin(const wale* wale_p)
+{
+	DTRACE_PROBE1(wale, wait_for_scroll_begin, wale_p);
+	if(CALLBACK_OF(wale_p, wait_for_scroll_begin) != NULL)
+		wale_p->trace_callbacks->wait_for_scroll_begin(wale_p->trace_callbacks->trace_handle, wale_p);
+}
+
+void fire_trace_wait_for_scroll_end(const wale* wale_p)
+{
+	DTRACE_PROBE1(wale, wait_for_scroll_end, wale_p);
+	if(CALLBACK_OF(wale_p, wait_for_scroll_end) != NULL)
+		wale_p->trace_callbacks->wait_for_scroll_end(wale_p->trace_callbacks->trace_handle, wale_p);
+}
+
+void fire_trace_flush_begin(const wale* wale_p)
+{
+	DTRACE_PROBE1(wale, flush_begin, wale_p);
+	if(CALLBACK_OF(wale_p, flush_begin) != NULL)
+		wale_p->trace_callbacks->flush_begin(wale_p->trace_callbacks->trace_handle, wale_p);
+}
+
+void fire_trace_flush_end(const wale* wale_p, uint256 last_flushed_log_sequence_number, int success)
+{
+	DTRACE_PROBE3(wale, flush_end, wale_p, get_uint64_for_probe(last_flushed_log_sequence_number), success);
+	if(CALLBACK_OF(wale_p, flush_end) != NULL)
+		wale_p->trace_callbacks->flush_end(wale_p->trace_callbacks->trace_handle, wale_p, last_flushed_log_sequence_number, success);
+}
+
+void fire_trace_master_record_written(const wale* wale_p, uint256 last_flushed_log_sequence_number, int success)
+{
+	DTRACE_PROBE3(wale, master_record_written, wale_p, get_uint64_for_probe(last_flushed_log_sequence_number), success);
+	if(CALLBACK_OF(wale_p, master_record_written) != NULL)
+		wale_p->trace_callbacks->master_record_written(wale_p->trace_callbacks->trace_handle, wale_p, last_flushed_log_sequence_number, success);
+}
+
+void fire_trace_read_io(const wale* wale_p, uint64_t block_id, uint64_t block_count)
+{
+	DTRACE_PROBE3(wale, read_io, wale_p, block_id, block_count);
+	if(CALLBACK_OF(wale_p, read_io) != NULL)
+		wale_p->trace_callbacks->read_io(wale_p->trace_callbacks->trace_handle, wale_p, block_id, block_count);
+}
\ No newline at end of file
@@ -6,6 +6,17 @@
 #include<util_append_only_buffer.h>
 #include<util_master_record.h>
 #include<block_io_ops_util.h>
+#include<util_ring_block_io.h>
+#include<util_log_record_compression.h>
+#include<util_wale_stats.h>
+#include<util_wale_trace.h>
+#include<util_wait_for_scroll.h>
+#include<util_flush_epochs.h>
+#include<util_block_buffer_pool.h>
+#include<util_log_sequence_number.h>
+
+#include<wale_archive.h>
+#include<wale_time_index.h>
 
 #include<rwlock.h>
 
@@ -16,19 +27,30 @@
 
 #include<stdlib.h>
 
+// write_and_flush_master_record(), counted and timed in the statistics of the wale_p, and traced
+static int write_and_flush_master_record_with_stats(wale* wale_p, const master_record* mr, int* error)
+{
+	uint64_t start_time = get_wale_stats_time();
+	int result = write_and_flush_master_record(mr, &(wale_p->block_io_functions), wale_p->block_buffers, error);
+	record_wale_stats_latency(wale_p, WALE_STATS_MASTER_RECORD_WRITE_LATENCY, start_time);
+	add_to_wale_stats_counter(wale_p, WALE_STATS_MASTER_RECORD_WRITES, 1);
+	trace_master_record_written(wale_p, mr->last_flushed_log_sequence_number, result);
+	return result;
+}
+
 static void prefix_to_acquire_flushed_log_records_reader_lock(wale* wale_p)
 {
 	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
-	read_lock(&(wale_p->flushed_log_records_lock), READ_PREFERRING, BLOCKING);
+	read_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK, READ_PREFERRING);
 
 	pthread_mutex_unlock(get_wale_lock(wale_p));
 }
 
 static void suffix_to_release_flushed_log_records_reader_lock(wale* wale_p)
 {
-	pthread_mutex_lock(get_wale_lock(wale_p));
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 	read_unlock(&(wale_p->flushed_log_records_lock));
 
@@ -44,6 +66,17 @@ static void suffix_to_release_flushed_log_records_reader_lock(wale* wale_p)
 	on_disk_master_record is just the cached structured copy of the master record on disk
 */
 
+// must be called with atleast a shared lock held on the flushed_log_records_lock
+// returns 1, if the log_sequence_number must be read from the attached archive, i.e. it is before the first_log_sequence_number (or the WALe has no log records)
+static int is_log_sequence_number_in_archive(const wale* wale_p, uint256 log_sequence_number)
+{
+	if(wale_p->archive == NULL)
+		return 0;
+
+	return are_equal_uint256(wale_p->on_disk_master_record.first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) ||
+		compare_uint256(log_sequence_number, wale_p->on_disk_master_record.first_log_sequence_number) < 0;
+}
+
 uint32_t get_log_sequence_number_width(wale* wale_p)
 {
 	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
@@ -61,6 +94,10 @@ uint256 get_first_log_sequence_number(wale* wale_p)
 
 	uint256 first_log_sequence_number = wale_p->on_disk_master_record.first_log_sequence_number;
 
+	// the attached archive holds the log records before the first_log_sequence_number
+	if(wale_p->archive != NULL && is_log_sequence_number_in_archive(wale_p, wale_p->archive->first_log_sequence_number))
+		first_log_sequence_number = wale_p->archive->first_log_sequence_number;
+
 	suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
 	return first_log_sequence_number;
@@ -72,6 +109,10 @@ uint256 get_last_flushed_log_sequence_number(wale* wale_p)
 
 	uint256 last_flushed_log_sequence_number = wale_p->on_disk_master_record.last_flushed_log_sequence_number;
 
+	// if there are no log records in the WALe, then the last one is in the attached archive
+	if(wale_p->archive != NULL && are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		last_flushed_log_sequence_number = wale_p->archive->last_log_sequence_number;
+
 	suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
 	return last_flushed_log_sequence_number;
@@ -99,38 +140,186 @@ uint256 get_next_log_sequence_number(wale* wale_p)
 	return next_log_sequence_number;
 }
 
+// LOG_RECORD_FORMAT_V1 header, excluding its crc32
+#define HEADER_SIZE UINT64_C(8)
+
+// the varints of the LOG_RECORD_FORMAT_V2 header never exceed (MAX_LOG_RECORD_SIZE << 1) | 1 or the slot size of a log record of MAX_LOG_RECORD_SIZE bytes, so they are atmost 5 bytes wide
+#define MAX_VARINT_SIZE 5
+
+// LOG_RECORD_FORMAT_V2 header after its 2 varints, i.e. the log_record_type and the header_check
+#define V2_HEADER_FIXED_SIZE 3
+#define V2_MAX_HEADER_SIZE (2 * MAX_VARINT_SIZE + V2_HEADER_FIXED_SIZE)
+
 typedef struct log_record_header log_record_header;
 struct log_record_header
 {
-	uint32_t prev_log_record_size;
+	// total bytes of the previous log record as stored (header, log_record and crc32-s)
+	uint64_t prev_log_record_slot_size;
+
+	// size of the log record as stored, without the COMPRESSED_LOG_RECORD_FLAG
 	uint32_t curr_log_record_size;
+
+	// set if the log record is stored compressed
+	int is_compressed;
+
+	// the log_record_type it was appended with, always 0 for the LOG_RECORD_FORMAT_V1
+	uint8_t log_record_type;
+
+	// bytes before the log record, i.e. the offset of the log record from the start of its header
+	uint32_t header_size;
+
+	// the header as read, the crc32 of a LOG_RECORD_FORMAT_V2 log record is calculated starting with it
+	char serial_header[max(HEADER_SIZE + 4, V2_MAX_HEADER_SIZE)];
 };
 
-#define HEADER_SIZE UINT64_C(8)
+// returns the number of bytes that the value takes as a varint
+static uint32_t get_varint_size(uint64_t value)
+{
+	uint32_t varint_size = 1;
+	while(value >= 0x80)
+	{
+		value >>= 7;
+		varint_size++;
+	}
+	return varint_size;
+}
 
-// 1 is success, 0 is failure
-static int parse_and_check_crc32_for_log_record_header_at(log_record_header* result, uint64_t file_offset, const block_io_ops* block_io_functions, int* error)
+// returns the number of bytes written to bytes
+static uint32_t serialize_varint(char* bytes, uint64_t value)
 {
-	char serial_header[HEADER_SIZE + 4];
+	uint32_t varint_size = 0;
+	while(value >= 0x80)
+	{
+		bytes[varint_size++] = (char)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	bytes[varint_size++] = (char)value;
+	return varint_size;
+}
 
-	// attempt read for the header at the file_offset
-	if(!random_read_at(serial_header, HEADER_SIZE + 4, file_offset, block_io_functions))
+// returns the number of bytes consumed from bytes, it returns 0, if there is no varint of atmost MAX_VARINT_SIZE bytes in the bytes_size bytes
+static uint32_t deserialize_varint(uint64_t* value, const char* bytes, uint32_t bytes_size)
+{
+	(*value) = 0;
+	for(uint32_t i = 0; i < min(bytes_size, MAX_VARINT_SIZE); i++)
 	{
-		(*error) = READ_IO_ERROR;
-		return 0;
+		(*value) |= ((uint64_t)(((uint8_t)bytes[i]) & 0x7f)) << (7 * i);
+		if(!(((uint8_t)bytes[i]) & 0x80))
+			return i + 1;
 	}
+	return 0;
+}
+
+// returns the total bytes that a log record of log_record_size (as stored) takes in the WALe file, following a log record of prev_log_record_slot_size
+static uint64_t get_log_record_slot_size(uint32_t log_record_format_version, uint64_t prev_log_record_slot_size, uint32_t log_record_size)
+{
+	if(log_record_format_version == LOG_RECORD_FORMAT_V1)
+		return HEADER_SIZE + ((uint64_t)log_record_size) + UINT64_C(8); // 8 for the 2 crc32 values of the header and the log record each
+
+	// the compression flag is the least significant bit, it never changes the size of the varint
+	return get_varint_size(prev_log_record_slot_size) + get_varint_size(((uint64_t)log_record_size) << 1) + V2_HEADER_FIXED_SIZE + ((uint64_t)log_record_size) + UINT64_C(4); // 4 for the combined crc32
+}
+
+// returns the header_check of the LOG_RECORD_FORMAT_V2 header, i.e. the lower 16 bits of the crc32 of the header bytes before it
+static uint16_t get_v2_header_check(const char* serial_header, uint32_t bytes_before_header_check)
+{
+	uint32_t calculated_crc32 = crc32_init();
+	calculated_crc32 = crc32_util(calculated_crc32, serial_header, bytes_before_header_check);
+	return calculated_crc32 & 0xffff;
+}
+
+// serializes the header of a log record of log_record_size (as stored) into the header, following a log record of prev_log_record_slot_size
+// returns the size of the header, and initializes the calculated_crc32 to the crc32 that the log record must be accumulated into
+static uint32_t serialize_log_record_header(char* header, uint32_t log_record_format_version, uint64_t prev_log_record_slot_size, uint32_t log_record_size, int is_compressed, uint8_t log_record_type, uint32_t* calculated_crc32)
+{
+	(*calculated_crc32) = crc32_init();
+
+	if(log_record_format_version == LOG_RECORD_FORMAT_V1)
+	{
+		// prev_log_record_size, i.e. the size of the previous log record as stored, and the log_record_size, along with the flag for the compressed log records
+		uint32_t prev_log_record_size = (prev_log_record_slot_size == 0) ? 0 : (prev_log_record_slot_size - HEADER_SIZE - UINT64_C(8));
+		serialize_uint32(header, sizeof(uint32_t), prev_log_record_size);
+		serialize_uint32(header + 4, sizeof(uint32_t), log_record_size | (is_compressed ? COMPRESSED_LOG_RECORD_FLAG : 0));
+
+		// the crc32 of the header, the crc32 of the log record starts afresh after it
+		serialize_uint32(header + HEADER_SIZE, sizeof(uint32_t), crc32_util(crc32_init(), header, HEADER_SIZE));
+		return HEADER_SIZE + 4;
+	}
+
+	// the varints of the header, the crc32 covers them along with the log record
+	uint32_t header_size = serialize_varint(header, prev_log_record_slot_size);
+	header_size += serialize_varint(header + header_size, (((uint64_t)log_record_size) << 1) | (!!is_compressed));
+	header[header_size++] = log_record_type;
+	serialize_uint32(header + header_size, sizeof(uint16_t), get_v2_header_check(header, header_size));
+	header_size += sizeof(uint16_t);
+	(*calculated_crc32) = crc32_util((*calculated_crc32), header, header_size);
+	return header_size;
+}
 
-	// calculate crc32 of the first 8 bytes
-	uint32_t calcuated_crc32 = crc32_init();
-	calcuated_crc32 = crc32_util(calcuated_crc32, serial_header, HEADER_SIZE);
+// 1 is success, 0 is failure
+// parses the header in result->serial_header, that holds the first min(bytes_available, sizeof(result->serial_header)) bytes of the log record
+// the header of a LOG_RECORD_FORMAT_V1 log record is checked using its crc32, and the header of a LOG_RECORD_FORMAT_V2 log record using its header_check
+// the whole log record must also be within the bytes_available
+static int parse_and_check_log_record_header(log_record_header* result, uint32_t log_record_format_version, uint64_t bytes_available, int* error)
+{
+	if(log_record_format_version == LOG_RECORD_FORMAT_V1)
+	{
+		if(bytes_available < HEADER_SIZE + 4)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return 0;
+		}
+
+		// calculate crc32 of the first 8 bytes
+		uint32_t calcuated_crc32 = crc32_init();
+		calcuated_crc32 = crc32_util(calcuated_crc32, result->serial_header, HEADER_SIZE);
+
+		// deserialize all the fields
+		uint32_t prev_log_record_size = deserialize_uint32(result->serial_header + 0, sizeof(uint32_t));
+		result->prev_log_record_slot_size = get_log_record_slot_size(LOG_RECORD_FORMAT_V1, 0, prev_log_record_size);
+		result->curr_log_record_size = deserialize_uint32(result->serial_header + 4, sizeof(uint32_t));
+		result->is_compressed = !!(result->curr_log_record_size & COMPRESSED_LOG_RECORD_FLAG);
+		result->curr_log_record_size &= ~COMPRESSED_LOG_RECORD_FLAG;
+		result->log_record_type = 0;
+		result->header_size = HEADER_SIZE + 4;
+		uint32_t parsed_crc32 = deserialize_uint32(result->serial_header + 8, sizeof(uint32_t));
+
+		// compare the parsed crc32 with the calculated one
+		if(parsed_crc32 != calcuated_crc32)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return 0;
+		}
+	}
+	else
+	{
+		uint32_t bytes_parsable = min(bytes_available, V2_MAX_HEADER_SIZE);
+
+		uint64_t curr_log_record_size_and_flag;
+		uint32_t prev_varint_size = deserialize_varint(&(result->prev_log_record_slot_size), result->serial_header, bytes_parsable);
+		uint32_t curr_varint_size = (prev_varint_size == 0) ? 0 : deserialize_varint(&curr_log_record_size_and_flag, result->serial_header + prev_varint_size, bytes_parsable - prev_varint_size);
+		uint32_t varints_size = prev_varint_size + curr_varint_size;
+		if(curr_varint_size == 0 || bytes_parsable - varints_size < V2_HEADER_FIXED_SIZE || (curr_log_record_size_and_flag >> 1) > MAX_LOG_RECORD_SIZE)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return 0;
+		}
 
-	// deserialize all the fields
-	result->prev_log_record_size = deserialize_uint32(serial_header + 0, sizeof(uint32_t));
-	result->curr_log_record_size = deserialize_uint32(serial_header + 4, sizeof(uint32_t));
-	uint32_t parsed_crc32 = deserialize_uint32(serial_header + 8, sizeof(uint32_t));
+		result->curr_log_record_size = curr_log_record_size_and_flag >> 1;
+		result->is_compressed = curr_log_record_size_and_flag & 1;
+		result->log_record_type = result->serial_header[varints_size];
+		result->header_size = varints_size + V2_HEADER_FIXED_SIZE;
+
+		uint16_t parsed_header_check = deserialize_uint32(result->serial_header + varints_size + 1, sizeof(uint16_t));
+		if(parsed_header_check != get_v2_header_check(result->serial_header, varints_size + 1))
+		{
+			(*error) = HEADER_CORRUPTED;
+			return 0;
+		}
+	}
 
-	// compare the parsed crc32 with the calculated one
-	if(parsed_crc32 != calcuated_crc32)
+	// the log record must end within the bytes_available
+	if(bytes_available - result->header_size < ((uint64_t)(result->curr_log_record_size)) + UINT64_C(4))
 	{
 		(*error) = HEADER_CORRUPTED;
 		return 0;
@@ -140,6 +329,88 @@ static int parse_and_check_crc32_for_log_record_header_at(log_record_header* res
 	return 1;
 }
 
+// 1 is success, 0 is failure
+// reads and checks the header of the log record at the file_offset, see parse_and_check_log_record_header()
+// the header of a LOG_RECORD_FORMAT_V2 log record is never read past the flushed log records, as its varints may be shorter than V2_MAX_HEADER_SIZE
+// must be called with atleast a read lock on the flushed_log_records_lock
+static int parse_and_check_crc32_for_log_record_header_at(log_record_header* result, uint64_t file_offset, wale* wale_p, int* error)
+{
+	// the LOG_RECORD_FORMAT_V1 log records are checked to be within the flushed log records by the callers
+	uint64_t bytes_available = UINT64_MAX;
+	if(wale_p->on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V1)
+	{
+		uint64_t end_file_offset = get_file_offset_for_next_log_sequence_number(&(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+		if(*error)
+			return 0;
+		if(end_file_offset <= file_offset)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return 0;
+		}
+		bytes_available = end_file_offset - file_offset;
+	}
+
+	// attempt read for the header at the file_offset
+	uint64_t bytes_to_read = min(bytes_available, (wale_p->on_disk_master_record.log_record_format_version == LOG_RECORD_FORMAT_V1) ? (HEADER_SIZE + 4) : V2_MAX_HEADER_SIZE);
+	if(!random_read_at(result->serial_header, bytes_to_read, file_offset, &(wale_p->block_io_functions), wale_p->block_buffers))
+	{
+		(*error) = READ_IO_ERROR;
+		return 0;
+	}
+
+	return parse_and_check_log_record_header(result, wale_p->on_disk_master_record.log_record_format_version, bytes_available, error);
+}
+
+// returns the crc32 to start with, for calculating the crc32 of the log record of the hdr
+// the crc32 of a LOG_RECORD_FORMAT_V2 log record covers its header
+static uint32_t get_initial_crc32_for_log_record(const log_record_header* hdr, wale* wale_p)
+{
+	uint32_t calculated_crc32 = crc32_init();
+	if(wale_p->on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V1)
+		calculated_crc32 = crc32_util(calculated_crc32, hdr->serial_header, hdr->header_size);
+	return calculated_crc32;
+}
+
+// returns the log_sequence_number right after (if is_forward is set) or right before the log record at log_sequence_number, with the header hdr
+// the log_sequence_number must not be the last_flushed_log_sequence_number (if is_forward is set) or the first_log_sequence_number
+// it fails with HEADER_CORRUPTED, if the adjacent log record is not within the flushed log records
+// must be called with atleast a read lock on the flushed_log_records_lock
+static uint256 get_adjacent_log_sequence_number(wale* wale_p, uint256 log_sequence_number, const log_record_header* hdr, int is_forward, int* error)
+{
+	uint256 adjacent_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	if(is_forward)
+	{
+		uint64_t total_size_curr_log_record = hdr->header_size + ((uint64_t)(hdr->curr_log_record_size)) + UINT64_C(4); // 4 for crc32 of the log record itself
+
+		// the next_log_sequence_number is right after this log_record
+		// and it can not be higher than the on_disk_master_record.last_flushed_log_sequence_number
+		if(!add_size_to_log_sequence_number(wale_p, &adjacent_log_sequence_number, log_sequence_number, total_size_curr_log_record) ||
+			compare_uint256(adjacent_log_sequence_number, wale_p->on_disk_master_record.last_flushed_log_sequence_number) > 0)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return INVALID_LOG_SEQUENCE_NUMBER;
+		}
+	}
+	else
+	{
+		uint64_t total_size_prev_log_record = hdr->prev_log_record_slot_size;
+
+		// the prev_log_sequence_number is right before this one
+		// it can not be equal to the total_size_prev_record, else prev_log_sequence_number will become 0, i.e. INVALID_LOG_SEQUENCE_NUMBER
+		// and it must be greater than or equal to the first_log_sequence_number
+		if(are_equal_uint256(log_sequence_number, get_uint256(total_size_prev_log_record)) ||
+			!sub_underflow_safe_uint256(&adjacent_log_sequence_number, log_sequence_number, get_uint256(total_size_prev_log_record)) ||
+			compare_uint256(adjacent_log_sequence_number, wale_p->on_disk_master_record.first_log_sequence_number) < 0)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return INVALID_LOG_SEQUENCE_NUMBER;
+		}
+	}
+
+	return adjacent_log_sequence_number;
+}
+
 uint256 get_next_log_sequence_number_of(wale* wale_p, uint256 log_sequence_number, int* error)
 {
 	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
@@ -157,6 +428,28 @@ uint256 get_next_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 	// set it to INVALID_LOG_SEQUENCE_NUMBER, which is default result
 	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 
+	// the log_sequence_numbers before the first_log_sequence_number are read from the attached archive
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		uint256 first_log_sequence_number = wale_p->on_disk_master_record.first_log_sequence_number;
+
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+		next_log_sequence_number = get_next_log_sequence_number_of_archive(wale_p->archive, log_sequence_number, error);
+
+		// the log record after the last archived log record, is the first log record of the WALe
+		// but only if the archive ends right where the WALe begins, else the log records in between were truncated without being archived
+		if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) && (*error) == NO_ERROR && !are_equal_uint256(first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			if(are_equal_uint256(wale_p->archive->next_log_sequence_number, first_log_sequence_number))
+				next_log_sequence_number = first_log_sequence_number;
+			else
+				(*error) = LOG_SEQUENCE_NUMBER_GAP;
+		}
+
+		return next_log_sequence_number;
+	}
+
 	// next of last_flushed_log_sequence_number does not exists
 	if(are_equal_uint256(log_sequence_number, wale_p->on_disk_master_record.last_flushed_log_sequence_number))
 		goto EXIT;
@@ -167,24 +460,10 @@ uint256 get_next_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 		goto EXIT;
 
 	log_record_header hdr;
-	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, &(wale_p->block_io_functions), error))
-		goto EXIT;
-
-	uint64_t total_size_curr_log_record = HEADER_SIZE + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(8); // 4 for crc32 of the log record itself and 4 for crc32 of the header
-
-	// the next_log_sequence_number is right after this log_record
-	if(!add_overflow_safe_uint256(&next_log_sequence_number, log_sequence_number, get_uint256(total_size_curr_log_record), wale_p->max_limit))
-	{
-		(*error) = HEADER_CORRUPTED;
+	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
 		goto EXIT;
-	}
 
-	// next_log_sequence_number can not be higher than the on_disk_master_record.last_flushed_log_sequence_number
-	if(compare_uint256(next_log_sequence_number, wale_p->on_disk_master_record.last_flushed_log_sequence_number) > 0)
-	{
-		(*error) = HEADER_CORRUPTED;
-		goto EXIT;
-	}
+	next_log_sequence_number = get_adjacent_log_sequence_number(wale_p, log_sequence_number, &hdr, 1, error);
 
 	EXIT:;
 	suffix_to_release_flushed_log_records_reader_lock(wale_p);
@@ -209,9 +488,36 @@ uint256 get_prev_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 	// set it to INVALID_LOG_SEQUENCE_NUMBER, which is default result
 	uint256 prev_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 
-	// prev of first_log_sequence_number does not exists
+	// the log_sequence_numbers before the first_log_sequence_number are read from the attached archive
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+		return get_prev_log_sequence_number_of_archive(wale_p->archive, log_sequence_number, error);
+	}
+
+	// prev of first_log_sequence_number does not exists, unless it is in the attached archive
 	if(are_equal_uint256(log_sequence_number, wale_p->on_disk_master_record.first_log_sequence_number))
+	{
+		if(wale_p->archive != NULL)
+		{
+			suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+			// if the archive and the WALe overlap, then the first_log_sequence_number is also in the archive
+			if(compare_uint256(log_sequence_number, wale_p->archive->last_log_sequence_number) <= 0)
+				return get_prev_log_sequence_number_of_archive(wale_p->archive, log_sequence_number, error);
+
+			// else the archive must end right where the WALe begins
+			if(!are_equal_uint256(wale_p->archive->next_log_sequence_number, log_sequence_number))
+			{
+				(*error) = LOG_SEQUENCE_NUMBER_GAP;
+				return INVALID_LOG_SEQUENCE_NUMBER;
+			}
+
+			return wale_p->archive->last_log_sequence_number;
+		}
 		goto EXIT;
+	}
 
 	// calculate the offset in file of the log_record at log_sequence_number
 	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
@@ -219,26 +525,10 @@ uint256 get_prev_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 		goto EXIT;
 
 	log_record_header hdr;
-	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, &(wale_p->block_io_functions), error))
-		goto EXIT;
-
-	uint64_t total_size_prev_log_record = HEADER_SIZE + ((uint64_t)(hdr.prev_log_record_size)) + UINT64_C(8); // 4 for crc32 of the previous log record and 4 for crc32 of its header
-
-	// the prev_log_sequence_number is right before this one
-	// it can not be equal to the total_size_prev_record, else prev_log_sequence_number will become 0, i.e. INVALID_LOG_SEQUENCE_NUMBER
-	if(are_equal_uint256(log_sequence_number, get_uint256(total_size_prev_log_record)) ||
-		!sub_underflow_safe_uint256(&prev_log_sequence_number, log_sequence_number, get_uint256(total_size_prev_log_record)))
-	{
-		(*error) = HEADER_CORRUPTED;
+	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
 		goto EXIT;
-	}
 
-	// previous log_sequence_number must be greater than or equal to the first_log_sequence_number
-	if(compare_uint256(prev_log_sequence_number, wale_p->on_disk_master_record.first_log_sequence_number) < 0)
-	{
-		(*error) = HEADER_CORRUPTED;
-		goto EXIT;
-	}
+	prev_log_sequence_number = get_adjacent_log_sequence_number(wale_p, log_sequence_number, &hdr, 0, error);
 
 	EXIT:;
 	suffix_to_release_flushed_log_records_reader_lock(wale_p);
@@ -246,107 +536,138 @@ uint256 get_prev_log_sequence_number_of(wale* wale_p, uint256 log_sequence_numbe
 	return prev_log_sequence_number;
 }
 
-void* get_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+void include_log_record_type_in_filter(log_record_type_filter* filter, uint8_t log_record_type)
 {
-	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
-	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	filter->types[log_record_type / 64] |= (UINT64_C(1) << (log_record_type % 64));
+}
+
+int is_log_record_type_in_filter(const log_record_type_filter* filter, uint8_t log_record_type)
+{
+	return !!(filter->types[log_record_type / 64] & (UINT64_C(1) << (log_record_type % 64)));
+}
+
+// steps over the log records after (if is_forward is set) or before the log record at log_sequence_number, using only their headers
+// returns the log_sequence_number of the first log record stepped onto, that passes the filter (or the first_log_sequence_number, if is_first is set)
+// it returns INVALID_LOG_SEQUENCE_NUMBER with no error, if there is no such log record until the first or the last flushed log record
+// must be called with atleast a read lock on the flushed_log_records_lock
+static uint256 seek_log_record_of_type(wale* wale_p, uint256 log_sequence_number, int is_forward, int is_first, const log_record_type_filter* filter, int* error)
+{
+	log_record_header hdr;
+
+	if(!is_first)
 	{
-		(*error) = PARAM_INVALID;
-		return NULL;
+		uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+		if(*error)
+			return INVALID_LOG_SEQUENCE_NUMBER;
+
+		if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
+			return INVALID_LOG_SEQUENCE_NUMBER;
 	}
 
-	// initialize error to no error
-	(*error) = NO_ERROR;
+	while(1)
+	{
+		if(!is_first)
+		{
+			// there is nothing to step onto, after the last flushed log record or before the first log record
+			if(are_equal_uint256(log_sequence_number, is_forward ? wale_p->on_disk_master_record.last_flushed_log_sequence_number : wale_p->on_disk_master_record.first_log_sequence_number))
+				return INVALID_LOG_SEQUENCE_NUMBER;
+
+			log_sequence_number = get_adjacent_log_sequence_number(wale_p, log_sequence_number, &hdr, is_forward, error);
+			if(*error)
+				return INVALID_LOG_SEQUENCE_NUMBER;
+		}
+		is_first = 0;
 
+		uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+		if(*error)
+			return INVALID_LOG_SEQUENCE_NUMBER;
+
+		if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
+			return INVALID_LOG_SEQUENCE_NUMBER;
+
+		if(is_log_record_type_in_filter(filter, hdr.log_record_type))
+			return log_sequence_number;
+	}
+}
+
+// returns the first log record of the WALe file that passes the filter, after the last log record of the attached archive
+// the archive must end right where the WALe begins (or overlap it), else it fails with LOG_SEQUENCE_NUMBER_GAP
+static uint256 seek_log_record_of_type_after_archive(wale* wale_p, const log_record_type_filter* filter, int* error)
+{
 	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
 
-	// set it to NULL, which is default result
-	void* log_record = NULL;
+	uint256 log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 
-	// calculate the offset in file of the log_record at log_sequence_number
-	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
-	if(*error)
+	uint256 first_log_sequence_number = wale_p->on_disk_master_record.first_log_sequence_number;
+	if(are_equal_uint256(first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
 		goto EXIT;
 
-	log_record_header hdr;
-	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, &(wale_p->block_io_functions), error))
-		goto EXIT;
+	// if the archive and the WALe overlap, then the last archived log record is also in the WALe
+	if(compare_uint256(wale_p->archive->last_log_sequence_number, first_log_sequence_number) >= 0)
+		log_sequence_number = seek_log_record_of_type(wale_p, wale_p->archive->last_log_sequence_number, 1, 0, filter, error);
+	else if(are_equal_uint256(wale_p->archive->next_log_sequence_number, first_log_sequence_number))
+		log_sequence_number = seek_log_record_of_type(wale_p, first_log_sequence_number, 1, 1, filter, error);
+	else
+		(*error) = LOG_SEQUENCE_NUMBER_GAP;
 
-	// make sure that we will not be reading past or at the offset of wale_p->on_disk_master_record.next_log_sequence_number
-	uint64_t total_log_size = HEADER_SIZE + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(8); // 8 for both the crc32-s
+	EXIT:;
+	suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
-	// make sure that the next_log_sequence_number of this log_record does not overflow
-	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
-	if(!add_overflow_safe_uint256(&next_log_sequence_number, log_sequence_number, get_uint256(total_log_size), wale_p->max_limit))
-	{
-		(*error) = PARAM_INVALID;
-		goto EXIT;
-	}
+	return log_sequence_number;
+}
 
-	// the next log_sequence number of this log_record can not be more than the next log_sequence number of the on_disk_master_record
-	if(compare_uint256(next_log_sequence_number, wale_p->on_disk_master_record.next_log_sequence_number) > 0)
+// returns the last log record of the attached archive that passes the filter, before the first_log_sequence_number of the WALe file
+// the archive must end right where the WALe begins (or overlap it), else it fails with LOG_SEQUENCE_NUMBER_GAP
+static uint256 seek_log_record_of_type_before_wale(wale* wale_p, uint256 first_log_sequence_number, const log_record_type_filter* filter, int* error)
+{
+	// if the archive and the WALe overlap, then the first_log_sequence_number is also in the archive
+	if(compare_uint256(first_log_sequence_number, wale_p->archive->last_log_sequence_number) <= 0)
+		return get_prev_log_sequence_number_of_type_archive(wale_p->archive, first_log_sequence_number, filter, error);
+
+	if(!are_equal_uint256(wale_p->archive->next_log_sequence_number, first_log_sequence_number))
 	{
-		(*error) = PARAM_INVALID;
-		goto EXIT;
+		(*error) = LOG_SEQUENCE_NUMBER_GAP;
+		return INVALID_LOG_SEQUENCE_NUMBER;
 	}
 
-	// calculate the offset of the log_record
-	uint64_t log_record_offset = file_offset_of_log_record + HEADER_SIZE + UINT64_C(4);
+	return get_last_log_sequence_number_of_type_archive(wale_p->archive, filter, error);
+}
 
-	// allocate memory for log record
-	(*log_record_size) = hdr.curr_log_record_size;
-	log_record = malloc((*log_record_size));
-	if(log_record == NULL)
-	{
-		(*error) = ALLOCATION_FAILED;
-		goto EXIT;
-	}
+uint256 get_first_log_sequence_number_of_type(wale* wale_p, const log_record_type_filter* filter, int* error)
+{
+	// initialize error to no error
+	(*error) = NO_ERROR;
 
-	// read data for log_record from the file, data size amounting to log_record_size
-	if(!random_read_at(log_record, (*log_record_size), log_record_offset, &(wale_p->block_io_functions)))
+	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
+
+	// the log records of the attached archive come before the ones in the WALe file
+	if(wale_p->archive != NULL && is_log_sequence_number_in_archive(wale_p, wale_p->archive->first_log_sequence_number))
 	{
-		(*error) = READ_IO_ERROR;
-		free(log_record);
-		log_record = NULL;
-		goto EXIT;
-	}
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
-	// calculate crc32 for the log_record read
-	uint32_t calculated_crc32 = crc32_init();
-	calculated_crc32 = crc32_util(calculated_crc32, log_record, (*log_record_size));
+		uint256 log_sequence_number = get_first_log_sequence_number_of_type_archive(wale_p->archive, filter, error);
+		if(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || (*error))
+			return log_sequence_number;
 
-	// read crc for log_record from the file, data size amounting to log_record_size
-	char crc_read[4];
-	if(!random_read_at(crc_read, UINT64_C(4), log_record_offset + (*log_record_size), &(wale_p->block_io_functions)))
-	{
-		(*error) = READ_IO_ERROR;
-		free(log_record);
-		log_record = NULL;
-		goto EXIT;
+		return seek_log_record_of_type_after_archive(wale_p, filter, error);
 	}
 
-	uint32_t parsed_crc32 = deserialize_uint32(crc_read, sizeof(uint32_t));
-	if(parsed_crc32 != calculated_crc32)
-	{
-		(*error) = LOG_RECORD_CORRUPTED;
-		free(log_record);
-		log_record = NULL;
-		goto EXIT;
-	}
+	uint256 log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	if(!are_equal_uint256(wale_p->on_disk_master_record.first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		log_sequence_number = seek_log_record_of_type(wale_p, wale_p->on_disk_master_record.first_log_sequence_number, 1, 1, filter, error);
 
-	EXIT:;
 	suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
-	return log_record;
+	return log_sequence_number;
 }
 
-int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+static uint256 get_adjacent_log_sequence_number_of_type(wale* wale_p, uint256 log_sequence_number, int is_forward, const log_record_type_filter* filter, int* error)
 {
 	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
 	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
 	{
 		(*error) = PARAM_INVALID;
-		return 0;
+		return INVALID_LOG_SEQUENCE_NUMBER;
 	}
 
 	// initialize error to no error
@@ -354,24 +675,330 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 
 	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
 
-	// default return valus
-	int valid = 0;
+	// the log_sequence_numbers before the first_log_sequence_number are stepped over in the attached archive, and then in the WALe file (when going forward)
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
 
-	// calculate the offset in file of the log_record at log_sequence_number
-	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
-	if(*error)
-		goto EXIT;
+		uint256 adjacent_log_sequence_number = is_forward
+			? get_next_log_sequence_number_of_type_archive(wale_p->archive, log_sequence_number, filter, error)
+			: get_prev_log_sequence_number_of_type_archive(wale_p->archive, log_sequence_number, filter, error);
+		if(!is_forward || !are_equal_uint256(adjacent_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || (*error))
+			return adjacent_log_sequence_number;
 
-	log_record_header hdr;
-	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, &(wale_p->block_io_functions), error))
-		goto EXIT;
+		return seek_log_record_of_type_after_archive(wale_p, filter, error);
+	}
 
-	// make sure that we will not be reading past or at the offset of wale_p->on_disk_master_record.next_log_sequence_number
-	uint64_t total_log_size = HEADER_SIZE + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(8); // 8 for both the crc32-s
+	uint256 first_log_sequence_number = wale_p->on_disk_master_record.first_log_sequence_number;
+
+	uint256 adjacent_log_sequence_number = seek_log_record_of_type(wale_p, log_sequence_number, is_forward, 0, filter, error);
+
+	suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+	// going backward, the log records before the first_log_sequence_number are stepped over in the attached archive
+	if(!is_forward && wale_p->archive != NULL && are_equal_uint256(adjacent_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) && (*error) == NO_ERROR)
+		adjacent_log_sequence_number = seek_log_record_of_type_before_wale(wale_p, first_log_sequence_number, filter, error);
+
+	return adjacent_log_sequence_number;
+}
+
+uint256 get_next_log_sequence_number_of_type(wale* wale_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error)
+{
+	return get_adjacent_log_sequence_number_of_type(wale_p, log_sequence_number, 1, filter, error);
+}
+
+uint256 get_prev_log_sequence_number_of_type(wale* wale_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error)
+{
+	return get_adjacent_log_sequence_number_of_type(wale_p, log_sequence_number, 0, filter, error);
+}
+
+int get_log_record_type_at(wale* wale_p, uint256 log_sequence_number, uint8_t* log_record_type, int* error)
+{
+	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
+
+	// the log_sequence_numbers before the first_log_sequence_number are read from the attached archive
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+		return get_log_record_type_at_archive(wale_p->archive, log_sequence_number, log_record_type, error);
+	}
+
+	int res = 0;
+
+	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto EXIT;
+
+	log_record_header hdr;
+	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
+		goto EXIT;
+
+	(*log_record_type) = hdr.log_record_type;
+	res = 1;
+
+	EXIT:;
+	suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+	return res;
+}
+
+void* get_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+{
+	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return NULL;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
+
+	// the log_sequence_numbers before the first_log_sequence_number are read from the attached archive
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+		void* archived_log_record = get_log_record_at_archive(wale_p->archive, log_sequence_number, log_record_size, error);
+
+		// the archive allocates using the malloc(), so with any other allocator, the log record is copied into its memory
+		if(archived_log_record != NULL && wale_p->allocator.allocate != default_wale_allocator.allocate)
+		{
+			void* log_record = wale_p->allocator.allocate(wale_p->allocator.allocator_handle, 1, max((*log_record_size), 1));
+			if(log_record == NULL)
+				(*error) = ALLOCATION_FAILED;
+			else
+				memory_move(log_record, archived_log_record, (*log_record_size));
+			release_log_record_archive(wale_p->archive, archived_log_record, (*log_record_size));
+			return log_record;
+		}
+
+		return archived_log_record;
+	}
+
+	// set it to NULL, which is default result
+	void* log_record = NULL;
+
+	// calculate the offset in file of the log_record at log_sequence_number
+	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto EXIT;
+
+	log_record_header hdr;
+	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
+		goto EXIT;
+
+	// make sure that we will not be reading past or at the offset of wale_p->on_disk_master_record.next_log_sequence_number
+	uint64_t total_log_size = hdr.header_size + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(4); // 4 for the crc32 of the log record
+
+	// make sure that the next_log_sequence_number of this log_record does not overflow
+	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	if(!add_size_to_log_sequence_number(wale_p, &next_log_sequence_number, log_sequence_number, total_log_size))
+	{
+		(*error) = PARAM_INVALID;
+		goto EXIT;
+	}
+
+	// the next log_sequence number of this log_record can not be more than the next log_sequence number of the on_disk_master_record
+	if(compare_uint256(next_log_sequence_number, wale_p->on_disk_master_record.next_log_sequence_number) > 0)
+	{
+		(*error) = PARAM_INVALID;
+		goto EXIT;
+	}
+
+	// calculate the offset of the log_record
+	uint64_t log_record_offset = file_offset_of_log_record + hdr.header_size;
+
+	// allocate memory for log record
+	(*log_record_size) = hdr.curr_log_record_size;
+	// the allocator is never asked for 0 bytes, so allocate atleast 1 byte
+	log_record = wale_p->allocator.allocate(wale_p->allocator.allocator_handle, 1, max((*log_record_size), 1));
+	if(log_record == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		goto EXIT;
+	}
+
+	// read data for log_record from the file, data size amounting to log_record_size
+	if(!random_read_at(log_record, (*log_record_size), log_record_offset, &(wale_p->block_io_functions), wale_p->block_buffers))
+	{
+		(*error) = READ_IO_ERROR;
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, log_record, max((*log_record_size), 1));
+		log_record = NULL;
+		goto EXIT;
+	}
+
+	// calculate crc32 for the log_record read
+	uint32_t calculated_crc32 = get_initial_crc32_for_log_record(&hdr, wale_p);
+	calculated_crc32 = crc32_util(calculated_crc32, log_record, (*log_record_size));
+
+	// read crc for log_record from the file, data size amounting to log_record_size
+	char crc_read[4];
+	if(!random_read_at(crc_read, UINT64_C(4), log_record_offset + (*log_record_size), &(wale_p->block_io_functions), wale_p->block_buffers))
+	{
+		(*error) = READ_IO_ERROR;
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, log_record, max((*log_record_size), 1));
+		log_record = NULL;
+		goto EXIT;
+	}
+
+	uint32_t parsed_crc32 = deserialize_uint32(crc_read, sizeof(uint32_t));
+	if(parsed_crc32 != calculated_crc32)
+	{
+		(*error) = LOG_RECORD_CORRUPTED;
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, log_record, max((*log_record_size), 1));
+		log_record = NULL;
+		goto EXIT;
+	}
+
+	EXIT:;
+	suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+	// decompress the log record, after releasing the locks
+	if(log_record != NULL && hdr.is_compressed)
+	{
+		void* compressed_log_record = log_record;
+		uint32_t compressed_log_record_size = (*log_record_size);
+		log_record = decompress_log_record(&(wale_p->log_record_codec), &(wale_p->allocator), compressed_log_record, compressed_log_record_size, log_record_size, error);
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, compressed_log_record, max(compressed_log_record_size, 1));
+	}
+
+	return log_record;
+}
+
+void release_log_record(wale* wale_p, void* log_record, uint32_t log_record_size)
+{
+	if(log_record == NULL)
+		return;
+	wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, log_record, max(log_record_size, 1));
+}
+
+uint64_t read_raw_log_range(wale* wale_p, uint256 from_log_sequence_number, uint64_t max_bytes, void* raw_log_range, int* error)
+{
+	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
+	if(are_equal_uint256(from_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
+
+	uint64_t raw_log_range_size = 0;
+
+	// there is nothing to read, after the last flushed log record
+	if(are_equal_uint256(from_log_sequence_number, wale_p->on_disk_master_record.next_log_sequence_number))
+		goto EXIT;
+
+	uint64_t file_offset_of_raw_log_range = get_file_offset_for_log_sequence_number(from_log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto EXIT;
+
+	// step over the headers of the log records, as long as the whole log records fit in max_bytes
+	// the log records are contiguous in the file (and on the ring), so they can then be read with a single random read
+	uint256 log_sequence_number = from_log_sequence_number;
+	while(1)
+	{
+		log_record_header hdr;
+		if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_raw_log_range + raw_log_range_size, wale_p, error))
+			goto FAIL;
+
+		uint64_t log_record_slot_size = hdr.header_size + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(4);
+		if(log_record_slot_size > max_bytes - raw_log_range_size)
+			break;
+		raw_log_range_size += log_record_slot_size;
+
+		if(are_equal_uint256(log_sequence_number, wale_p->on_disk_master_record.last_flushed_log_sequence_number))
+			break;
+
+		log_sequence_number = get_adjacent_log_sequence_number(wale_p, log_sequence_number, &hdr, 1, error);
+		if(*error)
+			goto FAIL;
+	}
+
+	// atleast the first log record must fit in the max_bytes
+	if(raw_log_range_size == 0)
+	{
+		(*error) = PARAM_INVALID;
+		goto EXIT;
+	}
+
+	if(!random_read_at(raw_log_range, raw_log_range_size, file_offset_of_raw_log_range, &(wale_p->block_io_functions), wale_p->block_buffers))
+	{
+		(*error) = READ_IO_ERROR;
+		goto FAIL;
+	}
+
+	goto EXIT;
+
+	FAIL:;
+	raw_log_range_size = 0;
+
+	EXIT:;
+	suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+	return raw_log_range_size;
+}
+
+int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+{
+	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	prefix_to_acquire_flushed_log_records_reader_lock(wale_p);
+
+	// the log_sequence_numbers before the first_log_sequence_number are read from the attached archive
+	// the archived log records are validated by reading them, as the crc32 of their chunk is checked before they are decompressed
+	if(is_log_sequence_number_in_archive(wale_p, log_sequence_number))
+	{
+		suffix_to_release_flushed_log_records_reader_lock(wale_p);
+
+		void* log_record = get_log_record_at_archive(wale_p->archive, log_sequence_number, log_record_size, error);
+		release_log_record_archive(wale_p->archive, log_record, (*log_record_size));
+		return log_record != NULL;
+	}
+
+	// default return valus
+	int valid = 0;
+
+	// calculate the offset in file of the log_record at log_sequence_number
+	uint64_t file_offset_of_log_record = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto EXIT;
+
+	log_record_header hdr;
+	if(!parse_and_check_crc32_for_log_record_header_at(&hdr, file_offset_of_log_record, wale_p, error))
+		goto EXIT;
+
+	// make sure that we will not be reading past or at the offset of wale_p->on_disk_master_record.next_log_sequence_number
+	uint64_t total_log_size = hdr.header_size + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(4); // 4 for the crc32 of the log record
 
 	// make sure that the next_log_sequence_number of this log_record does not overflow
 	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
-	if(!add_overflow_safe_uint256(&next_log_sequence_number, log_sequence_number, get_uint256(total_log_size), wale_p->max_limit))
+	if(!add_size_to_log_sequence_number(wale_p, &next_log_sequence_number, log_sequence_number, total_log_size))
 	{
 		(*error) = PARAM_INVALID;
 		goto EXIT;
@@ -385,14 +1012,14 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 	}
 
 	// calculate the offset of the log_record
-	uint64_t log_record_offset = file_offset_of_log_record + HEADER_SIZE + UINT64_C(4);
+	uint64_t log_record_offset = file_offset_of_log_record + hdr.header_size;
 
 	// set the valid log_record_size
 	(*log_record_size) = hdr.curr_log_record_size;
 
 	// calculate crc32 for the log_record, block by block
-	uint32_t calculated_crc32 = crc32_init();
-	if(!crc32_at(&calculated_crc32, (*log_record_size), log_record_offset, &(wale_p->block_io_functions)))
+	uint32_t calculated_crc32 = get_initial_crc32_for_log_record(&hdr, wale_p);
+	if(!crc32_at(&calculated_crc32, (*log_record_size), log_record_offset, &(wale_p->block_io_functions), wale_p->block_buffers))
 	{
 		(*error) = READ_IO_ERROR;
 		goto EXIT;
@@ -400,7 +1027,7 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 
 	// read crc for log_record from the file, data size amounting to log_record_size
 	char crc_read[4];
-	if(!random_read_at(crc_read, UINT64_C(4), log_record_offset + (*log_record_size), &(wale_p->block_io_functions)))
+	if(!random_read_at(crc_read, UINT64_C(4), log_record_offset + (*log_record_size), &(wale_p->block_io_functions), wale_p->block_buffers))
 	{
 		(*error) = READ_IO_ERROR;
 		goto EXIT;
@@ -413,6 +1040,23 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 		goto EXIT;
 	}
 
+	// for a compressed log record, return its uncompressed size, as parsed from the prefix of the stored log record
+	if(hdr.is_compressed)
+	{
+		char prefix[COMPRESSED_LOG_RECORD_PREFIX_SIZE];
+		if((*log_record_size) < COMPRESSED_LOG_RECORD_PREFIX_SIZE)
+		{
+			(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+			goto EXIT;
+		}
+		if(!random_read_at(prefix, COMPRESSED_LOG_RECORD_PREFIX_SIZE, log_record_offset, &(wale_p->block_io_functions), wale_p->block_buffers))
+		{
+			(*error) = READ_IO_ERROR;
+			goto EXIT;
+		}
+		parse_uncompressed_log_record_size(prefix, COMPRESSED_LOG_RECORD_PREFIX_SIZE, log_record_size);
+	}
+
 	valid = 1;
 
 	EXIT:;
@@ -424,11 +1068,20 @@ int validate_log_record_at(wale* wale_p, uint256 log_sequence_number, uint32_t*
 int modify_append_only_buffer_block_count(wale* wale_p, uint64_t buffer_block_count, int* error)
 {
 	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
-	exclusive_lock(&(wale_p->append_only_buffer_lock), BLOCKING);
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	// releasing the append only buffer discards its unflushed log records, that the writers of the large log records in progress would continue to write
+	int res = 0;
+	if(buffer_block_count == 0 && wale_p->large_log_record_writers != NULL)
+		(*error) = LARGE_LOG_RECORD_IN_PROGRESS;
+	else
+		res = resize_append_only_buffer(wale_p, buffer_block_count, error);
 
-	int res = resize_append_only_buffer(wale_p, buffer_block_count, error);
+	// the user now decides the size of the append only buffer, so it is not released by the autosizing anymore
+	if(res)
+		wale_p->is_append_only_buffer_released_on_idle = 0;
 
 	// if the buffer_block_count increased, i.e. now there is more space on it -> this is equivalent to a scroll
 	// else if the buffer_block_count became 0 i.e. now wale is read only, then wake up anyone who is waiting for a scroll to let then know about it
@@ -436,7 +1089,7 @@ int modify_append_only_buffer_block_count(wale* wale_p, uint64_t buffer_block_co
 	// so in any case scroll the buffer
 	// to be on safe side, we wake up all threads waiting for scroll, to inform them about the change in buffer_block_count
 	// resizing the append only buffer is expectd to an infrequent operation, hence hopefully waking up all the threads is just fine
-	pthread_cond_broadcast(&(wale_p->wait_for_scroll));
+	wake_up_all_scroll_waiters(wale_p);
 
 	exclusive_unlock(&(wale_p->append_only_buffer_lock));
 
@@ -446,41 +1099,57 @@ int modify_append_only_buffer_block_count(wale* wale_p, uint64_t buffer_block_co
 	return res;
 }
 
-static uint256 get_log_sequence_number_for_next_log_record_and_advance_master_record(wale* wale_p, uint32_t log_record_size, int is_check_point, uint32_t* prev_log_record_size, int* error)
+void set_log_record_codec(wale* wale_p, const log_record_codec* codec, uint32_t min_log_record_size_to_compress)
+{
+	if(codec == NULL)
+	{
+		wale_p->log_record_codec = (log_record_codec){.codec_handle = NULL, .codec_id = 0, .compress = NULL, .decompress = NULL};
+		wale_p->min_log_record_size_to_compress = 0;
+		return;
+	}
+
+	wale_p->log_record_codec = (*codec);
+	wale_p->min_log_record_size_to_compress = min_log_record_size_to_compress;
+}
+
+// returns the total slot size required by the new log record of log_record_size (as stored), along with the slot size of the log record before it
+// it returns 0, only if the in_memory_master_record is corrupted
+static uint64_t get_slot_size_for_next_log_record(wale* wale_p, uint32_t log_record_size, uint64_t* prev_log_record_slot_size, int* error)
 {
-	// compute the total slot size required by this new log record
-	uint64_t total_log_record_slot_size = HEADER_SIZE + ((uint64_t)log_record_size) + UINT64_C(8); // 8 for crc32 of header and log record itself
+	// if there was a last_flushed_log_sequence_number, then its slot size is all the bytes until the next_log_sequence_number
+	(*prev_log_record_slot_size) = 0;
+	if(!are_equal_uint256(wale_p->in_memory_master_record.last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		if(!get_log_sequence_number_difference(wale_p, prev_log_record_slot_size, wale_p->in_memory_master_record.next_log_sequence_number, wale_p->in_memory_master_record.last_flushed_log_sequence_number))
+		{
+			(*error) = MASTER_RECORD_CORRUPTED;
+			return 0;
+		}
+	}
+
+	return get_log_record_slot_size(wale_p->in_memory_master_record.log_record_format_version, (*prev_log_record_slot_size), log_record_size);
+}
 
+static uint256 get_log_sequence_number_for_next_log_record_and_advance_master_record(wale* wale_p, uint64_t total_log_record_slot_size, int is_check_point, int* error)
+{
 	// its log sequence number will simply be the next log sequence number
 	// check for overflow of the next_log_sequence_number, upon alloting this slot
 	// we do not advance the master record, if the next_log_sequence_number overflows
 	uint256 log_sequence_number = wale_p->in_memory_master_record.next_log_sequence_number;
 	uint256 new_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
-	if(!add_overflow_safe_uint256(&(new_next_log_sequence_number), wale_p->in_memory_master_record.next_log_sequence_number, get_uint256(total_log_record_slot_size), wale_p->max_limit))
+	if(!add_size_to_log_sequence_number(wale_p, &new_next_log_sequence_number, wale_p->in_memory_master_record.next_log_sequence_number, total_log_record_slot_size))
 	{
 		(*error) = LOG_SEQUENCE_NUMBER_OVERFLOW;
 		return INVALID_LOG_SEQUENCE_NUMBER;
 	}
 
-	// if there was a last_flushed_log_sequence_number, then return also its size
-	if(!are_equal_uint256(wale_p->in_memory_master_record.last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
-	{
-		uint64_t prev_log_record_total_size;
-		{
-			uint256 temp;
-			if(!sub_underflow_safe_uint256(&temp, wale_p->in_memory_master_record.next_log_sequence_number, wale_p->in_memory_master_record.last_flushed_log_sequence_number) ||
-				!cast_to_uint64_from_uint256(&prev_log_record_total_size, temp))
-				return INVALID_LOG_SEQUENCE_NUMBER;
-
-		}
-		(*prev_log_record_size) = prev_log_record_total_size - HEADER_SIZE - UINT64_C(8);
-	}
-	else
-		(*prev_log_record_size) = 0;
-
 	// if earlier there were no log records on the disk, then this will be the new first_log_sequence_number
+	// and it will also be the new base_log_sequence_number, i.e. it will go at the offset block_size in the file
 	if(are_equal_uint256(wale_p->in_memory_master_record.first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
 		wale_p->in_memory_master_record.first_log_sequence_number = log_sequence_number;
+		wale_p->in_memory_master_record.base_log_sequence_number = log_sequence_number;
+	}
 
 	// this will also be the new last_flushed_log_sequence_number
 	wale_p->in_memory_master_record.last_flushed_log_sequence_number = log_sequence_number;
@@ -513,170 +1182,1004 @@ static uint64_t append_log_record_data(wale* wale_p, uint64_t* append_slot, cons
 		if((*append_slot) == wale_p->buffer_block_count * wale_p->block_io_functions.block_size)
 		{
 			// scrolling needs global lock and an exclusive lock on the wale_p->append_only_buffer_lock
-			pthread_mutex_lock(get_wale_lock(wale_p));
+			pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+			// upgrade your shared lock on the append_only_buffer to exclusive lock while we scroll
+			upgrade_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+			// scroll and preserve the scroll error for the caller to see
+			(*error_in_scroll) = !scroll_append_only_buffer(wale_p);
+
+			// downgrade back to shared_lock on the append_only_buffer after the scroll
+			downgrade_lock(&(wale_p->append_only_buffer_lock));
+
+			if(!(*error_in_scroll))
+			{
+				// take the probably the first slot and advance the append_offset to how much we can write at most
+				(*append_slot) = wale_p->append_offset;
+				wale_p->append_offset = min(wale_p->append_offset + (*total_bytes_to_write_for_this_log_record), wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+
+				// wake up only as many of the other writers to append_only_buffer, who are waiting for append_only_buffer to scroll to the next_log_sequence_number, as there is space for
+				wake_up_scroll_waiters(wale_p);
+			}
+			else
+			{
+				// in case of scroll error, wake up any threads waiting for a successfull scroll
+				wale_p->major_scroll_error = 1;
+				wake_up_all_scroll_waiters(wale_p);
+			}
+
+			pthread_mutex_unlock(get_wale_lock(wale_p));
+
+			// if scroll was a failure we break out of the loop
+			if((*error_in_scroll))
+				break;
+		}
+	}
+
+	return bytes_written;
+}
+
+// wait_for_scroll(), that keeps waiting while the append only buffer is being scrolled, and fires the trace events around the wait
+// it must be called with the global lock held, and without any lock on the append_only_buffer_lock
+static int wait_for_scroll_traced(wale* wale_p, uint64_t total_bytes_to_write, int is_retry)
+{
+	trace_wait_for_scroll_begin(wale_p);
+	wale_p->autosize_scroll_waits++;
+	do
+	{
+		is_retry = wait_for_scroll(wale_p, total_bytes_to_write, is_retry);
+	}
+	while(wale_p->is_scrolling_append_only_buffer);
+	trace_wait_for_scroll_end(wale_p);
+	return is_retry;
+}
+
+// waits until the blocks of the log record ending at the end_file_offset have been handed to the write_blocks
+// it scrolls the append only buffer, only if no one else (i.e. a scroll by another appender or a flush) has done so, while it waited for the exclusive lock
+// it must be called without any locks held
+static int make_log_record_written(wale* wale_p, uint64_t end_file_offset, int* error)
+{
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	int res = 1;
+
+	// a released (or 0 sized) append only buffer has nothing left to write
+	if(wale_p->buffer_block_count > 0 && wale_p->written_file_offset < end_file_offset)
+	{
+		if(wale_p->major_scroll_error || !scroll_append_only_buffer(wale_p))
+		{
+			wale_p->major_scroll_error = 1;
+			(*error) = MAJOR_SCROLL_ERROR;
+			wake_up_all_scroll_waiters(wale_p);
+			res = 0;
+		}
+		else
+			wake_up_scroll_waiters(wale_p);
+	}
+
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	return res;
+}
+
+// waits until none of the large log records before the log_sequence_number are in progress, it must be called with the global lock held
+static void wait_for_large_log_records_before(wale* wale_p, uint256 log_sequence_number)
+{
+	while(wale_p->large_log_record_writers != NULL && compare_uint256(wale_p->large_log_record_writers->log_sequence_number, log_sequence_number) < 0)
+		pthread_cond_wait_recording_wait(wale_p, &(wale_p->large_log_record_ended), get_wale_lock(wale_p));
+}
+
+// waits until the log record at log_sequence_number is covered by the on_disk_master_record
+// it joins the flush in progress (or pending), if that covers the log record, else it issues a flush_all_log_records() on its own
+// it must be called without any locks held
+static int make_log_record_durable(wale* wale_p, uint256 log_sequence_number, int* error)
+{
+	while(1)
+	{
+		if(wale_p->has_internal_lock)
+			pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+		join_flush_epoch_covering(wale_p, log_sequence_number);
+
+		// the on_disk_master_record is updated only with the global lock held, so we can read it here without the flushed_log_records_lock
+		int is_durable = !are_equal_uint256(wale_p->on_disk_master_record.last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) &&
+			compare_uint256(log_sequence_number, wale_p->on_disk_master_record.last_flushed_log_sequence_number) <= 0;
+
+		// no flush covers the log record, until the large log records before it end
+		if(!is_durable)
+			wait_for_large_log_records_before(wale_p, log_sequence_number);
+
+		if(wale_p->has_internal_lock)
+			pthread_mutex_unlock(get_wale_lock(wale_p));
+
+		if(is_durable)
+			return 1;
+
+		// the joined epoch failed, or there was none in progress, or it did not cover the log record as a large log record before it was in progress
+		flush_all_log_records(wale_p, error);
+		if(*error)
+			return 0;
+	}
+}
+
+uint256 append_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, int is_check_point, append_durability durability, int* error)
+{
+	return append_typed_log_record(wale_p, log_record, log_record_size, 0, is_check_point, durability, error);
+}
+
+// appends the prefix (of prefix_size bytes, filled by the fill_prefix at the reservation of the slot) followed by the log_record, as a single log record
+// a prefix_size of 0 appends just the log_record, and only such a log record may be compressed
+static uint256 append_log_record_with_prefix(wale* wale_p, uint32_t prefix_size, log_record_prefix_filler fill_prefix, void* filler_handle, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, append_durability durability, int* error)
+{
+	uint64_t start_time = get_wale_stats_time();
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	// return value defaults to an INVALID_LOG_SEQUENCE_NUMBER
+	uint256 log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	// the most significant bit of the log_record_size is reserved for the COMPRESSED_LOG_RECORD_FLAG
+	// and the LOG_RECORD_FORMAT_V1 has no place for the log_record_type
+	if(prefix_size > MAX_LOG_RECORD_PREFIX_SIZE || log_record_size > MAX_LOG_RECORD_SIZE - prefix_size || durability > APPEND_DURABLE ||
+		(log_record_type != 0 && wale_p->in_memory_master_record.log_record_format_version == LOG_RECORD_FORMAT_V1))
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	// compress the log record, before taking any locks, if it shrinks then it is appended in its compressed form
+	// a prefixed log record is not compressed, as its prefix is not known until it takes its slot
+	uint32_t uncompressed_log_record_size = log_record_size;
+	uint32_t log_record_size_flag = 0;
+	void* compressed_log_record = NULL;
+	if(prefix_size == 0 && wale_p->log_record_codec.codec_id != 0 && wale_p->min_log_record_size_to_compress != 0 && log_record_size >= wale_p->min_log_record_size_to_compress)
+	{
+		uint32_t compressed_log_record_size;
+		compressed_log_record = compress_log_record(&(wale_p->log_record_codec), &(wale_p->allocator), log_record, log_record_size, &compressed_log_record_size);
+		if(compressed_log_record != NULL)
+		{
+			log_record = compressed_log_record;
+			log_record_size = compressed_log_record_size;
+			log_record_size_flag = COMPRESSED_LOG_RECORD_FLAG;
+		}
+	}
+
+	// size of the log record as stored, the prefix and the (may be compressed) log_record
+	uint32_t stored_log_record_size = prefix_size + log_record_size;
+
+	// compute the total bytes we will write, until we take the slot it is only an upper bound, as the varints of the LOG_RECORD_FORMAT_V2 depend on the previous log record
+	uint64_t total_bytes_to_write = max(get_log_record_slot_size(LOG_RECORD_FORMAT_V1, 0, stored_log_record_size), V2_MAX_HEADER_SIZE + ((uint64_t)stored_log_record_size) + UINT64_C(4));
+
+	// file offset of the end of the appended log record, it is set once we take the slot in the append only buffer
+	uint64_t end_file_offset_of_log_record = 0;
+
+	// the prefix is filled at the reservation of the slot
+	char prefix[MAX_LOG_RECORD_PREFIX_SIZE];
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// set, if we waited for the scroll in the queue of the waiters
+	int is_retry = 0;
+
+	// we do not block on the append_only_buffer_lock while the append only buffer is being scrolled, instead we wait in the queue of the scroll waiters
+	// so that the scroll wakes up only as many of us, as there will be space for
+	if(wale_p->is_scrolling_append_only_buffer)
+		is_retry = wait_for_scroll_traced(wale_p, total_bytes_to_write, is_retry);
+
+	ALLOCATE_RELEASED_APPEND_ONLY_BUFFER_AND_SHARE_LOCK:;
+	// the autosizing may have released the append only buffer of this WALe, when it was idle
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle && !reallocate_append_only_buffer_released_on_idle(wale_p, error))
+		goto RELEASE_GLOBAL_LOCK_AND_EXIT;
+
+	// share lock the append_only_buffer, inorder to write data into it at the wale_p->append_offset
+	// we take this lock this early, because we do not want anyone to scroll the append only buffer, after we get a slot in the append only buffer
+	shared_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK, WRITE_PREFERRING);
+
+	// the autosizing may have released it again, while we were waiting for the shared lock
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle)
+	{
+		shared_unlock(&(wale_p->append_only_buffer_lock));
+		goto ALLOCATE_RELEASED_APPEND_ONLY_BUFFER_AND_SHARE_LOCK;
+	}
+
+	while(wale_p->buffer_block_count > 0)
+	{
+		uint64_t file_offset_for_next_log_sequence_number = get_file_offset_for_next_log_sequence_number(&(wale_p->in_memory_master_record), &(wale_p->block_io_functions), error);
+		if(*error)
+			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+		// this is the case when the file_offset_for_next_log_sequence_number is valid,
+		// but it will become invalid for the log_record that goes after it, so we fail preemptively
+		if(will_unsigned_sum_overflow(uint64_t, file_offset_for_next_log_sequence_number, total_bytes_to_write))
+		{
+			(*error) = FILE_OFFSET_OVERFLOW;
+			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		}
+
+		if(!wale_p->major_scroll_error && wale_p->buffer_block_count > 0 &&
+			!is_file_offset_within_append_only_buffer(wale_p, file_offset_for_next_log_sequence_number))
+		{
+			shared_unlock(&(wale_p->append_only_buffer_lock));
+			is_retry = wait_for_scroll_traced(wale_p, total_bytes_to_write, is_retry);
+			shared_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK, WRITE_PREFERRING);
+		}
+		else
+			break;
+	}
+
+	// if the buffer block count is 0, then WALe is not in writable state
+	if(wale_p->buffer_block_count == 0)
+	{
+		(*error) = ZERO_BUFFER_BLOCK_COUNT;
+		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	if(wale_p->major_scroll_error)
+	{
+		(*error) = MAJOR_SCROLL_ERROR;
+		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	// the in_memory_master_record can not change until we release the global lock, so compute the exact bytes we will write
+	uint64_t prev_log_record_slot_size = 0;
+	total_bytes_to_write = get_slot_size_for_next_log_record(wale_p, stored_log_record_size, &prev_log_record_slot_size, error);
+	if(*error)
+		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+	// in ring mode, the new log record must not overwrite the log records that are not yet truncated
+	if(wale_p->ring_block_count != 0)
+	{
+		uint64_t file_offset_for_next_log_sequence_number = get_file_offset_for_next_log_sequence_number(&(wale_p->in_memory_master_record), &(wale_p->block_io_functions), error);
+		if(*error)
+			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+		if(!is_there_space_in_ring_until(wale_p, &(wale_p->in_memory_master_record), file_offset_for_next_log_sequence_number + total_bytes_to_write, error))
+		{
+			if((*error) == NO_ERROR)
+				(*error) = LOG_RING_FULL;
+			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		}
+	}
+
+	// take slot if the next log sequence number is in the append only buffer
+	log_sequence_number = get_log_sequence_number_for_next_log_record_and_advance_master_record(wale_p, total_bytes_to_write, is_check_point, error);
+
+	// exit suggesting failure to allocate a log_sequence_number
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+	// now take the slot in the append only buffer
+	uint64_t append_slot = wale_p->append_offset;
+
+	// the log record ends at this file offset, the APPEND_WRITTEN appenders wait until it is written
+	end_file_offset_of_log_record = wale_p->buffer_start_block_id * wale_p->block_io_functions.block_size + append_slot + total_bytes_to_write;
+
+	// advance the append_offset of the append only buffer
+	wale_p->append_offset = min(wale_p->append_offset + total_bytes_to_write, wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+
+	// observed by the autosizing of the append only buffer
+	wale_p->autosize_appended_bytes += total_bytes_to_write;
+
+	trace_append_slot_reserved(wale_p, log_sequence_number, stored_log_record_size, append_slot);
+
+	// the prefixes are filled with the global lock held, so they are filled in the order of the log_sequence_numbers
+	if(prefix_size > 0)
+		fill_prefix(filler_handle, log_sequence_number, prefix, prefix_size);
+
+	// we have the slot in the append only buffer, and a log_sequence_number, now we don't need the global lock
+	pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	// write the header
+	uint32_t calculated_crc32;
+	{
+		char header[max(HEADER_SIZE + 4, V2_MAX_HEADER_SIZE)];
+		uint32_t header_size = serialize_log_record_header(header, wale_p->in_memory_master_record.log_record_format_version, prev_log_record_slot_size, stored_log_record_size, !!log_record_size_flag, log_record_type, &calculated_crc32);
+		append_log_record_data(wale_p, &append_slot, header, header_size, &total_bytes_to_write, error);
+		if(*error)
+			goto SCROLL_FAIL;
+	}
+
+	// write the prefix
+	if(prefix_size > 0)
+	{
+		append_log_record_data(wale_p, &append_slot, prefix, prefix_size, &total_bytes_to_write, error);
+		calculated_crc32 = crc32_util(calculated_crc32, prefix, prefix_size);
+		if(*error)
+			goto SCROLL_FAIL;
+	}
+
+	// write log record itself
+	append_log_record_data(wale_p, &append_slot, log_record, log_record_size, &total_bytes_to_write, error);
+	calculated_crc32 = crc32_util(calculated_crc32, log_record, log_record_size);
+	if(*error)
+		goto SCROLL_FAIL;
+
+	// write calculated_crc32
+	{
+		char bytes_for_uint32[4];
+		serialize_uint32(bytes_for_uint32, sizeof(uint32_t), calculated_crc32);
+		append_log_record_data(wale_p, &append_slot, bytes_for_uint32, 4, &total_bytes_to_write, error);
+		if(*error)
+			goto SCROLL_FAIL;
+	}
+
+	SCROLL_FAIL:;
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// this condition implies a fail to scroll the append only buffer
+	if(*error)
+		log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT:;
+	// if we failed, we may have been woken up for the space, that we did not take, so let the next waiter have it
+	if((*error) && wale_p->scroll_waiters_head != NULL)
+		wake_up_scroll_waiters(wale_p);
+
+	// share_unlock the append_only_buffer
+	shared_unlock(&(wale_p->append_only_buffer_lock));
+
+	RELEASE_GLOBAL_LOCK_AND_EXIT:;
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	if(compressed_log_record != NULL)
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, compressed_log_record, uncompressed_log_record_size - 1);
+
+	// make the appended log record as durable as requested
+	if(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		int is_durable_enough = 1;
+		if(durability == APPEND_WRITTEN)
+			is_durable_enough = make_log_record_written(wale_p, end_file_offset_of_log_record, error);
+		else if(durability == APPEND_DURABLE)
+			is_durable_enough = make_log_record_durable(wale_p, log_sequence_number, error);
+
+		if(!is_durable_enough)
+			log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	if(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDS, 1);
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDED_BYTES, prefix_size + uncompressed_log_record_size);
+		record_wale_stats_latency(wale_p, WALE_STATS_APPEND_LATENCY, start_time);
+	}
+
+	return log_sequence_number;
+}
+
+uint256 append_typed_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, append_durability durability, int* error)
+{
+	return append_log_record_with_prefix(wale_p, 0, NULL, NULL, log_record, log_record_size, log_record_type, is_check_point, durability, error);
+}
+
+uint256 append_prefixed_log_record(wale* wale_p, uint32_t prefix_size, log_record_prefix_filler fill_prefix, void* filler_handle, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, append_durability durability, int* error)
+{
+	if(fill_prefix == NULL && prefix_size > 0)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	return append_log_record_with_prefix(wale_p, prefix_size, fill_prefix, filler_handle, log_record, log_record_size, log_record_type, is_check_point, durability, error);
+}
+
+uint256 append_raw_log_range(wale* wale_p, uint256 from_log_sequence_number, const void* raw_log_range, uint64_t raw_log_range_size, append_durability durability, int* error)
+{
+	uint64_t start_time = get_wale_stats_time();
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	if(are_equal_uint256(from_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || raw_log_range_size == 0 || durability > APPEND_DURABLE)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	// check all the log records of the raw_log_range once, before taking any locks
+	// they must be whole log records of the log record format of this WALe, each following the one before it
+	uint64_t log_record_count = 0;
+	uint64_t log_records_size = 0;
+	uint64_t offset_of_last_log_record = 0;
+	uint64_t prev_log_record_slot_size_of_first_log_record = 0;
+	for(uint64_t offset = 0; offset < raw_log_range_size;)
+	{
+		log_record_header hdr;
+		uint64_t bytes_available = raw_log_range_size - offset;
+		memory_move(hdr.serial_header, raw_log_range + offset, min(bytes_available, sizeof(hdr.serial_header)));
+		if(!parse_and_check_log_record_header(&hdr, wale_p->in_memory_master_record.log_record_format_version, bytes_available, error))
+			return INVALID_LOG_SEQUENCE_NUMBER;
+
+		if(offset == 0)
+			prev_log_record_slot_size_of_first_log_record = hdr.prev_log_record_slot_size;
+		else if(hdr.prev_log_record_slot_size != offset - offset_of_last_log_record)
+		{
+			(*error) = HEADER_CORRUPTED;
+			return INVALID_LOG_SEQUENCE_NUMBER;
+		}
+
+		uint32_t calculated_crc32 = get_initial_crc32_for_log_record(&hdr, wale_p);
+		calculated_crc32 = crc32_util(calculated_crc32, raw_log_range + offset + hdr.header_size, hdr.curr_log_record_size);
+		if(deserialize_uint32(raw_log_range + offset + hdr.header_size + hdr.curr_log_record_size, sizeof(uint32_t)) != calculated_crc32)
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			return INVALID_LOG_SEQUENCE_NUMBER;
+		}
+
+		offset_of_last_log_record = offset;
+		offset += hdr.header_size + ((uint64_t)(hdr.curr_log_record_size)) + UINT64_C(4);
+		log_records_size += hdr.curr_log_record_size;
+		log_record_count++;
+	}
+
+	uint256 last_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	// file offset of the end of the raw_log_range, it is set once it is copied into the append only buffer
+	uint64_t end_file_offset_of_raw_log_range = 0;
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// the autosizing may have released the append only buffer of this WALe, when it was idle
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle && !reallocate_append_only_buffer_released_on_idle(wale_p, error))
+		goto RELEASE_GLOBAL_LOCK_AND_EXIT;
+
+	// the raw_log_range is copied with an exclusive lock on the append only buffer, just like a flush
+	// it waits for all the appenders, that have taken their slots, to finish writing their log records into the append only buffer
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	if(wale_p->buffer_block_count == 0)
+	{
+		(*error) = ZERO_BUFFER_BLOCK_COUNT;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	if(wale_p->major_scroll_error)
+	{
+		(*error) = MAJOR_SCROLL_ERROR;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	// the log records must go at identical log sequence numbers, right after the last log record of this WALe
+	if(!are_equal_uint256(from_log_sequence_number, wale_p->in_memory_master_record.next_log_sequence_number))
+	{
+		(*error) = PARAM_INVALID;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	// and the first of them must follow the last log record of this WALe, if there is one
+	if(!are_equal_uint256(wale_p->in_memory_master_record.last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		uint64_t prev_log_record_slot_size = 0;
+		get_slot_size_for_next_log_record(wale_p, 0, &prev_log_record_slot_size, error);
+		if(*error)
+			goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+		if(prev_log_record_slot_size != prev_log_record_slot_size_of_first_log_record)
+		{
+			(*error) = PARAM_INVALID;
+			goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		}
+	}
+
+	uint256 new_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	if(!add_size_to_log_sequence_number(wale_p, &new_next_log_sequence_number, from_log_sequence_number, raw_log_range_size))
+	{
+		(*error) = LOG_SEQUENCE_NUMBER_OVERFLOW;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	uint64_t file_offset_for_next_log_sequence_number = get_file_offset_for_next_log_sequence_number(&(wale_p->in_memory_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+
+	if(will_unsigned_sum_overflow(uint64_t, file_offset_for_next_log_sequence_number, raw_log_range_size))
+	{
+		(*error) = FILE_OFFSET_OVERFLOW;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	// in ring mode, the log records must not overwrite the log records that are not yet truncated
+	if(wale_p->ring_block_count != 0 && !is_there_space_in_ring_until(wale_p, &(wale_p->in_memory_master_record), file_offset_for_next_log_sequence_number + raw_log_range_size, error))
+	{
+		if((*error) == NO_ERROR)
+			(*error) = LOG_RING_FULL;
+		goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	}
+
+	// copy the raw_log_range into the append only buffer as is, scrolling it whenever it is full
+	uint64_t append_only_buffer_size = wale_p->buffer_block_count * wale_p->block_io_functions.block_size;
+	for(uint64_t bytes_copied = 0; bytes_copied < raw_log_range_size;)
+	{
+		uint64_t bytes_to_copy = min(append_only_buffer_size - wale_p->append_offset, raw_log_range_size - bytes_copied);
+		memory_move(wale_p->buffer + wale_p->append_offset, raw_log_range + bytes_copied, bytes_to_copy);
+		wale_p->append_offset += bytes_to_copy;
+		bytes_copied += bytes_to_copy;
+
+		if(wale_p->append_offset == append_only_buffer_size && !scroll_append_only_buffer(wale_p))
+		{
+			(*error) = MAJOR_SCROLL_ERROR;
+			wale_p->major_scroll_error = 1;
+			goto RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		}
+	}
+
+	end_file_offset_of_raw_log_range = file_offset_for_next_log_sequence_number + raw_log_range_size;
+
+	// the log records of the raw_log_range are now appended, so advance the in_memory_master_record past them
+	add_size_to_log_sequence_number(wale_p, &last_log_sequence_number, from_log_sequence_number, offset_of_last_log_record);
+	if(are_equal_uint256(wale_p->in_memory_master_record.first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		wale_p->in_memory_master_record.first_log_sequence_number = from_log_sequence_number;
+		wale_p->in_memory_master_record.base_log_sequence_number = from_log_sequence_number;
+	}
+	wale_p->in_memory_master_record.last_flushed_log_sequence_number = last_log_sequence_number;
+	wale_p->in_memory_master_record.next_log_sequence_number = new_next_log_sequence_number;
+
+	// observed by the autosizing of the append only buffer
+	wale_p->autosize_appended_bytes += raw_log_range_size;
+
+	RELEASE_EXCLUSIVE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT:;
+	// the append only buffer may have been scrolled, or the WALe may have encountered a major scroll error
+	wake_up_all_scroll_waiters(wale_p);
+
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	RELEASE_GLOBAL_LOCK_AND_EXIT:;
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	// make the appended log records as durable as requested
+	if(!are_equal_uint256(last_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		int is_durable_enough = 1;
+		if(durability == APPEND_WRITTEN)
+			is_durable_enough = make_log_record_written(wale_p, end_file_offset_of_raw_log_range, error);
+		else if(durability == APPEND_DURABLE)
+			is_durable_enough = make_log_record_durable(wale_p, last_log_sequence_number, error);
+
+		if(!is_durable_enough)
+			last_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	if(!are_equal_uint256(last_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDS, log_record_count);
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDED_BYTES, log_records_size);
+		record_wale_stats_latency(wale_p, WALE_STATS_APPEND_LATENCY, start_time);
+	}
+
+	return last_log_sequence_number;
+}
+
+// a failed direct io of a large log record is a major scroll error, as the log now has a hole in it, it is recorded in the writer and in the WALe
+// it must be called without the global lock
+static void fail_large_log_record_writer(large_log_record_writer* writer)
+{
+	wale* wale_p = writer->wale_p;
+
+	writer->error = MAJOR_SCROLL_ERROR;
+
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+	wale_p->major_scroll_error = 1;
+	wake_up_all_scroll_waiters(wale_p);
+	pthread_mutex_unlock(get_wale_lock(wale_p));
+}
+
+// writes the block_count blocks of a large log record directly, it must be called without the global lock
+static int write_large_log_record_blocks(large_log_record_writer* writer, const void* blocks, uint64_t block_id, uint64_t block_count)
+{
+	wale* wale_p = writer->wale_p;
+
+	// with write_blocks_durable, the flushes do not flush all the writes, so these writes must be durable aswell
+	int io_success = (wale_p->block_io_functions.write_blocks_durable != NULL)
+		? wale_p->block_io_functions.write_blocks_durable(wale_p->block_io_functions.block_io_ops_handle, blocks, block_id, block_count)
+		: wale_p->block_io_functions.write_blocks(wale_p->block_io_functions.block_io_ops_handle, blocks, block_id, block_count);
+
+	if(!io_success)
+		fail_large_log_record_writer(writer);
+
+	return io_success;
+}
+
+// writes the bytes of the log record at the next_file_offset of the writer, it must be called without the global lock
+// the bytes before the buffered_file_offset are staged, and the staged blocks are written directly once they are complete
+// the rest go in to the tail_block, that is copied into the append only buffer by the end_large_log_record()
+// returns 0, if a direct write failed
+static int write_large_log_record_bytes(large_log_record_writer* writer, const char* data, uint64_t data_size)
+{
+	wale* wale_p = writer->wale_p;
+	uint64_t block_size = wale_p->block_io_functions.block_size;
+
+	while(data_size > 0 && !writer->error)
+	{
+		if(writer->next_file_offset >= writer->buffered_file_offset)
+		{
+			memory_move(writer->tail_block + get_block_offset_from_file_offset(writer->next_file_offset, &(wale_p->block_io_functions)), data, data_size);
+			writer->next_file_offset += data_size;
+			break;
+		}
+
+		// the buffered_file_offset is at a block boundary, if there are bytes before it
+		uint64_t staged_end_file_offset = min((writer->staged_block_id + writer->staged_block_count) * block_size, writer->buffered_file_offset);
+		uint64_t bytes_to_write = min(data_size, staged_end_file_offset - writer->next_file_offset);
+		memory_move(writer->staged_blocks + (writer->next_file_offset - writer->staged_block_id * block_size), data, bytes_to_write);
+		writer->next_file_offset += bytes_to_write;
+		data += bytes_to_write;
+		data_size -= bytes_to_write;
+
+		if(writer->next_file_offset == staged_end_file_offset)
+		{
+			uint64_t block_count_to_write = get_block_id_from_file_offset(staged_end_file_offset, &(wale_p->block_io_functions)) - writer->staged_block_id;
+			write_large_log_record_blocks(writer, writer->staged_blocks, writer->staged_block_id, block_count_to_write);
+			writer->staged_block_id += block_count_to_write;
+		}
+	}
+
+	return !writer->error;
+}
+
+// writes the master record of a flush only until the log record before the first large log record in progress, as the log records from it are not yet complete on the disk
+// the bytes of the log records before it are on the disk, as the begin_large_log_record() scrolled them out
+static void exclude_large_log_records_in_progress(master_record* mr, const large_log_record_writer* first_writer)
+{
+	mr->last_flushed_log_sequence_number = first_writer->prev_log_sequence_number;
+	mr->check_point_log_sequence_number = first_writer->prev_check_point_log_sequence_number;
+	mr->next_log_sequence_number = first_writer->log_sequence_number;
+
+	// the WALe was empty before it
+	if(are_equal_uint256(first_writer->prev_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		mr->first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+		mr->base_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+}
+
+// the blocks of a large log record are written directly, atmost these many bytes at a time
+#define LARGE_LOG_RECORD_STAGING_SIZE (UINT64_C(1) << 20)
+
+uint256 begin_large_log_record(wale* wale_p, large_log_record_writer* writer, uint32_t log_record_size, uint8_t log_record_type, int is_check_point, int* error)
+{
+	uint64_t start_time = get_wale_stats_time();
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	if(log_record_size > MAX_LOG_RECORD_SIZE || (log_record_type != 0 && wale_p->in_memory_master_record.log_record_format_version == LOG_RECORD_FORMAT_V1))
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	// an upper bound on the bytes of the log record, it never needs more blocks staged than it spans
+	uint64_t max_total_bytes_to_write = max(get_log_record_slot_size(LOG_RECORD_FORMAT_V1, 0, log_record_size), V2_MAX_HEADER_SIZE + ((uint64_t)log_record_size) + UINT64_C(4));
+
+	uint64_t block_size = wale_p->block_io_functions.block_size;
+	(*writer) = (large_log_record_writer){
+		.wale_p = wale_p,
+		.log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
+		.log_record_size = log_record_size,
+		.is_check_point = is_check_point,
+		.staged_block_count = max(1, min(LARGE_LOG_RECORD_STAGING_SIZE / block_size, get_block_count_for_size(max_total_bytes_to_write, &(wale_p->block_io_functions)) + 1)),
+		.start_time = start_time,
+	};
+	writer->staged_blocks = wale_p->allocator.allocate(wale_p->allocator.allocator_handle, wale_p->block_io_functions.block_buffer_alignment, (writer->staged_block_count + 1) * block_size);
+	if(writer->staged_blocks == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+	writer->tail_block = writer->staged_blocks + writer->staged_block_count * block_size;
+
+	uint256 log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	ALLOCATE_RELEASED_APPEND_ONLY_BUFFER_AND_EXCLUSIVE_LOCK:;
+	// the autosizing may have released the append only buffer of this WALe, when it was idle
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle && !reallocate_append_only_buffer_released_on_idle(wale_p, error))
+		goto RELEASE_GLOBAL_LOCK_AND_EXIT;
+
+	// exclusive lock the append_only_buffer, as we move it past the blocks of this log record
+	// this waits until all the appenders before us have written their log records into it
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	// the autosizing may have released it again, while we were waiting for the exclusive lock
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle)
+	{
+		exclusive_unlock(&(wale_p->append_only_buffer_lock));
+		goto ALLOCATE_RELEASED_APPEND_ONLY_BUFFER_AND_EXCLUSIVE_LOCK;
+	}
+
+	// if the buffer block count is 0, then WALe is not in writable state
+	if(wale_p->buffer_block_count == 0)
+	{
+		(*error) = ZERO_BUFFER_BLOCK_COUNT;
+		goto RELEASE_EXCLUSIVE_LOCK_AND_EXIT;
+	}
+
+	if(wale_p->major_scroll_error)
+	{
+		(*error) = MAJOR_SCROLL_ERROR;
+		goto RELEASE_EXCLUSIVE_LOCK_AND_EXIT;
+	}
+
+	// write out the log records before this one, after this the append only buffer starts at the block of the next_log_sequence_number
+	if(!scroll_append_only_buffer(wale_p))
+	{
+		wale_p->major_scroll_error = 1;
+		(*error) = MAJOR_SCROLL_ERROR;
+		wake_up_all_scroll_waiters(wale_p);
+		goto RELEASE_EXCLUSIVE_LOCK_AND_EXIT;
+	}
+
+	uint64_t append_slot = wale_p->append_offset;
+	uint64_t file_offset_for_next_log_sequence_number = wale_p->buffer_start_block_id * block_size + append_slot;
+
+	// this is the case when the file_offset_for_next_log_sequence_number is valid,
+	// but it will become invalid for the log_record that goes after it, so we fail preemptively
+	if(will_unsigned_sum_overflow(uint64_t, file_offset_for_next_log_sequence_number, max_total_bytes_to_write))
+	{
+		(*error) = FILE_OFFSET_OVERFLOW;
+		goto WAKE_UP_SCROLL_WAITERS_AND_EXIT;
+	}
+
+	uint64_t prev_log_record_slot_size = 0;
+	uint64_t total_bytes_to_write = get_slot_size_for_next_log_record(wale_p, log_record_size, &prev_log_record_slot_size, error);
+	if(*error)
+		goto WAKE_UP_SCROLL_WAITERS_AND_EXIT;
+
+	// in ring mode, the new log record must not overwrite the log records that are not yet truncated
+	if(wale_p->ring_block_count != 0 && !is_there_space_in_ring_until(wale_p, &(wale_p->in_memory_master_record), file_offset_for_next_log_sequence_number + total_bytes_to_write, error))
+	{
+		if((*error) == NO_ERROR)
+			(*error) = LOG_RING_FULL;
+		goto WAKE_UP_SCROLL_WAITERS_AND_EXIT;
+	}
+
+	// the flushes write the master record as it is now, until this log record ends
+	writer->prev_log_sequence_number = wale_p->in_memory_master_record.last_flushed_log_sequence_number;
+	writer->prev_check_point_log_sequence_number = wale_p->in_memory_master_record.check_point_log_sequence_number;
+
+	// the check_point_log_sequence_number is advanced by the end_large_log_record(), only if the log record is completed
+	log_sequence_number = get_log_sequence_number_for_next_log_record_and_advance_master_record(wale_p, total_bytes_to_write, 0, error);
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		goto WAKE_UP_SCROLL_WAITERS_AND_EXIT;
+
+	writer->log_sequence_number = log_sequence_number;
+
+	// it is the last of the large log records in progress, as it has the largest log_sequence_number
+	large_log_record_writer** last_writer = &(wale_p->large_log_record_writers);
+	while((*last_writer) != NULL)
+		last_writer = &((*last_writer)->next_in_progress);
+	(*last_writer) = writer;
+	writer->next_file_offset = file_offset_for_next_log_sequence_number;
+	writer->end_file_offset = file_offset_for_next_log_sequence_number + total_bytes_to_write;
+
+	// the first block of the log record is staged along with the bytes of the log records before it
+	memory_move(writer->staged_blocks, wale_p->buffer, append_slot);
+	writer->staged_block_id = wale_p->buffer_start_block_id;
+
+	// the append only buffer now starts at the last partial block of this log record, the bytes of the log record in that block go through it (at the end_large_log_record())
+	uint64_t end_block_id = get_block_id_from_file_offset(writer->end_file_offset, &(wale_p->block_io_functions));
+	writer->buffered_file_offset = max(file_offset_for_next_log_sequence_number, end_block_id * block_size);
+	wale_p->buffer_start_block_id = end_block_id;
+	wale_p->append_offset = writer->end_file_offset - end_block_id * block_size;
+
+	// observed by the autosizing of the append only buffer, the directly written bytes never pass through it
+	wale_p->autosize_appended_bytes += writer->end_file_offset - writer->buffered_file_offset;
+
+	trace_append_slot_reserved(wale_p, log_sequence_number, log_record_size, append_slot);
+
+	WAKE_UP_SCROLL_WAITERS_AND_EXIT:;
+	// the appenders after this log record may now take their slots in the append only buffer
+	wake_up_scroll_waiters(wale_p);
+
+	RELEASE_EXCLUSIVE_LOCK_AND_EXIT:;
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	RELEASE_GLOBAL_LOCK_AND_EXIT:;
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, writer->staged_blocks, (writer->staged_block_count + 1) * block_size);
+		writer->staged_blocks = NULL;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
 
-			// upgrade your shared lock on the append_only_buffer to exclusive lock while we scroll
-			upgrade_lock(&(wale_p->append_only_buffer_lock), BLOCKING);
+	// the header, a failure to write it is reported by the next call on the writer
+	char header[max(HEADER_SIZE + 4, V2_MAX_HEADER_SIZE)];
+	uint32_t header_size = serialize_log_record_header(header, wale_p->in_memory_master_record.log_record_format_version, prev_log_record_slot_size, log_record_size, 0, log_record_type, &(writer->calculated_crc32));
 
-			// scroll and preserve the scroll error for the caller to see
-			(*error_in_scroll) = !scroll_append_only_buffer(wale_p);
+	// the header may complete a staged block, and a failed direct write takes the global lock, so the external lock must not be held
+	if(!wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
 
-			// downgrade back to shared_lock on the append_only_buffer after the scroll
-			downgrade_lock(&(wale_p->append_only_buffer_lock));
+	write_large_log_record_bytes(writer, header, header_size);
 
-			if(!(*error_in_scroll))
-			{
-				// take the probably the first slot and advance the append_offset to how much we can write at most
-				(*append_slot) = wale_p->append_offset;
-				wale_p->append_offset = min(wale_p->append_offset + (*total_bytes_to_write_for_this_log_record), wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+	if(!wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
-				// if there is space in the append_only_buffer then we wake other writers to append_only_buffer, who are waiting for append_only_buffer to scroll to the next_log_sequence_number
-				if(wale_p->append_offset < wale_p->buffer_block_count * wale_p->block_io_functions.block_size)
-					pthread_cond_broadcast(&(wale_p->wait_for_scroll));
-			}
-			else
-			{
-				// in case of scroll error, wake up any threads waiting for a successfull scroll
-				wale_p->major_scroll_error = 1;
-				pthread_cond_broadcast(&(wale_p->wait_for_scroll));
-			}
+	return log_sequence_number;
+}
 
-			pthread_mutex_unlock(get_wale_lock(wale_p));
+int write_large_log_record_chunk(large_log_record_writer* writer, const void* chunk, uint32_t chunk_size, int* error)
+{
+	wale* wale_p = writer->wale_p;
 
-			// if scroll was a failure we break out of the loop
-			if((*error_in_scroll))
-				break;
-		}
+	if(writer->error)
+	{
+		(*error) = writer->error;
+		return 0;
 	}
 
-	return bytes_written;
-}
+	if(chunk_size > writer->log_record_size - writer->received_size)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
 
-uint256 append_log_record(wale* wale_p, const void* log_record, uint32_t log_record_size, int is_check_point, int* error)
-{
 	// initialize error to no error
 	(*error) = NO_ERROR;
 
-	// return value defaults to an INVALID_LOG_SEQUENCE_NUMBER
-	uint256 log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	// we do not need the global lock, as the bytes of the log record are either staged or written directly, until the end_large_log_record()
+	if(!wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
 
-	// compute the total bytes we will write
-	uint64_t total_bytes_to_write = HEADER_SIZE + ((uint64_t)log_record_size) + UINT64_C(8); // 8 for the 2 crc32 values of the header and the log record each
+	writer->calculated_crc32 = crc32_util(writer->calculated_crc32, chunk, chunk_size);
+	writer->received_size += chunk_size;
+	int res = write_large_log_record_bytes(writer, chunk, chunk_size);
 
-	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+	if(!wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
-	// share lock the append_only_buffer, inorder to write data into it at the wale_p->append_offset
-	// we take this lock this early, because we do not want anyone to scroll the append only buffer, after we get a slot in the append only buffer
-	shared_lock(&(wale_p->append_only_buffer_lock), WRITE_PREFERRING, BLOCKING);
+	if(!res)
+		(*error) = writer->error;
+	return res;
+}
 
-	while(wale_p->buffer_block_count > 0)
-	{
-		uint64_t file_offset_for_next_log_sequence_number = get_file_offset_for_next_log_sequence_number(&(wale_p->in_memory_master_record), &(wale_p->block_io_functions), error);
-		if(*error)
-			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+uint256 end_large_log_record(large_log_record_writer* writer, append_durability durability, int* error)
+{
+	wale* wale_p = writer->wale_p;
 
-		// this is the case when the file_offset_for_next_log_sequence_number is valid,
-		// but it will become invalid for the log_record that goes after it, so we fail preemptively
-		if(will_unsigned_sum_overflow(uint64_t, file_offset_for_next_log_sequence_number, total_bytes_to_write))
-		{
-			(*error) = FILE_OFFSET_OVERFLOW;
-			goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
-		}
+	// initialize error to no error
+	(*error) = NO_ERROR;
 
-		if(!wale_p->major_scroll_error && wale_p->buffer_block_count > 0 &&
-			!is_file_offset_within_append_only_buffer(wale_p, file_offset_for_next_log_sequence_number))
-		{
-			shared_unlock(&(wale_p->append_only_buffer_lock));
-			pthread_cond_wait(&(wale_p->wait_for_scroll), get_wale_lock(wale_p));
-			shared_lock(&(wale_p->append_only_buffer_lock), WRITE_PREFERRING, BLOCKING);
-		}
-		else
-			break;
-	}
+	if(!wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
 
-	// if the buffer block count is 0, then WALe is not in writable state
-	if(wale_p->buffer_block_count == 0)
+	// an incomplete log record is filled with zeros, as its slot is already taken, so that the log records after it can still be reached
+	int is_incomplete = (writer->received_size < writer->log_record_size);
+	while(!writer->error && writer->received_size < writer->log_record_size)
 	{
-		(*error) = ZERO_BUFFER_BLOCK_COUNT;
-		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		static const char zeros[512] = {0};
+		uint32_t bytes_to_write = min(sizeof(zeros), writer->log_record_size - writer->received_size);
+		writer->calculated_crc32 = crc32_util(writer->calculated_crc32, zeros, bytes_to_write);
+		writer->received_size += bytes_to_write;
+		write_large_log_record_bytes(writer, zeros, bytes_to_write);
 	}
 
-	if(wale_p->major_scroll_error)
+	// write calculated_crc32, this also writes the last of the staged blocks
+	// the header of an incomplete log record stays valid, but its crc32 is deliberately wrong, so that its zeros are never read as its contents
+	if(!writer->error)
 	{
-		(*error) = MAJOR_SCROLL_ERROR;
-		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+		char bytes_for_uint32[4];
+		serialize_uint32(bytes_for_uint32, sizeof(uint32_t), is_incomplete ? ~(writer->calculated_crc32) : writer->calculated_crc32);
+		write_large_log_record_bytes(writer, bytes_for_uint32, 4);
 	}
 
-	// take slot if the next log sequence number is in the append only buffer
-	uint32_t prev_log_record_size = 0;
-	log_sequence_number = get_log_sequence_number_for_next_log_record_and_advance_master_record(wale_p, log_record_size, is_check_point, &prev_log_record_size, error);
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
-	// exit suggesting failure to allocate a log_sequence_number
-	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
-		goto RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT;
+	// copy the tail_block into the last partial block of the log record, if the append only buffer is still at it
+	// else the appenders after this log record have scrolled it out (without the bytes of this log record), so it is read and written again directly
+	// the append only buffer never moves back to it, as the discards and the truncations fail while this log record is in progress
+	uint64_t tail_block_id = get_block_id_from_file_offset(writer->end_file_offset, &(wale_p->block_io_functions));
+	int is_tail_block_scrolled_out = 0;
+	if(!writer->error && writer->buffered_file_offset < writer->end_file_offset)
+	{
+		shared_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK, WRITE_PREFERRING);
 
-	// now take the slot in the append only buffer
-	uint64_t append_slot = wale_p->append_offset;
+		uint64_t tail_offset = get_block_offset_from_file_offset(writer->buffered_file_offset, &(wale_p->block_io_functions));
+		if(wale_p->buffer_block_count > 0 && wale_p->buffer_start_block_id == tail_block_id)
+		{
+			memory_move(wale_p->buffer + tail_offset, writer->tail_block + tail_offset, writer->end_file_offset - writer->buffered_file_offset);
 
-	// advance the append_offset of the append only buffer
-	wale_p->append_offset = min(wale_p->append_offset + total_bytes_to_write, wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+			// a scroll may have written this block, without the bytes of this log record
+			wale_p->written_file_offset = min(wale_p->written_file_offset, writer->buffered_file_offset);
+		}
+		else
+			is_tail_block_scrolled_out = 1;
 
-	// we have the slot in the append only buffer, and a log_sequence_number, now we don't need the global lock
-	pthread_mutex_unlock(get_wale_lock(wale_p));
+		shared_unlock(&(wale_p->append_only_buffer_lock));
+	}
 
-	// serialize log_record_size as a byte array ordered in little endian format
-	char bytes_for_uint32[4];
-	uint32_t calculated_crc32 = crc32_init();
+	if(is_tail_block_scrolled_out)
+	{
+		pthread_mutex_unlock(get_wale_lock(wale_p));
 
-	// write prev_log_record_size
-	serialize_uint32(bytes_for_uint32, sizeof(uint32_t), prev_log_record_size);
-	calculated_crc32 = crc32_util(calculated_crc32, bytes_for_uint32, 4);
-	append_log_record_data(wale_p, &append_slot, bytes_for_uint32, 4, &total_bytes_to_write, error);
-	if(*error)
-		goto SCROLL_FAIL;
+		// the first of the staged_blocks is free now, all of them have been written
+		uint64_t tail_offset = get_block_offset_from_file_offset(writer->buffered_file_offset, &(wale_p->block_io_functions));
+		if(!wale_p->block_io_functions.read_blocks(wale_p->block_io_functions.block_io_ops_handle, writer->staged_blocks, tail_block_id, 1))
+			fail_large_log_record_writer(writer);
+		else
+		{
+			memory_move(writer->staged_blocks + tail_offset, writer->tail_block + tail_offset, writer->end_file_offset - writer->buffered_file_offset);
+			write_large_log_record_blocks(writer, writer->staged_blocks, tail_block_id, 1);
+		}
 
-	// write log_record_size
-	serialize_uint32(bytes_for_uint32, sizeof(uint32_t), log_record_size);
-	calculated_crc32 = crc32_util(calculated_crc32, bytes_for_uint32, 4);
-	append_log_record_data(wale_p, &append_slot, bytes_for_uint32, 4, &total_bytes_to_write, error);
-	if(*error)
-		goto SCROLL_FAIL;
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+	}
 
-	// write calculated_crc32
-	serialize_uint32(bytes_for_uint32, sizeof(uint32_t), calculated_crc32);
-	append_log_record_data(wale_p, &append_slot, bytes_for_uint32, 4, &total_bytes_to_write, error);
-	if(*error)
-		goto SCROLL_FAIL;
+	// only a complete log record becomes the checkpoint, and not if a later log record already became one
+	// the large log records in progress after it, must let the flushes write it as the checkpoint
+	if(writer->is_check_point && !writer->error && !is_incomplete)
+	{
+		if(are_equal_uint256(wale_p->in_memory_master_record.check_point_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(wale_p->in_memory_master_record.check_point_log_sequence_number, writer->log_sequence_number) < 0)
+			wale_p->in_memory_master_record.check_point_log_sequence_number = writer->log_sequence_number;
 
-	// reinitialize the calculated_crc32
-	calculated_crc32 = crc32_init();
+		for(large_log_record_writer* later_writer = writer->next_in_progress; later_writer != NULL; later_writer = later_writer->next_in_progress)
+			if(are_equal_uint256(later_writer->prev_check_point_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(later_writer->prev_check_point_log_sequence_number, writer->log_sequence_number) < 0)
+				later_writer->prev_check_point_log_sequence_number = writer->log_sequence_number;
+	}
 
-	// write log record itself
-	append_log_record_data(wale_p, &append_slot, log_record, log_record_size, &total_bytes_to_write, error);
-	calculated_crc32 = crc32_util(calculated_crc32, log_record, log_record_size);
-	if(*error)
-		goto SCROLL_FAIL;
+	// the log record has ended, so the flushes may now cover it and the log records after it
+	large_log_record_writer** writer_p = &(wale_p->large_log_record_writers);
+	while((*writer_p) != writer)
+		writer_p = &((*writer_p)->next_in_progress);
+	(*writer_p) = writer->next_in_progress;
+	writer->next_in_progress = NULL;
+	pthread_cond_broadcast(&(wale_p->large_log_record_ended));
 
-	// write calculated_crc32
-	serialize_uint32(bytes_for_uint32, sizeof(uint32_t), calculated_crc32);
-	append_log_record_data(wale_p, &append_slot, bytes_for_uint32, 4, &total_bytes_to_write, error);
-	if(*error)
-		goto SCROLL_FAIL;
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
 
-	SCROLL_FAIL:;
-	pthread_mutex_lock(get_wale_lock(wale_p));
+	wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, writer->staged_blocks, (writer->staged_block_count + 1) * wale_p->block_io_functions.block_size);
+	writer->staged_blocks = NULL;
 
-	// this condition implies a fail to scroll the append only buffer
-	if(*error)
+	uint256 log_sequence_number = writer->log_sequence_number;
+	if(writer->error)
+	{
+		(*error) = writer->error;
+		log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+	else if(is_incomplete || durability > APPEND_DURABLE)
+	{
+		(*error) = PARAM_INVALID;
 		log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
 
-	RELEASE_SHARE_LOCK_ON_APPEND_ONLY_BUFFER_AND_EXIT:;
-	// share_unlock the append_only_buffer
-	shared_unlock(&(wale_p->append_only_buffer_lock));
+	// make the appended log record as durable as requested
+	if(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		int is_durable_enough = 1;
+		if(durability == APPEND_WRITTEN)
+			is_durable_enough = make_log_record_written(wale_p, writer->end_file_offset, error);
+		else if(durability == APPEND_DURABLE)
+			is_durable_enough = make_log_record_durable(wale_p, log_sequence_number, error);
+
+		if(!is_durable_enough)
+			log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
 
-	if(wale_p->has_internal_lock)
-		pthread_mutex_unlock(get_wale_lock(wale_p));
+	if(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDS, 1);
+		add_to_wale_stats_counter(wale_p, WALE_STATS_APPENDED_BYTES, writer->log_record_size);
+		record_wale_stats_latency(wale_p, WALE_STATS_APPEND_LATENCY, writer->start_time);
+	}
 
 	return log_sequence_number;
 }
@@ -686,15 +2189,35 @@ uint256 flush_all_log_records(wale* wale_p, int* error)
 	// initialize error to no error
 	(*error) = NO_ERROR;
 
+	add_to_wale_stats_counter(wale_p, WALE_STATS_FLUSHES, 1);
+	trace_flush_begin(wale_p);
+
 	// return value defaults to INVALID_LOG_SEQUENCE_NUMBER
 	uint256 last_flushed_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 
+	// the log records before this one were flushed by this call, it is recorded in the attached time index
+	uint256 flushed_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
 	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// this flush covers all the log records appended until now, the APPEND_DURABLE appenders may wait for it, instead of issuing their own flushes
+	int is_flush_pending = 1;
+	add_pending_flush(wale_p);
 
 	// get exclusive_lock on the append_only_buffer
 	// this waits only until, all append_log_record calls that were allotted be written to buffer (they may scroll if they will)
-	exclusive_lock(&(wale_p->append_only_buffer_lock), BLOCKING);
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	// an append only buffer is released by the autosizing, only after all of its log records have been flushed, so there is nothing to flush
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle)
+	{
+		read_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK, READ_PREFERRING);
+		last_flushed_log_sequence_number = wale_p->on_disk_master_record.last_flushed_log_sequence_number;
+		read_unlock(&(wale_p->flushed_log_records_lock));
+		exclusive_unlock(&(wale_p->append_only_buffer_lock));
+		goto EXIT;
+	}
 
 	// if the buffer block count is 0, then WALe is not in writable state
 	if(wale_p->buffer_block_count == 0)
@@ -721,39 +2244,67 @@ uint256 flush_all_log_records(wale* wale_p, int* error)
 	{
 		wale_p->major_scroll_error = 1;
 		(*error) = MAJOR_SCROLL_ERROR;
+		wake_up_all_scroll_waiters(wale_p);
 		exclusive_unlock(&(wale_p->append_only_buffer_lock));
 		goto EXIT;
 	}
 
-	// wake up any thread that was waiting for scroll to finish (even if there is scroll_error, we need to wake them up to let them know about it)
-	pthread_cond_broadcast(&(wale_p->wait_for_scroll));
+	// wake up the threads that were waiting for scroll to finish, as many as there is space for in the append only buffer
+	wake_up_scroll_waiters(wale_p);
 
 	// copy the valid values for flushing the on disk master record, before we release the global mutex lock
 	master_record new_on_disk_master_record = wale_p->in_memory_master_record;
+	if(wale_p->large_log_record_writers != NULL)
+		exclude_large_log_records_in_progress(&new_on_disk_master_record, wale_p->large_log_record_writers);
 
-	// we now need to write the new_on_disk_master_record to the on_disk_master_record and the actual on-disk master record, with respective flushes
-	write_lock(&(wale_p->flushed_log_records_lock), BLOCKING);
-
-	// release exclusive lock after the scroll is complete
-	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+	// begin the epoch of this flush, while we still hold the exclusive lock, so that the epochs begin in the order of their master records
+	uint64_t flush_epoch = begin_flush_epoch(wale_p);
 
-	// here the above locking order is essential, it ensures that the updates of flush are always installed in lock step order in the event of 2 ongoing flushes
+	// the APPEND_DURABLE appenders of the log records before this next_log_sequence_number may now join this epoch
+	wale_p->last_flush_epoch = flush_epoch;
+	wale_p->last_flush_epoch_next_log_sequence_number = new_on_disk_master_record.next_log_sequence_number;
+	is_flush_pending = 0;
+	remove_pending_flush(wale_p);
 
+	// release exclusive lock after the scroll is complete
 	// As you can predict/observe/analyze, now from here on, other append only writers, scrollers and flushes can proceed with their task concurrently with this one
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
 
 	// release the global lock
 	pthread_mutex_unlock(get_wale_lock(wale_p));
 
-	int flush_success = wale_p->block_io_functions.flush_all_writes(wale_p->block_io_functions.block_io_ops_handle) 
-	&& write_and_flush_master_record(&new_on_disk_master_record, &(wale_p->block_io_functions), error);
+	// flush the blocks written until now, without holding the flushed_log_records_lock
+	// this overlaps with the block writes of the next epoch, and with the master record write of the previous epoch
+	// with write_blocks_durable, all the scrolls (including ours) were durable writes, so there is nothing to flush
+	int flush_success = 1;
+	if(wale_p->block_io_functions.write_blocks_durable == NULL)
+		flush_success = wale_p->block_io_functions.flush_all_writes(wale_p->block_io_functions.block_io_ops_handle);
+
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// the master records are written and installed in the order of the epochs
+	wait_for_turn_of_flush_epoch(wale_p, flush_epoch);
+
+	if(flush_success)
+	{
+		// only the writers of the master record (i.e. the epochs) touch the block 0, and it is our turn, so no lock is required for this io
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+		flush_success = write_and_flush_master_record_with_stats(wale_p, &new_on_disk_master_record, error);
+
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+	}
 
 	if(flush_success)
 	{
-		// update the on_disk_master_record to the new value
+		// update the on_disk_master_record to the new value, the write lock is held only for this update
+		write_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK);
 		wale_p->on_disk_master_record = new_on_disk_master_record;
+		write_unlock(&(wale_p->flushed_log_records_lock));
 
 		// also set the return value
 		last_flushed_log_sequence_number = new_on_disk_master_record.last_flushed_log_sequence_number;
+		flushed_next_log_sequence_number = new_on_disk_master_record.next_log_sequence_number;
 	}
 	else
 	{
@@ -761,33 +2312,75 @@ uint256 flush_all_log_records(wale* wale_p, int* error)
 			(*error) = WRITE_IO_ERROR;
 	}
 
-	pthread_mutex_lock(get_wale_lock(wale_p));
-
-	// release write lock on the flushed_log_records
-	write_unlock(&(wale_p->flushed_log_records_lock));
+	// let the next epoch write its master record
+	complete_flush_epoch(wale_p, flush_epoch);
 
 	EXIT:;
+	if(is_flush_pending)
+		remove_pending_flush(wale_p);
+
+	// record the time of this flush in the attached time index, without the global lock
+	// the time index is only a hint for the find_log_sequence_number_at_time(), so its failure does not fail the flush
+	if(wale_p->time_index != NULL && !are_equal_uint256(flushed_next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		if(!wale_p->has_internal_lock)
+			pthread_mutex_unlock(get_wale_lock(wale_p));
+
+		int time_index_error;
+		record_in_wale_time_index(wale_p->time_index, get_wale_time_index_now(), flushed_next_log_sequence_number, &time_index_error);
+
+		if(!wale_p->has_internal_lock)
+			pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+	}
+
 	if(wale_p->has_internal_lock)
 		pthread_mutex_unlock(get_wale_lock(wale_p));
 
+	trace_flush_end(wale_p, last_flushed_log_sequence_number, (*error) == NO_ERROR);
+
 	return last_flushed_log_sequence_number;
 }
 
+int make_log_records_durable_until(wale* wale_p, uint256 log_sequence_number, int* error)
+{
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	return make_log_record_durable(wale_p, log_sequence_number, error);
+}
+
 uint256 discard_unflushed_log_records(wale* wale_p, int* error)
 {
 	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 	// default return value, on failure
 	uint256 last_flushed_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 
-	exclusive_lock(&(wale_p->append_only_buffer_lock), BLOCKING);
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	// the ongoing flushes must install their master records first, as the log records flushed by them can not be discarded
+	wait_for_all_flush_epochs(wale_p);
 
 	// read new in_memory_master_record
-	read_lock(&(wale_p->flushed_log_records_lock), READ_PREFERRING, BLOCKING);
+	read_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK, READ_PREFERRING);
 	master_record new_in_memory_master_record = wale_p->on_disk_master_record;
 	read_unlock(&(wale_p->flushed_log_records_lock));
 
+	// an append only buffer is released by the autosizing, only after all of its log records have been flushed, so there is nothing to discard
+	if(wale_p->buffer_block_count == 0 && wale_p->is_append_only_buffer_released_on_idle)
+	{
+		(*error) = NO_ERROR;
+		last_flushed_log_sequence_number = new_in_memory_master_record.last_flushed_log_sequence_number;
+		goto EXIT;
+	}
+
 	// if the buffer block count is 0, then WALe is not in writable state
 	if(wale_p->buffer_block_count == 0)
 	{
@@ -802,13 +2395,20 @@ uint256 discard_unflushed_log_records(wale* wale_p, int* error)
 		goto EXIT;
 	}
 
+	// the writers of the large log records in progress would continue to write into the discarded slots
+	if(wale_p->large_log_record_writers != NULL)
+	{
+		(*error) = LARGE_LOG_RECORD_IN_PROGRESS;
+		goto EXIT;
+	}
+
 	// update the contents of the append_only_buffer, by reading the latest bytes of flushed records from the disk
 	// we can release the global lock here, no worries
 	pthread_mutex_unlock(get_wale_lock(wale_p));
 
 	uint64_t file_offset_for_next_log_sequence_number = read_latest_vacant_block_using_master_record(wale_p->buffer, &new_in_memory_master_record, &(wale_p->block_io_functions), error);
 
-	pthread_mutex_lock(get_wale_lock(wale_p));
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 	if(*error)
 		goto EXIT;
@@ -816,9 +2416,10 @@ uint256 discard_unflushed_log_records(wale* wale_p, int* error)
 	wale_p->in_memory_master_record = new_in_memory_master_record;
 	wale_p->buffer_start_block_id = get_block_id_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
 	wale_p->append_offset = get_block_offset_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
+	wale_p->written_file_offset = file_offset_for_next_log_sequence_number;
 	
 	// since after the above read call the append_only_buffer must contain more space to write, we will wake up any thread that is waiting for a scroll
-	pthread_cond_broadcast(&(wale_p->wait_for_scroll));
+	wake_up_all_scroll_waiters(wale_p);
 
 	// return value
 	last_flushed_log_sequence_number = wale_p->in_memory_master_record.last_flushed_log_sequence_number;
@@ -832,6 +2433,19 @@ uint256 discard_unflushed_log_records(wale* wale_p, int* error)
 	return last_flushed_log_sequence_number;
 }
 
+// reclaims the blocks of the file that contain only the discarded log records, i.e. the blocks in [from_block_id, to_block_id)
+// it must be called with write lock on the flushed_log_records_lock, so that no one writes these blocks while they are being reclaimed
+static void punch_hole_for_discarded_log_records(wale* wale_p, uint64_t from_block_id, uint64_t to_block_id)
+{
+	// block 0 is the master record, it is never reclaimed
+	from_block_id = max(from_block_id, 1);
+
+	if(wale_p->block_io_functions.punch_hole_blocks == NULL || from_block_id >= to_block_id)
+		return;
+
+	wale_p->block_io_functions.punch_hole_blocks(wale_p->block_io_functions.block_io_ops_handle, from_block_id, to_block_id - from_block_id);
+}
+
 int truncate_log_records(wale* wale_p, int* error)
 {
 	// initialize error to no error
@@ -841,12 +2455,12 @@ int truncate_log_records(wale* wale_p, int* error)
 	int truncated_logs = 0;
 
 	if(wale_p->has_internal_lock)
-		pthread_mutex_lock(get_wale_lock(wale_p));
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 	// take exclusive lock on the append only buffer_lock,
 	// this ensures all appenders to the append only buffer have exited
 	// their writes may be in the buffer and we are unconcerned with that
-	exclusive_lock(&(wale_p->append_only_buffer_lock), BLOCKING);
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
 
 	// we can not flush if there has been a major scroll error
 	if(wale_p->major_scroll_error)
@@ -856,26 +2470,60 @@ int truncate_log_records(wale* wale_p, int* error)
 		goto EXIT;
 	}
 
+	// the writers of the large log records in progress would continue to write into the truncated slots
+	if(wale_p->large_log_record_writers != NULL)
+	{
+		(*error) = LARGE_LOG_RECORD_IN_PROGRESS;
+		exclusive_unlock(&(wale_p->append_only_buffer_lock));
+		goto EXIT;
+	}
+
 	// next_log_sequence_number is not advanced
 	master_record new_master_record = {
 		.log_sequence_number_width = wale_p->in_memory_master_record.log_sequence_number_width,
+		.base_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
 		.first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
 		.check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
 		.last_flushed_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
 		.next_log_sequence_number = wale_p->in_memory_master_record.next_log_sequence_number,
+		.ring_block_count = wale_p->in_memory_master_record.ring_block_count,
+		.log_record_format_version = wale_p->in_memory_master_record.log_record_format_version,
 	};
 	uint64_t new_append_offset = 0;
 
+	// blocks from the first log record, until the end of the last appended log record are to be reclaimed after the truncation
+	uint64_t discarded_from_block_id = 0;
+	uint64_t discarded_to_block_id = 0;
+	if(!are_equal_uint256(wale_p->in_memory_master_record.first_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		int offset_error = NO_ERROR;
+		uint64_t first_file_offset = get_file_offset_for_log_sequence_number(wale_p->in_memory_master_record.first_log_sequence_number, &(wale_p->in_memory_master_record), &(wale_p->block_io_functions), &offset_error);
+		uint64_t next_file_offset = get_file_offset_for_next_log_sequence_number(&(wale_p->in_memory_master_record), &(wale_p->block_io_functions), &offset_error);
+		if(!offset_error)
+		{
+			discarded_from_block_id = get_block_id_from_file_offset(first_file_offset, &(wale_p->block_io_functions));
+			discarded_to_block_id = get_block_id_from_file_offset(next_file_offset, &(wale_p->block_io_functions)) + (get_block_offset_from_file_offset(next_file_offset, &(wale_p->block_io_functions)) != 0);
+		}
+	}
+
+	// the truncation writes the master record, so it must wait for the ongoing flushes to write theirs
+	uint64_t flush_epoch = begin_flush_epoch(wale_p);
+	wait_for_turn_of_flush_epoch(wale_p, flush_epoch);
+
 	// now we also need write lock on the on_disk_master_record, so that we can update it, along with the actual ondisk master record
-	write_lock(&(wale_p->flushed_log_records_lock), BLOCKING);
+	write_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK);
 
 	// performing io with out the lock
 	pthread_mutex_unlock(get_wale_lock(wale_p));
 
 	int master_record_io_error = 0;
-	truncated_logs = write_and_flush_master_record(&new_master_record, &(wale_p->block_io_functions), &master_record_io_error);
+	truncated_logs = write_and_flush_master_record_with_stats(wale_p, &new_master_record, &master_record_io_error);
+
+	// the discarded log records will never be read again, so reclaim their blocks
+	if(truncated_logs)
+		punch_hole_for_discarded_log_records(wale_p, discarded_from_block_id, discarded_to_block_id);
 
-	pthread_mutex_lock(get_wale_lock(wale_p));
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
 
 	if(truncated_logs)
 	{
@@ -886,16 +2534,107 @@ int truncate_log_records(wale* wale_p, int* error)
 		wale_p->in_memory_master_record = new_master_record;
 		wale_p->append_offset = new_append_offset;
 		wale_p->buffer_start_block_id = 1;
+		wale_p->written_file_offset = wale_p->block_io_functions.block_size;
 
 		// no contents in the append_only_buffer, hence we can wake up any thread waiting for a scroll
-		pthread_cond_broadcast(&(wale_p->wait_for_scroll));
+		wake_up_all_scroll_waiters(wale_p);
 	}
 
 	// release both the exclusive locks
 	write_unlock(&(wale_p->flushed_log_records_lock));
+	complete_flush_epoch(wale_p, flush_epoch);
 	exclusive_unlock(&(wale_p->append_only_buffer_lock));
 
 	EXIT:;
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	return truncated_logs;
+}
+
+int truncate_log_records_before(wale* wale_p, uint256 log_sequence_number, int* error)
+{
+	// primary check, you may never provide INVALID_LOG_SEQUENCE_NUMBER
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// initialize error to no error
+	(*error) = NO_ERROR;
+
+	// return value, suggesting if the log was truncated
+	int truncated_logs = 0;
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// a shared lock on the append only buffer is sufficient to update the first_log_sequence_number of the in_memory_master_record
+	// appenders may continue to append to the append only buffer, while we truncate the log
+	shared_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK, WRITE_PREFERRING);
+
+	// the truncation writes the master record, so it must wait for the ongoing flushes to write theirs, and the next flush must wait for us
+	uint64_t flush_epoch = begin_flush_epoch(wale_p);
+	wait_for_turn_of_flush_epoch(wale_p, flush_epoch);
+
+	// the on_disk_master_record will be updated, along with the actual ondisk master record
+	write_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK);
+
+	// the log_sequence_number must be a flushed log record, i.e. it must be between first_log_sequence_number and last_flushed_log_sequence_number
+	uint64_t new_first_file_offset = get_file_offset_for_log_sequence_number(log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto RELEASE_LOCKS_AND_EXIT;
+
+	uint64_t old_first_file_offset = get_file_offset_for_log_sequence_number(wale_p->on_disk_master_record.first_log_sequence_number, &(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error);
+	if(*error)
+		goto RELEASE_LOCKS_AND_EXIT;
+
+	// base_log_sequence_number remains as is, so the surviving log records stay where they are in the file
+	master_record new_on_disk_master_record = wale_p->on_disk_master_record;
+	new_on_disk_master_record.first_log_sequence_number = log_sequence_number;
+	if(compare_uint256(new_on_disk_master_record.check_point_log_sequence_number, log_sequence_number) < 0)
+		new_on_disk_master_record.check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	// performing io with out the lock
+	pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	// make sure that the log_sequence_number is at the start of a log record, by checking its header
+	log_record_header hdr;
+	if(parse_and_check_crc32_for_log_record_header_at(&hdr, new_first_file_offset, wale_p, error))
+	{
+		truncated_logs = write_and_flush_master_record_with_stats(wale_p, &new_on_disk_master_record, error);
+
+		// the block containing the new first log record is still in use, all blocks before it can be reclaimed
+		if(truncated_logs)
+			punch_hole_for_discarded_log_records(wale_p, get_block_id_from_file_offset(old_first_file_offset, &(wale_p->block_io_functions)), get_block_id_from_file_offset(new_first_file_offset, &(wale_p->block_io_functions)));
+	}
+	else if((*error) == HEADER_CORRUPTED) // the log_sequence_number is not at the start of a valid log record
+		(*error) = PARAM_INVALID;
+
+	pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	if(truncated_logs)
+	{
+		// we can update the on_disk_master_record here since, we have write lock on flushed_log_records_lock
+		wale_p->on_disk_master_record = new_on_disk_master_record;
+
+		// the in_memory_master_record may have advanced, only its first_log_sequence_number and check_point_log_sequence_number need to change
+		wale_p->in_memory_master_record.first_log_sequence_number = log_sequence_number;
+		if(compare_uint256(wale_p->in_memory_master_record.check_point_log_sequence_number, log_sequence_number) < 0)
+			wale_p->in_memory_master_record.check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+		// and so do the check_point_log_sequence_numbers, that the flushes write while the large log records are in progress
+		for(large_log_record_writer* writer = wale_p->large_log_record_writers; writer != NULL; writer = writer->next_in_progress)
+			if(compare_uint256(writer->prev_check_point_log_sequence_number, log_sequence_number) < 0)
+				writer->prev_check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	RELEASE_LOCKS_AND_EXIT:;
+	write_unlock(&(wale_p->flushed_log_records_lock));
+	complete_flush_epoch(wale_p, flush_epoch);
+	shared_unlock(&(wale_p->append_only_buffer_lock));
+
 	if(wale_p->has_internal_lock)
 		pthread_mutex_unlock(get_wale_lock(wale_p));
 
@@ -0,0 +1,78 @@
+#include<wale_allocator.h>
+
+#include<wale.h>
+
+#include<wale_get_lock_util.h>
+#include<util_block_buffer_pool.h>
+#include<util_wale_stats.h>
+
+#include<rwlock.h>
+
+#include<cutlery_stds.h>
+
+#include<stdlib.h>
+
+static void* default_allocate(void* allocator_handle, size_t alignment, size_t size)
+{
+	if(alignment <= _Alignof(max_align_t))
+		return malloc(size);
+	return aligned_alloc(alignment, size);
+}
+
+static void default_deallocate(void* allocator_handle, void* ptr, size_t size)
+{
+	free(ptr);
+}
+
+const wale_allocator default_wale_allocator = {
+	.allocator_handle = NULL,
+	.allocate = default_allocate,
+	.deallocate = default_deallocate,
+};
+
+int set_wale_allocator(wale* wale_p, const wale_allocator* allocator)
+{
+	if(allocator == NULL)
+		allocator = &default_wale_allocator;
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// no appender may be writing into the append only buffer, and no reader may be holding a block buffer, while they are reallocated
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+	write_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK);
+
+	int res = 1;
+
+	// move the contents of the append only buffer, into the memory of the new allocator
+	if(wale_p->buffer_block_count != 0)
+	{
+		uint64_t buffer_size = wale_p->buffer_block_count * wale_p->block_io_functions.block_size;
+		void* new_buffer = allocator->allocate(allocator->allocator_handle, wale_p->block_io_functions.block_buffer_alignment, buffer_size);
+		if(new_buffer == NULL)
+		{
+			res = 0;
+			goto EXIT;
+		}
+
+		memory_move(new_buffer, wale_p->buffer, wale_p->append_offset);
+
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, wale_p->buffer, buffer_size);
+		wale_p->buffer = new_buffer;
+	}
+
+	// the free block buffers are released to the old allocator, the new ones are allocated on demand
+	deinitialize_block_buffer_pool(wale_p->block_buffers);
+	initialize_block_buffer_pool(wale_p->block_buffers, &(wale_p->underlying_block_io_functions), allocator);
+
+	wale_p->allocator = (*allocator);
+
+	EXIT:;
+	write_unlock(&(wale_p->flushed_log_records_lock));
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	return res;
+}
\ No newline at end of file
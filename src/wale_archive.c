@@ -0,0 +1,918 @@
+#include<wale_archive.h>
+
+#include<crc32_util.h>
+
+#include<serial_int.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<stdlib.h>
+#include<limits.h>
+
+// the archive_version that we write
+// the log records in the chunks of the archive_version 0 do not have their log_record_type, they are read with the log_record_type 0
+#define ARCHIVE_VERSION 1
+
+#define ARCHIVE_VERSION_BITS_OFFSET 16
+
+// size of the serialized archive header, excluding its crc32
+static uint64_t get_archive_header_size(uint32_t log_sequence_number_width)
+{
+	return sizeof(uint32_t) + 3 * log_sequence_number_width + 3 * sizeof(uint64_t);
+}
+
+// size of a serialized index entry
+static uint64_t get_index_entry_size(uint32_t log_sequence_number_width)
+{
+	return log_sequence_number_width + sizeof(uint64_t) + 2 * sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+}
+
+// size of the header of every log record in a chunk, i.e. its slot_size, log_record_size and log_record_type (from the archive_version 1)
+static uint32_t get_chunk_entry_header_size(uint32_t archive_version)
+{
+	return 2 * sizeof(uint32_t) + ((archive_version >= 1) ? sizeof(uint8_t) : 0);
+}
+
+static uint64_t get_block_count_for_size(uint64_t size, const block_io_ops* block_io_functions)
+{
+	return UINT_ALIGN_UP(size, block_io_functions->block_size) / block_io_functions->block_size;
+}
+
+// -------------------------------------------------------------
+// writing the archive
+
+typedef struct archive_writer archive_writer;
+struct archive_writer
+{
+	const block_io_ops* block_io_functions;
+	const log_record_codec* codec;
+
+	// the chunk being built, and its first log_sequence_number
+	void* chunk;
+	uint32_t chunk_used;
+	uint32_t chunk_capacity;
+	uint256 chunk_first_log_sequence_number;
+
+	// the index built so far
+	wale_archive_chunk* chunks;
+	uint64_t chunk_count;
+	uint64_t chunks_capacity;
+
+	// the next chunk goes at this block
+	uint64_t next_block_id;
+};
+
+// compresses the chunk being built and writes it at the next_block_id, then inserts its entry in the index
+static int write_chunk(archive_writer* aw, int* error)
+{
+	if(aw->chunk_used == 0)
+		return 1;
+
+	if(aw->chunk_count == aw->chunks_capacity)
+	{
+		uint64_t new_chunks_capacity = (aw->chunks_capacity * 2) + 16;
+		wale_archive_chunk* new_chunks = realloc(aw->chunks, new_chunks_capacity * sizeof(wale_archive_chunk));
+		if(new_chunks == NULL)
+		{
+			(*error) = ALLOCATION_FAILED;
+			return 0;
+		}
+		aw->chunks = new_chunks;
+		aw->chunks_capacity = new_chunks_capacity;
+	}
+
+	uint64_t stored_chunk_capacity = UINT_ALIGN_UP(aw->chunk_used, aw->block_io_functions->block_size);
+	void* stored_chunk = aligned_alloc(aw->block_io_functions->block_buffer_alignment, stored_chunk_capacity);
+	if(stored_chunk == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	wale_archive_chunk* c = &(aw->chunks[aw->chunk_count]);
+	c->first_log_sequence_number = aw->chunk_first_log_sequence_number;
+	c->block_id = aw->next_block_id;
+	c->uncompressed_size = aw->chunk_used;
+
+	// the chunk is stored compressed, only if it shrinks
+	c->stored_size = 0;
+	if(aw->codec != NULL && aw->chunk_used > 1)
+		c->stored_size = aw->codec->compress(aw->codec->codec_handle, stored_chunk, aw->chunk_used - 1, aw->chunk, aw->chunk_used);
+	if(c->stored_size != 0)
+		c->codec_id = aw->codec->codec_id;
+	else
+	{
+		memory_move(stored_chunk, aw->chunk, aw->chunk_used);
+		c->stored_size = aw->chunk_used;
+		c->codec_id = 0;
+	}
+
+	c->crc32 = crc32_util(crc32_init(), stored_chunk, c->stored_size);
+
+	// zero out the unused bytes of the last block
+	uint64_t block_count = get_block_count_for_size(c->stored_size, aw->block_io_functions);
+	memory_set(stored_chunk + c->stored_size, 0, block_count * aw->block_io_functions->block_size - c->stored_size);
+
+	int io_success = aw->block_io_functions->write_blocks(aw->block_io_functions->block_io_ops_handle, stored_chunk, c->block_id, block_count);
+	free(stored_chunk);
+	if(!io_success)
+	{
+		(*error) = WRITE_IO_ERROR;
+		return 0;
+	}
+
+	aw->chunk_count++;
+	aw->next_block_id += block_count;
+	aw->chunk_used = 0;
+	return 1;
+}
+
+// inserts the log record in the chunk being built, writing the chunk first if the log record does not fit in it
+static int insert_log_record_in_chunk(archive_writer* aw, uint32_t chunk_size, uint256 log_sequence_number, uint32_t slot_size, const void* log_record, uint32_t log_record_size, uint8_t log_record_type, int* error)
+{
+	uint32_t entry_header_size = get_chunk_entry_header_size(ARCHIVE_VERSION);
+	uint64_t entry_size = entry_header_size + ((uint64_t)log_record_size);
+
+	if(aw->chunk_used > 0 && aw->chunk_used + entry_size > chunk_size)
+	{
+		if(!write_chunk(aw, error))
+			return 0;
+	}
+
+	if(aw->chunk_used + entry_size > aw->chunk_capacity)
+	{
+		// a single log record (of atmost MAX_LOG_RECORD_SIZE) always fits in an empty chunk, without overflowing uint32_t
+		uint64_t new_chunk_capacity = max(aw->chunk_used + entry_size, min(((uint64_t)aw->chunk_capacity) * 2, UINT32_MAX));
+		void* new_chunk = realloc(aw->chunk, new_chunk_capacity);
+		if(new_chunk == NULL)
+		{
+			(*error) = ALLOCATION_FAILED;
+			return 0;
+		}
+		aw->chunk = new_chunk;
+		aw->chunk_capacity = new_chunk_capacity;
+	}
+
+	if(aw->chunk_used == 0)
+		aw->chunk_first_log_sequence_number = log_sequence_number;
+
+	serialize_uint32(aw->chunk + aw->chunk_used, sizeof(uint32_t), slot_size);
+	serialize_uint32(aw->chunk + aw->chunk_used + sizeof(uint32_t), sizeof(uint32_t), log_record_size);
+	((uint8_t*)(aw->chunk + aw->chunk_used))[2 * sizeof(uint32_t)] = log_record_type;
+	memory_move(aw->chunk + aw->chunk_used + entry_header_size, log_record, log_record_size);
+	aw->chunk_used += entry_size;
+
+	return 1;
+}
+
+// writes the index at the next_block_id, followed by the archive header at block 0, flushing after each of them
+static int write_index_and_header(archive_writer* aw, uint32_t log_sequence_number_width, uint256 first_log_sequence_number, uint256 last_log_sequence_number, uint256 next_log_sequence_number, int* error)
+{
+	const block_io_ops* block_io_functions = aw->block_io_functions;
+
+	uint64_t index_entry_size = get_index_entry_size(log_sequence_number_width);
+	uint64_t index_size = aw->chunk_count * index_entry_size + sizeof(uint32_t);
+	uint64_t index_block_id = aw->next_block_id;
+	uint64_t index_block_count = get_block_count_for_size(index_size, block_io_functions);
+
+	void* index_serial = aligned_alloc(block_io_functions->block_buffer_alignment, index_block_count * block_io_functions->block_size);
+	if(index_serial == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+	memory_set(index_serial, 0, index_block_count * block_io_functions->block_size);
+
+	for(uint64_t i = 0; i < aw->chunk_count; i++)
+	{
+		void* entry = index_serial + i * index_entry_size;
+		const wale_archive_chunk* c = &(aw->chunks[i]);
+		serialize_uint256(entry, log_sequence_number_width, c->first_log_sequence_number);
+		serialize_uint64(entry + log_sequence_number_width, sizeof(uint64_t), c->block_id);
+		serialize_uint32(entry + log_sequence_number_width + 8, sizeof(uint32_t), c->stored_size);
+		serialize_uint32(entry + log_sequence_number_width + 12, sizeof(uint32_t), c->uncompressed_size);
+		((uint8_t*)entry)[log_sequence_number_width + 16] = c->codec_id;
+		serialize_uint32(entry + log_sequence_number_width + 17, sizeof(uint32_t), c->crc32);
+	}
+	serialize_uint32(index_serial + aw->chunk_count * index_entry_size, sizeof(uint32_t), crc32_util(crc32_init(), index_serial, aw->chunk_count * index_entry_size));
+
+	int io_success = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, index_serial, index_block_id, index_block_count)
+		&& block_io_functions->flush_all_writes(block_io_functions->block_io_ops_handle);
+	free(index_serial);
+	if(!io_success)
+	{
+		(*error) = WRITE_IO_ERROR;
+		return 0;
+	}
+
+	// all of the chunks and the index are on disk, now write the header that makes the archive valid
+	void* header_serial = aligned_alloc(block_io_functions->block_buffer_alignment, block_io_functions->block_size);
+	if(header_serial == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+	memory_set(header_serial, 0, block_io_functions->block_size);
+
+	uint64_t header_size = get_archive_header_size(log_sequence_number_width);
+	serialize_uint32(header_serial, sizeof(uint32_t), log_sequence_number_width | (ARCHIVE_VERSION << ARCHIVE_VERSION_BITS_OFFSET));
+	serialize_uint256(header_serial + sizeof(uint32_t), log_sequence_number_width, first_log_sequence_number);
+	serialize_uint256(header_serial + sizeof(uint32_t) + log_sequence_number_width, log_sequence_number_width, last_log_sequence_number);
+	serialize_uint256(header_serial + sizeof(uint32_t) + 2 * log_sequence_number_width, log_sequence_number_width, next_log_sequence_number);
+	serialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width, sizeof(uint64_t), aw->chunk_count);
+	serialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width + 8, sizeof(uint64_t), index_block_id);
+	serialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width + 16, sizeof(uint64_t), index_size);
+	serialize_uint32(header_serial + header_size, sizeof(uint32_t), crc32_util(crc32_init(), header_serial, header_size));
+
+	io_success = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, header_serial, 0, 1)
+		&& block_io_functions->flush_all_writes(block_io_functions->block_io_ops_handle);
+	free(header_serial);
+	if(!io_success)
+	{
+		(*error) = WRITE_IO_ERROR;
+		return 0;
+	}
+
+	return 1;
+}
+
+int archive_log_records_before(wale* wale_p, uint256 from_log_sequence_number, uint256 log_sequence_number, block_io_ops archive_block_io_functions, const log_record_codec* codec, uint32_t chunk_size, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint32_t log_sequence_number_width = get_log_sequence_number_width(wale_p);
+
+	// the range must not be empty, and the archive header must fit in a block
+	if(are_equal_uint256(from_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) ||
+		compare_uint256(from_log_sequence_number, log_sequence_number) >= 0 ||
+		get_archive_header_size(log_sequence_number_width) + sizeof(uint32_t) > archive_block_io_functions.block_size)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	if(chunk_size == 0)
+		chunk_size = DEFAULT_ARCHIVE_CHUNK_SIZE;
+
+	archive_writer aw = {
+		.block_io_functions = &archive_block_io_functions,
+		.codec = codec,
+		.chunk = NULL,
+		.chunk_used = 0,
+		.chunk_capacity = 0,
+		.chunk_first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER,
+		.chunks = NULL,
+		.chunk_count = 0,
+		.chunks_capacity = 0,
+		.next_block_id = 1,
+	};
+
+	int result = 0;
+
+	// walk the log records using the reader functions of the WALe
+	uint256 curr_log_sequence_number = from_log_sequence_number;
+	uint256 last_log_sequence_number = from_log_sequence_number;
+	while(compare_uint256(curr_log_sequence_number, log_sequence_number) < 0)
+	{
+		uint8_t log_record_type;
+		if(!get_log_record_type_at(wale_p, curr_log_sequence_number, &log_record_type, error))
+			goto EXIT;
+
+		uint32_t log_record_size;
+		void* log_record = get_log_record_at(wale_p, curr_log_sequence_number, &log_record_size, error);
+		if(log_record == NULL)
+			goto EXIT;
+
+		// the log_sequence_number must be a log record that comes after the curr_log_sequence_number
+		uint256 next_log_sequence_number = get_next_log_sequence_number_of(wale_p, curr_log_sequence_number, error);
+		if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(next_log_sequence_number, log_sequence_number) > 0)
+		{
+			if((*error) == NO_ERROR)
+				(*error) = PARAM_INVALID;
+			release_log_record(wale_p, log_record, log_record_size);
+			goto EXIT;
+		}
+
+		uint256 slot_size_uint256;
+		uint64_t slot_size;
+		sub_underflow_safe_uint256(&slot_size_uint256, next_log_sequence_number, curr_log_sequence_number);
+		if(!cast_to_uint64_from_uint256(&slot_size, slot_size_uint256) || slot_size > UINT32_MAX)
+		{
+			(*error) = HEADER_CORRUPTED;
+			release_log_record(wale_p, log_record, log_record_size);
+			goto EXIT;
+		}
+
+		int inserted = insert_log_record_in_chunk(&aw, chunk_size, curr_log_sequence_number, slot_size, log_record, log_record_size, log_record_type, error);
+		release_log_record(wale_p, log_record, log_record_size);
+		if(!inserted)
+			goto EXIT;
+
+		last_log_sequence_number = curr_log_sequence_number;
+		curr_log_sequence_number = next_log_sequence_number;
+	}
+
+	if(!write_chunk(&aw, error))
+		goto EXIT;
+
+	if(!write_index_and_header(&aw, log_sequence_number_width, from_log_sequence_number, last_log_sequence_number, log_sequence_number, error))
+		goto EXIT;
+
+	result = 1;
+
+	EXIT:;
+	free(aw.chunk);
+	free(aw.chunks);
+	return result;
+}
+
+// -------------------------------------------------------------
+// opening and closing the archive
+
+static int read_archive_header(wale_archive* archive_p, uint64_t* index_block_id, uint64_t* index_size, int* error)
+{
+	const block_io_ops* block_io_functions = &(archive_p->block_io_functions);
+
+	void* header_serial = aligned_alloc(block_io_functions->block_buffer_alignment, block_io_functions->block_size);
+	if(header_serial == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, header_serial, 0, 1))
+	{
+		(*error) = READ_IO_ERROR;
+		free(header_serial);
+		return 0;
+	}
+
+	uint32_t width_and_version = deserialize_uint32(header_serial, sizeof(uint32_t));
+	uint32_t archive_version = width_and_version >> ARCHIVE_VERSION_BITS_OFFSET;
+	uint32_t log_sequence_number_width = width_and_version & ((UINT32_C(1) << ARCHIVE_VERSION_BITS_OFFSET) - 1);
+
+	if(archive_version > ARCHIVE_VERSION || log_sequence_number_width == 0 || log_sequence_number_width > get_max_bytes_uint256() ||
+		get_archive_header_size(log_sequence_number_width) + sizeof(uint32_t) > block_io_functions->block_size)
+	{
+		(*error) = MASTER_RECORD_CORRUPTED;
+		free(header_serial);
+		return 0;
+	}
+
+	uint64_t header_size = get_archive_header_size(log_sequence_number_width);
+	if(crc32_util(crc32_init(), header_serial, header_size) != deserialize_uint32(header_serial + header_size, sizeof(uint32_t)))
+	{
+		(*error) = MASTER_RECORD_CORRUPTED;
+		free(header_serial);
+		return 0;
+	}
+
+	archive_p->archive_version = archive_version;
+	archive_p->log_sequence_number_width = log_sequence_number_width;
+	archive_p->first_log_sequence_number = deserialize_uint256(header_serial + sizeof(uint32_t), log_sequence_number_width);
+	archive_p->last_log_sequence_number = deserialize_uint256(header_serial + sizeof(uint32_t) + log_sequence_number_width, log_sequence_number_width);
+	archive_p->next_log_sequence_number = deserialize_uint256(header_serial + sizeof(uint32_t) + 2 * log_sequence_number_width, log_sequence_number_width);
+	archive_p->chunk_count = deserialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width, sizeof(uint64_t));
+	(*index_block_id) = deserialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width + 8, sizeof(uint64_t));
+	(*index_size) = deserialize_uint64(header_serial + sizeof(uint32_t) + 3 * log_sequence_number_width + 16, sizeof(uint64_t));
+
+	free(header_serial);
+
+	// the index must hold exactly chunk_count entries and its crc32
+	uint64_t index_entry_size = get_index_entry_size(log_sequence_number_width);
+	if(archive_p->chunk_count == 0 ||
+		will_unsigned_mul_overflow(uint64_t, archive_p->chunk_count, index_entry_size) ||
+		(*index_size) != archive_p->chunk_count * index_entry_size + sizeof(uint32_t))
+	{
+		(*error) = MASTER_RECORD_CORRUPTED;
+		return 0;
+	}
+
+	return 1;
+}
+
+static int read_archive_index(wale_archive* archive_p, uint64_t index_block_id, uint64_t index_size, int* error)
+{
+	const block_io_ops* block_io_functions = &(archive_p->block_io_functions);
+
+	uint64_t index_block_count = get_block_count_for_size(index_size, block_io_functions);
+	void* index_serial = aligned_alloc(block_io_functions->block_buffer_alignment, index_block_count * block_io_functions->block_size);
+	if(index_serial == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, index_serial, index_block_id, index_block_count))
+	{
+		(*error) = READ_IO_ERROR;
+		free(index_serial);
+		return 0;
+	}
+
+	uint64_t index_entry_size = get_index_entry_size(archive_p->log_sequence_number_width);
+	uint64_t entries_size = archive_p->chunk_count * index_entry_size;
+	if(crc32_util(crc32_init(), index_serial, entries_size) != deserialize_uint32(index_serial + entries_size, sizeof(uint32_t)))
+	{
+		(*error) = MASTER_RECORD_CORRUPTED;
+		free(index_serial);
+		return 0;
+	}
+
+	archive_p->chunks = malloc(archive_p->chunk_count * sizeof(wale_archive_chunk));
+	if(archive_p->chunks == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		free(index_serial);
+		return 0;
+	}
+
+	uint32_t w = archive_p->log_sequence_number_width;
+	for(uint64_t i = 0; i < archive_p->chunk_count; i++)
+	{
+		const void* entry = index_serial + i * index_entry_size;
+		wale_archive_chunk* c = &(archive_p->chunks[i]);
+		c->first_log_sequence_number = deserialize_uint256(entry, w);
+		c->block_id = deserialize_uint64(entry + w, sizeof(uint64_t));
+		c->stored_size = deserialize_uint32(entry + w + 8, sizeof(uint32_t));
+		c->uncompressed_size = deserialize_uint32(entry + w + 12, sizeof(uint32_t));
+		c->codec_id = ((const uint8_t*)entry)[w + 16];
+		c->crc32 = deserialize_uint32(entry + w + 17, sizeof(uint32_t));
+	}
+
+	free(index_serial);
+	return 1;
+}
+
+int open_wale_archive(wale_archive* archive_p, block_io_ops block_io_functions, const log_record_codec* codec, int* error)
+{
+	(*error) = NO_ERROR;
+
+	archive_p->block_io_functions = block_io_functions;
+	if(codec == NULL)
+		archive_p->log_record_codec = (log_record_codec){.codec_handle = NULL, .codec_id = 0, .compress = NULL, .decompress = NULL};
+	else
+		archive_p->log_record_codec = (*codec);
+
+	uint64_t index_block_id;
+	uint64_t index_size;
+	if(!read_archive_header(archive_p, &index_block_id, &index_size, error))
+		return 0;
+
+	if(!read_archive_index(archive_p, index_block_id, index_size, error))
+		return 0;
+
+	archive_p->max_limit = get_0_uint256();
+	set_bit_in_uint256(&(archive_p->max_limit), archive_p->log_sequence_number_width * CHAR_BIT);
+
+	pthread_mutex_init(&(archive_p->cache_lock), NULL);
+	archive_p->cached_chunk_index = archive_p->chunk_count;
+	archive_p->cached_chunk = NULL;
+
+	return 1;
+}
+
+void close_wale_archive(wale_archive* archive_p)
+{
+	free(archive_p->cached_chunk);
+	free(archive_p->chunks);
+	pthread_mutex_destroy(&(archive_p->cache_lock));
+}
+
+// -------------------------------------------------------------
+// reading the archive
+
+// returns the index of the chunk that may contain the log_sequence_number, using a binary search on the sparse index
+// returns chunk_count, if the log_sequence_number is not in the archive
+static uint64_t find_chunk_index_for_log_sequence_number(const wale_archive* archive_p, uint256 log_sequence_number)
+{
+	if(compare_uint256(log_sequence_number, archive_p->first_log_sequence_number) < 0 ||
+		compare_uint256(log_sequence_number, archive_p->last_log_sequence_number) > 0)
+		return archive_p->chunk_count;
+
+	// find the last chunk, with its first_log_sequence_number <= log_sequence_number
+	uint64_t low = 0;
+	uint64_t high = archive_p->chunk_count - 1;
+	while(low < high)
+	{
+		uint64_t mid = low + (high - low + 1) / 2;
+		if(compare_uint256(archive_p->chunks[mid].first_log_sequence_number, log_sequence_number) <= 0)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	return low;
+}
+
+// must be called with the cache_lock held
+// returns the decompressed chunk at the chunk_index, reading it only if it is not already cached
+static const void* get_chunk(wale_archive* archive_p, uint64_t chunk_index, int* error)
+{
+	if(archive_p->cached_chunk_index == chunk_index)
+		return archive_p->cached_chunk;
+
+	const wale_archive_chunk* c = &(archive_p->chunks[chunk_index]);
+	const block_io_ops* block_io_functions = &(archive_p->block_io_functions);
+
+	uint64_t block_count = get_block_count_for_size(c->stored_size, block_io_functions);
+	void* stored_chunk = aligned_alloc(block_io_functions->block_buffer_alignment, max(block_count, 1) * block_io_functions->block_size);
+	if(stored_chunk == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return NULL;
+	}
+
+	if(!block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, stored_chunk, c->block_id, block_count))
+	{
+		(*error) = READ_IO_ERROR;
+		free(stored_chunk);
+		return NULL;
+	}
+
+	if(crc32_util(crc32_init(), stored_chunk, c->stored_size) != c->crc32)
+	{
+		(*error) = LOG_RECORD_CORRUPTED;
+		free(stored_chunk);
+		return NULL;
+	}
+
+	void* chunk = stored_chunk;
+	if(c->codec_id != 0)
+	{
+		if(archive_p->log_record_codec.codec_id != c->codec_id)
+		{
+			(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+			free(stored_chunk);
+			return NULL;
+		}
+
+		chunk = malloc(max(c->uncompressed_size, 1));
+		if(chunk == NULL)
+		{
+			(*error) = ALLOCATION_FAILED;
+			free(stored_chunk);
+			return NULL;
+		}
+
+		int decompressed = archive_p->log_record_codec.decompress(archive_p->log_record_codec.codec_handle, chunk, c->uncompressed_size, stored_chunk, c->stored_size);
+		free(stored_chunk);
+		if(!decompressed)
+		{
+			(*error) = LOG_RECORD_DECOMPRESSION_FAILED;
+			free(chunk);
+			return NULL;
+		}
+	}
+
+	// replace the cached chunk
+	free(archive_p->cached_chunk);
+	archive_p->cached_chunk = chunk;
+	archive_p->cached_chunk_index = chunk_index;
+
+	return chunk;
+}
+
+typedef struct chunk_entry chunk_entry;
+struct chunk_entry
+{
+	uint256 log_sequence_number;
+
+	uint32_t slot_size;
+	uint32_t log_record_size;
+	uint8_t log_record_type;
+
+	// pointer to the log record in the decompressed chunk
+	const void* log_record;
+};
+
+// parses the entry at the offset in the chunk, returns 0 if it does not fit in the chunk
+// the offset of the entry after it is offset + get_chunk_entry_header_size() + log_record_size
+static int parse_chunk_entry(uint32_t archive_version, const void* chunk, uint32_t chunk_size, uint32_t offset, chunk_entry* entry)
+{
+	uint32_t entry_header_size = get_chunk_entry_header_size(archive_version);
+	if(chunk_size - offset < entry_header_size)
+		return 0;
+
+	entry->slot_size = deserialize_uint32(chunk + offset, sizeof(uint32_t));
+	entry->log_record_size = deserialize_uint32(chunk + offset + sizeof(uint32_t), sizeof(uint32_t));
+	if(chunk_size - offset - entry_header_size < entry->log_record_size || entry->slot_size == 0)
+		return 0;
+
+	entry->log_record_type = (archive_version >= 1) ? ((const uint8_t*)(chunk + offset))[2 * sizeof(uint32_t)] : 0;
+	entry->log_record = chunk + offset + entry_header_size;
+	return 1;
+}
+
+// must be called with the cache_lock held
+// finds the log record at the log_sequence_number in the archive, and the log_sequence_number of the log record before it (INVALID_LOG_SEQUENCE_NUMBER if it is the first log record of its chunk)
+// if the log_sequence_number is INVALID_LOG_SEQUENCE_NUMBER, then the last log record of the chunk at chunk_index is found
+static int find_chunk_entry(wale_archive* archive_p, uint64_t chunk_index, uint256 log_sequence_number, chunk_entry* entry, uint256* prev_log_sequence_number_in_chunk, int* error)
+{
+	const void* chunk = get_chunk(archive_p, chunk_index, error);
+	if(chunk == NULL)
+		return 0;
+
+	uint32_t chunk_size = archive_p->chunks[chunk_index].uncompressed_size;
+	int find_last = are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER);
+
+	(*prev_log_sequence_number_in_chunk) = INVALID_LOG_SEQUENCE_NUMBER;
+	uint256 curr_log_sequence_number = archive_p->chunks[chunk_index].first_log_sequence_number;
+	uint32_t offset = 0;
+	while(1)
+	{
+		if(!parse_chunk_entry(archive_p->archive_version, chunk, chunk_size, offset, entry))
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			return 0;
+		}
+		entry->log_sequence_number = curr_log_sequence_number;
+
+		uint32_t next_offset = offset + get_chunk_entry_header_size(archive_p->archive_version) + entry->log_record_size;
+		if(find_last ? (next_offset == chunk_size) : are_equal_uint256(curr_log_sequence_number, log_sequence_number))
+			return 1;
+
+		// the log_sequence_number is not at the start of a log record
+		if(!find_last && compare_uint256(curr_log_sequence_number, log_sequence_number) > 0)
+		{
+			(*error) = PARAM_INVALID;
+			return 0;
+		}
+
+		(*prev_log_sequence_number_in_chunk) = curr_log_sequence_number;
+		if(!add_overflow_safe_uint256(&curr_log_sequence_number, curr_log_sequence_number, get_uint256(entry->slot_size), archive_p->max_limit))
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			return 0;
+		}
+		offset = next_offset;
+	}
+}
+
+uint256 get_next_log_sequence_number_of_archive(wale_archive* archive_p, uint256 log_sequence_number, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint64_t chunk_index = find_chunk_index_for_log_sequence_number(archive_p, log_sequence_number);
+	if(chunk_index == archive_p->chunk_count)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	// next of the last log record is not in the archive
+	if(are_equal_uint256(log_sequence_number, archive_p->last_log_sequence_number))
+		return INVALID_LOG_SEQUENCE_NUMBER;
+
+	uint256 next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	pthread_mutex_lock(&(archive_p->cache_lock));
+
+	chunk_entry entry;
+	uint256 prev_log_sequence_number_in_chunk;
+	if(find_chunk_entry(archive_p, chunk_index, log_sequence_number, &entry, &prev_log_sequence_number_in_chunk, error))
+	{
+		if(!add_overflow_safe_uint256(&next_log_sequence_number, log_sequence_number, get_uint256(entry.slot_size), archive_p->max_limit))
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+		}
+	}
+
+	pthread_mutex_unlock(&(archive_p->cache_lock));
+
+	return next_log_sequence_number;
+}
+
+uint256 get_prev_log_sequence_number_of_archive(wale_archive* archive_p, uint256 log_sequence_number, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint64_t chunk_index = find_chunk_index_for_log_sequence_number(archive_p, log_sequence_number);
+	if(chunk_index == archive_p->chunk_count)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	// prev of the first log record is not in the archive
+	if(are_equal_uint256(log_sequence_number, archive_p->first_log_sequence_number))
+		return INVALID_LOG_SEQUENCE_NUMBER;
+
+	uint256 prev_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	pthread_mutex_lock(&(archive_p->cache_lock));
+
+	chunk_entry entry;
+	if(find_chunk_entry(archive_p, chunk_index, log_sequence_number, &entry, &prev_log_sequence_number, error))
+	{
+		// the first log record of a chunk, is preceded by the last log record of the previous chunk
+		if(are_equal_uint256(prev_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			uint256 unused;
+			if(find_chunk_entry(archive_p, chunk_index - 1, INVALID_LOG_SEQUENCE_NUMBER, &entry, &unused, error))
+				prev_log_sequence_number = entry.log_sequence_number;
+		}
+	}
+
+	pthread_mutex_unlock(&(archive_p->cache_lock));
+
+	return prev_log_sequence_number;
+}
+
+void* get_log_record_at_archive(wale_archive* archive_p, uint256 log_sequence_number, uint32_t* log_record_size, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint64_t chunk_index = find_chunk_index_for_log_sequence_number(archive_p, log_sequence_number);
+	if(chunk_index == archive_p->chunk_count)
+	{
+		(*error) = PARAM_INVALID;
+		return NULL;
+	}
+
+	void* log_record = NULL;
+
+	pthread_mutex_lock(&(archive_p->cache_lock));
+
+	chunk_entry entry;
+	uint256 prev_log_sequence_number_in_chunk;
+	if(find_chunk_entry(archive_p, chunk_index, log_sequence_number, &entry, &prev_log_sequence_number_in_chunk, error))
+	{
+		log_record = malloc(max(entry.log_record_size, 1));
+		if(log_record == NULL)
+			(*error) = ALLOCATION_FAILED;
+		else
+		{
+			memory_move(log_record, entry.log_record, entry.log_record_size);
+			(*log_record_size) = entry.log_record_size;
+		}
+	}
+
+	pthread_mutex_unlock(&(archive_p->cache_lock));
+
+	return log_record;
+}
+
+void release_log_record_archive(wale_archive* archive_p, void* log_record, uint32_t log_record_size)
+{
+	free(log_record);
+}
+
+int get_log_record_type_at_archive(wale_archive* archive_p, uint256 log_sequence_number, uint8_t* log_record_type, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint64_t chunk_index = find_chunk_index_for_log_sequence_number(archive_p, log_sequence_number);
+	if(chunk_index == archive_p->chunk_count)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	pthread_mutex_lock(&(archive_p->cache_lock));
+
+	chunk_entry entry;
+	uint256 prev_log_sequence_number_in_chunk;
+	int res = find_chunk_entry(archive_p, chunk_index, log_sequence_number, &entry, &prev_log_sequence_number_in_chunk, error);
+	if(res)
+		(*log_record_type) = entry.log_record_type;
+
+	pthread_mutex_unlock(&(archive_p->cache_lock));
+
+	return res;
+}
+
+// must be called with the cache_lock held
+// sets the found_log_sequence_number to the first (if is_forward is set, else the last) log record in the chunk at chunk_index, whose log_record_type is in the filter
+// only the log records after (or before) the log_sequence_number are considered, and also the log record at it if is_inclusive is set
+// all the log records of the chunk are considered, if the log_sequence_number is INVALID_LOG_SEQUENCE_NUMBER
+// the found_log_sequence_number is INVALID_LOG_SEQUENCE_NUMBER, if there is no such log record in the chunk
+static int find_chunk_entry_of_type(wale_archive* archive_p, uint64_t chunk_index, uint256 log_sequence_number, int is_forward, int is_inclusive, const log_record_type_filter* filter, uint256* found_log_sequence_number, int* error)
+{
+	const void* chunk = get_chunk(archive_p, chunk_index, error);
+	if(chunk == NULL)
+		return 0;
+
+	uint32_t chunk_size = archive_p->chunks[chunk_index].uncompressed_size;
+	int consider_all = are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER);
+
+	(*found_log_sequence_number) = INVALID_LOG_SEQUENCE_NUMBER;
+	uint256 curr_log_sequence_number = archive_p->chunks[chunk_index].first_log_sequence_number;
+	uint32_t offset = 0;
+	while(offset < chunk_size)
+	{
+		chunk_entry entry;
+		if(!parse_chunk_entry(archive_p->archive_version, chunk, chunk_size, offset, &entry))
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			return 0;
+		}
+
+		int compared = consider_all ? 0 : compare_uint256(curr_log_sequence_number, log_sequence_number);
+
+		// going backward, the log records after the log_sequence_number are never considered
+		if(!is_forward && compared > 0)
+			break;
+
+		int is_considered = consider_all || (is_forward ? (compared > 0) : (compared < 0)) || (is_inclusive && compared == 0);
+		if(is_considered && is_log_record_type_in_filter(filter, entry.log_record_type))
+		{
+			(*found_log_sequence_number) = curr_log_sequence_number;
+			if(is_forward)
+				return 1;
+		}
+
+		offset += get_chunk_entry_header_size(archive_p->archive_version) + entry.log_record_size;
+		if(offset < chunk_size && !add_overflow_safe_uint256(&curr_log_sequence_number, curr_log_sequence_number, get_uint256(entry.slot_size), archive_p->max_limit))
+		{
+			(*error) = LOG_RECORD_CORRUPTED;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+// steps over the log records after (if is_forward is set) or before the log record at log_sequence_number (and onto it, if is_inclusive is set) in the archive
+// returns the log_sequence_number of the first log record stepped onto, whose log_record_type is in the filter
+// it returns INVALID_LOG_SEQUENCE_NUMBER with no error, if there is no such log record until the first or the last log record of the archive
+static uint256 seek_log_record_of_type_in_archive(wale_archive* archive_p, uint256 log_sequence_number, int is_forward, int is_inclusive, const log_record_type_filter* filter, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint64_t chunk_index = find_chunk_index_for_log_sequence_number(archive_p, log_sequence_number);
+	if(chunk_index == archive_p->chunk_count)
+	{
+		(*error) = PARAM_INVALID;
+		return INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	uint256 found_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+	pthread_mutex_lock(&(archive_p->cache_lock));
+
+	// the log_sequence_number must be at the start of a log record
+	chunk_entry entry;
+	uint256 prev_log_sequence_number_in_chunk;
+	if(!find_chunk_entry(archive_p, chunk_index, log_sequence_number, &entry, &prev_log_sequence_number_in_chunk, error))
+		goto EXIT;
+
+	while(1)
+	{
+		if(!find_chunk_entry_of_type(archive_p, chunk_index, log_sequence_number, is_forward, is_inclusive, filter, &found_log_sequence_number, error))
+			goto EXIT;
+
+		if(!are_equal_uint256(found_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+			goto EXIT;
+
+		// there is no chunk to step onto, after the last chunk or before the first chunk
+		if(is_forward ? (chunk_index + 1 == archive_p->chunk_count) : (chunk_index == 0))
+			goto EXIT;
+
+		// all the log records of the adjacent chunk are considered
+		chunk_index = is_forward ? (chunk_index + 1) : (chunk_index - 1);
+		log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	}
+
+	EXIT:;
+	pthread_mutex_unlock(&(archive_p->cache_lock));
+
+	return found_log_sequence_number;
+}
+
+uint256 get_first_log_sequence_number_of_type_archive(wale_archive* archive_p, const log_record_type_filter* filter, int* error)
+{
+	return seek_log_record_of_type_in_archive(archive_p, archive_p->first_log_sequence_number, 1, 1, filter, error);
+}
+
+uint256 get_last_log_sequence_number_of_type_archive(wale_archive* archive_p, const log_record_type_filter* filter, int* error)
+{
+	return seek_log_record_of_type_in_archive(archive_p, archive_p->last_log_sequence_number, 0, 1, filter, error);
+}
+
+uint256 get_next_log_sequence_number_of_type_archive(wale_archive* archive_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error)
+{
+	return seek_log_record_of_type_in_archive(archive_p, log_sequence_number, 1, 0, filter, error);
+}
+
+uint256 get_prev_log_sequence_number_of_type_archive(wale_archive* archive_p, uint256 log_sequence_number, const log_record_type_filter* filter, int* error)
+{
+	return seek_log_record_of_type_in_archive(archive_p, log_sequence_number, 0, 0, filter, error);
+}
+
+// -------------------------------------------------------------
+
+int attach_wale_archive(wale* wale_p, wale_archive* archive_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(archive_p != NULL && archive_p->log_sequence_number_width != get_log_sequence_number_width(wale_p))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	wale_p->archive = archive_p;
+	return 1;
+}
\ No newline at end of file
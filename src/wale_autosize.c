@@ -0,0 +1,136 @@
+#include<wale.h>
+
+#include<wale_get_lock_util.h>
+#include<util_append_only_buffer.h>
+#include<util_wale_stats.h>
+#include<util_wait_for_scroll.h>
+
+#include<rwlock.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+int set_append_only_buffer_autosize_policy(wale* wale_p, const wale_autosize_policy* policy, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(policy != NULL && (policy->min_buffer_block_count == 0 || policy->min_buffer_block_count > policy->max_buffer_block_count || policy->shrink_below_percent > 100))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	int res = 1;
+
+	// on disabling, the policy is retained, so that an append only buffer that is already released, can be allocated again with its min_buffer_block_count
+	if(policy == NULL)
+	{
+		wale_p->is_autosize_enabled = 0;
+		goto EXIT;
+	}
+
+	wale_p->is_autosize_enabled = 1;
+	wale_p->autosize_policy = (*policy);
+	wale_p->autosize_scroll_waits = 0;
+	wale_p->autosize_appended_bytes = 0;
+	wale_p->autosize_idle_ticks = 0;
+
+	// a read only WALe (with 0 blocks in its append only buffer) is never resized by the autosizing
+	if(wale_p->buffer_block_count == 0)
+		goto EXIT;
+
+	uint64_t new_buffer_block_count = max(min(wale_p->buffer_block_count, policy->max_buffer_block_count), policy->min_buffer_block_count);
+	if(new_buffer_block_count != wale_p->buffer_block_count)
+	{
+		res = resize_append_only_buffer(wale_p, new_buffer_block_count, error);
+		wake_up_all_scroll_waiters(wale_p);
+	}
+
+	EXIT:;
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	return res;
+}
+
+int tick_append_only_buffer_autosize(wale* wale_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	// return value, suggesting if the append only buffer was resized
+	int resized = 0;
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_lock_recording_wait(wale_p, get_wale_lock(wale_p));
+
+	// this waits for all the appenders that have taken their slots, to finish writing their log records into the append only buffer
+	exclusive_lock_recording_wait(wale_p, &(wale_p->append_only_buffer_lock), WALE_STATS_APPEND_ONLY_BUFFER_LOCK);
+
+	if(!wale_p->is_autosize_enabled || wale_p->buffer_block_count == 0 || wale_p->major_scroll_error)
+		goto EXIT;
+
+	const wale_autosize_policy* policy = &(wale_p->autosize_policy);
+
+	// consume the observations since the last tick
+	uint64_t scroll_waits = wale_p->autosize_scroll_waits;
+	uint64_t appended_bytes = wale_p->autosize_appended_bytes;
+	wale_p->autosize_scroll_waits = 0;
+	wale_p->autosize_appended_bytes = 0;
+
+	if(appended_bytes == 0)
+		wale_p->autosize_idle_ticks++;
+	else
+		wale_p->autosize_idle_ticks = 0;
+
+	// release the append only buffer of an idle WALe, only if all of its log records have been flushed
+	// else the unflushed log records in the append only buffer would have to be written out, for which it is the flush_all_log_records()'s job
+	if(policy->release_after_idle_ticks != 0 && wale_p->autosize_idle_ticks >= policy->release_after_idle_ticks)
+	{
+		read_lock_recording_wait(wale_p, &(wale_p->flushed_log_records_lock), WALE_STATS_FLUSHED_LOG_RECORDS_LOCK, READ_PREFERRING);
+		int is_everything_flushed = are_equal_uint256(wale_p->in_memory_master_record.next_log_sequence_number, wale_p->on_disk_master_record.next_log_sequence_number);
+		read_unlock(&(wale_p->flushed_log_records_lock));
+
+		if(is_everything_flushed)
+		{
+			resized = resize_append_only_buffer(wale_p, 0, error);
+			if(resized)
+				wale_p->is_append_only_buffer_released_on_idle = 1;
+			goto WAKE_UP_AND_EXIT;
+		}
+	}
+
+	uint64_t buffer_size = wale_p->buffer_block_count * wale_p->block_io_functions.block_size;
+
+	uint64_t new_buffer_block_count = wale_p->buffer_block_count;
+	if(policy->grow_at_scroll_waits != 0 && scroll_waits >= policy->grow_at_scroll_waits)
+		new_buffer_block_count = (wale_p->buffer_block_count > (policy->max_buffer_block_count / 2)) ? policy->max_buffer_block_count : (wale_p->buffer_block_count * 2);
+	else if(scroll_waits == 0 && appended_bytes < (buffer_size / 100) * policy->shrink_below_percent)
+		new_buffer_block_count = wale_p->buffer_block_count / 2;
+
+	// the policy may have changed since the last resize, so always clamp to its bounds
+	new_buffer_block_count = max(min(new_buffer_block_count, policy->max_buffer_block_count), policy->min_buffer_block_count);
+
+	if(new_buffer_block_count == wale_p->buffer_block_count)
+		goto EXIT;
+
+	resized = resize_append_only_buffer(wale_p, new_buffer_block_count, error);
+
+	WAKE_UP_AND_EXIT:;
+	// the waiters must learn about the new buffer_block_count, as in modify_append_only_buffer_block_count()
+	wake_up_all_scroll_waiters(wale_p);
+
+	EXIT:;
+	exclusive_unlock(&(wale_p->append_only_buffer_lock));
+
+	if(wale_p->has_internal_lock)
+		pthread_mutex_unlock(get_wale_lock(wale_p));
+
+	return resized;
+}
\ No newline at end of file
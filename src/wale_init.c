@@ -2,14 +2,23 @@
 
 #include<wale_get_lock_util.h>
 #include<util_master_record.h>
+#include<util_ring_block_io.h>
+#include<util_wale_stats.h>
+#include<util_wait_for_scroll.h>
+#include<util_flush_epochs.h>
+#include<util_block_buffer_pool.h>
 #include<block_io_ops_util.h>
+#include<util_log_sequence_number.h>
 
 #include<stdlib.h>
 
 #include<cutlery_stds.h>
 
-int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, pthread_mutex_t* external_lock, block_io_ops block_io_functions, uint64_t append_only_block_count, int* error)
+int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 next_log_sequence_number, uint64_t ring_block_count, pthread_mutex_t* external_lock, block_io_ops block_io_functions, uint64_t append_only_block_count, int* error)
 {
+	// initialize error to no error, the steps below only set it on a failure
+	(*error) = NO_ERROR;
+
 	wale_p->has_internal_lock = (external_lock == NULL);
 
 	if(wale_p->has_internal_lock)
@@ -17,12 +26,25 @@ int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 ne
 	else
 		wale_p->external_lock = external_lock;
 
+	wale_p->underlying_block_io_functions = block_io_functions;
 	wale_p->block_io_functions = block_io_functions;
 
+	// the default allocator, until set_wale_allocator() is called
+	wale_p->allocator = default_wale_allocator;
+
+	// the block buffers are sized and aligned for the user provided block_io_functions, the ring and the stats block_io_ops only wrap them
+	wale_p->block_buffers = malloc(sizeof(block_buffer_pool));
+	if(wale_p->block_buffers == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+	initialize_block_buffer_pool(wale_p->block_buffers, &(wale_p->block_io_functions), &(wale_p->allocator));
+
 	if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
 	{
-		if(!read_master_record(&(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error))
-			return 0;
+		if(!read_master_record(&(wale_p->on_disk_master_record), &(wale_p->block_io_functions), wale_p->block_buffers, error))
+			goto DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL;
 	}
 	else
 	{
@@ -30,66 +52,132 @@ int initialize_wale(wale* wale_p, uint32_t log_sequence_number_width, uint256 ne
 		if(log_sequence_number_width == 0 || log_sequence_number_width > get_max_bytes_uint256())
 		{
 			(*error) = PARAM_INVALID;
-			return 0;
+			goto DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL;
 		}
 
 		wale_p->on_disk_master_record.log_sequence_number_width = log_sequence_number_width;
+		wale_p->on_disk_master_record.base_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 		wale_p->on_disk_master_record.first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 		wale_p->on_disk_master_record.last_flushed_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 		wale_p->on_disk_master_record.check_point_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
 		wale_p->on_disk_master_record.next_log_sequence_number = next_log_sequence_number;
+		wale_p->on_disk_master_record.ring_block_count = ring_block_count;
+		wale_p->on_disk_master_record.log_record_format_version = LOG_RECORD_FORMAT_V2;
+
+		// preallocate the ring, before the master record makes it a valid WALe file
+		if(ring_block_count != 0 && !zero_out_ring_blocks(&(wale_p->underlying_block_io_functions), ring_block_count, error))
+			goto DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL;
 
-		if(!write_and_flush_master_record(&(wale_p->on_disk_master_record), &(wale_p->block_io_functions), error))
-			return 0;
+		if(!write_and_flush_master_record(&(wale_p->on_disk_master_record), &(wale_p->block_io_functions), wale_p->block_buffers, error))
+			goto DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL;
 	}
 
+	// in ring mode, all io for the log records happens through the ring block_io_ops
+	wale_p->ring_block_count = wale_p->on_disk_master_record.ring_block_count;
+	if(wale_p->ring_block_count != 0)
+		wale_p->block_io_functions = get_ring_block_io_ops(wale_p);
+
 	wale_p->in_memory_master_record = wale_p->on_disk_master_record;
 
-	pthread_cond_init(&(wale_p->wait_for_scroll), NULL);
+	// no log_record_codec, until set_log_record_codec() is called
+	set_log_record_codec(wale_p, NULL, 0);
+
+	// no archive, until attach_wale_archive() is called
+	wale_p->archive = NULL;
+
+	// no time index, until attach_wale_time_index() is called
+	wale_p->time_index = NULL;
+
+	// no trace callbacks, until set_wale_trace_callbacks() is called
+	wale_p->trace_callbacks = NULL;
+
+	// no autosizing of the append only buffer, until set_append_only_buffer_autosize_policy() is called
+	wale_p->is_autosize_enabled = 0;
+	wale_p->autosize_scroll_waits = 0;
+	wale_p->autosize_appended_bytes = 0;
+	wale_p->autosize_idle_ticks = 0;
+	wale_p->is_append_only_buffer_released_on_idle = 0;
+
+	// no large log records in progress
+	wale_p->large_log_record_writers = NULL;
+	pthread_cond_init(&(wale_p->large_log_record_ended), NULL);
+
+	initialize_scroll_waiters(wale_p);
+	initialize_flush_epochs(wale_p);
 	initialize_rwlock(&(wale_p->flushed_log_records_lock), get_wale_lock(wale_p));
 	initialize_rwlock(&(wale_p->append_only_buffer_lock), get_wale_lock(wale_p));
 
+	// no scroll has failed yet
+	wale_p->major_scroll_error = 0;
+
 	wale_p->max_limit = get_0_uint256();
 	set_bit_in_uint256(&(wale_p->max_limit), wale_p->in_memory_master_record.log_sequence_number_width * CHAR_BIT);
+	select_log_sequence_number_arithmetic(wale_p);
 
 	if(append_only_block_count == 0) // WALe is opened only for reading
 	{
 		wale_p->buffer = NULL;
 		wale_p->buffer_block_count = 0;
+		wale_p->written_file_offset = 0;
 	}
 	else
 	{
-		wale_p->buffer = aligned_alloc(wale_p->block_io_functions.block_buffer_alignment, (append_only_block_count * wale_p->block_io_functions.block_size));
+		wale_p->buffer = wale_p->allocator.allocate(wale_p->allocator.allocator_handle, wale_p->block_io_functions.block_buffer_alignment, (append_only_block_count * wale_p->block_io_functions.block_size));
 		wale_p->buffer_block_count = append_only_block_count;
 
 		if(wale_p->buffer == NULL)
 		{
 			(*error) = ALLOCATION_FAILED;
-			return 0;
+			goto DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL;
 		}
 
 		uint64_t file_offset_for_next_log_sequence_number = read_latest_vacant_block_using_master_record(wale_p->buffer, &(wale_p->in_memory_master_record), &(wale_p->block_io_functions), error);
 		if(*error)
-		{
-			free(wale_p->buffer);
-			return 0;
-		}
+			goto DEALLOCATE_BUFFER_AND_FAIL;
 
 		wale_p->buffer_start_block_id = get_block_id_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
 		wale_p->append_offset = get_block_offset_from_file_offset(file_offset_for_next_log_sequence_number, &(wale_p->block_io_functions));
+		wale_p->written_file_offset = file_offset_for_next_log_sequence_number;
+	}
+
+	// all the io from here on is counted in the statistics of the WALe
+	if(!initialize_wale_stats(wale_p))
+	{
+		(*error) = ALLOCATION_FAILED;
+		goto DEALLOCATE_BUFFER_AND_FAIL;
 	}
+	wale_p->counted_block_io_functions = wale_p->block_io_functions;
+	wale_p->block_io_functions = get_stats_block_io_ops(wale_p);
 
 	return 1;
+
+	DEALLOCATE_BUFFER_AND_FAIL:;
+	if(wale_p->buffer != NULL)
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, wale_p->buffer, wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+
+	DEINITIALIZE_BLOCK_BUFFERS_AND_FAIL:;
+	deinitialize_block_buffer_pool(wale_p->block_buffers);
+	free(wale_p->block_buffers);
+	return 0;
 }
 
 void deinitialize_wale(wale* wale_p)
 {
-	free(wale_p->buffer);
+	if(wale_p->buffer != NULL)
+		wale_p->allocator.deallocate(wale_p->allocator.allocator_handle, wale_p->buffer, wale_p->buffer_block_count * wale_p->block_io_functions.block_size);
+
+	deinitialize_block_buffer_pool(wale_p->block_buffers);
+	free(wale_p->block_buffers);
+
+	deinitialize_wale_stats(wale_p);
+
+	deinitialize_flush_epochs(wale_p);
+
+	pthread_cond_destroy(&(wale_p->large_log_record_ended));
 
 	if(wale_p->has_internal_lock)
 		pthread_mutex_destroy(&(wale_p->internal_lock));
 
-	pthread_cond_destroy(&(wale_p->wait_for_scroll));
 	deinitialize_rwlock(&(wale_p->flushed_log_records_lock));
 	deinitialize_rwlock(&(wale_p->append_only_buffer_lock));
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include<wale_replay.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<stdlib.h>
+
+// a log record handed by the reader to a worker
+typedef struct replay_item replay_item;
+struct replay_item
+{
+	uint256 log_sequence_number;
+	void* log_record;
+	uint32_t log_record_size;
+};
+
+typedef struct replay_dispatcher replay_dispatcher;
+
+typedef struct replay_worker replay_worker;
+struct replay_worker
+{
+	replay_dispatcher* dispatcher;
+
+	uint32_t worker_id;
+
+	pthread_t thread;
+
+	// FIFO ring of the log records to be applied by this worker, of the queue_capacity of the dispatcher
+	// protected by the lock of the dispatcher
+	replay_item* queue;
+	uint64_t queue_head;
+	uint64_t queue_count;
+
+	// signalled when a log record is queued, or when the replay ends
+	pthread_cond_t queue_not_empty;
+};
+
+struct replay_dispatcher
+{
+	wale* wale_p;
+
+	const wale_replay_callbacks* callbacks;
+
+	uint32_t batch_size;
+
+	uint64_t queue_capacity;
+
+	replay_worker* workers;
+	uint32_t worker_count;
+
+	// protects all the below attributes and the queues of the workers
+	pthread_mutex_t lock;
+
+	// signalled by the workers, every time they have applied a batch
+	pthread_cond_t batch_applied;
+
+	// number of log records queued or being applied by the workers, a barrier waits for it to become 0
+	uint64_t in_flight_count;
+
+	// set by the reader, once it has queued all the log records
+	int is_reading_done;
+
+	// the first error of the replay, the workers stop applying the log records once it is set
+	// it is also read without the lock by the workers, between their log records
+	int error;
+};
+
+// the workers are chosen by a fibonacci hash of the partition key, so that the keys with a common stride are still spread over all the workers
+static uint32_t get_worker_id_for_key(const replay_dispatcher* dispatcher, uint64_t key)
+{
+	return ((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32) % dispatcher->worker_count;
+}
+
+// must be called with the lock held
+static void set_replay_error(replay_dispatcher* dispatcher, int error)
+{
+	if(dispatcher->error != NO_ERROR)
+		return;
+
+	__atomic_store_n(&(dispatcher->error), error, __ATOMIC_RELAXED);
+
+	// wake up everyone, so that they notice the error
+	pthread_cond_broadcast(&(dispatcher->batch_applied));
+	for(uint32_t i = 0; i < dispatcher->worker_count; i++)
+		pthread_cond_broadcast(&(dispatcher->workers[i].queue_not_empty));
+}
+
+static void* run_replay_worker(void* worker_p)
+{
+	replay_worker* worker = worker_p;
+	replay_dispatcher* dispatcher = worker->dispatcher;
+
+	replay_item* batch = malloc(sizeof(replay_item) * dispatcher->batch_size);
+
+	pthread_mutex_lock(&(dispatcher->lock));
+
+	if(batch == NULL)
+		set_replay_error(dispatcher, ALLOCATION_FAILED);
+
+	while(1)
+	{
+		while(worker->queue_count == 0 && !dispatcher->is_reading_done && dispatcher->error == NO_ERROR)
+			pthread_cond_wait(&(worker->queue_not_empty), &(dispatcher->lock));
+
+		// the queued log records are released by the reader, on an error
+		if(worker->queue_count == 0 || dispatcher->error != NO_ERROR)
+			break;
+
+		// take a batch of log records off the queue, and apply them without the lock
+		uint64_t batch_count = min(worker->queue_count, dispatcher->batch_size);
+		for(uint64_t i = 0; i < batch_count; i++)
+			batch[i] = worker->queue[(worker->queue_head + i) % dispatcher->queue_capacity];
+		worker->queue_head = (worker->queue_head + batch_count) % dispatcher->queue_capacity;
+		worker->queue_count -= batch_count;
+
+		pthread_mutex_unlock(&(dispatcher->lock));
+
+		int is_applied = 1;
+		for(uint64_t i = 0; i < batch_count; i++)
+		{
+			if(is_applied && __atomic_load_n(&(dispatcher->error), __ATOMIC_RELAXED) == NO_ERROR)
+				is_applied = dispatcher->callbacks->apply(dispatcher->callbacks->replay_handle, worker->worker_id, batch[i].log_sequence_number, batch[i].log_record, batch[i].log_record_size);
+			release_log_record(dispatcher->wale_p, batch[i].log_record, batch[i].log_record_size);
+		}
+
+		pthread_mutex_lock(&(dispatcher->lock));
+
+		if(!is_applied)
+			set_replay_error(dispatcher, LOG_RECORD_APPLY_FAILED);
+
+		dispatcher->in_flight_count -= batch_count;
+		pthread_cond_broadcast(&(dispatcher->batch_applied));
+	}
+
+	pthread_mutex_unlock(&(dispatcher->lock));
+
+	free(batch);
+	return NULL;
+}
+
+// queues the batch_count log records of the batch to their workers, waiting for the space in their queues
+// must be called with the lock held, it returns 0, if the replay failed in the meantime, the log records that were not queued are then released
+static int dispatch_batch(replay_dispatcher* dispatcher, replay_item* batch, const uint32_t* worker_ids, uint32_t batch_count)
+{
+	uint32_t i = 0;
+	for(; i < batch_count; i++)
+	{
+		replay_worker* worker = &(dispatcher->workers[worker_ids[i]]);
+
+		while(worker->queue_count == dispatcher->queue_capacity && dispatcher->error == NO_ERROR)
+			pthread_cond_wait(&(dispatcher->batch_applied), &(dispatcher->lock));
+
+		if(dispatcher->error != NO_ERROR)
+			break;
+
+		worker->queue[(worker->queue_head + worker->queue_count) % dispatcher->queue_capacity] = batch[i];
+		worker->queue_count++;
+		dispatcher->in_flight_count++;
+
+		// the worker waits only on an empty queue
+		if(worker->queue_count == 1)
+			pthread_cond_signal(&(worker->queue_not_empty));
+	}
+
+	for(; i < batch_count; i++)
+		release_log_record(dispatcher->wale_p, batch[i].log_record, batch[i].log_record_size);
+
+	return dispatcher->error == NO_ERROR;
+}
+
+// reads the log records from the from_log_sequence_number until the last_log_sequence_number, and hands them to the workers
+// it is run by the calling thread of the replay_log_records(), and the first error is set in the dispatcher
+static void read_and_dispatch(replay_dispatcher* dispatcher, uint256 from_log_sequence_number, uint256 last_log_sequence_number, uint256 check_point_log_sequence_number)
+{
+	wale* wale_p = dispatcher->wale_p;
+	const wale_replay_callbacks* callbacks = dispatcher->callbacks;
+
+	replay_item* batch = malloc(sizeof(replay_item) * dispatcher->batch_size);
+	uint32_t* worker_ids = malloc(sizeof(uint32_t) * dispatcher->batch_size);
+	if(batch == NULL || worker_ids == NULL)
+	{
+		pthread_mutex_lock(&(dispatcher->lock));
+		set_replay_error(dispatcher, ALLOCATION_FAILED);
+		pthread_mutex_unlock(&(dispatcher->lock));
+		goto EXIT;
+	}
+
+	int error = NO_ERROR;
+	uint256 log_sequence_number = from_log_sequence_number;
+	while(!are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) && error == NO_ERROR)
+	{
+		// read and classify the next batch, it ends at a barrier
+		uint32_t batch_count = 0;
+		int is_barrier = 0;
+		while(batch_count < dispatcher->batch_size && !is_barrier && !are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			replay_item* item = &(batch[batch_count]);
+			item->log_sequence_number = log_sequence_number;
+			item->log_record = get_log_record_at(wale_p, log_sequence_number, &(item->log_record_size), &error);
+			if(item->log_record == NULL)
+				break;
+
+			uint64_t key = callbacks->classify(callbacks->replay_handle, log_sequence_number, item->log_record, item->log_record_size);
+			is_barrier = (key == WALE_REPLAY_BARRIER_KEY) || are_equal_uint256(log_sequence_number, check_point_log_sequence_number);
+			worker_ids[batch_count++] = is_barrier ? dispatcher->worker_count : get_worker_id_for_key(dispatcher, key);
+
+			// the last_log_sequence_number is the last one to be replayed
+			if(are_equal_uint256(log_sequence_number, last_log_sequence_number))
+				log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+			else
+			{
+				log_sequence_number = get_next_log_sequence_number_of(wale_p, log_sequence_number, &error);
+				if(error != NO_ERROR)
+					break;
+			}
+		}
+
+		// the barrier is not queued, it is applied by us, once all the log records before it are applied
+		uint32_t queued_count = is_barrier ? (batch_count - 1) : batch_count;
+
+		pthread_mutex_lock(&(dispatcher->lock));
+
+		if(error != NO_ERROR)
+			set_replay_error(dispatcher, error);
+
+		if(!dispatch_batch(dispatcher, batch, worker_ids, queued_count))
+		{
+			pthread_mutex_unlock(&(dispatcher->lock));
+			if(is_barrier)
+				release_log_record(wale_p, batch[queued_count].log_record, batch[queued_count].log_record_size);
+			break;
+		}
+
+		if(is_barrier)
+		{
+			while(dispatcher->in_flight_count > 0 && dispatcher->error == NO_ERROR)
+				pthread_cond_wait(&(dispatcher->batch_applied), &(dispatcher->lock));
+
+			int is_applied = 0;
+			if(dispatcher->error == NO_ERROR)
+			{
+				pthread_mutex_unlock(&(dispatcher->lock));
+
+				replay_item* barrier = &(batch[queued_count]);
+				is_applied = callbacks->apply(callbacks->replay_handle, dispatcher->worker_count, barrier->log_sequence_number, barrier->log_record, barrier->log_record_size);
+
+				pthread_mutex_lock(&(dispatcher->lock));
+
+				if(!is_applied)
+					set_replay_error(dispatcher, LOG_RECORD_APPLY_FAILED);
+			}
+			error = dispatcher->error;
+
+			pthread_mutex_unlock(&(dispatcher->lock));
+
+			release_log_record(wale_p, batch[queued_count].log_record, batch[queued_count].log_record_size);
+		}
+		else
+		{
+			error = dispatcher->error;
+			pthread_mutex_unlock(&(dispatcher->lock));
+		}
+	}
+
+	EXIT:;
+	free(batch);
+	free(worker_ids);
+}
+
+int replay_log_records(wale* wale_p, uint256 from_log_sequence_number, uint32_t worker_count, uint32_t batch_size, const wale_replay_callbacks* callbacks, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(are_equal_uint256(from_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || worker_count == 0 || callbacks == NULL || callbacks->classify == NULL || callbacks->apply == NULL)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	// the log records flushed after this point, are not replayed
+	uint256 last_log_sequence_number = get_last_flushed_log_sequence_number(wale_p);
+	if(are_equal_uint256(last_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(from_log_sequence_number, last_log_sequence_number) > 0)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	if(batch_size == 0)
+		batch_size = DEFAULT_REPLAY_BATCH_SIZE;
+
+	replay_dispatcher dispatcher = {
+		.wale_p = wale_p,
+		.callbacks = callbacks,
+		.batch_size = batch_size,
+		.queue_capacity = ((uint64_t)batch_size) * REPLAY_QUEUE_BATCHES_PER_WORKER,
+		.workers = calloc(worker_count, sizeof(replay_worker)),
+		.worker_count = worker_count,
+		.in_flight_count = 0,
+		.is_reading_done = 0,
+		.error = NO_ERROR,
+	};
+	if(dispatcher.workers == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	pthread_mutex_init(&(dispatcher.lock), NULL);
+	pthread_cond_init(&(dispatcher.batch_applied), NULL);
+
+	for(uint32_t i = 0; i < worker_count; i++)
+	{
+		replay_worker* worker = &(dispatcher.workers[i]);
+		worker->dispatcher = &dispatcher;
+		worker->worker_id = i;
+		worker->queue = malloc(sizeof(replay_item) * dispatcher.queue_capacity);
+		worker->queue_head = 0;
+		worker->queue_count = 0;
+		pthread_cond_init(&(worker->queue_not_empty), NULL);
+		if(worker->queue == NULL)
+			dispatcher.error = ALLOCATION_FAILED;
+	}
+
+	uint32_t started_count = 0;
+	for(; started_count < worker_count && dispatcher.error == NO_ERROR; started_count++)
+	{
+		if(pthread_create(&(dispatcher.workers[started_count].thread), NULL, run_replay_worker, &(dispatcher.workers[started_count])) != 0)
+		{
+			pthread_mutex_lock(&(dispatcher.lock));
+			set_replay_error(&dispatcher, ALLOCATION_FAILED);
+			pthread_mutex_unlock(&(dispatcher.lock));
+			break;
+		}
+	}
+
+	if(dispatcher.error == NO_ERROR)
+		read_and_dispatch(&dispatcher, from_log_sequence_number, last_log_sequence_number, get_check_point_log_sequence_number(wale_p));
+
+	// let the workers drain their queues and exit
+	pthread_mutex_lock(&(dispatcher.lock));
+	dispatcher.is_reading_done = 1;
+	for(uint32_t i = 0; i < started_count; i++)
+		pthread_cond_broadcast(&(dispatcher.workers[i].queue_not_empty));
+	pthread_mutex_unlock(&(dispatcher.lock));
+
+	for(uint32_t i = 0; i < started_count; i++)
+		pthread_join(dispatcher.workers[i].thread, NULL);
+
+	for(uint32_t i = 0; i < worker_count; i++)
+	{
+		replay_worker* worker = &(dispatcher.workers[i]);
+
+		// on an error, the workers leave their queued log records behind
+		for(; worker->queue_count > 0; worker->queue_count--, worker->queue_head = (worker->queue_head + 1) % dispatcher.queue_capacity)
+			release_log_record(wale_p, worker->queue[worker->queue_head].log_record, worker->queue[worker->queue_head].log_record_size);
+
+		free(worker->queue);
+		pthread_cond_destroy(&(worker->queue_not_empty));
+	}
+
+	(*error) = dispatcher.error;
+
+	free(dispatcher.workers);
+	pthread_cond_destroy(&(dispatcher.batch_applied));
+	pthread_mutex_destroy(&(dispatcher.lock));
+
+	return (*error) == NO_ERROR;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include<wale_stats.h>
+
+#include<util_wale_stats.h>
+
+#include<cutlery_stds.h>
+
+void get_wale_stats(wale* wale_p, wale_stats* stats)
+{
+	memory_set(stats, 0, sizeof(wale_stats));
+
+	for(uint32_t s = 0; s < WALE_STATS_SHARD_COUNT; s++)
+	{
+		const wale_stats_shard* shard = &(wale_p->stats_shards[s]);
+
+		for(uint32_t i = 0; i < WALE_STATS_COUNTER_COUNT; i++)
+			stats->counters[i] += __atomic_load_n(&(shard->counters[i]), __ATOMIC_RELAXED);
+
+		for(uint32_t i = 0; i < WALE_STATS_LATENCY_COUNT; i++)
+		{
+			const wale_stats_histogram* shard_histogram = &(shard->latencies[i]);
+			wale_stats_histogram* histogram = &(stats->latencies[i]);
+
+			histogram->count += __atomic_load_n(&(shard_histogram->count), __ATOMIC_RELAXED);
+			histogram->sum_ns += __atomic_load_n(&(shard_histogram->sum_ns), __ATOMIC_RELAXED);
+			uint64_t max_ns = __atomic_load_n(&(shard_histogram->max_ns), __ATOMIC_RELAXED);
+			if(max_ns > histogram->max_ns)
+				histogram->max_ns = max_ns;
+			for(uint32_t b = 0; b < WALE_STATS_BUCKET_COUNT; b++)
+				histogram->buckets[b] += __atomic_load_n(&(shard_histogram->buckets[b]), __ATOMIC_RELAXED);
+		}
+
+		for(uint32_t i = 0; i < WALE_STATS_LOCK_COUNT; i++)
+		{
+			stats->lock_waits[i] += __atomic_load_n(&(shard->lock_waits[i]), __ATOMIC_RELAXED);
+			stats->lock_wait_ns[i] += __atomic_load_n(&(shard->lock_wait_ns[i]), __ATOMIC_RELAXED);
+		}
+	}
+}
+
+uint64_t get_wale_stats_bucket_lower_bound(uint32_t bucket_index)
+{
+	if(bucket_index < (UINT32_C(1) << WALE_STATS_SUB_BUCKET_BITS))
+		return bucket_index;
+
+	uint32_t most_significant_bit = (bucket_index >> WALE_STATS_SUB_BUCKET_BITS) + WALE_STATS_SUB_BUCKET_BITS - 1;
+	if(most_significant_bit >= 64)
+		return UINT64_MAX;
+
+	uint64_t sub_bucket = bucket_index & ((UINT32_C(1) << WALE_STATS_SUB_BUCKET_BITS) - 1);
+	return (UINT64_C(1) << most_significant_bit) | (sub_bucket << (most_significant_bit - WALE_STATS_SUB_BUCKET_BITS));
+}
+
+uint64_t get_wale_stats_percentile(const wale_stats_histogram* histogram, double percentile)
+{
+	uint64_t count = 0;
+	for(uint32_t b = 0; b < WALE_STATS_BUCKET_COUNT; b++)
+		count += histogram->buckets[b];
+
+	if(count == 0)
+		return 0;
+
+	// the value at the percentile is the rank-th smallest value (1-indexed)
+	double exact_rank = (percentile / 100.0) * count;
+	uint64_t rank = (uint64_t)exact_rank;
+	if(rank < exact_rank)
+		rank++;
+	if(rank == 0)
+		rank = 1;
+	if(rank > count)
+		rank = count;
+
+	uint64_t seen = 0;
+	for(uint32_t b = 0; b < WALE_STATS_BUCKET_COUNT; b++)
+	{
+		seen += histogram->buckets[b];
+		if(seen >= rank)
+			return get_wale_stats_bucket_lower_bound(b);
+	}
+
+	return histogram->max_ns;
+}
\ No newline at end of file
@@ -0,0 +1,451 @@
+#include<wale_time_index.h>
+
+#include<crc32_util.h>
+
+#include<serial_int.h>
+
+#include<cutlery_stds.h>
+#include<cutlery_math.h>
+
+#include<stdlib.h>
+#include<time.h>
+
+// the time_index_version that we write
+#define TIME_INDEX_VERSION 0
+
+#define TIME_INDEX_VERSION_BITS_OFFSET 16
+
+// size of the serialized time index header, excluding its crc32
+#define TIME_INDEX_HEADER_SIZE (sizeof(uint32_t) + sizeof(uint64_t))
+
+// size of the entry_count and the crc32 at the start of every block of entries
+#define ENTRIES_BLOCK_HEADER_SIZE (2 * sizeof(uint32_t))
+
+// size of a serialized entry
+static uint64_t get_entry_size(uint32_t log_sequence_number_width)
+{
+	return sizeof(uint64_t) + log_sequence_number_width;
+}
+
+static uint32_t get_entries_per_block(const wale_time_index* time_index_p)
+{
+	return (time_index_p->block_io_functions.block_size - ENTRIES_BLOCK_HEADER_SIZE) / get_entry_size(time_index_p->log_sequence_number_width);
+}
+
+static uint32_t get_entry_count(const void* block)
+{
+	return deserialize_uint32(block, sizeof(uint32_t));
+}
+
+static uint64_t get_entry_time(const wale_time_index* time_index_p, const void* block, uint32_t entry_index)
+{
+	return deserialize_uint64(block + ENTRIES_BLOCK_HEADER_SIZE + entry_index * get_entry_size(time_index_p->log_sequence_number_width), sizeof(uint64_t));
+}
+
+static uint256 get_entry_next_log_sequence_number(const wale_time_index* time_index_p, const void* block, uint32_t entry_index)
+{
+	return deserialize_uint256(block + ENTRIES_BLOCK_HEADER_SIZE + entry_index * get_entry_size(time_index_p->log_sequence_number_width) + sizeof(uint64_t), time_index_p->log_sequence_number_width);
+}
+
+static uint32_t get_block_crc32(const wale_time_index* time_index_p, const void* block, uint32_t entry_count)
+{
+	uint32_t crc = crc32_util(crc32_init(), block, sizeof(uint32_t));
+	return crc32_util(crc, block + ENTRIES_BLOCK_HEADER_SIZE, entry_count * get_entry_size(time_index_p->log_sequence_number_width));
+}
+
+// returns 1, if the block holds atleast 1 entry and its crc32 matches
+static int is_valid_entries_block(const wale_time_index* time_index_p, const void* block)
+{
+	uint32_t entry_count = get_entry_count(block);
+	return entry_count > 0 && entry_count <= get_entries_per_block(time_index_p) &&
+		get_block_crc32(time_index_p, block, entry_count) == deserialize_uint32(block + sizeof(uint32_t), sizeof(uint32_t));
+}
+
+static int write_time_index_header(wale_time_index* time_index_p)
+{
+	const block_io_ops* block_io_functions = &(time_index_p->block_io_functions);
+
+	void* header_serial = aligned_alloc(block_io_functions->block_buffer_alignment, block_io_functions->block_size);
+	if(header_serial == NULL)
+		return 0;
+	memory_set(header_serial, 0, block_io_functions->block_size);
+
+	serialize_uint32(header_serial, sizeof(uint32_t), time_index_p->log_sequence_number_width | (TIME_INDEX_VERSION << TIME_INDEX_VERSION_BITS_OFFSET));
+	serialize_uint64(header_serial + sizeof(uint32_t), sizeof(uint64_t), time_index_p->tail_block_id);
+	serialize_uint32(header_serial + TIME_INDEX_HEADER_SIZE, sizeof(uint32_t), crc32_util(crc32_init(), header_serial, TIME_INDEX_HEADER_SIZE));
+
+	int io_success = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, header_serial, 0, 1);
+	free(header_serial);
+	return io_success;
+}
+
+// -------------------------------------------------------------
+// opening and closing the time index
+
+// reads the header in the block 0 (already read into the header_serial), setting the tail_block_id to its hint
+static int parse_time_index_header(wale_time_index* time_index_p, const void* header_serial, int* error)
+{
+	uint32_t width_and_version = deserialize_uint32(header_serial, sizeof(uint32_t));
+	uint32_t time_index_version = width_and_version >> TIME_INDEX_VERSION_BITS_OFFSET;
+	uint32_t log_sequence_number_width = width_and_version & ((UINT32_C(1) << TIME_INDEX_VERSION_BITS_OFFSET) - 1);
+
+	if(time_index_version > TIME_INDEX_VERSION ||
+		crc32_util(crc32_init(), header_serial, TIME_INDEX_HEADER_SIZE) != deserialize_uint32(header_serial + TIME_INDEX_HEADER_SIZE, sizeof(uint32_t)))
+	{
+		(*error) = TIME_INDEX_CORRUPTED;
+		return 0;
+	}
+
+	// the time index must be opened for a WALe of the width it was created with
+	if(log_sequence_number_width != time_index_p->log_sequence_number_width)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	time_index_p->tail_block_id = deserialize_uint64(header_serial + sizeof(uint32_t), sizeof(uint64_t));
+	if(time_index_p->tail_block_id == 0)
+	{
+		(*error) = TIME_INDEX_CORRUPTED;
+		return 0;
+	}
+
+	return 1;
+}
+
+// reads the block_id into the block, returns 1, only if it is a valid block of entries
+static int read_valid_entries_block(const wale_time_index* time_index_p, void* block, uint64_t block_id)
+{
+	const block_io_ops* block_io_functions = &(time_index_p->block_io_functions);
+	return block_io_functions->read_blocks(block_io_functions->block_io_ops_handle, block, block_id, 1) && is_valid_entries_block(time_index_p, block);
+}
+
+// the tail_block_id in the header is only a hint, it may be behind the actual tail (a crash after a new block was written, but before the header was)
+// or ahead of it (a crash after the header was written, but before the new block was)
+// so we step back to the last valid block, and then forward for as long as the next blocks are valid and continue its entries
+static void recover_tail_block(wale_time_index* time_index_p, void* scratch_block)
+{
+	while(time_index_p->tail_block_id > 1 && !read_valid_entries_block(time_index_p, time_index_p->tail_block, time_index_p->tail_block_id))
+		time_index_p->tail_block_id--;
+
+	if(time_index_p->tail_block_id == 1 && !read_valid_entries_block(time_index_p, time_index_p->tail_block, time_index_p->tail_block_id))
+	{
+		// there are no entries
+		memory_set(time_index_p->tail_block, 0, time_index_p->block_io_functions.block_size);
+		time_index_p->tail_entry_count = 0;
+		time_index_p->last_time = 0;
+		time_index_p->last_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+		return;
+	}
+
+	while(1)
+	{
+		uint32_t tail_entry_count = get_entry_count(time_index_p->tail_block);
+		time_index_p->tail_entry_count = tail_entry_count;
+		time_index_p->last_time = get_entry_time(time_index_p, time_index_p->tail_block, tail_entry_count - 1);
+		time_index_p->last_next_log_sequence_number = get_entry_next_log_sequence_number(time_index_p, time_index_p->tail_block, tail_entry_count - 1);
+
+		if(!read_valid_entries_block(time_index_p, scratch_block, time_index_p->tail_block_id + 1) ||
+			get_entry_time(time_index_p, scratch_block, 0) < time_index_p->last_time ||
+			compare_uint256(get_entry_next_log_sequence_number(time_index_p, scratch_block, 0), time_index_p->last_next_log_sequence_number) <= 0)
+			break;
+
+		time_index_p->tail_block_id++;
+		memory_move(time_index_p->tail_block, scratch_block, time_index_p->block_io_functions.block_size);
+	}
+}
+
+int open_wale_time_index(wale_time_index* time_index_p, block_io_ops block_io_functions, uint32_t log_sequence_number_width, uint64_t min_interval_in_microseconds, int* error)
+{
+	(*error) = NO_ERROR;
+
+	// the header and atleast 1 entry must fit in a block
+	if(log_sequence_number_width == 0 || log_sequence_number_width > get_max_bytes_uint256() ||
+		TIME_INDEX_HEADER_SIZE + sizeof(uint32_t) > block_io_functions.block_size ||
+		ENTRIES_BLOCK_HEADER_SIZE + get_entry_size(log_sequence_number_width) > block_io_functions.block_size)
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	time_index_p->block_io_functions = block_io_functions;
+	time_index_p->log_sequence_number_width = log_sequence_number_width;
+	time_index_p->min_interval_in_microseconds = (min_interval_in_microseconds == 0) ? DEFAULT_TIME_INDEX_MIN_INTERVAL : min_interval_in_microseconds;
+
+	time_index_p->tail_block = aligned_alloc(block_io_functions.block_buffer_alignment, block_io_functions.block_size);
+	void* scratch_block = aligned_alloc(block_io_functions.block_buffer_alignment, block_io_functions.block_size);
+	if(time_index_p->tail_block == NULL || scratch_block == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		goto FAILED;
+	}
+
+	if(!block_io_functions.read_blocks(block_io_functions.block_io_ops_handle, scratch_block, 0, 1))
+	{
+		(*error) = READ_IO_ERROR;
+		goto FAILED;
+	}
+
+	int is_new = 1;
+	for(uint64_t i = 0; i < block_io_functions.block_size && is_new; i++)
+		is_new = (((const char*)scratch_block)[i] == 0);
+
+	if(is_new)
+	{
+		// a new time index, with no entries
+		time_index_p->tail_block_id = 1;
+		memory_set(time_index_p->tail_block, 0, block_io_functions.block_size);
+		time_index_p->tail_entry_count = 0;
+		time_index_p->last_time = 0;
+		time_index_p->last_next_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+
+		if(!write_time_index_header(time_index_p) || !block_io_functions.flush_all_writes(block_io_functions.block_io_ops_handle))
+		{
+			(*error) = WRITE_IO_ERROR;
+			goto FAILED;
+		}
+	}
+	else
+	{
+		if(!parse_time_index_header(time_index_p, scratch_block, error))
+			goto FAILED;
+		recover_tail_block(time_index_p, scratch_block);
+	}
+
+	free(scratch_block);
+
+	// the tail block on the disk is as we have it in memory, an empty tail block need not be written
+	time_index_p->is_tail_block_written = 1;
+
+	pthread_mutex_init(&(time_index_p->tail_lock), NULL);
+
+	return 1;
+
+	FAILED:;
+	free(time_index_p->tail_block);
+	free(scratch_block);
+	return 0;
+}
+
+void close_wale_time_index(wale_time_index* time_index_p)
+{
+	const block_io_ops* block_io_functions = &(time_index_p->block_io_functions);
+
+	// a failed write of the tail block is retried, it is only a hint, so its failure is ignored
+	if(!time_index_p->is_tail_block_written)
+		block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, time_index_p->tail_block, time_index_p->tail_block_id, 1);
+	block_io_functions->flush_all_writes(block_io_functions->block_io_ops_handle);
+
+	free(time_index_p->tail_block);
+	pthread_mutex_destroy(&(time_index_p->tail_lock));
+}
+
+// -------------------------------------------------------------
+// recording the entries
+
+int record_in_wale_time_index(wale_time_index* time_index_p, uint64_t time, uint256 next_log_sequence_number, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	const block_io_ops* block_io_functions = &(time_index_p->block_io_functions);
+
+	pthread_mutex_lock(&(time_index_p->tail_lock));
+
+	int has_entries = !are_equal_uint256(time_index_p->last_next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER);
+
+	// the recorded times never decrease, even if the wall clock goes back
+	time = max(time, time_index_p->last_time);
+
+	// nothing was flushed since the last entry, or it is too soon for the next entry
+	if(has_entries && (compare_uint256(next_log_sequence_number, time_index_p->last_next_log_sequence_number) <= 0 ||
+		time - time_index_p->last_time < time_index_p->min_interval_in_microseconds))
+	{
+		pthread_mutex_unlock(&(time_index_p->tail_lock));
+		return 1;
+	}
+
+	// begin a new tail block, once the current one is full and on the disk
+	if(time_index_p->tail_entry_count == get_entries_per_block(time_index_p))
+	{
+		if(!time_index_p->is_tail_block_written)
+			time_index_p->is_tail_block_written = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, time_index_p->tail_block, time_index_p->tail_block_id, 1);
+		if(!time_index_p->is_tail_block_written)
+		{
+			(*error) = WRITE_IO_ERROR;
+			pthread_mutex_unlock(&(time_index_p->tail_lock));
+			return 0;
+		}
+
+		time_index_p->tail_block_id++;
+		memory_set(time_index_p->tail_block, 0, block_io_functions->block_size);
+		time_index_p->tail_entry_count = 0;
+
+		// the tail_block_id in the header is only a hint for the open_wale_time_index(), so a failure to write it is ignored
+		write_time_index_header(time_index_p);
+	}
+
+	void* entry = time_index_p->tail_block + ENTRIES_BLOCK_HEADER_SIZE + time_index_p->tail_entry_count * get_entry_size(time_index_p->log_sequence_number_width);
+	serialize_uint64(entry, sizeof(uint64_t), time);
+	serialize_uint256(entry + sizeof(uint64_t), time_index_p->log_sequence_number_width, next_log_sequence_number);
+	time_index_p->tail_entry_count++;
+	serialize_uint32(time_index_p->tail_block, sizeof(uint32_t), time_index_p->tail_entry_count);
+	serialize_uint32(time_index_p->tail_block + sizeof(uint32_t), sizeof(uint32_t), get_block_crc32(time_index_p, time_index_p->tail_block, time_index_p->tail_entry_count));
+
+	time_index_p->last_time = time;
+	time_index_p->last_next_log_sequence_number = next_log_sequence_number;
+
+	// the entry is in memory, even if its write fails, the write is then retried along with the next entry
+	time_index_p->is_tail_block_written = block_io_functions->write_blocks(block_io_functions->block_io_ops_handle, time_index_p->tail_block, time_index_p->tail_block_id, 1);
+	if(!time_index_p->is_tail_block_written)
+		(*error) = WRITE_IO_ERROR;
+
+	pthread_mutex_unlock(&(time_index_p->tail_lock));
+
+	return time_index_p->is_tail_block_written;
+}
+
+uint64_t get_wale_time_index_now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return ((uint64_t)now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// -------------------------------------------------------------
+// searching the entries
+
+// returns the index of the last entry in the block, with its time before the time, the first entry of the block must be before the time
+static uint32_t find_last_entry_before_time(const wale_time_index* time_index_p, const void* block, uint64_t time)
+{
+	uint32_t low = 0;
+	uint32_t high = get_entry_count(block) - 1;
+	while(low < high)
+	{
+		uint32_t mid = low + (high - low + 1) / 2;
+		if(get_entry_time(time_index_p, block, mid) < time)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	return low;
+}
+
+// sets the next_log_sequence_number of the last entry before the time, or INVALID_LOG_SEQUENCE_NUMBER, if there is no such entry
+static int find_next_log_sequence_number_before_time(wale_time_index* time_index_p, uint64_t time, uint256* next_log_sequence_number, int* error)
+{
+	const block_io_ops* block_io_functions = &(time_index_p->block_io_functions);
+
+	(*next_log_sequence_number) = INVALID_LOG_SEQUENCE_NUMBER;
+
+	void* block = aligned_alloc(block_io_functions->block_buffer_alignment, block_io_functions->block_size);
+	if(block == NULL)
+	{
+		(*error) = ALLOCATION_FAILED;
+		return 0;
+	}
+
+	// only the tail block is ever modified, so we search a copy of it, and the blocks before it are read without the tail_lock
+	pthread_mutex_lock(&(time_index_p->tail_lock));
+	uint64_t tail_block_id = time_index_p->tail_block_id;
+	uint32_t tail_entry_count = time_index_p->tail_entry_count;
+	memory_move(block, time_index_p->tail_block, block_io_functions->block_size);
+	pthread_mutex_unlock(&(time_index_p->tail_lock));
+
+	int result = 0;
+
+	if(tail_entry_count == 0 || get_entry_time(time_index_p, block, 0) >= time)
+	{
+		// find the last block before the tail block, with its first entry before the time
+		uint64_t found_block_id = 0;
+		uint64_t block_id_in_block = 0;
+		uint64_t low = 1;
+		uint64_t high = tail_block_id - 1;
+		while(low <= high)
+		{
+			uint64_t mid = low + (high - low) / 2;
+			if(!read_valid_entries_block(time_index_p, block, mid))
+			{
+				(*error) = TIME_INDEX_CORRUPTED;
+				goto EXIT;
+			}
+			block_id_in_block = mid;
+
+			if(get_entry_time(time_index_p, block, 0) < time)
+			{
+				found_block_id = mid;
+				low = mid + 1;
+			}
+			else
+				high = mid - 1;
+		}
+
+		// all the entries are at or after the time
+		if(found_block_id == 0)
+		{
+			result = 1;
+			goto EXIT;
+		}
+
+		if(block_id_in_block != found_block_id && !read_valid_entries_block(time_index_p, block, found_block_id))
+		{
+			(*error) = TIME_INDEX_CORRUPTED;
+			goto EXIT;
+		}
+	}
+
+	(*next_log_sequence_number) = get_entry_next_log_sequence_number(time_index_p, block, find_last_entry_before_time(time_index_p, block, time));
+	result = 1;
+
+	EXIT:;
+	free(block);
+	return result;
+}
+
+// -------------------------------------------------------------
+// attaching the time index to a WALe
+
+int attach_wale_time_index(wale* wale_p, wale_time_index* time_index_p, int* error)
+{
+	(*error) = NO_ERROR;
+
+	if(time_index_p != NULL && time_index_p->log_sequence_number_width != get_log_sequence_number_width(wale_p))
+	{
+		(*error) = PARAM_INVALID;
+		return 0;
+	}
+
+	wale_p->time_index = time_index_p;
+	return 1;
+}
+
+uint256 find_log_sequence_number_at_time(wale* wale_p, uint64_t time, int* error)
+{
+	(*error) = NO_ERROR;
+
+	uint256 first_log_sequence_number = get_first_log_sequence_number(wale_p);
+
+	// without a time index, the scan must begin from the start
+	if(wale_p->time_index == NULL)
+		return first_log_sequence_number;
+
+	uint256 next_log_sequence_number;
+	if(!find_next_log_sequence_number_before_time(wale_p->time_index, time, &next_log_sequence_number, error))
+		return INVALID_LOG_SEQUENCE_NUMBER;
+
+	// no entry before the time, or the log records it points to have since been truncated
+	if(are_equal_uint256(next_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(next_log_sequence_number, first_log_sequence_number) < 0)
+		return first_log_sequence_number;
+
+	// no log record was flushed after the entry
+	uint256 last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(wale_p);
+	if(are_equal_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) || compare_uint256(next_log_sequence_number, last_flushed_log_sequence_number) > 0)
+		return INVALID_LOG_SEQUENCE_NUMBER;
+
+	return next_log_sequence_number;
+}
\ No newline at end of file
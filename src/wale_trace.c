@@ -0,0 +1,6 @@
+#include<wale_trace.h>
+
+void set_wale_trace_callbacks(wale* wale_p, const wale_trace_callbacks* callbacks)
+{
+	wale_p->trace_callbacks = callbacks;
+}
\ No newline at end of file
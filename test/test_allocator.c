@@ -0,0 +1,202 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_allocator.h>
+
+#include<string.h>
+#include<errno.h>
+#include<stdatomic.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOG_COUNT 2000
+
+// larger than a pooled block buffer, so that it is read in chunks
+#define LARGE_LOG_RECORD_SIZE (200 * 1024)
+
+#define LOG_FORMAT "log_number=<%d> some padding to make the log records span across the blocks"
+
+// counts every allocation made by the WALe, and checks that every deallocation is with the size it was allocated with
+typedef struct counting_allocator counting_allocator;
+struct counting_allocator
+{
+	atomic_uint_fast64_t allocations;
+	atomic_uint_fast64_t live_allocations;
+	atomic_uint_fast64_t live_bytes;
+};
+
+static void* counting_allocate(void* allocator_handle, size_t alignment, size_t size)
+{
+	counting_allocator* ca = allocator_handle;
+	if(size == 0 || (size % alignment) != 0)
+	{
+		printf("allocator asked for %zu bytes aligned to %zu\n", size, alignment);
+		exit(-1);
+	}
+	void* ptr = aligned_alloc(alignment, size);
+	if(ptr != NULL)
+	{
+		atomic_fetch_add(&(ca->allocations), 1);
+		atomic_fetch_add(&(ca->live_allocations), 1);
+		atomic_fetch_add(&(ca->live_bytes), size);
+	}
+	return ptr;
+}
+
+static void counting_deallocate(void* allocator_handle, void* ptr, size_t size)
+{
+	counting_allocator* ca = allocator_handle;
+	atomic_fetch_sub(&(ca->live_allocations), 1);
+	atomic_fetch_sub(&(ca->live_bytes), size);
+	free(ptr);
+}
+
+wale walE;
+
+static void append_or_exit(const void* log_record, uint32_t log_record_size)
+{
+	int error = 0;
+	if(compare_uint256(append_log_record(&walE, log_record, log_record_size, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+static void flush_or_exit()
+{
+	int error = 0;
+	if(compare_uint256(flush_all_log_records(&walE, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0 || error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+// reads and releases all the log records, returns their count
+static int read_all_or_exit()
+{
+	int error = 0;
+	int log_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error))
+	{
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL)
+		{
+			printf("log record %d could not be read : error = %d\n", log_count, error);
+			exit(-1);
+		}
+		if(log_record_size != LARGE_LOG_RECORD_SIZE && strncmp(log_record, "log_number=<", 12) != 0)
+		{
+			printf("log record %d read incorrectly\n", log_count);
+			exit(-1);
+		}
+		if(log_record_size == LARGE_LOG_RECORD_SIZE)
+		{
+			for(uint32_t i = 0; i < log_record_size; i++)
+			{
+				if(log_record[i] != (char)(i % 251))
+				{
+					printf("large log record read incorrectly at byte %u\n", i);
+					exit(-1);
+				}
+			}
+		}
+		if(!validate_log_record_at(&walE, log_sequence_number, &log_record_size, &error))
+		{
+			printf("log record %d could not be validated : error = %d\n", log_count, error);
+			exit(-1);
+		}
+		release_log_record(&walE, log_record, log_record_size);
+		log_count++;
+	}
+	return log_count;
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	counting_allocator ca = {};
+	if(!set_wale_allocator(&walE, &((wale_allocator){.allocator_handle = &ca, .allocate = counting_allocate, .deallocate = counting_deallocate})))
+	{
+		printf("failed to set the allocator\n");
+		return -1;
+	}
+
+	// the append only buffer is moved into the memory of the new allocator
+	if(ca.live_allocations != 1 || ca.live_bytes != APPEND_ONLY_BUFFER_COUNT * BLOCK_SIZE)
+	{
+		printf("append only buffer was not reallocated using the new allocator\n");
+		return -1;
+	}
+
+	char* large_log_record = malloc(LARGE_LOG_RECORD_SIZE);
+	for(uint32_t i = 0; i < LARGE_LOG_RECORD_SIZE; i++)
+		large_log_record[i] = (char)(i % 251);
+
+	// warm up the pool of the block buffers
+	append_or_exit(large_log_record, LARGE_LOG_RECORD_SIZE);
+	flush_or_exit();
+	read_all_or_exit();
+
+	// in the steady state, the only allocations are of the log records returned by get_log_record_at()
+	uint64_t allocations = ca.allocations;
+	uint64_t live_allocations = ca.live_allocations;
+
+	for(int log_number = 0; log_number < LOG_COUNT; log_number++)
+	{
+		char log_buffer[128];
+		sprintf(log_buffer, LOG_FORMAT, log_number);
+		append_or_exit(log_buffer, strlen(log_buffer) + 1);
+		if(log_number % 100 == 0)
+			flush_or_exit();
+	}
+	flush_or_exit();
+
+	int log_count = read_all_or_exit();
+	printf("read %d log records, with %" PRIu64 " allocations\n", log_count, ca.allocations - allocations);
+	if(log_count != LOG_COUNT + 1)
+	{
+		printf("expected %d log records\n", LOG_COUNT + 1);
+		return -1;
+	}
+	if(ca.allocations - allocations != log_count || ca.live_allocations != live_allocations)
+	{
+		printf("expected only %d allocations, for the returned log records\n", log_count);
+		return -1;
+	}
+
+	free(large_log_record);
+
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+
+	// everything allocated by the WALe is deallocated by the deinitialize_wale()
+	if(ca.live_allocations != 0 || ca.live_bytes != 0)
+	{
+		printf("%" PRIu64 " allocations of %" PRIu64 " bytes leaked\n", (uint64_t)ca.live_allocations, (uint64_t)ca.live_bytes);
+		return -1;
+	}
+
+	return 0;
+}
\ No newline at end of file
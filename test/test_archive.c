@@ -0,0 +1,266 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+#include<deflate_log_record_codec.h>
+
+#include<wale.h>
+#include<wale_archive.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/stat.h>
+
+#define FILENAME			"test_archive.log"
+#define ARCHIVE_FILENAME	"test_archive.archive"
+#define BLOCK_SIZE			4096
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOGS_TO_WRITE 20000
+
+// every log record is appended with the log_record_type of log_number % LOG_RECORD_TYPE_COUNT
+#define LOG_RECORD_TYPE_COUNT 3
+
+#define ARCHIVE_CHUNK_SIZE (16 * 1024)
+
+#define LOG_FORMAT "log_number=<%d> row={\"id\":%d,\"name\":\"name_%d\",\"padding\":\"%.*s\"}"
+#define PADDING "0123456789-10111213141516171819-20212223242526272829-30313233343536373839-40414243444546474849-50515253545556575859"
+
+wale walE;
+
+wale_archive archivE;
+
+static void make_log_record(char* log_buffer, int log_number)
+{
+	sprintf(log_buffer, LOG_FORMAT, log_number, log_number, log_number, (int)(strlen(PADDING)), PADDING);
+}
+
+static void print_file_usage(const char* filename)
+{
+	struct stat st;
+	stat(filename, &st);
+	printf("%s : file size = %lld, allocated bytes = %lld\n", filename, (long long)st.st_size, (long long)st.st_blocks * 512LL);
+}
+
+int main()
+{
+	log_record_codec deflate_codec = get_deflate_log_record_codec();
+
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	uint256 middle_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(int log_number = 0; log_number < LOGS_TO_WRITE; log_number++)
+	{
+		char log_buffer[512];
+		make_log_record(log_buffer, log_number);
+		uint256 log_sequence_number = append_typed_log_record(&walE, log_buffer, strlen(log_buffer) + 1, log_number % LOG_RECORD_TYPE_COUNT, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+		if(log_number == LOGS_TO_WRITE / 2)
+			middle_log_sequence_number = log_sequence_number;
+	}
+
+	printf("flushed until = "); print_uint256(flush_all_log_records(&walE, &error)); printf(" : error -> %d\n", error);
+
+	// archive the first half of the log, and then truncate it from the WALe
+	file_block_io archive_fbio;
+	unlink(ARCHIVE_FILENAME);
+	if(!open_file_block_io(&archive_fbio, ARCHIVE_FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create archive file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int archived = archive_log_records_before(&walE, get_first_log_sequence_number(&walE), middle_log_sequence_number, get_block_io_ops_for_file_block_io(&archive_fbio), &deflate_codec, ARCHIVE_CHUNK_SIZE, &error);
+	printf("archived = %d : error -> %d\n", archived, error);
+	if(!archived)
+		exit(-1);
+
+	int truncated = truncate_log_records_before(&walE, middle_log_sequence_number, &error);
+	printf("truncated = %d : error -> %d\n", truncated, error);
+	if(!truncated)
+		exit(-1);
+
+	print_file_usage(FILENAME);
+	print_file_usage(ARCHIVE_FILENAME);
+
+	deinitialize_wale(&walE);
+
+	// reopen the WALe read-only, with the archive attached
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_file_block_io(&fbio), 0, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	if(!open_wale_archive(&archivE, get_block_io_ops_for_file_block_io(&archive_fbio), &deflate_codec, &error))
+	{
+		printf("failed to open archive : error -> %d\n", error);
+		return -1;
+	}
+	printf("archive chunk_count = %" PRIu64 "\n", archivE.chunk_count);
+
+	if(!attach_wale_archive(&walE, &archivE, &error))
+	{
+		printf("failed to attach archive : error -> %d\n", error);
+		return -1;
+	}
+
+	// walk all the log records in forward direction, across the archive and the WALe
+	int log_records_seen = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		char expected_log_record[512];
+		make_log_record(expected_log_record, log_records_seen);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || log_record_size != strlen(expected_log_record) + 1 || strcmp(log_record, expected_log_record) != 0)
+		{
+			printf("log record mismatch at log_number = %d : error -> %d\n", log_records_seen, error);
+			exit(-1);
+		}
+		free(log_record);
+
+		if(!validate_log_record_at(&walE, log_sequence_number, &log_record_size, &error))
+		{
+			printf("validation failed at log_number = %d : error -> %d\n", log_records_seen, error);
+			exit(-1);
+		}
+
+		uint8_t log_record_type;
+		if(!get_log_record_type_at(&walE, log_sequence_number, &log_record_type, &error) || log_record_type != log_records_seen % LOG_RECORD_TYPE_COUNT)
+		{
+			printf("log_record_type mismatch at log_number = %d : error -> %d\n", log_records_seen, error);
+			exit(-1);
+		}
+
+		log_records_seen++;
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+		if(error)
+		{
+			printf("error walking forward = %d\n", error);
+			exit(-1);
+		}
+	}
+	printf("log records seen walking forward = %d\n", log_records_seen);
+	if(log_records_seen != LOGS_TO_WRITE)
+		exit(-1);
+
+	// walk all the log records in backward direction, across the WALe and the archive
+	log_records_seen = 0;
+	log_sequence_number = get_last_flushed_log_sequence_number(&walE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		log_records_seen++;
+		log_sequence_number = get_prev_log_sequence_number_of(&walE, log_sequence_number, &error);
+		if(error)
+		{
+			printf("error walking backward = %d\n", error);
+			exit(-1);
+		}
+	}
+	printf("log records seen walking backward = %d\n", log_records_seen);
+	if(log_records_seen != LOGS_TO_WRITE)
+		exit(-1);
+
+	// walk only the log records of the last log_record_type in forward direction, across the archive and the WALe
+	log_record_type_filter filter = {0};
+	include_log_record_type_in_filter(&filter, LOG_RECORD_TYPE_COUNT - 1);
+	int expected_log_number = LOG_RECORD_TYPE_COUNT - 1;
+	log_sequence_number = get_first_log_sequence_number_of_type(&walE, &filter, &error);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		char expected_log_record[512];
+		make_log_record(expected_log_record, expected_log_number);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || strcmp(log_record, expected_log_record) != 0)
+		{
+			printf("typed log record mismatch walking forward at log_number = %d : error -> %d\n", expected_log_number, error);
+			exit(-1);
+		}
+		free(log_record);
+
+		expected_log_number += LOG_RECORD_TYPE_COUNT;
+		log_sequence_number = get_next_log_sequence_number_of_type(&walE, log_sequence_number, &filter, &error);
+	}
+	printf("typed log records seen walking forward until log_number = %d : error -> %d\n", expected_log_number, error);
+	if(error || expected_log_number < LOGS_TO_WRITE || expected_log_number >= LOGS_TO_WRITE + LOG_RECORD_TYPE_COUNT)
+		exit(-1);
+
+	// and in backward direction, across the WALe and the archive
+	expected_log_number -= LOG_RECORD_TYPE_COUNT;
+	log_sequence_number = get_last_flushed_log_sequence_number(&walE);
+	uint8_t last_log_record_type;
+	if(!get_log_record_type_at(&walE, log_sequence_number, &last_log_record_type, &error))
+		exit(-1);
+	if(!is_log_record_type_in_filter(&filter, last_log_record_type))
+		log_sequence_number = get_prev_log_sequence_number_of_type(&walE, log_sequence_number, &filter, &error);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		char expected_log_record[512];
+		make_log_record(expected_log_record, expected_log_number);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || strcmp(log_record, expected_log_record) != 0)
+		{
+			printf("typed log record mismatch walking backward at log_number = %d : error -> %d\n", expected_log_number, error);
+			exit(-1);
+		}
+		free(log_record);
+
+		expected_log_number -= LOG_RECORD_TYPE_COUNT;
+		log_sequence_number = get_prev_log_sequence_number_of_type(&walE, log_sequence_number, &filter, &error);
+	}
+	printf("typed log records seen walking backward until log_number = %d : error -> %d\n", expected_log_number, error);
+	if(error || expected_log_number != -1)
+		exit(-1);
+
+	// truncate the log record after the archive from the WALe, without archiving it, the gap must not be skipped silently
+	if(!modify_append_only_buffer_block_count(&walE, APPEND_ONLY_BUFFER_COUNT, &error) || !truncate_log_records_before(&walE, get_next_log_sequence_number_of(&walE, middle_log_sequence_number, &error), &error))
+	{
+		printf("failed to truncate the log record after the archive : error -> %d\n", error);
+		exit(-1);
+	}
+	if(compare_uint256(get_next_log_sequence_number_of(&walE, archivE.last_log_sequence_number, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != LOG_SEQUENCE_NUMBER_GAP)
+	{
+		printf("walked forward over the gap after the archive : error -> %d\n", error);
+		exit(-1);
+	}
+	if(compare_uint256(get_prev_log_sequence_number_of(&walE, walE.on_disk_master_record.first_log_sequence_number, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != LOG_SEQUENCE_NUMBER_GAP)
+	{
+		printf("walked backward over the gap before the WALe : error -> %d\n", error);
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_wale_archive(&archivE);
+	close_file_block_io(&archive_fbio);
+	close_file_block_io(&fbio);
+
+	printf("no error found - archive test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
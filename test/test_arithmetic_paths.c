@@ -0,0 +1,138 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define MAX_BLOCK_COUNT		(1 << 14)
+
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+#define LOG_RECORD_COUNT 2000
+
+#define LOG_FORMAT "log_number=<%d> "
+
+// the narrow (uint64_t) and the wide (uint256) log_sequence_number arithmetic, with power of two and other block sizes
+// every combination must append, traverse (in both directions) and reopen to the same log records
+#define LOG_SEQUENCE_NUMBER_WIDTHS {4, 8, 16}
+#define BLOCK_SIZES {512, 520}
+
+static uint32_t get_log_record_size(int log_number)
+{
+	return 24 + ((log_number * 53) % 700);
+}
+
+static void run_or_exit(uint32_t log_sequence_number_width, uint64_t block_size)
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, block_size, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		exit(-1);
+	}
+
+	wale walE;
+	int error = 0;
+	if(!initialize_wale(&walE, log_sequence_number_width, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		exit(-1);
+	}
+
+	char log_record[1024];
+	for(int log_number = 0; log_number < LOG_RECORD_COUNT; log_number++)
+	{
+		memset(log_record, 'a', sizeof(log_record));
+		sprintf(log_record, LOG_FORMAT, log_number);
+		if(compare_uint256(append_log_record(&walE, log_record, get_log_record_size(log_number), 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+	flush_all_log_records(&walE, &error);
+	deinitialize_wale(&walE);
+
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		exit(-1);
+	}
+
+	int log_number = 0;
+	uint256 last_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error), log_number++)
+	{
+		uint32_t log_record_size;
+		char* read_log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		sprintf(log_record, LOG_FORMAT, log_number);
+		if(read_log_record == NULL || log_record_size != get_log_record_size(log_number) || strncmp(read_log_record, log_record, strlen(log_record)) != 0)
+		{
+			printf("log record %d read incorrectly, width = %u, block_size = %" PRIu64 " : error -> %d\n", log_number, log_sequence_number_width, block_size, error);
+			exit(-1);
+		}
+		release_log_record(&walE, read_log_record, log_record_size);
+		last_log_sequence_number = log_sequence_number;
+	}
+	if(error || log_number != LOG_RECORD_COUNT)
+	{
+		printf("read %d log records forward, width = %u, block_size = %" PRIu64 " : error -> %d\n", log_number, log_sequence_number_width, block_size, error);
+		exit(-1);
+	}
+
+	for(uint256 log_sequence_number = last_log_sequence_number; compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_prev_log_sequence_number_of(&walE, log_sequence_number, &error))
+		log_number--;
+	if(error || log_number != 0)
+	{
+		printf("read %d log records backward, width = %u, block_size = %" PRIu64 " : error -> %d\n", LOG_RECORD_COUNT - log_number, log_sequence_number_width, block_size, error);
+		exit(-1);
+	}
+
+	// the appends continue after the reopen
+	uint256 log_sequence_number = append_log_record(&walE, "after reopen", 13, 0, APPEND_DURABLE, &error);
+	if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0 || compare_uint256(log_sequence_number, get_last_flushed_log_sequence_number(&walE)) != 0)
+	{
+		printf("failed to append after the reopen : error -> %d\n", error);
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+}
+
+int main()
+{
+	uint32_t log_sequence_number_widths[] = LOG_SEQUENCE_NUMBER_WIDTHS;
+	uint64_t block_sizes[] = BLOCK_SIZES;
+	for(int w = 0; w < sizeof(log_sequence_number_widths) / sizeof(log_sequence_number_widths[0]); w++)
+		for(int b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++)
+			run_or_exit(log_sequence_number_widths[w], block_sizes[b]);
+
+	// a narrow log_sequence_number must not overflow its width
+	memory_block_io mbio;
+	open_memory_block_io(&mbio, 512, MAX_BLOCK_COUNT);
+	wale walE;
+	int error = 0;
+	if(!initialize_wale(&walE, 2, get_uint256(UINT16_MAX - 100), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+	char log_record[200] = {};
+	if(compare_uint256(append_log_record(&walE, log_record, 50, 0, APPEND_BUFFERED, &error), get_uint256(UINT16_MAX - 100)) != 0
+	|| compare_uint256(append_log_record(&walE, log_record, 50, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != LOG_SEQUENCE_NUMBER_OVERFLOW)
+	{
+		printf("2 byte wide log_sequence_number did not overflow : error -> %d\n", error);
+		return -1;
+	}
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+
+	printf("no error found - log sequence number arithmetic test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
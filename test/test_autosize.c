@@ -0,0 +1,196 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+#include<latency_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 2
+
+#define AUTOSIZE_POLICY ((wale_autosize_policy){.min_buffer_block_count = 2, .max_buffer_block_count = 64, .grow_at_scroll_waits = 1, .shrink_below_percent = 10, .release_after_idle_ticks = 3})
+
+// the autosizing is ticked every TICK_PERIOD_US, while the appenders run
+#define TICK_PERIOD_US 2000
+
+#define THREAD_COUNT 4
+#define LOGS_PER_THREAD 2000
+
+#define LOG_FORMAT "thread=<%d> log_number=<%d> some padding to make the log records span across the blocks"
+
+// every scroll is a slow write, so that the appenders keep waiting for it
+#define WRITE_LATENCY ((latency_distribution){.base_ns = 50000, .jitter_ns = 10000})
+
+wale walE;
+
+static void append_or_exit(int thread_id, int log_number)
+{
+	char log_buffer[128];
+	sprintf(log_buffer, LOG_FORMAT, thread_id, log_number);
+
+	int error = 0;
+	uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+	if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+static void* append_log_records(void* thread_id_p)
+{
+	int thread_id = *((int*)thread_id_p);
+	for(int log_number = 0; log_number < LOGS_PER_THREAD; log_number++)
+		append_or_exit(thread_id, log_number);
+	return NULL;
+}
+
+static uint64_t tick_or_exit()
+{
+	int error = 0;
+	tick_append_only_buffer_autosize(&walE, &error);
+	if(error)
+	{
+		printf("failed to tick the autosizing : error -> %d\n", error);
+		exit(-1);
+	}
+	return walE.buffer_block_count;
+}
+
+static void flush_or_exit()
+{
+	int error = 0;
+	uint256 last_flushed_log_sequence_number = flush_all_log_records(&walE, &error);
+	if(error || compare_uint256(last_flushed_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	latency_block_io lbio;
+	open_latency_block_io(&lbio, get_block_io_ops_for_memory_block_io(&mbio), &((latency_block_io_config){
+		.write_latency = WRITE_LATENCY,
+		.seed = 1,
+	}));
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_latency_block_io(&lbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	if(set_append_only_buffer_autosize_policy(&walE, &((wale_autosize_policy){.min_buffer_block_count = 0, .max_buffer_block_count = 1}), &error) || error != PARAM_INVALID)
+	{
+		printf("an invalid autosize policy was accepted\n");
+		return -1;
+	}
+
+	if(!set_append_only_buffer_autosize_policy(&walE, &AUTOSIZE_POLICY, &error))
+	{
+		printf("failed to set the autosize policy : error -> %d\n", error);
+		return -1;
+	}
+
+	// hot phase : the appenders keep waiting for the scrolls of the tiny append only buffer, so it must grow
+	pthread_t threads[THREAD_COUNT];
+	int thread_ids[THREAD_COUNT];
+	for(int i = 0; i < THREAD_COUNT; i++)
+	{
+		thread_ids[i] = i;
+		pthread_create(&(threads[i]), NULL, append_log_records, &(thread_ids[i]));
+	}
+
+	uint64_t max_buffer_block_count_seen = APPEND_ONLY_BUFFER_COUNT;
+	for(int i = 0; i < (THREAD_COUNT * LOGS_PER_THREAD) / 200; i++)
+	{
+		usleep(TICK_PERIOD_US);
+		uint64_t buffer_block_count = tick_or_exit();
+		if(buffer_block_count > max_buffer_block_count_seen)
+			max_buffer_block_count_seen = buffer_block_count;
+	}
+
+	for(int i = 0; i < THREAD_COUNT; i++)
+		pthread_join(threads[i], NULL);
+
+	printf("append only buffer grew from %d to %" PRIu64 " blocks\n", APPEND_ONLY_BUFFER_COUNT, max_buffer_block_count_seen);
+	if(max_buffer_block_count_seen <= APPEND_ONLY_BUFFER_COUNT || max_buffer_block_count_seen > AUTOSIZE_POLICY.max_buffer_block_count)
+	{
+		printf("append only buffer did not grow within the bounds\n");
+		return -1;
+	}
+
+	// idle phase : with no appends, it must shrink to the min_buffer_block_count, but it is not released until everything is flushed
+	for(int i = 0; i < 16; i++)
+		tick_or_exit();
+	if(walE.buffer_block_count != AUTOSIZE_POLICY.min_buffer_block_count)
+	{
+		printf("append only buffer of %" PRIu64 " blocks, did not shrink to %" PRIu64 " blocks\n", walE.buffer_block_count, AUTOSIZE_POLICY.min_buffer_block_count);
+		return -1;
+	}
+
+	flush_or_exit();
+	for(uint32_t i = 0; i < AUTOSIZE_POLICY.release_after_idle_ticks; i++)
+		tick_or_exit();
+	if(walE.buffer_block_count != 0)
+	{
+		printf("append only buffer of an idle WALe was not released\n");
+		return -1;
+	}
+	printf("append only buffer released on idle\n");
+
+	// a released append only buffer has nothing to flush, and the next append allocates it again
+	flush_or_exit();
+	append_or_exit(THREAD_COUNT, 0);
+	if(walE.buffer_block_count != AUTOSIZE_POLICY.min_buffer_block_count)
+	{
+		printf("append only buffer was not allocated again on the append\n");
+		return -1;
+	}
+	flush_or_exit();
+
+	// every log record must be read back, across the resizes and the release
+	int log_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error))
+	{
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || strncmp(log_record, "thread=<", 8) != 0)
+		{
+			printf("log record %d read incorrectly : error = %d\n", log_count, error);
+			return -1;
+		}
+		free(log_record);
+		log_count++;
+	}
+	printf("read %d log records\n", log_count);
+	if(log_count != THREAD_COUNT * LOGS_PER_THREAD + 1)
+	{
+		printf("expected %d log records\n", THREAD_COUNT * LOGS_PER_THREAD + 1);
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_latency_block_io(&lbio);
+	close_memory_block_io(&mbio);
+
+	return 0;
+}
\ No newline at end of file
@@ -6,6 +6,48 @@ gcc ./test_prwrite.c ./test_util.c -o prwrite.out -I./ -lboompar -lblockio -lwal
 
 gcc ./test_prwrite_validate.c ./test_util.c -o prwrite_validate.out -I./ -lblockio -lwale -lserint -lrwlock -lpthread -lcutlery -lz
 
+gcc ./test_segmented.c ./test_util.c -o segmented.out -lblockio -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_truncate_before.c -o truncate_before.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_ring.c -o ring.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_compression.c -o compression.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_archive.c -o archive.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_stats.c -o stats.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_trace.c -o trace.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_latency_block_io.c -o latency_block_io.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_autosize.c -o autosize.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_durability.c -o durability.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_allocator.c -o allocator.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_vectored_io.c -o vectored_io.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_durable_write.c -o durable_write.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_record_format.c -o record_format.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_log_record_types.c -o log_record_types.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_log_shipping.c -o log_shipping.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_partitioned.c -o partitioned.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_arithmetic_paths.c -o arithmetic_paths.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_large_log_record.c -o large_log_record.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_time_index.c -o time_index.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
+gcc ./test_replay.c -o replay.out -lwale -lserint -lrwlock -lpthread -lcutlery -lz
+
 # use below command to change a byte anywhere in the file and see, how crc32 identifies this error
 # printf '\x31' | dd of=test_blob bs=1 seek=100 count=1 conv=notrunc
 
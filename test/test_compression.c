@@ -0,0 +1,175 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+#include<deflate_log_record_codec.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/stat.h>
+
+#define FILENAME				"test_compression.log"
+#define UNCOMPRESSED_FILENAME	"test_compression_uncompressed.log"
+#define BLOCK_SIZE				4096
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOGS_TO_WRITE 10000
+
+// log records of lesser than this size are never compressed
+#define MIN_LOG_RECORD_SIZE_TO_COMPRESS 64
+
+// every third log record is small, and is not compressed
+#define LOG_FORMAT_SMALL "log_number=<%d>"
+#define LOG_FORMAT "log_number=<%d> row={\"id\":%d,\"name\":\"name_%d\",\"city\":\"city\",\"country\":\"country\",\"padding\":\"%.*s\"}"
+#define PADDING "0123456789-10111213141516171819-20212223242526272829-30313233343536373839-40414243444546474849-50515253545556575859"
+
+static void make_log_record(char* log_buffer, int log_number)
+{
+	if(log_number % 3 == 0)
+		sprintf(log_buffer, LOG_FORMAT_SMALL, log_number);
+	else
+		sprintf(log_buffer, LOG_FORMAT, log_number, log_number, log_number, (int)(strlen(PADDING)), PADDING);
+}
+
+static long long get_file_size(const char* filename)
+{
+	struct stat st;
+	stat(filename, &st);
+	return (long long)st.st_size;
+}
+
+// appends LOGS_TO_WRITE log records to a new WALe at filename, compressing them if the codec is not NULL
+static void write_log_records(const char* filename, const log_record_codec* codec)
+{
+	file_block_io fbio;
+	unlink(filename);
+	if(!open_file_block_io(&fbio, filename, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		exit(-1);
+	}
+
+	wale walE;
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		exit(-1);
+	}
+
+	set_log_record_codec(&walE, codec, MIN_LOG_RECORD_SIZE_TO_COMPRESS);
+
+	for(int log_number = 0; log_number < LOGS_TO_WRITE; log_number++)
+	{
+		char log_buffer[512];
+		make_log_record(log_buffer, log_number);
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+
+	flush_all_log_records(&walE, &error);
+	if(error)
+	{
+		printf("failed to flush : error -> %d\n", error);
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+}
+
+// reopens the WALe at filename, and reads back all the log records, using the codec (if not NULL)
+// returns the number of log records that could not be decompressed, all other log records must match
+static int read_log_records(const char* filename, const log_record_codec* codec)
+{
+	file_block_io fbio;
+	if(!open_file_block_io(&fbio, filename, 0, BLOCK_SIZE, 0))
+	{
+		printf("failed to open file : errno = %d\n", errno);
+		exit(-1);
+	}
+
+	wale walE;
+	int error = 0;
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_file_block_io(&fbio), 0, &error))
+	{
+		printf("failed to open wale instance wale_erro = %d\n", error);
+		exit(-1);
+	}
+
+	set_log_record_codec(&walE, codec, 0);
+
+	int log_number = 0;
+	int decompression_failures = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		char expected_log_record[512];
+		make_log_record(expected_log_record, log_number);
+
+		// validation never needs the codec, and it reports the uncompressed size
+		uint32_t log_record_size = 0;
+		if(!validate_log_record_at(&walE, log_sequence_number, &log_record_size, &error) || log_record_size != strlen(expected_log_record) + 1)
+		{
+			printf("validation failed at log_number = %d : error -> %d\n", log_number, error);
+			exit(-1);
+		}
+
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL && error == LOG_RECORD_DECOMPRESSION_FAILED)
+			decompression_failures++;
+		else if(log_record == NULL || log_record_size != strlen(expected_log_record) + 1 || strcmp(log_record, expected_log_record) != 0)
+		{
+			printf("log record mismatch at log_number = %d : error -> %d\n", log_number, error);
+			exit(-1);
+		}
+		free(log_record);
+
+		log_number++;
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	}
+
+	if(log_number != LOGS_TO_WRITE)
+	{
+		printf("expected %d log records, found %d : error -> %d\n", LOGS_TO_WRITE, log_number, error);
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	return decompression_failures;
+}
+
+int main()
+{
+	log_record_codec deflate_codec = get_deflate_log_record_codec();
+
+	write_log_records(FILENAME, &deflate_codec);
+	write_log_records(UNCOMPRESSED_FILENAME, NULL);
+
+	printf("file size : compressed = %lld, uncompressed = %lld\n", get_file_size(FILENAME), get_file_size(UNCOMPRESSED_FILENAME));
+
+	int decompression_failures = read_log_records(FILENAME, &deflate_codec);
+	printf("read back with the codec : decompression failures = %d\n", decompression_failures);
+	if(decompression_failures != 0)
+		exit(-1);
+
+	// without the codec, the compressed log records can not be read, but the small ones can
+	decompression_failures = read_log_records(FILENAME, NULL);
+	printf("read back without the codec : decompression failures = %d\n", decompression_failures);
+	if(decompression_failures != LOGS_TO_WRITE - ((LOGS_TO_WRITE + 2) / 3))
+		exit(-1);
+
+	printf("no error found - compression test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
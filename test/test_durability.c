@@ -0,0 +1,136 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+#include<latency_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define THREAD_COUNT 8
+#define LOGS_PER_THREAD 400
+
+// every DURABLE_EVERY-th log record of a thread is a commit record, appended with APPEND_DURABLE, the others alternate between APPEND_BUFFERED and APPEND_WRITTEN
+#define DURABLE_EVERY 4
+
+#define LOG_FORMAT "thread=<%d> log_number=<%d> durability=<%d>"
+
+// simulate a device with a 2 ms fsync, so that the commit records of the threads pile up on the flush in progress
+#define FLUSH_LATENCY ((latency_distribution){.base_ns = 2000000, .jitter_ns = 200000})
+#define WRITE_LATENCY ((latency_distribution){.base_ns = 20000, .jitter_ns = 5000})
+
+wale walE;
+
+static void* append_log_records(void* thread_id_p)
+{
+	int thread_id = *((int*)thread_id_p);
+	for(int log_number = 0; log_number < LOGS_PER_THREAD; log_number++)
+	{
+		append_durability durability = ((log_number + 1) % DURABLE_EVERY == 0) ? APPEND_DURABLE : ((log_number % 2) ? APPEND_WRITTEN : APPEND_BUFFERED);
+
+		char log_buffer[128];
+		sprintf(log_buffer, LOG_FORMAT, thread_id, log_number, durability);
+
+		int error = 0;
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, durability, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+
+		// a durable log record must be covered by the on-disk master record, as soon as the append returns
+		if(durability == APPEND_DURABLE && compare_uint256(log_sequence_number, get_last_flushed_log_sequence_number(&walE)) > 0)
+		{
+			printf("log record appended with APPEND_DURABLE was not flushed\n");
+			exit(-1);
+		}
+	}
+	return NULL;
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	latency_block_io lbio;
+	open_latency_block_io(&lbio, get_block_io_ops_for_memory_block_io(&mbio), &((latency_block_io_config){
+		.write_latency = WRITE_LATENCY,
+		.flush_latency = FLUSH_LATENCY,
+		.seed = 1,
+	}));
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_latency_block_io(&lbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	// a log record appended with APPEND_WRITTEN is handed to write_blocks before the append returns
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+	uint64_t write_ios = stats.counters[WALE_STATS_WRITE_IOS];
+	if(compare_uint256(append_log_record(&walE, "written", 8, 0, APPEND_WRITTEN, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		return -1;
+	}
+	get_wale_stats(&walE, &stats);
+	if(stats.counters[WALE_STATS_WRITE_IOS] == write_ios || compare_uint256(get_last_flushed_log_sequence_number(&walE), INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		printf("log record appended with APPEND_WRITTEN was not just written\n");
+		return -1;
+	}
+
+	pthread_t threads[THREAD_COUNT];
+	int thread_ids[THREAD_COUNT];
+	for(int i = 0; i < THREAD_COUNT; i++)
+	{
+		thread_ids[i] = i;
+		pthread_create(&(threads[i]), NULL, append_log_records, &(thread_ids[i]));
+	}
+	for(int i = 0; i < THREAD_COUNT; i++)
+		pthread_join(threads[i], NULL);
+
+	// the commit records must have joined the flushes in progress, instead of each issuing its own
+	get_wale_stats(&walE, &stats);
+	uint64_t durable_appends = THREAD_COUNT * (LOGS_PER_THREAD / DURABLE_EVERY);
+	printf("%" PRIu64 " durable appends, made durable by %" PRIu64 " flushes\n", durable_appends, stats.counters[WALE_STATS_FLUSHES]);
+	if(stats.counters[WALE_STATS_FLUSHES] >= durable_appends)
+	{
+		printf("durable appends did not join the flushes in progress\n");
+		return -1;
+	}
+
+	flush_all_log_records(&walE, &error);
+
+	int log_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error))
+		log_count++;
+	if(log_count != THREAD_COUNT * LOGS_PER_THREAD + 1)
+	{
+		printf("read %d log records, expected %d\n", log_count, THREAD_COUNT * LOGS_PER_THREAD + 1);
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_latency_block_io(&lbio);
+	close_memory_block_io(&mbio);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+
+#define FILENAME			"test_durable_write.log"
+#define BLOCK_SIZE			512
+
+#define APPEND_ONLY_BUFFER_COUNT 4
+
+#define LOG_COUNT 2000
+#define FLUSH_EVERY 50
+
+#define LOG_FORMAT "log_number=<%d> some padding to make the log records span across the blocks"
+
+// wraps the durable write block_io_ops of the file_block_io, counting the ios issued to it
+typedef struct counting_block_io counting_block_io;
+struct counting_block_io
+{
+	block_io_ops file_block_io_functions;
+
+	uint64_t writes;
+	uint64_t durable_writes;
+	uint64_t flushes;
+};
+
+static int read_blocks_counting(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	const counting_block_io* cbio_p = block_io_ops_handle;
+	return cbio_p->file_block_io_functions.read_blocks(cbio_p->file_block_io_functions.block_io_ops_handle, dest, block_id, block_count);
+}
+
+static int write_blocks_counting(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	counting_block_io* cbio_p = (counting_block_io*) block_io_ops_handle;
+	cbio_p->writes++;
+	return cbio_p->file_block_io_functions.write_blocks(cbio_p->file_block_io_functions.block_io_ops_handle, src, block_id, block_count);
+}
+
+static int write_blocks_durable_counting(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	counting_block_io* cbio_p = (counting_block_io*) block_io_ops_handle;
+	cbio_p->durable_writes++;
+	return cbio_p->file_block_io_functions.write_blocks_durable(cbio_p->file_block_io_functions.block_io_ops_handle, src, block_id, block_count);
+}
+
+static int flush_all_writes_counting(const void* block_io_ops_handle)
+{
+	counting_block_io* cbio_p = (counting_block_io*) block_io_ops_handle;
+	cbio_p->flushes++;
+	return cbio_p->file_block_io_functions.flush_all_writes(cbio_p->file_block_io_functions.block_io_ops_handle);
+}
+
+wale walE;
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	counting_block_io cbio = {.file_block_io_functions = get_durable_write_block_io_ops_for_file_block_io(&fbio)};
+	block_io_ops counting_block_io_functions = {
+		.block_io_ops_handle = &cbio,
+		.block_size = cbio.file_block_io_functions.block_size,
+		.block_buffer_alignment = cbio.file_block_io_functions.block_buffer_alignment,
+		.read_blocks = read_blocks_counting,
+		.write_blocks = write_blocks_counting,
+		.flush_all_writes = flush_all_writes_counting,
+		.write_blocks_durable = write_blocks_durable_counting,
+	};
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, counting_block_io_functions, APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	for(int log_number = 0; log_number < LOG_COUNT; log_number++)
+	{
+		char log_buffer[128];
+		sprintf(log_buffer, LOG_FORMAT, log_number);
+		if(compare_uint256(append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			return -1;
+		}
+
+		if((log_number + 1) % FLUSH_EVERY == 0 && compare_uint256(flush_all_log_records(&walE, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to flush wale : error -> %d\n", error);
+			return -1;
+		}
+	}
+
+	printf("%" PRIu64 " durable writes, %" PRIu64 " writes and %" PRIu64 " flushes of the whole file\n", cbio.durable_writes, cbio.writes, cbio.flushes);
+
+	// every log record and the master record must have been made durable with the durable writes only
+	if(cbio.writes != 0 || cbio.flushes != 0 || cbio.durable_writes < 2 * (LOG_COUNT / FLUSH_EVERY))
+	{
+		printf("the WALe did not use the durable writes\n");
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+
+	// reopen the WALe without the durable writes, and read back all the log records
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_file_block_io(&fbio), 0, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	int log_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error))
+	{
+		char expected[128];
+		sprintf(expected, LOG_FORMAT, log_count);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || strcmp(log_record, expected) != 0)
+		{
+			printf("log record %d read incorrectly : error = %d\n", log_count, error);
+			return -1;
+		}
+		free(log_record);
+		log_count++;
+	}
+
+	printf("read %d log records after reopening\n", log_count);
+	if(log_count != LOG_COUNT)
+	{
+		printf("expected %d log records\n", LOG_COUNT);
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	printf("no error found - durable write test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+// the append only buffer is much smaller than the large log records
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+// large log records of consecutive sizes, so that they end at every offset within a block
+#define SWEEP_LOG_RECORD_SIZE 1000
+#define SWEEP_LOG_RECORD_COUNT 600
+
+#define BLOB_LOG_RECORD_SIZE (3 * 1024 * 1024)
+#define BLOB_LOG_RECORD_COUNT 4
+
+#define SMALL_LOG_RECORD_SIZE 64
+
+#define MAX_LOG_RECORD_COUNT 2048
+
+wale walE;
+
+// every log record appended, the byte i of the log record number n is get_log_record_byte(n, i)
+typedef struct expected_log_record expected_log_record;
+struct expected_log_record
+{
+	uint64_t log_sequence_number;
+	uint32_t log_record_size;
+	uint8_t log_record_type;
+
+	// bytes of the log record written, an incomplete log record (with fewer bytes written) must fail to be read
+	uint32_t written_size;
+};
+
+expected_log_record expected[MAX_LOG_RECORD_COUNT];
+int expected_count = 0;
+
+static char get_log_record_byte(int number, uint32_t i)
+{
+	return (number * 31 + i * 7 + (i >> 9)) & 0xff;
+}
+
+static void expect(uint256 log_sequence_number, uint32_t log_record_size, uint8_t log_record_type, uint32_t written_size)
+{
+	cast_to_uint64_from_uint256(&(expected[expected_count].log_sequence_number), log_sequence_number);
+	expected[expected_count].log_record_size = log_record_size;
+	expected[expected_count].log_record_type = log_record_type;
+	expected[expected_count].written_size = written_size;
+	expected_count++;
+}
+
+static void append_small_or_exit()
+{
+	char log_record[SMALL_LOG_RECORD_SIZE];
+	for(uint32_t i = 0; i < SMALL_LOG_RECORD_SIZE; i++)
+		log_record[i] = get_log_record_byte(expected_count, i);
+
+	int error = 0;
+	uint256 log_sequence_number = append_typed_log_record(&walE, log_record, SMALL_LOG_RECORD_SIZE, 1, 0, APPEND_BUFFERED, &error);
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		printf("failed to append a small log record : error -> %d\n", error);
+		exit(-1);
+	}
+	expect(log_sequence_number, SMALL_LOG_RECORD_SIZE, 1, SMALL_LOG_RECORD_SIZE);
+}
+
+static void* append_small_log_records(void* count_p)
+{
+	for(int i = 0; i < *((int*)count_p); i++)
+		append_small_or_exit();
+	return NULL;
+}
+
+// writes the first written_size bytes of the log record in chunks of varying sizes
+static void write_chunks_or_exit(large_log_record_writer* writer, int number, uint32_t from, uint32_t written_size)
+{
+	static char chunk[70000];
+	for(uint32_t offset = from; offset < written_size;)
+	{
+		uint32_t chunk_size = 1 + ((offset * 2654435761u) % sizeof(chunk));
+		if(chunk_size > written_size - offset)
+			chunk_size = written_size - offset;
+		for(uint32_t i = 0; i < chunk_size; i++)
+			chunk[i] = get_log_record_byte(number, offset + i);
+
+		int error = 0;
+		if(!write_large_log_record_chunk(writer, chunk, chunk_size, &error))
+		{
+			printf("failed to write a chunk of a large log record : error -> %d\n", error);
+			exit(-1);
+		}
+		offset += chunk_size;
+	}
+}
+
+static uint256 append_large_or_exit(uint32_t log_record_size, int is_check_point, append_durability durability)
+{
+	int number = expected_count;
+
+	int error = 0;
+	large_log_record_writer writer;
+	uint256 log_sequence_number = begin_large_log_record(&walE, &writer, log_record_size, 2, is_check_point, &error);
+	if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		printf("failed to begin a large log record : error -> %d\n", error);
+		exit(-1);
+	}
+
+	write_chunks_or_exit(&writer, number, 0, log_record_size);
+
+	if(compare_uint256(end_large_log_record(&writer, durability, &error), log_sequence_number) != 0)
+	{
+		printf("failed to end a large log record : error -> %d\n", error);
+		exit(-1);
+	}
+	expect(log_sequence_number, log_record_size, 2, log_record_size);
+	return log_sequence_number;
+}
+
+static void check_all_log_records_or_exit(const char* when)
+{
+	int error = 0;
+	int log_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); !are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER); log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error), log_count++)
+	{
+		if(log_count == expected_count)
+			break;
+		const expected_log_record* e = &(expected[log_count]);
+
+		uint64_t lsn;
+		cast_to_uint64_from_uint256(&lsn, log_sequence_number);
+		uint8_t log_record_type;
+		uint32_t log_record_size;
+		if(lsn != e->log_sequence_number || !get_log_record_type_at(&walE, log_sequence_number, &log_record_type, &error) || log_record_type != e->log_record_type)
+		{
+			printf("%s : log record %d is not as appended : error -> %d\n", when, log_count, error);
+			exit(-1);
+		}
+
+		// the header of an incomplete log record is valid, but its contents must never be read
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(e->written_size < e->log_record_size)
+		{
+			if(log_record != NULL || error != LOG_RECORD_CORRUPTED)
+			{
+				printf("%s : incomplete log record %d was read : error -> %d\n", when, log_count, error);
+				exit(-1);
+			}
+			error = NO_ERROR;
+			continue;
+		}
+
+		if(log_record == NULL || log_record_size != e->log_record_size)
+		{
+			printf("%s : log record %d is not as appended : error -> %d\n", when, log_count, error);
+			exit(-1);
+		}
+		for(uint32_t i = 0; i < log_record_size; i++)
+			if(log_record[i] != get_log_record_byte(log_count, i))
+			{
+				printf("%s : byte %u of log record %d differs\n", when, i, log_count);
+				exit(-1);
+			}
+		release_log_record(&walE, log_record, log_record_size);
+	}
+	if(error || log_count != expected_count)
+	{
+		printf("%s : read %d log records, expected %d : error -> %d\n", when, log_count, expected_count, error);
+		exit(-1);
+	}
+	printf("%s : all %d log records are as appended\n", when, log_count);
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	// large log records ending at every offset within a block, each between small log records
+	for(int i = 0; i < SWEEP_LOG_RECORD_COUNT; i++)
+	{
+		append_small_or_exit();
+		append_large_or_exit(SWEEP_LOG_RECORD_SIZE + i, 0, APPEND_BUFFERED);
+	}
+
+	// a large log record that fits in a single block, it becomes the checkpoint once it ends
+	uint256 check_point_log_sequence_number = append_large_or_exit(10, 1, APPEND_DURABLE);
+	if(compare_uint256(get_check_point_log_sequence_number(&walE), check_point_log_sequence_number) != 0)
+	{
+		printf("large log record did not become the checkpoint\n");
+		return -1;
+	}
+
+	// the blob images, the appenders after them take their slots while the blob is being written
+	for(int b = 0; b < BLOB_LOG_RECORD_COUNT; b++)
+	{
+		int number = expected_count;
+		large_log_record_writer writer;
+		uint256 log_sequence_number = begin_large_log_record(&walE, &writer, BLOB_LOG_RECORD_SIZE, 2, 0, &error);
+		if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			printf("failed to begin a blob log record : error -> %d\n", error);
+			return -1;
+		}
+		expect(log_sequence_number, BLOB_LOG_RECORD_SIZE, 2, BLOB_LOG_RECORD_SIZE);
+
+		write_chunks_or_exit(&writer, number, 0, BLOB_LOG_RECORD_SIZE / 2);
+
+		// the appenders are not blocked by the blob, the odd ones append more small log records than fit in the append only buffer, so that they scroll it past the last block of the blob
+		pthread_t appender;
+		int small_count = (b % 2) ? 4 * APPEND_ONLY_BUFFER_COUNT * BLOCK_SIZE / SMALL_LOG_RECORD_SIZE : 4;
+		pthread_create(&appender, NULL, append_small_log_records, &small_count);
+		pthread_join(appender, NULL);
+
+		// nor is the flush, it covers only the log records before the blob, and the unflushed log records can not be discarded while the blob is being written
+		uint256 last_flushed_log_sequence_number = flush_all_log_records(&walE, &error);
+		if(error || compare_uint256(last_flushed_log_sequence_number, log_sequence_number) >= 0)
+		{
+			printf("flush in the middle of a blob log record, did not stop before it : error -> %d\n", error);
+			return -1;
+		}
+		if(!are_equal_uint256(discard_unflushed_log_records(&walE, &error), INVALID_LOG_SEQUENCE_NUMBER) || error != LARGE_LOG_RECORD_IN_PROGRESS)
+		{
+			printf("unflushed log records were discarded in the middle of a blob log record : error -> %d\n", error);
+			return -1;
+		}
+
+		write_chunks_or_exit(&writer, number, BLOB_LOG_RECORD_SIZE / 2, BLOB_LOG_RECORD_SIZE);
+
+		if(compare_uint256(end_large_log_record(&writer, (b % 2) ? APPEND_DURABLE : APPEND_WRITTEN, &error), log_sequence_number) != 0)
+		{
+			printf("failed to end a blob log record : error -> %d\n", error);
+			return -1;
+		}
+		if((b % 2) && compare_uint256(get_last_flushed_log_sequence_number(&walE), log_sequence_number) < 0)
+		{
+			printf("blob log record ended with APPEND_DURABLE, but it was not flushed\n");
+			return -1;
+		}
+	}
+
+	// a chunk beyond the log_record_size is rejected, and an incomplete log record is filled, but it never becomes the checkpoint
+	{
+		int number = expected_count;
+		large_log_record_writer writer;
+		uint256 log_sequence_number = begin_large_log_record(&walE, &writer, 5000, 2, 1, &error);
+		write_chunks_or_exit(&writer, number, 0, 4000);
+		char chunk[2000] = {0};
+		if(write_large_log_record_chunk(&writer, chunk, sizeof(chunk), &error) || error != PARAM_INVALID)
+		{
+			printf("a chunk beyond the log_record_size was written\n");
+			return -1;
+		}
+		if(!are_equal_uint256(end_large_log_record(&writer, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) || error != PARAM_INVALID)
+		{
+			printf("an incomplete large log record was ended successfully\n");
+			return -1;
+		}
+		flush_all_log_records(&walE, &error);
+		if(error)
+		{
+			printf("failed to flush wale : error -> %d\n", error);
+			return -1;
+		}
+		if(compare_uint256(get_check_point_log_sequence_number(&walE), check_point_log_sequence_number) != 0)
+		{
+			printf("an incomplete large log record became the checkpoint\n");
+			return -1;
+		}
+		expect(log_sequence_number, 5000, 2, 4000);
+	}
+	append_small_or_exit();
+
+	// a LOG_RECORD_FORMAT_V2 WALe, a log_record_size beyond MAX_LOG_RECORD_SIZE is rejected
+	large_log_record_writer writer;
+	if(!are_equal_uint256(begin_large_log_record(&walE, &writer, MAX_LOG_RECORD_SIZE + 1, 2, 0, &error), INVALID_LOG_SEQUENCE_NUMBER) || error != PARAM_INVALID)
+	{
+		printf("a large log record beyond MAX_LOG_RECORD_SIZE was begun\n");
+		return -1;
+	}
+
+	flush_all_log_records(&walE, &error);
+	if(error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		return -1;
+	}
+	check_all_log_records_or_exit("after flush");
+
+	// and the same, after reopening the WALe
+	deinitialize_wale(&walE);
+	if(!initialize_wale(&walE, 8, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+	check_all_log_records_or_exit("after reopen");
+
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+
+	printf("no error found - large log record test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
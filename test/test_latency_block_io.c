@@ -0,0 +1,121 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+#include<latency_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+#define LOG_COUNT 2000
+#define FLUSH_EVERY 100
+
+#define LOG_FORMAT "log_number=<%d> some padding to make the log records span across the blocks"
+
+// simulate a device with a 2 ms +- 0.5 ms fsync, and a 10 ms tail for 1 in 100 fsyncs
+#define FLUSH_LATENCY ((latency_distribution){.base_ns = 2000000, .jitter_ns = 500000, .tail_ns = 10000000, .tail_per_million = 10000})
+#define WRITE_LATENCY ((latency_distribution){.base_ns = 20000, .jitter_ns = 5000})
+#define WRITE_BYTES_PER_SECOND (UINT64_C(64) * 1024 * 1024)
+
+wale walE;
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	latency_block_io lbio;
+	open_latency_block_io(&lbio, get_block_io_ops_for_memory_block_io(&mbio), &((latency_block_io_config){
+		.write_latency = WRITE_LATENCY,
+		.flush_latency = FLUSH_LATENCY,
+		.write_bytes_per_second = WRITE_BYTES_PER_SECOND,
+		.seed = 1,
+	}));
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_latency_block_io(&lbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	uint256 first_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(int log_number = 0; log_number < LOG_COUNT; log_number++)
+	{
+		char log_buffer[128];
+		sprintf(log_buffer, LOG_FORMAT, log_number);
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			return -1;
+		}
+		if(log_number == 0)
+			first_log_sequence_number = log_sequence_number;
+
+		if((log_number + 1) % FLUSH_EVERY == 0)
+			flush_all_log_records(&walE, &error);
+	}
+
+	// read all the log records back from the memory
+	int log_number = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&walE); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error))
+	{
+		char expected[128];
+		sprintf(expected, LOG_FORMAT, log_number);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || strcmp(log_record, expected) != 0)
+		{
+			printf("log record %d read incorrectly : error = %d\n", log_number, error);
+			return -1;
+		}
+		free(log_record);
+		log_number++;
+	}
+	if(log_number != LOG_COUNT || compare_uint256(first_log_sequence_number, get_first_log_sequence_number(&walE)) != 0)
+	{
+		printf("read %d log records, expected %d\n", log_number, LOG_COUNT);
+		return -1;
+	}
+
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+	const wale_stats_histogram* flush_latencies = &(stats.latencies[WALE_STATS_FLUSH_ALL_WRITES_LATENCY]);
+	printf("flush_all_writes : count = %" PRIu64 ", p50 = %" PRIu64 " ns, p99 = %" PRIu64 " ns, max = %" PRIu64 " ns\n", flush_latencies->count,
+		get_wale_stats_percentile(flush_latencies, 50.0), get_wale_stats_percentile(flush_latencies, 99.0), flush_latencies->max_ns);
+	printf("written bytes = %" PRIu64 ", in %" PRIu64 " write ios\n", stats.counters[WALE_STATS_WRITTEN_BYTES], stats.counters[WALE_STATS_WRITE_IOS]);
+
+	// every flush_all_writes must have been delayed by atleast the base_ns - jitter_ns
+	if(flush_latencies->count == 0 || (flush_latencies->sum_ns / flush_latencies->count) < (FLUSH_LATENCY.base_ns - FLUSH_LATENCY.jitter_ns))
+	{
+		printf("flush latency was not injected\n");
+		return -1;
+	}
+
+	// truncate the log records, it returns their memory using punch_hole_blocks
+	if(!truncate_log_records(&walE, &error))
+	{
+		printf("failed to truncate log records : error = %d\n", error);
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_latency_block_io(&lbio);
+	close_memory_block_io(&mbio);
+
+	return 0;
+}
\ No newline at end of file
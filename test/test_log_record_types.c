@@ -0,0 +1,186 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 64
+
+// the log record types of a recovery, the analysis pass wants only the checkpoints and the commits
+#define PAGE_LOG_RECORD		1
+#define COMMIT_LOG_RECORD	2
+#define CHECKPOINT_LOG_RECORD	3
+
+#define PAGE_LOG_RECORD_SIZE 8192
+#define PAGE_LOG_RECORD_COUNT 200
+
+// a commit after every COMMIT_EVERY page log records, and a checkpoint after every CHECKPOINT_EVERY page log records
+#define COMMIT_EVERY 20
+#define CHECKPOINT_EVERY 100
+
+#define LOG_FORMAT "type=<%d> number=<%d>"
+
+wale walE;
+
+static void append_or_exit(uint8_t log_record_type, int number, uint32_t log_record_size)
+{
+	static char log_record[PAGE_LOG_RECORD_SIZE];
+	memset(log_record, 'p', log_record_size);
+	sprintf(log_record, LOG_FORMAT, log_record_type, number);
+
+	int error = 0;
+	if(compare_uint256(append_typed_log_record(&walE, log_record, log_record_size, log_record_type, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+static uint64_t get_read_bytes()
+{
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+	return stats.counters[WALE_STATS_READ_BYTES];
+}
+
+// checks that the log record at log_sequence_number is of the log_record_type, by its type tag and by its contents
+static void check_log_record_or_exit(uint256 log_sequence_number, uint8_t expected_log_record_type)
+{
+	int error = 0;
+
+	uint8_t log_record_type;
+	if(!get_log_record_type_at(&walE, log_sequence_number, &log_record_type, &error) || log_record_type != expected_log_record_type)
+	{
+		printf("log record is not of the type %d : error -> %d\n", expected_log_record_type, error);
+		exit(-1);
+	}
+
+	uint32_t log_record_size;
+	char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+	char prefix[64];
+	sprintf(prefix, "type=<%d>", expected_log_record_type);
+	if(log_record == NULL || strncmp(log_record, prefix, strlen(prefix)) != 0)
+	{
+		printf("log record of the type %d read incorrectly : error -> %d\n", expected_log_record_type, error);
+		exit(-1);
+	}
+	release_log_record(&walE, log_record, log_record_size);
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	int commit_count = 0;
+	int checkpoint_count = 0;
+	for(int page_number = 1; page_number <= PAGE_LOG_RECORD_COUNT; page_number++)
+	{
+		append_or_exit(PAGE_LOG_RECORD, page_number, PAGE_LOG_RECORD_SIZE);
+		if(page_number % COMMIT_EVERY == 0)
+			append_or_exit(COMMIT_LOG_RECORD, commit_count++, 32);
+		if(page_number % CHECKPOINT_EVERY == 0)
+			append_or_exit(CHECKPOINT_LOG_RECORD, checkpoint_count++, 64);
+	}
+
+	flush_all_log_records(&walE, &error);
+	if(error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		return -1;
+	}
+
+	log_record_type_filter analysis_filter = {};
+	include_log_record_type_in_filter(&analysis_filter, COMMIT_LOG_RECORD);
+	include_log_record_type_in_filter(&analysis_filter, CHECKPOINT_LOG_RECORD);
+
+	// the analysis pass, forward, reads only the headers of the page log records
+	uint64_t read_bytes = get_read_bytes();
+	int matched_count = 0;
+	uint256 last_matched_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(uint256 log_sequence_number = get_first_log_sequence_number_of_type(&walE, &analysis_filter, &error); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of_type(&walE, log_sequence_number, &analysis_filter, &error))
+	{
+		uint8_t log_record_type;
+		get_log_record_type_at(&walE, log_sequence_number, &log_record_type, &error);
+		check_log_record_or_exit(log_sequence_number, log_record_type);
+		matched_count++;
+		last_matched_log_sequence_number = log_sequence_number;
+	}
+	read_bytes = get_read_bytes() - read_bytes;
+
+	uint64_t log_bytes;
+	cast_to_uint64_from_uint256(&log_bytes, get_next_log_sequence_number(&walE));
+	printf("analysis pass matched %d log records, reading %" PRIu64 " bytes of the %" PRIu64 " bytes of the log\n", matched_count, read_bytes, log_bytes);
+	if(error || matched_count != commit_count + checkpoint_count)
+	{
+		printf("expected %d log records : error -> %d\n", commit_count + checkpoint_count, error);
+		return -1;
+	}
+	if(read_bytes > log_bytes / 4)
+	{
+		printf("analysis pass read the payloads of the page log records\n");
+		return -1;
+	}
+
+	// the checkpoints, backward from the last log record of the analysis pass
+	log_record_type_filter checkpoint_filter = {};
+	include_log_record_type_in_filter(&checkpoint_filter, CHECKPOINT_LOG_RECORD);
+	int backward_count = 1;
+	check_log_record_or_exit(last_matched_log_sequence_number, CHECKPOINT_LOG_RECORD);
+	for(uint256 log_sequence_number = get_prev_log_sequence_number_of_type(&walE, last_matched_log_sequence_number, &checkpoint_filter, &error); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_prev_log_sequence_number_of_type(&walE, log_sequence_number, &checkpoint_filter, &error))
+	{
+		check_log_record_or_exit(log_sequence_number, CHECKPOINT_LOG_RECORD);
+		backward_count++;
+	}
+	if(error || backward_count != checkpoint_count)
+	{
+		printf("read %d checkpoints backward, expected %d : error -> %d\n", backward_count, checkpoint_count, error);
+		return -1;
+	}
+
+	// the redo pass, wants the page log records
+	log_record_type_filter redo_filter = {};
+	include_log_record_type_in_filter(&redo_filter, PAGE_LOG_RECORD);
+	int page_count = 0;
+	for(uint256 log_sequence_number = get_first_log_sequence_number_of_type(&walE, &redo_filter, &error); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of_type(&walE, log_sequence_number, &redo_filter, &error))
+		page_count++;
+	if(error || page_count != PAGE_LOG_RECORD_COUNT)
+	{
+		printf("redo pass found %d page log records, expected %d : error -> %d\n", page_count, PAGE_LOG_RECORD_COUNT, error);
+		return -1;
+	}
+
+	// an empty filter matches nothing
+	log_record_type_filter empty_filter = {};
+	if(compare_uint256(get_first_log_sequence_number_of_type(&walE, &empty_filter, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error)
+	{
+		printf("empty filter matched a log record : error -> %d\n", error);
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+
+	printf("no error found - log record type test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
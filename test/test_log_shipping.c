@@ -0,0 +1,279 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<sys/socket.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOG_RECORD_COUNT 5000
+
+// the primary ships its flushed log records to the replica, in raw log ranges of atmost SHIPPING_SIZE bytes
+#define SHIPPING_SIZE (64 * 1024)
+
+#define LOG_FORMAT "log_number=<%d> "
+
+wale primary;
+wale replica;
+
+// a frame on the socket is the from_log_sequence_number and the size of the raw log range, followed by the raw log range
+// a frame of size 0 ends the shipping
+typedef struct frame_header frame_header;
+struct frame_header
+{
+	uint64_t from_log_sequence_number;
+	uint64_t raw_log_range_size;
+};
+
+static void send_or_exit(int fd, const void* data, uint64_t size)
+{
+	for(uint64_t sent = 0; sent < size;)
+	{
+		ssize_t res = send(fd, data + sent, size - sent, 0);
+		if(res <= 0)
+		{
+			printf("failed to send : errno = %d\n", errno);
+			exit(-1);
+		}
+		sent += res;
+	}
+}
+
+static void recv_or_exit(int fd, void* data, uint64_t size)
+{
+	for(uint64_t received = 0; received < size;)
+	{
+		ssize_t res = recv(fd, data + received, size - received, 0);
+		if(res <= 0)
+		{
+			printf("failed to recv : errno = %d\n", errno);
+			exit(-1);
+		}
+		received += res;
+	}
+}
+
+static void* ship_log_records(void* fd_p)
+{
+	int fd = *((int*)fd_p);
+
+	void* raw_log_range = malloc(SHIPPING_SIZE);
+
+	int error = 0;
+	uint64_t from_log_sequence_number;
+	cast_to_uint64_from_uint256(&from_log_sequence_number, get_first_log_sequence_number(&primary));
+	while(1)
+	{
+		uint64_t raw_log_range_size = read_raw_log_range(&primary, get_uint256(from_log_sequence_number), SHIPPING_SIZE, raw_log_range, &error);
+		if(error)
+		{
+			printf("failed to read raw log range : error -> %d\n", error);
+			exit(-1);
+		}
+
+		frame_header fh = {.from_log_sequence_number = from_log_sequence_number, .raw_log_range_size = raw_log_range_size};
+		send_or_exit(fd, &fh, sizeof(fh));
+
+		if(raw_log_range_size == 0)
+			break;
+
+		send_or_exit(fd, raw_log_range, raw_log_range_size);
+		from_log_sequence_number += raw_log_range_size;
+	}
+
+	free(raw_log_range);
+	return NULL;
+}
+
+static void append_or_exit(wale* wale_p, int log_number)
+{
+	// log records of varying sizes, so that some of them span across the raw log ranges
+	char log_record[4096];
+	int log_record_size = 32 + ((log_number * 37) % 4000);
+	memset(log_record, 'r', log_record_size);
+	sprintf(log_record, LOG_FORMAT, log_number);
+
+	int error = 0;
+	if(compare_uint256(append_typed_log_record(wale_p, log_record, log_record_size, log_number % 3, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+static void flush_or_exit(wale* wale_p)
+{
+	int error = 0;
+	flush_all_log_records(wale_p, &error);
+	if(error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+int main()
+{
+	memory_block_io primary_mbio;
+	memory_block_io replica_mbio;
+	if(!open_memory_block_io(&primary_mbio, BLOCK_SIZE, MAX_BLOCK_COUNT) || !open_memory_block_io(&replica_mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	// the replica starts with the first_log_sequence_number of the primary, as its next_log_sequence_number
+	int error = 0;
+	if(!initialize_wale(&primary, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&primary_mbio), APPEND_ONLY_BUFFER_COUNT, &error)
+	|| !initialize_wale(&replica, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&replica_mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	for(int log_number = 0; log_number < LOG_RECORD_COUNT; log_number++)
+		append_or_exit(&primary, log_number);
+	flush_or_exit(&primary);
+
+	int fds[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+	{
+		printf("failed to create socket pair : errno = %d\n", errno);
+		return -1;
+	}
+
+	pthread_t shipper;
+	pthread_create(&shipper, NULL, ship_log_records, &(fds[0]));
+
+	// the replica appends the raw log ranges as they arrive, at the log sequence numbers it expects
+	void* raw_log_range = malloc(SHIPPING_SIZE);
+	int frame_count = 0;
+	uint64_t expected_log_sequence_number = 7;
+	while(1)
+	{
+		frame_header fh;
+		recv_or_exit(fds[1], &fh, sizeof(fh));
+		if(fh.raw_log_range_size == 0)
+			break;
+		recv_or_exit(fds[1], raw_log_range, fh.raw_log_range_size);
+
+		if(fh.from_log_sequence_number != expected_log_sequence_number)
+		{
+			printf("raw log range shipped out of order\n");
+			return -1;
+		}
+
+		if(compare_uint256(append_raw_log_range(&replica, get_uint256(fh.from_log_sequence_number), raw_log_range, fh.raw_log_range_size, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append raw log range : error -> %d\n", error);
+			return -1;
+		}
+		expected_log_sequence_number += fh.raw_log_range_size;
+		frame_count++;
+	}
+	pthread_join(shipper, NULL);
+	close(fds[0]);
+	close(fds[1]);
+	flush_or_exit(&replica);
+
+	// the replica must have the same log records, at the same log sequence numbers, of the same types
+	int log_count = 0;
+	uint256 replica_log_sequence_number = get_first_log_sequence_number(&replica);
+	for(uint256 log_sequence_number = get_first_log_sequence_number(&primary); compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(&primary, log_sequence_number, &error))
+	{
+		if(compare_uint256(log_sequence_number, replica_log_sequence_number) != 0)
+		{
+			printf("log record %d is at a different log sequence number on the replica\n", log_count);
+			return -1;
+		}
+
+		uint32_t primary_log_record_size;
+		char* primary_log_record = get_log_record_at(&primary, log_sequence_number, &primary_log_record_size, &error);
+		uint32_t replica_log_record_size;
+		char* replica_log_record = get_log_record_at(&replica, log_sequence_number, &replica_log_record_size, &error);
+		uint8_t primary_log_record_type;
+		uint8_t replica_log_record_type;
+		get_log_record_type_at(&primary, log_sequence_number, &primary_log_record_type, &error);
+		get_log_record_type_at(&replica, log_sequence_number, &replica_log_record_type, &error);
+		if(primary_log_record == NULL || replica_log_record == NULL || primary_log_record_size != replica_log_record_size || memcmp(primary_log_record, replica_log_record, primary_log_record_size) != 0 || primary_log_record_type != replica_log_record_type)
+		{
+			printf("log record %d differs on the replica : error -> %d\n", log_count, error);
+			return -1;
+		}
+		release_log_record(&primary, primary_log_record, primary_log_record_size);
+		release_log_record(&replica, replica_log_record, replica_log_record_size);
+
+		replica_log_sequence_number = get_next_log_sequence_number_of(&replica, replica_log_sequence_number, &error);
+		log_count++;
+	}
+	printf("shipped %d log records in %d raw log ranges\n", log_count, frame_count);
+	if(log_count != LOG_RECORD_COUNT || compare_uint256(replica_log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0
+	|| compare_uint256(get_next_log_sequence_number(&primary), get_next_log_sequence_number(&replica)) != 0)
+	{
+		printf("expected %d log records on the replica\n", LOG_RECORD_COUNT);
+		return -1;
+	}
+
+	// the replica keeps on accepting the log records, as the primary appends them
+	append_or_exit(&primary, LOG_RECORD_COUNT);
+	flush_or_exit(&primary);
+	uint256 from_log_sequence_number = get_next_log_sequence_number(&replica);
+
+	// a max_bytes, that the first log record does not fit in, is rejected
+	if(read_raw_log_range(&primary, from_log_sequence_number, 16, raw_log_range, &error) != 0 || error != PARAM_INVALID)
+	{
+		printf("raw log range was read with a max_bytes too small for its first log record\n");
+		return -1;
+	}
+
+	uint64_t raw_log_range_size = read_raw_log_range(&primary, from_log_sequence_number, SHIPPING_SIZE, raw_log_range, &error);
+	if(raw_log_range_size == 0)
+	{
+		printf("failed to read raw log range : error -> %d\n", error);
+		return -1;
+	}
+
+	// a raw log range at a log sequence number, that the replica does not expect, is rejected
+	if(compare_uint256(append_raw_log_range(&replica, get_uint256(7), raw_log_range, raw_log_range_size, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != PARAM_INVALID)
+	{
+		printf("raw log range was appended at a wrong log sequence number\n");
+		return -1;
+	}
+
+	// a corrupted raw log range is rejected
+	((char*)raw_log_range)[raw_log_range_size / 2] ^= 0x31;
+	if(compare_uint256(append_raw_log_range(&replica, from_log_sequence_number, raw_log_range, raw_log_range_size, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != LOG_RECORD_CORRUPTED)
+	{
+		printf("corrupted raw log range was appended : error -> %d\n", error);
+		return -1;
+	}
+	((char*)raw_log_range)[raw_log_range_size / 2] ^= 0x31;
+
+	// and the intact one is appended, and made durable on the replica
+	uint256 last_log_sequence_number = append_raw_log_range(&replica, from_log_sequence_number, raw_log_range, raw_log_range_size, APPEND_DURABLE, &error);
+	if(compare_uint256(last_log_sequence_number, get_last_flushed_log_sequence_number(&primary)) != 0 || compare_uint256(get_last_flushed_log_sequence_number(&replica), last_log_sequence_number) != 0)
+	{
+		printf("failed to append raw log range durably : error -> %d\n", error);
+		return -1;
+	}
+	free(raw_log_range);
+
+	deinitialize_wale(&primary);
+	deinitialize_wale(&replica);
+	close_memory_block_io(&primary_mbio);
+	close_memory_block_io(&replica_mbio);
+
+	printf("no error found - log shipping test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
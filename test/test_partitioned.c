@@ -0,0 +1,218 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<partitioned_wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define PARTITION_COUNT 4
+
+// every thread appends to its local partition, and every TOUCH_OTHER_EVERY-th transaction also touches the next partition
+#define THREAD_COUNT 8
+#define TRANSACTIONS_PER_THREAD 250
+#define LOG_RECORDS_PER_TRANSACTION 4
+#define TOUCH_OTHER_EVERY 5
+
+#define LOG_FORMAT "thread=<%d> log_number=<%d> some padding for the log record"
+
+partitioned_wale pwalE;
+
+static void* run_transactions(void* thread_id_p)
+{
+	int thread_id = *((int*)thread_id_p);
+	uint32_t local_partition_id = thread_id % PARTITION_COUNT;
+
+	int log_number = 0;
+	for(int t = 0; t < TRANSACTIONS_PER_THREAD; t++)
+	{
+		partitioned_wale_transaction transaction = {};
+		for(int i = 0; i < LOG_RECORDS_PER_TRANSACTION; i++, log_number++)
+		{
+			uint32_t partition_id = local_partition_id;
+			if(t % TOUCH_OTHER_EVERY == 0 && i == LOG_RECORDS_PER_TRANSACTION - 1)
+				partition_id = (local_partition_id + 1) % PARTITION_COUNT;
+
+			char log_record[128];
+			sprintf(log_record, LOG_FORMAT, thread_id, log_number);
+
+			int error = 0;
+			if(compare_uint256(append_log_record_partitioned(&pwalE, partition_id, &transaction, log_record, strlen(log_record) + 1, 1, NULL, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+			{
+				printf("failed to append to partitioned wale : error -> %d\n", error);
+				exit(-1);
+			}
+		}
+
+		int error = 0;
+		if(!commit_partitioned_wale_transaction(&pwalE, &transaction, &error))
+		{
+			printf("failed to commit transaction : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+	return NULL;
+}
+
+static uint64_t get_flush_count(uint32_t partition_id)
+{
+	wale_stats stats;
+	get_wale_stats(get_partition_wale(&pwalE, partition_id), &stats);
+	return stats.counters[WALE_STATS_FLUSHES];
+}
+
+int main()
+{
+	memory_block_io mbios[PARTITION_COUNT];
+	block_io_ops partition_block_io_functions[PARTITION_COUNT];
+	for(int i = 0; i < PARTITION_COUNT; i++)
+	{
+		if(!open_memory_block_io(&(mbios[i]), BLOCK_SIZE, MAX_BLOCK_COUNT))
+		{
+			printf("failed to open memory block io : errno = %d\n", errno);
+			return -1;
+		}
+		partition_block_io_functions[i] = get_block_io_ops_for_memory_block_io(&(mbios[i]));
+	}
+
+	int error = 0;
+	if(initialize_partitioned_wale(&pwalE, MAX_PARTITION_COUNT + 1, partition_block_io_functions, 8, get_uint256(7), APPEND_ONLY_BUFFER_COUNT, &error) || error != PARAM_INVALID)
+	{
+		printf("partitioned wale initialized with too many partitions\n");
+		return -1;
+	}
+
+	if(!initialize_partitioned_wale(&pwalE, PARTITION_COUNT, partition_block_io_functions, 8, get_uint256(7), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create partitioned wale instance : error -> %d\n", error);
+		return -1;
+	}
+
+	pthread_t threads[THREAD_COUNT];
+	int thread_ids[THREAD_COUNT];
+	for(int i = 0; i < THREAD_COUNT; i++)
+	{
+		thread_ids[i] = i;
+		pthread_create(&(threads[i]), NULL, run_transactions, &(thread_ids[i]));
+	}
+	for(int i = 0; i < THREAD_COUNT; i++)
+		pthread_join(threads[i], NULL);
+
+	// a commit flushes only the partitions, that its transaction touched
+	uint64_t untouched_flush_count = get_flush_count(0);
+	partitioned_wale_transaction transaction = {};
+	uint64_t global_sequence_number = 0;
+	if(compare_uint256(append_log_record_partitioned(&pwalE, 1, &transaction, "thread=<-1>", 12, 2, &global_sequence_number, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0
+	|| !commit_partitioned_wale_transaction(&pwalE, &transaction, &error))
+	{
+		printf("failed to commit transaction : error -> %d\n", error);
+		return -1;
+	}
+	if(get_flush_count(0) != untouched_flush_count || compare_uint256(get_last_flushed_log_sequence_number(get_partition_wale(&pwalE, 1)), transaction.last_log_sequence_numbers[1]) < 0)
+	{
+		printf("commit did not flush only the touched partition\n");
+		return -1;
+	}
+
+	// reopen the partitions, the global_sequence_numbers must continue after the largest one
+	deinitialize_partitioned_wale(&pwalE);
+	if(!initialize_partitioned_wale(&pwalE, PARTITION_COUNT, partition_block_io_functions, 8, INVALID_LOG_SEQUENCE_NUMBER, APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to reopen partitioned wale instance : error -> %d\n", error);
+		return -1;
+	}
+	if(pwalE.next_global_sequence_number != global_sequence_number + 1)
+	{
+		printf("reopened partitioned wale continues at the global_sequence_number %" PRIu64 ", expected %" PRIu64 "\n", pwalE.next_global_sequence_number, global_sequence_number + 1);
+		return -1;
+	}
+
+	// the merged scan, must yield all the log records in the increasing order of their global_sequence_numbers
+	// and the log records of every thread in the order it appended them
+	partitioned_wale_cursor cursor;
+	if(!initialize_partitioned_wale_cursor(&cursor, &pwalE, &error))
+	{
+		printf("failed to initialize the merged cursor : error -> %d\n", error);
+		return -1;
+	}
+
+	int next_log_numbers[THREAD_COUNT] = {};
+	int log_count = 0;
+	uint64_t prev_global_sequence_number = 0;
+	uint32_t partition_id;
+	uint32_t log_record_size;
+	char* log_record;
+	while((log_record = get_next_log_record_partitioned(&cursor, &partition_id, NULL, &global_sequence_number, &log_record_size, &error)) != NULL)
+	{
+		if(global_sequence_number <= prev_global_sequence_number)
+		{
+			printf("merged scan yielded the global_sequence_number %" PRIu64 " after %" PRIu64 "\n", global_sequence_number, prev_global_sequence_number);
+			return -1;
+		}
+		prev_global_sequence_number = global_sequence_number;
+
+		int thread_id;
+		int log_number;
+		if(sscanf(log_record, LOG_FORMAT, &thread_id, &log_number) == 2)
+		{
+			if(thread_id < 0 || thread_id >= THREAD_COUNT || log_number != next_log_numbers[thread_id])
+			{
+				printf("merged scan yielded log record %d of thread %d, out of order\n", log_number, thread_id);
+				return -1;
+			}
+			next_log_numbers[thread_id]++;
+		}
+
+		release_log_record_partitioned(&pwalE, partition_id, log_record, log_record_size);
+		log_count++;
+	}
+	deinitialize_partitioned_wale_cursor(&cursor);
+
+	printf("merged scan yielded %d log records from %d partitions\n", log_count, PARTITION_COUNT);
+	if(error || log_count != THREAD_COUNT * TRANSACTIONS_PER_THREAD * LOG_RECORDS_PER_TRANSACTION + 1)
+	{
+		printf("expected %d log records : error -> %d\n", THREAD_COUNT * TRANSACTIONS_PER_THREAD * LOG_RECORDS_PER_TRANSACTION + 1, error);
+		return -1;
+	}
+
+	// a partition that fails to be read during the merge, must leave the cursor safe to be advanced and deinitialized
+	// the first log record of every partition is read into the cursor, and then its header is corrupted, so the cursor fails to advance past it
+	if(!initialize_partitioned_wale_cursor(&cursor, &pwalE, &error))
+	{
+		printf("failed to initialize the merged cursor : error -> %d\n", error);
+		return -1;
+	}
+	for(int i = 0; i < PARTITION_COUNT; i++)
+		((char*)(mbios[i].memory))[BLOCK_SIZE] ^= 0x01;
+	for(int i = 0; i < PARTITION_COUNT; i++)
+	{
+		if(get_next_log_record_partitioned(&cursor, &partition_id, NULL, NULL, &log_record_size, &error) != NULL || error != HEADER_CORRUPTED)
+		{
+			printf("merged scan advanced past a corrupted header : error -> %d\n", error);
+			return -1;
+		}
+	}
+	if(get_next_log_record_partitioned(&cursor, &partition_id, NULL, NULL, &log_record_size, &error) != NULL || error != NO_ERROR)
+	{
+		printf("merged scan yielded a log record, after all the partitions failed : error -> %d\n", error);
+		return -1;
+	}
+	deinitialize_partitioned_wale_cursor(&cursor);
+
+	deinitialize_partitioned_wale(&pwalE);
+	for(int i = 0; i < PARTITION_COUNT; i++)
+		close_memory_block_io(&(mbios[i]));
+
+	printf("no error found - partitioned wale test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
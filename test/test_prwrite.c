@@ -32,7 +32,7 @@ int append_test_log(int thread_id, int log_number)
 	uint32_t ls = (((unsigned int)rand()) % strlen(NUMBERS));
 	sprintf(log_buffer, LOG_FORMAT, thread_id, log_number, ls, ls, NUMBERS);
 	int error = 0;
-	uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, &error);
+	uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
 	#ifdef DEBUG_PRINT_LOG_BUFFER
 		printf("log_sequence_number = "); print_uint256(log_sequence_number); printf(" ::: %s : error -> %d\n\n", log_buffer, error);
 	#endif
@@ -93,7 +93,7 @@ int main()
 	}
 
 	int init_error = 0;
-	if(!initialize_wale(&walE, 12, (new_file ? get_uint256(7) : INVALID_LOG_SEQUENCE_NUMBER), NULL, get_block_io_functions(&bf), APPEND_ONLY_BUFFER_COUNT, &init_error))
+	if(!initialize_wale(&walE, 12, (new_file ? get_uint256(7) : INVALID_LOG_SEQUENCE_NUMBER), 0, NULL, get_block_io_functions(&bf), APPEND_ONLY_BUFFER_COUNT, &init_error))
 	{
 		printf("failed to create wale instance wale_erro = %d (error = %d on fd = %d)\n", init_error, errno, bf.file_descriptor);
 		close_block_file(&bf);
@@ -0,0 +1,348 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+
+#include<serial_int.h>
+
+#include<zlib.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 12)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOG_SEQUENCE_NUMBER_WIDTH 8
+#define FIRST_LOG_SEQUENCE_NUMBER 7
+
+// the log records of 24 bytes, that we care about, take 33 bytes each in the LOG_RECORD_FORMAT_V2, instead of 40 bytes in the LOG_RECORD_FORMAT_V1
+#define SMALL_LOG_RECORD_SIZE 24
+#define SMALL_LOG_RECORD_COUNT 100
+#define V2_SMALL_LOG_RECORD_SLOT_SIZE (SMALL_LOG_RECORD_SIZE + 9)
+
+// a log record large enough for the varints of its own and of the next log record to be 2 bytes wide
+#define LARGE_LOG_RECORD_SIZE 1000
+
+// log records that we write in the LOG_RECORD_FORMAT_V1 by hand, and then those appended to it by the WALe
+#define V1_LOG_RECORD_COUNT 20
+#define V1_APPENDED_LOG_RECORD_COUNT 10
+
+#define LOG_FORMAT "log record number <%04d>"
+
+static void fill_log_record(char* log_record, uint32_t log_record_size, int log_number)
+{
+	memset(log_record, 'a' + (log_number % 26), log_record_size);
+	char prefix[64];
+	int prefix_size = sprintf(prefix, LOG_FORMAT, log_number);
+	memcpy(log_record, prefix, (prefix_size < log_record_size) ? prefix_size : log_record_size);
+}
+
+static void append_or_exit(wale* wale_p, int log_number, uint32_t log_record_size)
+{
+	char log_record[LARGE_LOG_RECORD_SIZE];
+	fill_log_record(log_record, log_record_size, log_number);
+
+	int error = 0;
+	if(compare_uint256(append_log_record(wale_p, log_record, log_record_size, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append log record %d : error -> %d\n", log_number, error);
+		exit(-1);
+	}
+}
+
+static void flush_or_exit(wale* wale_p)
+{
+	int error = 0;
+	flush_all_log_records(wale_p, &error);
+	if(error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		exit(-1);
+	}
+}
+
+// reads all the log records of the WALe, forward and then backward, checking their contents, with log_record_sizes[i] being the size of the i-th log record
+static void read_all_or_exit(wale* wale_p, const uint32_t* log_record_sizes, int log_count)
+{
+	int error = 0;
+
+	int log_number = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number(wale_p);
+	uint256 last_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(; compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_next_log_sequence_number_of(wale_p, log_sequence_number, &error), log_number++)
+	{
+		char expected[LARGE_LOG_RECORD_SIZE];
+		fill_log_record(expected, log_record_sizes[log_number], log_number);
+
+		uint32_t log_record_size;
+		char* log_record = get_log_record_at(wale_p, log_sequence_number, &log_record_size, &error);
+		if(log_record == NULL || log_record_size != log_record_sizes[log_number] || memcmp(log_record, expected, log_record_size) != 0)
+		{
+			printf("log record %d read incorrectly : error -> %d\n", log_number, error);
+			exit(-1);
+		}
+		release_log_record(wale_p, log_record, log_record_size);
+
+		if(!validate_log_record_at(wale_p, log_sequence_number, &log_record_size, &error))
+		{
+			printf("log record %d did not validate : error -> %d\n", log_number, error);
+			exit(-1);
+		}
+
+		last_log_sequence_number = log_sequence_number;
+	}
+	if(error || log_number != log_count)
+	{
+		printf("read %d log records forward, expected %d : error -> %d\n", log_number, log_count, error);
+		exit(-1);
+	}
+
+	log_number = 0;
+	for(log_sequence_number = last_log_sequence_number; compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; log_sequence_number = get_prev_log_sequence_number_of(wale_p, log_sequence_number, &error))
+		log_number++;
+	if(error || log_number != log_count)
+	{
+		printf("read %d log records backward, expected %d : error -> %d\n", log_number, log_count, error);
+		exit(-1);
+	}
+}
+
+// truncates all the log records of the WALe, and appends log_count log records to it, the format of the WALe must survive the truncation, and a reopen after it
+static void truncate_and_reopen_or_exit(wale* wale_p, memory_block_io* mbio, uint32_t log_record_format_version, uint32_t* log_record_sizes, int log_count)
+{
+	// the WALe may have been reopened read only
+	int error = 0;
+	if(!modify_append_only_buffer_block_count(wale_p, APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to resize the append only buffer : error -> %d\n", error);
+		exit(-1);
+	}
+
+	if(!truncate_log_records(wale_p, &error) || wale_p->on_disk_master_record.log_record_format_version != log_record_format_version)
+	{
+		printf("failed to truncate the wale, or it lost its format : error -> %d\n", error);
+		exit(-1);
+	}
+
+	uint256 next_log_sequence_number = get_next_log_sequence_number(wale_p);
+	for(int log_number = 0; log_number < log_count; log_number++)
+		append_or_exit(wale_p, log_number, log_record_sizes[log_number] = SMALL_LOG_RECORD_SIZE);
+	flush_or_exit(wale_p);
+
+	// the log records appended after the truncation are in the same format
+	uint64_t bytes_appended;
+	uint256 temp;
+	sub_underflow_safe_uint256(&temp, get_next_log_sequence_number(wale_p), next_log_sequence_number);
+	cast_to_uint64_from_uint256(&bytes_appended, temp);
+	uint64_t expected_slot_size = (log_record_format_version == LOG_RECORD_FORMAT_V1) ? (SMALL_LOG_RECORD_SIZE + 16) : V2_SMALL_LOG_RECORD_SLOT_SIZE;
+	if(bytes_appended != log_count * expected_slot_size)
+	{
+		printf("log records appended after the truncation took %" PRIu64 " bytes, expected %" PRIu64 "\n", bytes_appended, log_count * expected_slot_size);
+		exit(-1);
+	}
+
+	deinitialize_wale(wale_p);
+	if(!initialize_wale(wale_p, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(mbio), APPEND_ONLY_BUFFER_COUNT, &error) || wale_p->on_disk_master_record.log_record_format_version != log_record_format_version)
+	{
+		printf("failed to reopen the truncated wale : error -> %d\n", error);
+		exit(-1);
+	}
+	read_all_or_exit(wale_p, log_record_sizes, log_count);
+}
+
+// writes a WALe file in the LOG_RECORD_FORMAT_V1, as written before the LOG_RECORD_FORMAT_V2 existed, i.e. with a master record of version 2
+static void write_v1_wale_file(memory_block_io* mbio, uint32_t* log_record_sizes)
+{
+	char* file = mbio->memory;
+
+	uint64_t log_sequence_number = FIRST_LOG_SEQUENCE_NUMBER;
+	uint64_t last_log_sequence_number = 0;
+	uint32_t prev_log_record_size = 0;
+	for(int log_number = 0; log_number < V1_LOG_RECORD_COUNT; log_number++)
+	{
+		uint32_t log_record_size = log_record_sizes[log_number] = 10 + (log_number * 7) % 50;
+		char* slot = file + BLOCK_SIZE + (log_sequence_number - FIRST_LOG_SEQUENCE_NUMBER);
+
+		serialize_uint32(slot, sizeof(uint32_t), prev_log_record_size);
+		serialize_uint32(slot + 4, sizeof(uint32_t), log_record_size);
+		serialize_uint32(slot + 8, sizeof(uint32_t), crc32(crc32(0UL, NULL, 0U), (const void*)slot, 8));
+		fill_log_record(slot + 12, log_record_size, log_number);
+		serialize_uint32(slot + 12 + log_record_size, sizeof(uint32_t), crc32(crc32(0UL, NULL, 0U), (const void*)(slot + 12), log_record_size));
+
+		last_log_sequence_number = log_sequence_number;
+		log_sequence_number += 16 + log_record_size;
+		prev_log_record_size = log_record_size;
+	}
+
+	char* mr = file;
+	serialize_uint32(mr, sizeof(uint32_t), LOG_SEQUENCE_NUMBER_WIDTH | (2 << 16));
+	serialize_uint64(mr + 4, LOG_SEQUENCE_NUMBER_WIDTH, FIRST_LOG_SEQUENCE_NUMBER);					// first_log_sequence_number
+	serialize_uint64(mr + 4 + 8, LOG_SEQUENCE_NUMBER_WIDTH, last_log_sequence_number);				// last_flushed_log_sequence_number
+	serialize_uint64(mr + 4 + 16, LOG_SEQUENCE_NUMBER_WIDTH, 0);									// check_point_log_sequence_number
+	serialize_uint64(mr + 4 + 24, LOG_SEQUENCE_NUMBER_WIDTH, log_sequence_number);					// next_log_sequence_number
+	serialize_uint64(mr + 4 + 32, LOG_SEQUENCE_NUMBER_WIDTH, FIRST_LOG_SEQUENCE_NUMBER);			// base_log_sequence_number
+	serialize_uint64(mr + 4 + 40, sizeof(uint64_t), 0);											// ring_block_count
+	serialize_uint32(mr + 4 + 48, sizeof(uint32_t), crc32(crc32(0UL, NULL, 0U), (const void*)mr, 4 + 48));
+}
+
+int main()
+{
+	uint32_t log_record_sizes[SMALL_LOG_RECORD_COUNT + 2 + V1_LOG_RECORD_COUNT + V1_APPENDED_LOG_RECORD_COUNT];
+	int error = 0;
+
+	// a new WALe file is created in the LOG_RECORD_FORMAT_V2
+	{
+		memory_block_io mbio;
+		if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+		{
+			printf("failed to open memory block io : errno = %d\n", errno);
+			return -1;
+		}
+
+		wale walE;
+		if(!initialize_wale(&walE, LOG_SEQUENCE_NUMBER_WIDTH, get_uint256(FIRST_LOG_SEQUENCE_NUMBER), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+		{
+			printf("failed to create wale instance wale_erro = %d\n", error);
+			return -1;
+		}
+
+		if(walE.on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V2)
+		{
+			printf("new WALe file was not created in the LOG_RECORD_FORMAT_V2\n");
+			return -1;
+		}
+
+		for(int log_number = 0; log_number < SMALL_LOG_RECORD_COUNT; log_number++)
+			append_or_exit(&walE, log_number, log_record_sizes[log_number] = SMALL_LOG_RECORD_SIZE);
+		flush_or_exit(&walE);
+
+		uint64_t bytes_appended;
+		cast_to_uint64_from_uint256(&bytes_appended, get_next_log_sequence_number(&walE));
+		bytes_appended -= FIRST_LOG_SEQUENCE_NUMBER;
+		printf("%d log records of %d bytes took %" PRIu64 " bytes\n", SMALL_LOG_RECORD_COUNT, SMALL_LOG_RECORD_SIZE, bytes_appended);
+		if(bytes_appended != SMALL_LOG_RECORD_COUNT * V2_SMALL_LOG_RECORD_SLOT_SIZE)
+		{
+			printf("expected %d bytes\n", SMALL_LOG_RECORD_COUNT * V2_SMALL_LOG_RECORD_SLOT_SIZE);
+			return -1;
+		}
+
+		append_or_exit(&walE, SMALL_LOG_RECORD_COUNT, log_record_sizes[SMALL_LOG_RECORD_COUNT] = LARGE_LOG_RECORD_SIZE);
+		append_or_exit(&walE, SMALL_LOG_RECORD_COUNT + 1, log_record_sizes[SMALL_LOG_RECORD_COUNT + 1] = SMALL_LOG_RECORD_SIZE);
+		flush_or_exit(&walE);
+
+		read_all_or_exit(&walE, log_record_sizes, SMALL_LOG_RECORD_COUNT + 2);
+
+		// the format is read back from the master record
+		deinitialize_wale(&walE);
+		if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), 0, &error) || walE.on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V2)
+		{
+			printf("failed to reopen the LOG_RECORD_FORMAT_V2 wale : error -> %d\n", error);
+			return -1;
+		}
+		read_all_or_exit(&walE, log_record_sizes, SMALL_LOG_RECORD_COUNT + 2);
+
+		// corrupt a byte of the log record 50, its combined crc32 must catch it, while the traversal past it only needs its header
+		uint256 log_sequence_number = get_uint256(FIRST_LOG_SEQUENCE_NUMBER + 50 * V2_SMALL_LOG_RECORD_SLOT_SIZE);
+		char* log_record_in_file = ((char*)mbio.memory) + BLOCK_SIZE + 50 * V2_SMALL_LOG_RECORD_SLOT_SIZE;
+		log_record_in_file[5 + 10] ^= 0x01;
+
+		uint32_t log_record_size;
+		if(get_log_record_at(&walE, log_sequence_number, &log_record_size, &error) != NULL || error != LOG_RECORD_CORRUPTED)
+		{
+			printf("corrupted log record was read : error -> %d\n", error);
+			return -1;
+		}
+		if(validate_log_record_at(&walE, log_sequence_number, &log_record_size, &error) || error != LOG_RECORD_CORRUPTED)
+		{
+			printf("corrupted log record was validated : error -> %d\n", error);
+			return -1;
+		}
+		if(compare_uint256(get_next_log_sequence_number_of(&walE, log_sequence_number, &error), INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("could not traverse past the log record with a valid header : error -> %d\n", error);
+			return -1;
+		}
+
+		// corrupt its log_record_type, its header_check must catch it
+		log_record_in_file[2] ^= 0x01;
+		if(compare_uint256(get_next_log_sequence_number_of(&walE, log_sequence_number, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != HEADER_CORRUPTED)
+		{
+			printf("traversed past the corrupted header : error -> %d\n", error);
+			return -1;
+		}
+
+		truncate_and_reopen_or_exit(&walE, &mbio, LOG_RECORD_FORMAT_V2, log_record_sizes, SMALL_LOG_RECORD_COUNT);
+
+		deinitialize_wale(&walE);
+		close_memory_block_io(&mbio);
+	}
+
+	// an existing WALe file in the LOG_RECORD_FORMAT_V1 stays readable, and the new log records are appended to it in the same format
+	{
+		memory_block_io mbio;
+		if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+		{
+			printf("failed to open memory block io : errno = %d\n", errno);
+			return -1;
+		}
+
+		write_v1_wale_file(&mbio, log_record_sizes);
+
+		wale walE;
+		if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+		{
+			printf("failed to open the LOG_RECORD_FORMAT_V1 wale : error -> %d\n", error);
+			return -1;
+		}
+		if(walE.on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V1)
+		{
+			printf("LOG_RECORD_FORMAT_V1 wale was not recognized\n");
+			return -1;
+		}
+		read_all_or_exit(&walE, log_record_sizes, V1_LOG_RECORD_COUNT);
+
+		// there is no place for a log_record_type in the LOG_RECORD_FORMAT_V1
+		if(compare_uint256(append_typed_log_record(&walE, "typed", 6, 1, 0, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER) != 0 || error != PARAM_INVALID)
+		{
+			printf("typed log record was appended in the LOG_RECORD_FORMAT_V1\n");
+			return -1;
+		}
+
+		uint256 next_log_sequence_number = get_next_log_sequence_number(&walE);
+		for(int log_number = V1_LOG_RECORD_COUNT; log_number < V1_LOG_RECORD_COUNT + V1_APPENDED_LOG_RECORD_COUNT; log_number++)
+			append_or_exit(&walE, log_number, log_record_sizes[log_number] = SMALL_LOG_RECORD_SIZE);
+		flush_or_exit(&walE);
+
+		uint64_t bytes_appended;
+		uint256 temp;
+		sub_underflow_safe_uint256(&temp, get_next_log_sequence_number(&walE), next_log_sequence_number);
+		cast_to_uint64_from_uint256(&bytes_appended, temp);
+		if(bytes_appended != V1_APPENDED_LOG_RECORD_COUNT * (SMALL_LOG_RECORD_SIZE + 16))
+		{
+			printf("log records were not appended in the LOG_RECORD_FORMAT_V1, they took %" PRIu64 " bytes\n", bytes_appended);
+			return -1;
+		}
+
+		deinitialize_wale(&walE);
+		if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), 0, &error) || walE.on_disk_master_record.log_record_format_version != LOG_RECORD_FORMAT_V1)
+		{
+			printf("failed to reopen the LOG_RECORD_FORMAT_V1 wale : error -> %d\n", error);
+			return -1;
+		}
+		read_all_or_exit(&walE, log_record_sizes, V1_LOG_RECORD_COUNT + V1_APPENDED_LOG_RECORD_COUNT);
+
+		truncate_and_reopen_or_exit(&walE, &mbio, LOG_RECORD_FORMAT_V1, log_record_sizes, V1_APPENDED_LOG_RECORD_COUNT);
+
+		deinitialize_wale(&walE);
+		close_memory_block_io(&mbio);
+	}
+
+	printf("no error found - record format test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_replay.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 16)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+// every log record updates a key (e.g. a page), every BARRIER_EVERY-th log record is a barrier (e.g. a checkpoint of our own)
+#define KEY_COUNT 97
+#define LOG_RECORD_COUNT 20000
+#define BARRIER_EVERY 3001
+
+// the log record at this index is appended as the checkpoint of the WALe
+#define CHECK_POINT_INDEX 12345
+
+#define LOG_FORMAT "key=<%d> update=<%d> index=<%d>"
+#define BARRIER_FORMAT "barrier index=<%d>"
+
+// the apply fails at this index, for the failing replay
+#define FAIL_AT_INDEX 7777
+
+wale walE;
+
+typedef struct replay_state replay_state;
+struct replay_state
+{
+	uint32_t worker_count;
+
+	// index of the first log record replayed
+	int from_index;
+
+	// the update expected next for every key, and the worker that applied the key
+	// a key is only ever applied by its worker (or by the reader at a barrier), so they are not protected by any lock
+	int next_updates[KEY_COUNT];
+	uint32_t worker_ids[KEY_COUNT];
+
+	// number of the log records applied until now
+	uint64_t applied_count;
+
+	// the apply fails at this index, unless it is -1
+	int fail_at_index;
+};
+
+uint256 check_point_log_sequence_number;
+
+// the updates of every key, before the CHECK_POINT_INDEX - 1
+int updates_before_check_point[KEY_COUNT];
+
+static uint64_t classify(void* replay_handle, uint256 log_sequence_number, const void* log_record, uint32_t log_record_size)
+{
+	int key, update, index;
+	if(sscanf(log_record, LOG_FORMAT, &key, &update, &index) == 3)
+		return key;
+	return WALE_REPLAY_BARRIER_KEY;
+}
+
+static int apply(void* replay_handle, uint32_t worker_id, uint256 log_sequence_number, const void* log_record, uint32_t log_record_size)
+{
+	replay_state* state = replay_handle;
+
+	int key, update, index;
+	int is_key_log_record = (sscanf(log_record, LOG_FORMAT, &key, &update, &index) == 3);
+	if(!is_key_log_record)
+		sscanf(log_record, BARRIER_FORMAT, &index);
+
+	if(index == state->fail_at_index)
+		return 0;
+
+	// a barrier (or the checkpoint) is applied by the reader, after all the log records before it, and before all the log records after it
+	int is_barrier = !is_key_log_record || are_equal_uint256(log_sequence_number, check_point_log_sequence_number);
+	if(is_barrier && (worker_id != state->worker_count || __atomic_load_n(&(state->applied_count), __ATOMIC_RELAXED) != index - state->from_index))
+	{
+		printf("barrier at index %d applied by worker %u, with %" PRIu64 " log records applied\n", index, worker_id, state->applied_count);
+		exit(-1);
+	}
+
+	if(is_key_log_record)
+	{
+		if(update != state->next_updates[key] || (!is_barrier && worker_id >= state->worker_count))
+		{
+			printf("key %d update %d applied out of order by worker %u\n", key, update, worker_id);
+			exit(-1);
+		}
+		if(!is_barrier && state->worker_ids[key] != UINT32_MAX && state->worker_ids[key] != worker_id)
+		{
+			printf("key %d applied by workers %u and %u\n", key, state->worker_ids[key], worker_id);
+			exit(-1);
+		}
+		if(!is_barrier)
+			state->worker_ids[key] = worker_id;
+		state->next_updates[key]++;
+	}
+
+	__atomic_fetch_add(&(state->applied_count), 1, __ATOMIC_RELAXED);
+	return 1;
+}
+
+static void initialize_replay_state(replay_state* state, uint32_t worker_count, int from_index, int fail_at_index)
+{
+	(*state) = (replay_state){.worker_count = worker_count, .from_index = from_index, .fail_at_index = fail_at_index};
+	for(int i = 0; i < KEY_COUNT; i++)
+	{
+		state->next_updates[i] = (from_index == 0) ? 0 : updates_before_check_point[i];
+		state->worker_ids[i] = UINT32_MAX;
+	}
+}
+
+static void replay_or_exit(uint32_t worker_count, uint32_t batch_size)
+{
+	replay_state state;
+	initialize_replay_state(&state, worker_count, 0, -1);
+	wale_replay_callbacks callbacks = {.replay_handle = &state, .classify = classify, .apply = apply};
+
+	int error = 0;
+	if(!replay_log_records(&walE, get_first_log_sequence_number(&walE), worker_count, batch_size, &callbacks, &error))
+	{
+		printf("failed to replay with %u workers : error -> %d\n", worker_count, error);
+		exit(-1);
+	}
+
+	if(state.applied_count != LOG_RECORD_COUNT)
+	{
+		printf("replay with %u workers applied %" PRIu64 " log records, expected %d\n", worker_count, state.applied_count, LOG_RECORD_COUNT);
+		exit(-1);
+	}
+
+	printf("replay with %u workers and batches of %u applied all %" PRIu64 " log records in order\n", worker_count, batch_size, state.applied_count);
+}
+
+int main()
+{
+	memory_block_io mbio;
+	if(!open_memory_block_io(&mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	int updates[KEY_COUNT] = {};
+	for(int i = 0; i < LOG_RECORD_COUNT; i++)
+	{
+		char log_record[128];
+		if(i == CHECK_POINT_INDEX - 1)
+			memcpy(updates_before_check_point, updates, sizeof(updates));
+
+		if(i % BARRIER_EVERY == BARRIER_EVERY - 1)
+			sprintf(log_record, BARRIER_FORMAT, i);
+		else
+		{
+			// skew the keys, so that some of the workers get more log records than the others
+			int key = (i % 3 == 0) ? (i % 5) : (i % KEY_COUNT);
+			sprintf(log_record, LOG_FORMAT, key, updates[key]++, i);
+		}
+
+		if(are_equal_uint256(append_log_record(&walE, log_record, strlen(log_record) + 1, i == CHECK_POINT_INDEX, APPEND_BUFFERED, &error), INVALID_LOG_SEQUENCE_NUMBER))
+		{
+			printf("failed to append log record : error -> %d\n", error);
+			return -1;
+		}
+	}
+
+	flush_all_log_records(&walE, &error);
+	if(error)
+	{
+		printf("failed to flush wale : error -> %d\n", error);
+		return -1;
+	}
+
+	check_point_log_sequence_number = get_check_point_log_sequence_number(&walE);
+
+	replay_or_exit(1, 0);
+	replay_or_exit(4, 0);
+	replay_or_exit(8, 16);
+	replay_or_exit(3, 1);
+
+	// replay from the log record before the checkpoint, the checkpoint is a barrier, even though the classify does not make it one
+	{
+		replay_state state;
+		initialize_replay_state(&state, 4, CHECK_POINT_INDEX - 1, -1);
+		wale_replay_callbacks callbacks = {.replay_handle = &state, .classify = classify, .apply = apply};
+
+		uint256 from_log_sequence_number = get_prev_log_sequence_number_of(&walE, check_point_log_sequence_number, &error);
+		if(!replay_log_records(&walE, from_log_sequence_number, 4, 0, &callbacks, &error))
+		{
+			printf("failed to replay from the checkpoint : error -> %d\n", error);
+			return -1;
+		}
+		if(state.applied_count != LOG_RECORD_COUNT - (CHECK_POINT_INDEX - 1))
+		{
+			printf("replay from the checkpoint applied %" PRIu64 " log records, expected %d\n", state.applied_count, LOG_RECORD_COUNT - (CHECK_POINT_INDEX - 1));
+			return -1;
+		}
+		printf("replay from the checkpoint applied %" PRIu64 " log records in order\n", state.applied_count);
+	}
+
+	// a failed apply fails the replay
+	{
+		replay_state state;
+		initialize_replay_state(&state, 4, 0, FAIL_AT_INDEX);
+		wale_replay_callbacks callbacks = {.replay_handle = &state, .classify = classify, .apply = apply};
+		if(replay_log_records(&walE, get_first_log_sequence_number(&walE), 4, 0, &callbacks, &error) || error != LOG_RECORD_APPLY_FAILED)
+		{
+			printf("replay with a failing apply did not fail with LOG_RECORD_APPLY_FAILED : error -> %d\n", error);
+			return -1;
+		}
+		if(state.applied_count >= LOG_RECORD_COUNT)
+		{
+			printf("replay with a failing apply applied all the log records\n");
+			return -1;
+		}
+	}
+
+	if(replay_log_records(&walE, get_first_log_sequence_number(&walE), 0, 0, &(wale_replay_callbacks){.classify = classify, .apply = apply}, &error) || error != PARAM_INVALID)
+	{
+		printf("replay with 0 workers did not fail with PARAM_INVALID\n");
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+	close_memory_block_io(&mbio);
+
+	printf("no error found - replay test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/stat.h>
+
+#define FILENAME			"test_ring.log"
+#define BLOCK_SIZE			4096
+
+#define RING_BLOCK_COUNT 64
+
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+#define ROUNDS 8
+
+#define LOG_FORMAT "round=<%d> log_number=<%d> padding=<%.*s>"
+#define PADDING "0123456789-10111213141516171819-20212223242526272829-30313233343536373839-40414243444546474849-50515253545556575859"
+
+wale walE;
+
+static long long get_file_size()
+{
+	struct stat st;
+	stat(FILENAME, &st);
+	return (long long)st.st_size;
+}
+
+// appends log records until the ring is full, returns the number of log records appended
+static int append_until_ring_is_full(int round)
+{
+	int log_number = 0;
+	while(1)
+	{
+		char log_buffer[256];
+		sprintf(log_buffer, LOG_FORMAT, round, log_number, (int)(strlen(PADDING)), PADDING);
+		int error = 0;
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			if(error == LOG_RING_FULL)
+				return log_number;
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+		log_number++;
+	}
+}
+
+// reads all the log records, and checks that they are all from the given round, and in order
+// the first log record may be the last log record of the previous round, that the truncation retained
+static int read_all_log_records(int round)
+{
+	int error = 0;
+	int log_records_seen = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	if(round > 0)
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		uint32_t log_record_size;
+		char* log_record = (char*) get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		int log_round = -1, log_number = -1;
+		if(log_record == NULL || sscanf(log_record, "round=<%d> log_number=<%d>", &log_round, &log_number) != 2 || log_round != round || log_number != log_records_seen)
+		{
+			printf("error at log_sequence_number = "); print_uint256(log_sequence_number); printf(" : error -> %d, round = %d, log_number = %d\n", error, log_round, log_number);
+			exit(-1);
+		}
+		free(log_record);
+		log_records_seen++;
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	}
+	return log_records_seen;
+}
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), RING_BLOCK_COUNT, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		close_file_block_io(&fbio);
+		return -1;
+	}
+
+	long long initial_file_size = get_file_size();
+	printf("initial file size = %lld\n", initial_file_size);
+
+	int last_round_log_records = 0;
+	for(int round = 0; round < ROUNDS; round++)
+	{
+		int log_records_appended = append_until_ring_is_full(round);
+
+		flush_all_log_records(&walE, &error);
+		if(error)
+		{
+			printf("failed to flush : error -> %d\n", error);
+			exit(-1);
+		}
+
+		int log_records_seen = read_all_log_records(round);
+		printf("round = %d : appended = %d, seen = %d, file size = %lld\n", round, log_records_appended, log_records_seen, get_file_size());
+		if(log_records_seen != log_records_appended || get_file_size() != initial_file_size)
+		{
+			printf("error in round %d\n", round);
+			exit(-1);
+		}
+
+		if(round == ROUNDS - 1)
+		{
+			last_round_log_records = log_records_appended;
+			break;
+		}
+
+		// make the ring reusable for the next round, by truncating all but the last log record
+		uint256 last_flushed_log_sequence_number = get_last_flushed_log_sequence_number(&walE);
+		if(!truncate_log_records_before(&walE, last_flushed_log_sequence_number, &error))
+		{
+			printf("failed to truncate : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+
+	deinitialize_wale(&walE);
+
+	// reopen the ring, and check that the last round can still be read, across the wrap around
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		close_file_block_io(&fbio);
+		return -1;
+	}
+	int log_records_seen = read_all_log_records(ROUNDS - 1);
+	printf("after reopen : seen = %d\n", log_records_seen);
+	if(log_records_seen != last_round_log_records)
+	{
+		printf("error after reopen\n");
+		exit(-1);
+	}
+	deinitialize_wale(&walE);
+
+	close_file_block_io(&fbio);
+
+	printf("no error found - ring test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
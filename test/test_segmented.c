@@ -0,0 +1,194 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<block_io.h>
+
+#include<segmented_wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<dirent.h>
+#include<unistd.h>
+
+#define ADDITIONAL_FLAGS	0 //| O_DIRECT | O_SYNC
+#define DIRNAME				"./"
+#define EXTENSION			".log"
+
+#define APPEND_ONLY_BUFFER_COUNT 4
+
+// small segments, so that we roll over often
+#define MAX_SEGMENT_SIZE (16 * 4096)
+
+#define LOGS_TO_WRITE 4000
+
+#define LOG_FORMAT "log_number=<%d>"
+
+block_io_ops get_block_io_functions(const block_file* bf);
+
+segmented_wale swalE;
+
+static void get_segment_filename(char* filename, uint64_t segment_id)
+{
+	sprintf(filename, DIRNAME "%" PRIu64 EXTENSION, segment_id);
+}
+
+int get_segments_range(const void* segment_ops_handle, uint64_t* first_segment_id, uint64_t* segment_count)
+{
+	DIR* dir = opendir(DIRNAME);
+	if(dir == NULL)
+		return 0;
+
+	uint64_t min_segment_id = UINT64_MAX;
+	uint64_t max_segment_id = 0;
+	(*segment_count) = 0;
+
+	struct dirent* entry;
+	while((entry = readdir(dir)) != NULL)
+	{
+		uint64_t segment_id;
+		char extension[16];
+		if(sscanf(entry->d_name, "%" SCNu64 "%15s", &segment_id, extension) == 2 && strcmp(extension, EXTENSION) == 0)
+		{
+			min_segment_id = (segment_id < min_segment_id) ? segment_id : min_segment_id;
+			max_segment_id = (segment_id > max_segment_id) ? segment_id : max_segment_id;
+			(*segment_count) = 1;
+		}
+	}
+
+	closedir(dir);
+
+	if((*segment_count))
+	{
+		(*first_segment_id) = min_segment_id;
+		(*segment_count) = max_segment_id - min_segment_id + 1;
+	}
+
+	return 1;
+}
+
+int open_segment(const void* segment_ops_handle, uint64_t segment_id, int create, block_io_ops* block_io_functions)
+{
+	char filename[64];
+	get_segment_filename(filename, segment_id);
+
+	block_file* bf = malloc(sizeof(block_file));
+	if(!(create ? create_and_open_block_file(bf, filename, ADDITIONAL_FLAGS) : open_block_file(bf, filename, ADDITIONAL_FLAGS)))
+	{
+		free(bf);
+		return 0;
+	}
+
+	(*block_io_functions) = get_block_io_functions(bf);
+	return 1;
+}
+
+int close_segment(const void* segment_ops_handle, uint64_t segment_id, const block_io_ops* block_io_functions)
+{
+	block_file* bf = (block_file*)(block_io_functions->block_io_ops_handle);
+	close_block_file(bf);
+	free(bf);
+	return 1;
+}
+
+int delete_segment(const void* segment_ops_handle, uint64_t segment_id)
+{
+	char filename[64];
+	get_segment_filename(filename, segment_id);
+	return unlink(filename) == 0;
+}
+
+int main()
+{
+	segment_ops segment_functions = {
+		.segment_ops_handle = NULL,
+		.get_segments_range = get_segments_range,
+		.open_segment = open_segment,
+		.close_segment = close_segment,
+		.delete_segment = delete_segment,
+	};
+
+	uint64_t first_segment_id, segment_count;
+	if(!get_segments_range(NULL, &first_segment_id, &segment_count))
+	{
+		printf("failed to list segments\n");
+		return -1;
+	}
+
+	int init_error = 0;
+	if(!initialize_segmented_wale(&swalE, 8, (segment_count == 0 ? get_uint256(7) : INVALID_LOG_SEQUENCE_NUMBER), MAX_SEGMENT_SIZE, segment_functions, APPEND_ONLY_BUFFER_COUNT, &init_error))
+	{
+		printf("failed to create segmented wale instance wale_erro = %d (error = %d)\n", init_error, errno);
+		return -1;
+	}
+
+	int error = 0;
+
+	for(int log_number = 0; log_number < LOGS_TO_WRITE; log_number++)
+	{
+		char log_buffer[64];
+		sprintf(log_buffer, LOG_FORMAT, log_number);
+		uint256 log_sequence_number = append_log_record_segmented(&swalE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to segmented wale : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+
+	printf("flushed until = "); print_uint256(flush_all_log_records_segmented(&swalE, &error)); printf(" : error -> %d\n", error);
+	printf("segment_count = %" PRIu64 "\n\n", swalE.segment_count);
+
+	// walk all the log records in forward direction, across segments
+	int log_records_seen = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number_segmented(&swalE);
+	uint256 middle_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		uint32_t log_record_size;
+		char* log_record = (char*) get_log_record_at_segmented(&swalE, log_sequence_number, &log_record_size, &error);
+		if(error)
+		{
+			printf("error = %d\n", error);
+			exit(-1);
+		}
+		log_records_seen++;
+		release_log_record_segmented(&swalE, log_record, log_record_size);
+
+		if(log_records_seen == LOGS_TO_WRITE / 2)
+			middle_log_sequence_number = log_sequence_number;
+
+		log_sequence_number = get_next_log_sequence_number_of_segmented(&swalE, log_sequence_number, &error);
+		if(error)
+		{
+			printf("error = %d\n", error);
+			exit(-1);
+		}
+	}
+	printf("log records seen walking forward = %d\n", log_records_seen);
+
+	// walk all the log records in backward direction, across segments
+	log_records_seen = 0;
+	log_sequence_number = get_last_flushed_log_sequence_number_segmented(&swalE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		log_records_seen++;
+		log_sequence_number = get_prev_log_sequence_number_of_segmented(&swalE, log_sequence_number, &error);
+		if(error)
+		{
+			printf("error = %d\n", error);
+			exit(-1);
+		}
+	}
+	printf("log records seen walking backward = %d\n\n", log_records_seen);
+
+	// we are no longer concerned with the first half of the log records
+	uint64_t segments_deleted = discard_segments_before_segmented(&swalE, middle_log_sequence_number, &error);
+	printf("segments deleted = %" PRIu64 " : error -> %d\n", segments_deleted, error);
+	printf("segment_count = %" PRIu64 "\n", swalE.segment_count);
+	printf("first_log_sequence_number = "); print_uint256(get_first_log_sequence_number_segmented(&swalE)); printf("\n");
+	printf("middle_log_sequence_number = "); print_uint256(middle_log_sequence_number); printf("\n");
+
+	deinitialize_segmented_wale(&swalE);
+
+	return 0;
+}
\ No newline at end of file
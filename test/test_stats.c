@@ -0,0 +1,123 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#define FILENAME			"test_stats.log"
+#define BLOCK_SIZE			4096
+
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+#define THREAD_COUNT 4
+#define LOGS_PER_THREAD 5000
+
+// every thread flushes after these many appends
+#define FLUSH_EVERY 500
+
+#define LOG_FORMAT "thread=<%d> log_number=<%d>"
+
+wale walE;
+
+static void* append_log_records(void* thread_id_p)
+{
+	int thread_id = *((int*)thread_id_p);
+	for(int log_number = 0; log_number < LOGS_PER_THREAD; log_number++)
+	{
+		char log_buffer[64];
+		sprintf(log_buffer, LOG_FORMAT, thread_id, log_number);
+
+		int error = 0;
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+
+		if((log_number + 1) % FLUSH_EVERY == 0)
+			flush_all_log_records(&walE, &error);
+	}
+	return NULL;
+}
+
+static void print_histogram(const char* name, const wale_stats_histogram* histogram)
+{
+	printf("%-28s count = %8" PRIu64 ", avg = %8" PRIu64 " ns, p50 = %8" PRIu64 " ns, p99 = %8" PRIu64 " ns, max = %8" PRIu64 " ns\n", name,
+		histogram->count, (histogram->count == 0) ? 0 : (histogram->sum_ns / histogram->count),
+		get_wale_stats_percentile(histogram, 50.0), get_wale_stats_percentile(histogram, 99.0), histogram->max_ns);
+}
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	pthread_t threads[THREAD_COUNT];
+	int thread_ids[THREAD_COUNT];
+	for(int i = 0; i < THREAD_COUNT; i++)
+	{
+		thread_ids[i] = i;
+		pthread_create(&(threads[i]), NULL, append_log_records, &(thread_ids[i]));
+	}
+	for(int i = 0; i < THREAD_COUNT; i++)
+		pthread_join(threads[i], NULL);
+
+	flush_all_log_records(&walE, &error);
+
+	// read back a few log records, to have some read ios
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	for(int i = 0; i < 100 && compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0; i++)
+	{
+		uint32_t log_record_size;
+		free(get_log_record_at(&walE, log_sequence_number, &log_record_size, &error));
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	}
+
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+
+	printf("appends = %" PRIu64 ", appended bytes = %" PRIu64 "\n", stats.counters[WALE_STATS_APPENDS], stats.counters[WALE_STATS_APPENDED_BYTES]);
+	printf("scrolls = %" PRIu64 ", flushes = %" PRIu64 ", master record writes = %" PRIu64 "\n", stats.counters[WALE_STATS_SCROLLS], stats.counters[WALE_STATS_FLUSHES], stats.counters[WALE_STATS_MASTER_RECORD_WRITES]);
+	printf("read ios = %" PRIu64 ", read bytes = %" PRIu64 ", write ios = %" PRIu64 ", written bytes = %" PRIu64 "\n\n", stats.counters[WALE_STATS_READ_IOS], stats.counters[WALE_STATS_READ_BYTES], stats.counters[WALE_STATS_WRITE_IOS], stats.counters[WALE_STATS_WRITTEN_BYTES]);
+
+	print_histogram("append", &(stats.latencies[WALE_STATS_APPEND_LATENCY]));
+	print_histogram("scroll", &(stats.latencies[WALE_STATS_SCROLL_LATENCY]));
+	print_histogram("flush_all_writes", &(stats.latencies[WALE_STATS_FLUSH_ALL_WRITES_LATENCY]));
+	print_histogram("write_and_flush_master_record", &(stats.latencies[WALE_STATS_MASTER_RECORD_WRITE_LATENCY]));
+	printf("\n");
+
+	const char* lock_names[WALE_STATS_LOCK_COUNT] = {"global lock", "append_only_buffer_lock", "flushed_log_records_lock", "wait_for_scroll"};
+	for(int i = 0; i < WALE_STATS_LOCK_COUNT; i++)
+		printf("%-28s waits = %8" PRIu64 ", waited = %12" PRIu64 " ns\n", lock_names[i], stats.lock_waits[i], stats.lock_wait_ns[i]);
+
+	if(stats.counters[WALE_STATS_APPENDS] != THREAD_COUNT * LOGS_PER_THREAD || stats.latencies[WALE_STATS_APPEND_LATENCY].count != THREAD_COUNT * LOGS_PER_THREAD)
+	{
+		printf("\nappends were not counted correctly\n");
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	return 0;
+}
\ No newline at end of file
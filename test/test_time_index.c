@@ -0,0 +1,232 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<memory_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_time_index.h>
+
+#include<string.h>
+#include<errno.h>
+
+#define BLOCK_SIZE			512
+#define MAX_BLOCK_COUNT		(1 << 14)
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+// every flush gets its own entry, so that the index spans many blocks
+#define FLUSH_COUNT 500
+#define MIN_INTERVAL_IN_MICROSECONDS 1
+
+wale walE;
+wale_time_index time_index;
+
+// the wall clock time taken before the appends of every flush, and the log_sequence_number of the first log record appended after it
+uint64_t times[FLUSH_COUNT];
+uint256 first_log_sequence_numbers[FLUSH_COUNT];
+
+static uint64_t get_next_microsecond()
+{
+	uint64_t now = get_wale_time_index_now();
+	uint64_t next;
+	while((next = get_wale_time_index_now()) == now);
+	return next;
+}
+
+static uint256 find_or_exit(uint64_t time)
+{
+	int error = 0;
+	uint256 log_sequence_number = find_log_sequence_number_at_time(&walE, time, &error);
+	if(error)
+	{
+		printf("failed to find the log_sequence_number at time %" PRIu64 " : error -> %d\n", time, error);
+		exit(-1);
+	}
+	return log_sequence_number;
+}
+
+// a seek to the times[i] must land exactly on the first log record appended after it
+// the entries of the flushes from lost_from_flush onwards have been lost, so their seeks may land earlier
+static void check_seeks_or_exit(const char* when, int lost_from_flush)
+{
+	for(int i = 0; i < FLUSH_COUNT; i++)
+	{
+		uint256 found = find_or_exit(times[i]);
+		if(i < lost_from_flush)
+		{
+			if(!are_equal_uint256(found, first_log_sequence_numbers[i]))
+			{
+				printf("%s : seek to the time of flush %d did not land on its first log record\n", when, i);
+				exit(-1);
+			}
+		}
+		else if(compare_uint256(found, first_log_sequence_numbers[lost_from_flush - 1]) < 0 || compare_uint256(found, first_log_sequence_numbers[i]) > 0)
+		{
+			// without its entry, the seek must land before the log record, but after the last recorded entry
+			printf("%s : seek to the time of flush %d, with its entry lost, landed after its first log record\n", when, i);
+			exit(-1);
+		}
+	}
+
+	// nothing was appended after the last flush, unless its entry was lost
+	if(lost_from_flush == FLUSH_COUNT && !are_equal_uint256(find_or_exit(get_wale_time_index_now() + 1), INVALID_LOG_SEQUENCE_NUMBER))
+	{
+		printf("%s : seek after the last flush found a log record\n", when);
+		exit(-1);
+	}
+
+	printf("%s : all %d seeks landed as expected\n", when, FLUSH_COUNT);
+}
+
+int main()
+{
+	memory_block_io wale_mbio;
+	memory_block_io time_index_mbio;
+	if(!open_memory_block_io(&wale_mbio, BLOCK_SIZE, MAX_BLOCK_COUNT) || !open_memory_block_io(&time_index_mbio, BLOCK_SIZE, MAX_BLOCK_COUNT))
+	{
+		printf("failed to open memory block io : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_memory_block_io(&wale_mbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	// a time index of a different width can not be attached
+	if(!open_wale_time_index(&time_index, get_block_io_ops_for_memory_block_io(&time_index_mbio), 4, MIN_INTERVAL_IN_MICROSECONDS, &error))
+	{
+		printf("failed to create time index : error -> %d\n", error);
+		return -1;
+	}
+	if(attach_wale_time_index(&walE, &time_index, &error) || error != PARAM_INVALID)
+	{
+		printf("attached a time index of a different log_sequence_number_width\n");
+		return -1;
+	}
+	close_wale_time_index(&time_index);
+	close_memory_block_io(&time_index_mbio);
+
+	if(!open_memory_block_io(&time_index_mbio, BLOCK_SIZE, MAX_BLOCK_COUNT)
+		|| !open_wale_time_index(&time_index, get_block_io_ops_for_memory_block_io(&time_index_mbio), 8, MIN_INTERVAL_IN_MICROSECONDS, &error)
+		|| !attach_wale_time_index(&walE, &time_index, &error))
+	{
+		printf("failed to create and attach time index : error -> %d\n", error);
+		return -1;
+	}
+
+	// every flush is preceeded by a distinct microsecond, so the entry of the previous flush is before it, and the entry of this flush is after it
+	for(int i = 0; i < FLUSH_COUNT; i++)
+	{
+		times[i] = get_next_microsecond();
+		for(int j = 0; j <= i % 4; j++)
+		{
+			char log_record[64];
+			sprintf(log_record, "flush=<%d> log_record=<%d>", i, j);
+			uint256 log_sequence_number = append_log_record(&walE, log_record, strlen(log_record) + 1, 0, APPEND_BUFFERED, &error);
+			if(are_equal_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER))
+			{
+				printf("failed to append log record : error -> %d\n", error);
+				return -1;
+			}
+			if(j == 0)
+				first_log_sequence_numbers[i] = log_sequence_number;
+		}
+		flush_all_log_records(&walE, &error);
+		if(error)
+		{
+			printf("failed to flush wale : error -> %d\n", error);
+			return -1;
+		}
+		get_next_microsecond();
+	}
+
+	// a flush with nothing new to flush, is not recorded
+	uint64_t tail_block_id = time_index.tail_block_id;
+	uint32_t tail_entry_count = time_index.tail_entry_count;
+	flush_all_log_records(&walE, &error);
+	if(tail_block_id != time_index.tail_block_id || tail_entry_count != time_index.tail_entry_count)
+	{
+		printf("a flush of nothing was recorded in the time index\n");
+		return -1;
+	}
+	printf("time index has %" PRIu64 " blocks of entries\n", time_index.tail_block_id);
+
+	check_seeks_or_exit("after appends", FLUSH_COUNT);
+
+	// reopen both, the seeks must land the same
+	attach_wale_time_index(&walE, NULL, &error);
+	close_wale_time_index(&time_index);
+	deinitialize_wale(&walE);
+	if(!initialize_wale(&walE, 8, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_memory_block_io(&wale_mbio), APPEND_ONLY_BUFFER_COUNT, &error)
+		|| !open_wale_time_index(&time_index, get_block_io_ops_for_memory_block_io(&time_index_mbio), 8, MIN_INTERVAL_IN_MICROSECONDS, &error)
+		|| !attach_wale_time_index(&walE, &time_index, &error))
+	{
+		printf("failed to reopen wale and its time index : error -> %d\n", error);
+		return -1;
+	}
+	check_seeks_or_exit("after reopen", FLUSH_COUNT);
+
+	// lose the tail block of the index (as if it was never written), the seeks into it must land earlier, but never after their log records
+	uint64_t entries_per_block = (BLOCK_SIZE - 8) / (8 + 8);
+	uint64_t lost_block_id = time_index.tail_block_id;
+	int lost_from_flush = (lost_block_id - 1) * entries_per_block;
+	attach_wale_time_index(&walE, NULL, &error);
+	close_wale_time_index(&time_index);
+	memset(time_index_mbio.memory + lost_block_id * BLOCK_SIZE, 0, BLOCK_SIZE);
+	if(!open_wale_time_index(&time_index, get_block_io_ops_for_memory_block_io(&time_index_mbio), 8, MIN_INTERVAL_IN_MICROSECONDS, &error)
+		|| !attach_wale_time_index(&walE, &time_index, &error))
+	{
+		printf("failed to reopen time index : error -> %d\n", error);
+		return -1;
+	}
+	if(time_index.tail_block_id != lost_block_id - 1)
+	{
+		printf("time index recovered the tail block %" PRIu64 ", expected %" PRIu64 "\n", time_index.tail_block_id, lost_block_id - 1);
+		return -1;
+	}
+	check_seeks_or_exit("after losing the tail block", lost_from_flush);
+
+	// an entry must have a valid next_log_sequence_number
+	if(record_in_wale_time_index(&time_index, get_wale_time_index_now(), INVALID_LOG_SEQUENCE_NUMBER, &error) || error != PARAM_INVALID)
+	{
+		printf("recorded an entry with INVALID_LOG_SEQUENCE_NUMBER\n");
+		return -1;
+	}
+
+	// after truncating the WALe, the seeks before its first log record land on it
+	if(!truncate_log_records_before(&walE, first_log_sequence_numbers[FLUSH_COUNT / 2], &error))
+	{
+		printf("failed to truncate wale : error -> %d\n", error);
+		return -1;
+	}
+	for(int i = 0; i <= FLUSH_COUNT / 2; i++)
+	{
+		if(!are_equal_uint256(find_or_exit(times[i]), first_log_sequence_numbers[FLUSH_COUNT / 2]))
+		{
+			printf("seek to the time of the truncated flush %d did not land on the first log record\n", i);
+			return -1;
+		}
+	}
+
+	// corrupt the block of entries, that the binary search lands on first, the seek must fail with the error of the time index, and not of the WALe
+	uint64_t corrupted_block_id = 1 + (time_index.tail_block_id - 2) / 2;
+	((char*)(time_index_mbio.memory))[corrupted_block_id * BLOCK_SIZE + BLOCK_SIZE / 2] ^= 0x01;
+	if(!are_equal_uint256(find_log_sequence_number_at_time(&walE, times[0], &error), INVALID_LOG_SEQUENCE_NUMBER) || error != TIME_INDEX_CORRUPTED)
+	{
+		printf("seek over a corrupted block of the time index : error -> %d\n", error);
+		return -1;
+	}
+
+	attach_wale_time_index(&walE, NULL, &error);
+	close_wale_time_index(&time_index);
+	deinitialize_wale(&walE);
+	close_memory_block_io(&time_index_mbio);
+	close_memory_block_io(&wale_mbio);
+
+	printf("no error found - time index test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_trace.h>
+
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<time.h>
+#include<unistd.h>
+
+#define FILENAME			"test_trace.log"
+#define BLOCK_SIZE			4096
+
+#define APPEND_ONLY_BUFFER_COUNT 4
+
+#define THREAD_COUNT 4
+#define LOGS_PER_THREAD 5000
+
+// every thread flushes after these many appends
+#define FLUSH_EVERY 1000
+
+#define LOG_FORMAT "thread=<%d> log_number=<%d>"
+
+wale walE;
+
+// the tracer, it counts the events and measures the longest stall on the wait_for_scroll
+
+typedef struct tracer tracer;
+struct tracer
+{
+	uint64_t append_slots_reserved;
+	uint64_t scroll_begins;
+	uint64_t scroll_ends;
+	uint64_t wait_for_scroll_begins;
+	uint64_t wait_for_scroll_ends;
+	uint64_t flush_begins;
+	uint64_t flush_ends;
+	uint64_t master_records_written;
+	uint64_t read_ios;
+	uint64_t read_blocks;
+
+	uint64_t max_wait_for_scroll_ns;
+};
+
+static __thread uint64_t wait_for_scroll_begin_time;
+
+static uint64_t now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec) * UINT64_C(1000000000) + ((uint64_t)now.tv_nsec);
+}
+
+static void count(uint64_t* counter, uint64_t value)
+{
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static void on_append_slot_reserved(void* trace_handle, const wale* wale_p, uint256 log_sequence_number, uint32_t log_record_size, uint64_t append_slot)
+{
+	count(&(((tracer*)trace_handle)->append_slots_reserved), 1);
+}
+
+static void on_scroll_begin(void* trace_handle, const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count)
+{
+	count(&(((tracer*)trace_handle)->scroll_begins), 1);
+}
+
+static void on_scroll_end(void* trace_handle, const wale* wale_p, uint64_t buffer_start_block_id, uint64_t block_count, int success)
+{
+	count(&(((tracer*)trace_handle)->scroll_ends), 1);
+}
+
+static void on_wait_for_scroll_begin(void* trace_handle, const wale* wale_p)
+{
+	count(&(((tracer*)trace_handle)->wait_for_scroll_begins), 1);
+	wait_for_scroll_begin_time = now_ns();
+}
+
+static void on_wait_for_scroll_end(void* trace_handle, const wale* wale_p)
+{
+	tracer* tracer_p = trace_handle;
+	count(&(tracer_p->wait_for_scroll_ends), 1);
+
+	uint64_t waited_ns = now_ns() - wait_for_scroll_begin_time;
+	uint64_t curr_max = __atomic_load_n(&(tracer_p->max_wait_for_scroll_ns), __ATOMIC_RELAXED);
+	while(curr_max < waited_ns && !__atomic_compare_exchange_n(&(tracer_p->max_wait_for_scroll_ns), &curr_max, waited_ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static void on_flush_begin(void* trace_handle, const wale* wale_p)
+{
+	count(&(((tracer*)trace_handle)->flush_begins), 1);
+}
+
+static void on_flush_end(void* trace_handle, const wale* wale_p, uint256 last_flushed_log_sequence_number, int success)
+{
+	count(&(((tracer*)trace_handle)->flush_ends), 1);
+}
+
+static void on_master_record_written(void* trace_handle, const wale* wale_p, uint256 last_flushed_log_sequence_number, int success)
+{
+	count(&(((tracer*)trace_handle)->master_records_written), 1);
+}
+
+static void on_read_io(void* trace_handle, const wale* wale_p, uint64_t block_id, uint64_t block_count)
+{
+	count(&(((tracer*)trace_handle)->read_ios), 1);
+	count(&(((tracer*)trace_handle)->read_blocks), block_count);
+}
+
+tracer tracer_data;
+
+const wale_trace_callbacks callbacks = {
+	.trace_handle = &tracer_data,
+	.append_slot_reserved = on_append_slot_reserved,
+	.scroll_begin = on_scroll_begin,
+	.scroll_end = on_scroll_end,
+	.wait_for_scroll_begin = on_wait_for_scroll_begin,
+	.wait_for_scroll_end = on_wait_for_scroll_end,
+	.flush_begin = on_flush_begin,
+	.flush_end = on_flush_end,
+	.master_record_written = on_master_record_written,
+	.read_io = on_read_io,
+};
+
+static void* append_log_records(void* thread_id_p)
+{
+	int thread_id = *((int*)thread_id_p);
+	for(int log_number = 0; log_number < LOGS_PER_THREAD; log_number++)
+	{
+		char log_buffer[64];
+		sprintf(log_buffer, LOG_FORMAT, thread_id, log_number);
+
+		int error = 0;
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+
+		if((log_number + 1) % FLUSH_EVERY == 0)
+			flush_all_log_records(&walE, &error);
+	}
+	return NULL;
+}
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	set_wale_trace_callbacks(&walE, &callbacks);
+
+	pthread_t threads[THREAD_COUNT];
+	int thread_ids[THREAD_COUNT];
+	for(int i = 0; i < THREAD_COUNT; i++)
+	{
+		thread_ids[i] = i;
+		pthread_create(&(threads[i]), NULL, append_log_records, &(thread_ids[i]));
+	}
+	for(int i = 0; i < THREAD_COUNT; i++)
+		pthread_join(threads[i], NULL);
+
+	flush_all_log_records(&walE, &error);
+
+	// walk all the log records, to fire the read_io events
+	uint64_t log_records_read = 0;
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		uint32_t log_record_size;
+		free(get_log_record_at(&walE, log_sequence_number, &log_record_size, &error));
+		log_records_read++;
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	}
+
+	set_wale_trace_callbacks(&walE, NULL);
+
+	printf("append_slot_reserved = %" PRIu64 "\n", tracer_data.append_slots_reserved);
+	printf("scroll begin/end = %" PRIu64 "/%" PRIu64 "\n", tracer_data.scroll_begins, tracer_data.scroll_ends);
+	printf("wait_for_scroll begin/end = %" PRIu64 "/%" PRIu64 ", longest wait = %" PRIu64 " ns\n", tracer_data.wait_for_scroll_begins, tracer_data.wait_for_scroll_ends, tracer_data.max_wait_for_scroll_ns);
+	printf("flush begin/end = %" PRIu64 "/%" PRIu64 "\n", tracer_data.flush_begins, tracer_data.flush_ends);
+	printf("master_record_written = %" PRIu64 "\n", tracer_data.master_records_written);
+	printf("read_io = %" PRIu64 " (%" PRIu64 " blocks), for %" PRIu64 " log records read\n", tracer_data.read_ios, tracer_data.read_blocks, log_records_read);
+
+	if(tracer_data.append_slots_reserved != THREAD_COUNT * LOGS_PER_THREAD || log_records_read != THREAD_COUNT * LOGS_PER_THREAD ||
+		tracer_data.scroll_begins != tracer_data.scroll_ends ||
+		tracer_data.wait_for_scroll_begins != tracer_data.wait_for_scroll_ends ||
+		tracer_data.flush_begins != tracer_data.flush_ends ||
+		tracer_data.flush_begins != tracer_data.master_records_written)
+	{
+		printf("\ntrace events were not fired correctly\n");
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/stat.h>
+
+#define FILENAME			"test_truncate_before.log"
+#define BLOCK_SIZE			4096
+
+#define APPEND_ONLY_BUFFER_COUNT 16
+
+#define LOGS_TO_WRITE 20000
+
+#define LOG_FORMAT "log_number=<%d> padding=<%.*s>"
+#define PADDING "0123456789-10111213141516171819-20212223242526272829-30313233343536373839-40414243444546474849-50515253545556575859"
+
+wale walE;
+
+static void print_file_usage(const char* when)
+{
+	struct stat st;
+	stat(FILENAME, &st);
+	printf("%s : file size = %lld, allocated bytes = %lld\n", when, (long long)st.st_size, (long long)st.st_blocks * 512LL);
+}
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		close_file_block_io(&fbio);
+		return -1;
+	}
+
+	uint256 middle_log_sequence_number = INVALID_LOG_SEQUENCE_NUMBER;
+	for(int log_number = 0; log_number < LOGS_TO_WRITE; log_number++)
+	{
+		char log_buffer[256];
+		sprintf(log_buffer, LOG_FORMAT, log_number, (int)(strlen(PADDING)), PADDING);
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+		if(log_number == LOGS_TO_WRITE / 2)
+			middle_log_sequence_number = log_sequence_number;
+	}
+
+	printf("flushed until = "); print_uint256(flush_all_log_records(&walE, &error)); printf(" : error -> %d\n", error);
+	print_file_usage("before truncation");
+
+	// a log_sequence_number that is not at the start of a log record must fail
+	uint256 not_a_log_record;
+	add_overflow_safe_uint256(&not_a_log_record, middle_log_sequence_number, get_uint256(3), get_0_uint256());
+	int truncated = truncate_log_records_before(&walE, not_a_log_record, &error);
+	printf("truncation at a non log record boundary = %d : error -> %d\n", truncated, error);
+
+	truncated = truncate_log_records_before(&walE, middle_log_sequence_number, &error);
+	printf("truncation before the middle log record = %d : error -> %d\n", truncated, error);
+	print_file_usage("after truncation");
+
+	printf("first_log_sequence_number = "); print_uint256(get_first_log_sequence_number(&walE)); printf("\n");
+	printf("middle_log_sequence_number = "); print_uint256(middle_log_sequence_number); printf("\n");
+
+	// the surviving log records must all be readable, in order
+	int expected_log_number = LOGS_TO_WRITE / 2;
+	uint256 log_sequence_number = get_first_log_sequence_number(&walE);
+	while(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) != 0)
+	{
+		uint32_t log_record_size;
+		char* log_record = (char*) get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+		int log_number = -1;
+		if(log_record == NULL || sscanf(log_record, "log_number=<%d>", &log_number) != 1 || log_number != expected_log_number)
+		{
+			printf("error at log_sequence_number = "); print_uint256(log_sequence_number); printf(" : error -> %d, log_number = %d, expected = %d\n", error, log_number, expected_log_number);
+			exit(-1);
+		}
+		free(log_record);
+		expected_log_number++;
+		log_sequence_number = get_next_log_sequence_number_of(&walE, log_sequence_number, &error);
+	}
+
+	if(expected_log_number != LOGS_TO_WRITE)
+	{
+		printf("error we saw only %d log records\n", expected_log_number - LOGS_TO_WRITE / 2);
+		exit(-1);
+	}
+
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	// reopening must see the truncated log, as it is
+	open_file_block_io(&fbio, FILENAME, 0, BLOCK_SIZE, 0);
+	if(!initialize_wale(&walE, 0, INVALID_LOG_SEQUENCE_NUMBER, 0, NULL, get_block_io_ops_for_file_block_io(&fbio), 0, &error))
+	{
+		printf("failed to reopen wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+	printf("first_log_sequence_number after reopening = "); print_uint256(get_first_log_sequence_number(&walE)); printf("\n");
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	printf("no error found - truncate_before test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include<stdio.h>
+#include<stdlib.h>
+
+#include<file_block_io_ops.h>
+
+#include<wale.h>
+#include<wale_stats.h>
+
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+
+#define FILENAME			"test_vectored_io.log"
+#define BLOCK_SIZE			512
+
+#define RING_BLOCK_COUNT 64
+
+#define APPEND_ONLY_BUFFER_COUNT 8
+
+#define ROUNDS 4
+
+// larger than a few pooled block buffers, so that it is read with a scattered vectored read
+#define LARGE_LOG_RECORD_SIZE (300 * 1024)
+
+#define LOG_FORMAT "round=<%d> log_number=<%d> some padding to make the log records span across the blocks"
+
+// wraps the file_block_io, counting the ios issued to it
+typedef struct counting_block_io counting_block_io;
+struct counting_block_io
+{
+	block_io_ops file_block_io_functions;
+
+	uint64_t write_ios;
+
+	// write ios of more than one vector, i.e. of the runs of blocks that wrapped around the ring
+	uint64_t multi_vector_write_ios;
+};
+
+static int read_blocks_counting(const void* block_io_ops_handle, void* dest, uint64_t block_id, uint64_t block_count)
+{
+	const counting_block_io* cbio_p = block_io_ops_handle;
+	return cbio_p->file_block_io_functions.read_blocks(cbio_p->file_block_io_functions.block_io_ops_handle, dest, block_id, block_count);
+}
+
+static int write_blocks_counting(const void* block_io_ops_handle, const void* src, uint64_t block_id, uint64_t block_count)
+{
+	counting_block_io* cbio_p = (counting_block_io*) block_io_ops_handle;
+	cbio_p->write_ios++;
+	return cbio_p->file_block_io_functions.write_blocks(cbio_p->file_block_io_functions.block_io_ops_handle, src, block_id, block_count);
+}
+
+static int flush_all_writes_counting(const void* block_io_ops_handle)
+{
+	const counting_block_io* cbio_p = block_io_ops_handle;
+	return cbio_p->file_block_io_functions.flush_all_writes(cbio_p->file_block_io_functions.block_io_ops_handle);
+}
+
+static int read_blocks_v_counting(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	const counting_block_io* cbio_p = block_io_ops_handle;
+	return cbio_p->file_block_io_functions.read_blocks_v(cbio_p->file_block_io_functions.block_io_ops_handle, vectors, vector_count);
+}
+
+static int write_blocks_v_counting(const void* block_io_ops_handle, const block_io_vector* vectors, uint64_t vector_count)
+{
+	counting_block_io* cbio_p = (counting_block_io*) block_io_ops_handle;
+	cbio_p->write_ios++;
+	if(vector_count > 1)
+		cbio_p->multi_vector_write_ios++;
+	return cbio_p->file_block_io_functions.write_blocks_v(cbio_p->file_block_io_functions.block_io_ops_handle, vectors, vector_count);
+}
+
+static void fill_block(char* block, char fill)
+{
+	memset(block, fill, BLOCK_SIZE);
+}
+
+static void check_block(const char* block, char fill, const char* what)
+{
+	for(int i = 0; i < BLOCK_SIZE; i++)
+	{
+		if(block[i] != fill)
+		{
+			printf("%s : expected 0x%02x at byte %d, found 0x%02x\n", what, fill, i, block[i]);
+			exit(-1);
+		}
+	}
+}
+
+// writes non-contiguous runs of blocks with a single write_blocks_v, and reads them back with both read_blocks and read_blocks_v
+static void test_file_block_io_vectors(const block_io_ops* bio)
+{
+	char* blocks = aligned_alloc(BLOCK_SIZE, 6 * BLOCK_SIZE);
+	for(int i = 0; i < 6; i++)
+		fill_block(blocks + i * BLOCK_SIZE, 'a' + i);
+
+	// the first two runs are contiguous on disk, but not in memory
+	block_io_vector write_vectors[] = {
+		{.buffer = blocks + 0 * BLOCK_SIZE, .block_id = 3, .block_count = 2},
+		{.buffer = blocks + 5 * BLOCK_SIZE, .block_id = 5, .block_count = 1},
+		{.buffer = blocks + 2 * BLOCK_SIZE, .block_id = 10, .block_count = 3},
+	};
+	if(!bio->write_blocks_v(bio->block_io_ops_handle, write_vectors, 3))
+	{
+		printf("write_blocks_v failed : errno = %d\n", errno);
+		exit(-1);
+	}
+
+	char* read_back = aligned_alloc(BLOCK_SIZE, 8 * BLOCK_SIZE);
+	const char expected[] = {'a', 'b', 'f', 0, 0, 0, 0, 'c', 'd', 'e'};
+	for(int i = 0; i < 10; i++)
+	{
+		if(!bio->read_blocks(bio->block_io_ops_handle, read_back, 3 + i, 1))
+		{
+			printf("read_blocks failed : errno = %d\n", errno);
+			exit(-1);
+		}
+		check_block(read_back, expected[i], "read_blocks after write_blocks_v");
+	}
+
+	// the last run is past the end of the file, and must read as zeros
+	memset(read_back, 0xff, 8 * BLOCK_SIZE);
+	block_io_vector read_vectors[] = {
+		{.buffer = read_back + 4 * BLOCK_SIZE, .block_id = 3, .block_count = 3},
+		{.buffer = read_back + 0 * BLOCK_SIZE, .block_id = 11, .block_count = 2},
+		{.buffer = read_back + 7 * BLOCK_SIZE, .block_id = 1000, .block_count = 1},
+	};
+	if(!bio->read_blocks_v(bio->block_io_ops_handle, read_vectors, 3))
+	{
+		printf("read_blocks_v failed : errno = %d\n", errno);
+		exit(-1);
+	}
+	check_block(read_back + 4 * BLOCK_SIZE, 'a', "read_blocks_v");
+	check_block(read_back + 5 * BLOCK_SIZE, 'b', "read_blocks_v");
+	check_block(read_back + 6 * BLOCK_SIZE, 'f', "read_blocks_v");
+	check_block(read_back + 0 * BLOCK_SIZE, 'd', "read_blocks_v");
+	check_block(read_back + 1 * BLOCK_SIZE, 'e', "read_blocks_v");
+	check_block(read_back + 7 * BLOCK_SIZE, 0, "read_blocks_v past the end of the file");
+
+	free(blocks);
+	free(read_back);
+}
+
+wale walE;
+
+// appends log records until the ring is full, returns the number of log records appended
+static int append_until_ring_is_full(int round)
+{
+	int log_number = 0;
+	while(1)
+	{
+		char log_buffer[256];
+		sprintf(log_buffer, LOG_FORMAT, round, log_number);
+		int error = 0;
+		uint256 log_sequence_number = append_log_record(&walE, log_buffer, strlen(log_buffer) + 1, 0, APPEND_BUFFERED, &error);
+		if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+		{
+			if(error == LOG_RING_FULL)
+				return log_number;
+			printf("failed to append to wale : error -> %d\n", error);
+			exit(-1);
+		}
+		log_number++;
+	}
+}
+
+int main()
+{
+	file_block_io fbio;
+	unlink(FILENAME);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+
+	block_io_ops file_block_io_functions = get_block_io_ops_for_file_block_io(&fbio);
+	test_file_block_io_vectors(&file_block_io_functions);
+	printf("file block io vectors read back correctly\n");
+
+	// a ring WALe over the counting file_block_io
+	counting_block_io cbio = {.file_block_io_functions = file_block_io_functions};
+	block_io_ops counting_block_io_functions = {
+		.block_io_ops_handle = &cbio,
+		.block_size = file_block_io_functions.block_size,
+		.block_buffer_alignment = file_block_io_functions.block_buffer_alignment,
+		.read_blocks = read_blocks_counting,
+		.write_blocks = write_blocks_counting,
+		.flush_all_writes = flush_all_writes_counting,
+		.read_blocks_v = read_blocks_v_counting,
+		.write_blocks_v = write_blocks_v_counting,
+	};
+
+	int error = 0;
+	if(!initialize_wale(&walE, 8, get_uint256(7), RING_BLOCK_COUNT, NULL, counting_block_io_functions, APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	// every write io of the WALe, including the scrolls that wrap around the ring, must reach the file as a single io
+	wale_stats stats;
+	get_wale_stats(&walE, &stats);
+	uint64_t wale_write_ios = stats.counters[WALE_STATS_WRITE_IOS];
+	uint64_t file_write_ios = cbio.write_ios;
+
+	for(int round = 0; round < ROUNDS; round++)
+	{
+		int log_records_appended = append_until_ring_is_full(round);
+
+		uint256 last_flushed_log_sequence_number = flush_all_log_records(&walE, &error);
+		if(error)
+		{
+			printf("failed to flush : error -> %d\n", error);
+			exit(-1);
+		}
+		printf("round = %d : appended = %d\n", round, log_records_appended);
+
+		// make the ring reusable for the next round, by truncating all but the last log record
+		if(!truncate_log_records_before(&walE, last_flushed_log_sequence_number, &error))
+		{
+			printf("failed to truncate : error -> %d\n", error);
+			exit(-1);
+		}
+	}
+
+	get_wale_stats(&walE, &stats);
+	wale_write_ios = stats.counters[WALE_STATS_WRITE_IOS] - wale_write_ios;
+	file_write_ios = cbio.write_ios - file_write_ios;
+	printf("%" PRIu64 " write ios of the WALe, issued as %" PRIu64 " file write ios, %" PRIu64 " of them wrapped around the ring\n", wale_write_ios, file_write_ios, cbio.multi_vector_write_ios);
+	if(file_write_ios != wale_write_ios || cbio.multi_vector_write_ios == 0)
+	{
+		printf("the writes wrapping around the ring were not issued as single vectored ios\n");
+		return -1;
+	}
+
+	deinitialize_wale(&walE);
+
+	// a large log record is read back with lesser ios than the pooled buffers it spans
+	unlink(FILENAME);
+	close_file_block_io(&fbio);
+	if(!open_file_block_io(&fbio, FILENAME, 1, BLOCK_SIZE, 0))
+	{
+		printf("failed to create file : errno = %d\n", errno);
+		return -1;
+	}
+	if(!initialize_wale(&walE, 8, get_uint256(7), 0, NULL, get_block_io_ops_for_file_block_io(&fbio), APPEND_ONLY_BUFFER_COUNT, &error))
+	{
+		printf("failed to create wale instance wale_erro = %d\n", error);
+		return -1;
+	}
+
+	char* large_log_record = malloc(LARGE_LOG_RECORD_SIZE);
+	for(uint32_t i = 0; i < LARGE_LOG_RECORD_SIZE; i++)
+		large_log_record[i] = (char)(i % 251);
+	uint256 log_sequence_number = append_log_record(&walE, large_log_record, LARGE_LOG_RECORD_SIZE, 0, APPEND_DURABLE, &error);
+	if(compare_uint256(log_sequence_number, INVALID_LOG_SEQUENCE_NUMBER) == 0)
+	{
+		printf("failed to append to wale : error -> %d\n", error);
+		return -1;
+	}
+
+	get_wale_stats(&walE, &stats);
+	uint64_t read_ios = stats.counters[WALE_STATS_READ_IOS];
+
+	uint32_t log_record_size;
+	char* log_record = get_log_record_at(&walE, log_sequence_number, &log_record_size, &error);
+	if(log_record == NULL || log_record_size != LARGE_LOG_RECORD_SIZE || memcmp(log_record, large_log_record, LARGE_LOG_RECORD_SIZE) != 0)
+	{
+		printf("large log record read incorrectly : error = %d\n", error);
+		return -1;
+	}
+	free(log_record);
+
+	get_wale_stats(&walE, &stats);
+	read_ios = stats.counters[WALE_STATS_READ_IOS] - read_ios;
+	printf("large log record of %d bytes read with %" PRIu64 " read ios\n", LARGE_LOG_RECORD_SIZE, read_ios);
+
+	// the header and the crc32 of the log record are read with an io each, and the log record with atmost 2 vectored ios
+	if(read_ios > 4)
+	{
+		printf("large log record was not read with vectored ios\n");
+		return -1;
+	}
+
+	free(large_log_record);
+	deinitialize_wale(&walE);
+	close_file_block_io(&fbio);
+
+	printf("no error found - vectored io test cases were successfull\n");
+
+	return 0;
+}
\ No newline at end of file